@@ -9,6 +9,29 @@
 
 static std::atomic<uint64_t> s_revision{ 0 };
 
+static bool equalPixels(const std::vector<RGBQUAD>& lhs, const std::vector<RGBQUAD>& rhs) noexcept
+{
+    return lhs.size() == rhs.size() && (lhs.empty() || std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(RGBQUAD)) == 0);
+}
+
+// Returns a table that maps pixel indices to colors, including the transparent index 0.
+static std::array<RGBQUAD, 256> paletteLookupTable(const std::vector<RGBQUAD>& palette) noexcept
+{
+    std::array<RGBQUAD, 256> lut{};
+    std::copy_n(palette.begin(), std::min<size_t>(palette.size(), lut.size() - 1), lut.begin() + 1);
+    return lut;
+}
+
+bool ImageSlice::Storage::IsIndexed() const noexcept
+{
+    return pixels.empty();
+}
+
+bool ImageSlice::Storage::operator==(const Storage& rhs) const noexcept
+{
+    return indices == rhs.indices && equalPixels(palette, rhs.palette) && equalPixels(pixels, rhs.pixels);
+}
+
 ImageSlice::ImageSlice(const til::size cellSize) noexcept :
     _cellSize{ cellSize }
 {
@@ -43,57 +66,299 @@ til::CoordType ImageSlice::PixelWidth() const noexcept
     return _pixelWidth;
 }
 
-std::span<const RGBQUAD> ImageSlice::Pixels() const noexcept
+// Returns the number of pixels that ExpandPixels() writes.
+size_t ImageSlice::PixelCount() const noexcept
+{
+    return _storage ? gsl::narrow_cast<size_t>(_pixelWidth) * gsl::narrow_cast<size_t>(_cellSize.height) : 0;
+}
+
+// Returns the approximate number of bytes this slice occupies.
+// Storage that's shared with other slices is split up evenly between them.
+size_t ImageSlice::MemoryUsage() const noexcept
+{
+    auto bytes = sizeof(ImageSlice);
+    if (_storage)
+    {
+        const auto& s = *_storage;
+        const auto storageBytes = sizeof(Storage) + s.indices.capacity() + (s.palette.capacity() + s.pixels.capacity()) * sizeof(RGBQUAD);
+        bytes += storageBytes / gsl::narrow_cast<size_t>(std::max(1L, _storage.use_count()));
+    }
+    return bytes;
+}
+
+bool ImageSlice::SharesStorageWith(const ImageSlice& other) const noexcept
+{
+    return _storage && _storage == other._storage;
+}
+
+// Converts the pixels to RGBQUADs, as expected by the renderers. This is only done at paint time,
+// which allows us to store them as palette indices the rest of the time.
+// `dst` should be PixelCount() large. Transparent pixels have an rgbReserved of 0.
+void ImageSlice::ExpandPixels(const std::span<RGBQUAD> dst) const noexcept
+{
+    if (!_storage)
+    {
+        return;
+    }
+
+    const auto& s = *_storage;
+
+    if (s.IsIndexed())
+    {
+        const auto lut = paletteLookupTable(s.palette);
+        const auto count = std::min(dst.size(), s.indices.size());
+        for (size_t i = 0; i < count; i++)
+        {
+            til::at(dst, i) = til::at(lut, til::at(s.indices, i));
+        }
+    }
+    else
+    {
+        const auto count = std::min(dst.size(), s.pixels.size());
+        std::memcpy(dst.data(), s.pixels.data(), count * sizeof(RGBQUAD));
+    }
+}
+
+// Writes a block of `srcWidth` x `srcHeight` pixels to the slice, starting at the left edge of `columnBegin`.
+// The columns in [columnBegin, columnEnd) are allocated if necessary. `colors` maps the color indices of the
+// source pixels to their color and must have 256 entries. Transparent source pixels leave the slice unchanged.
+void ImageSlice::WritePixels(const til::CoordType columnBegin, const til::CoordType columnEnd, const IndexedPixel* src, const size_t srcStride, const til::CoordType srcWidth, const til::CoordType srcHeight, const std::span<const RGBQUAD> colors)
+{
+    assert(colors.size() >= 256);
+
+    auto& storage = _prepareWrite(columnBegin, columnEnd);
+    const auto dstOffset = gsl::narrow_cast<size_t>((columnBegin - _columnBegin) * _cellSize.width);
+    const auto dstStride = gsl::narrow_cast<size_t>(_pixelWidth);
+    const auto width = gsl::narrow_cast<size_t>(std::clamp(srcWidth, 0, _pixelWidth - (columnBegin - _columnBegin) * _cellSize.width));
+    const auto height = gsl::narrow_cast<size_t>(std::clamp(srcHeight, 0, _cellSize.height));
+
+    if (storage.IsIndexed())
+    {
+        std::array<bool, 256> used{};
+        for (size_t y = 0; y < height; y++)
+        {
+            const auto srcRow = src + y * srcStride;
+            for (size_t x = 0; x < width; x++)
+            {
+                const auto& pixel = srcRow[x];
+                if (!pixel.transparent)
+                {
+                    til::at(used, pixel.colorIndex) = true;
+                }
+            }
+        }
+
+        std::array<uint8_t, 256> mapping{};
+        const auto mapUsedColors = [&]() {
+            for (size_t i = 0; i < used.size(); i++)
+            {
+                if (til::at(used, i) && !_mapColor(storage, til::at(colors, i), til::at(mapping, i)))
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // Palettes fill up with colors that aren't used anymore when images are overwritten
+        // repeatedly (e.g. animations), so we try to compact it before giving up on it.
+        auto fits = mapUsedColors();
+        if (!fits)
+        {
+            _compactPalette(storage);
+            fits = mapUsedColors();
+        }
+
+        if (fits)
+        {
+            for (size_t y = 0; y < height; y++)
+            {
+                const auto srcRow = src + y * srcStride;
+                const auto dstRow = storage.indices.data() + dstOffset + y * dstStride;
+                for (size_t x = 0; x < width; x++)
+                {
+                    const auto& pixel = srcRow[x];
+                    if (!pixel.transparent)
+                    {
+                        dstRow[x] = til::at(mapping, pixel.colorIndex);
+                    }
+                }
+            }
+            return;
+        }
+
+        _convertToPixels(storage);
+    }
+
+    for (size_t y = 0; y < height; y++)
+    {
+        const auto srcRow = src + y * srcStride;
+        const auto dstRow = storage.pixels.data() + dstOffset + y * dstStride;
+        for (size_t x = 0; x < width; x++)
+        {
+            const auto& pixel = srcRow[x];
+            if (!pixel.transparent)
+            {
+                dstRow[x] = til::at(colors, pixel.colorIndex);
+            }
+        }
+    }
+}
+
+// If `other` has the same size, position and contents as this slice,
+// this slice will share its storage with `other` and return true.
+bool ImageSlice::Deduplicate(const ImageSlice& other) noexcept
 {
-    return _pixelBuffer;
+    if (!_storage || !other._storage)
+    {
+        return false;
+    }
+    if (_storage == other._storage)
+    {
+        return true;
+    }
+    if (_cellSize != other._cellSize || _columnBegin != other._columnBegin || _columnEnd != other._columnEnd || !(*_storage == *other._storage))
+    {
+        return false;
+    }
+    _storage = other._storage;
+    return true;
 }
 
-const RGBQUAD* ImageSlice::Pixels(const til::CoordType columnBegin) const noexcept
+ImageSlice::Storage& ImageSlice::_mutableStorage()
 {
-    const auto pixelOffset = (columnBegin - _columnBegin) * _cellSize.width;
-    return &til::at(_pixelBuffer, pixelOffset);
+    if (!_storage)
+    {
+        _storage = std::make_shared<Storage>();
+    }
+    else if (_storage.use_count() > 1)
+    {
+        _storage = std::make_shared<Storage>(*_storage);
+    }
+    return *_storage;
 }
 
-RGBQUAD* ImageSlice::MutablePixels(const til::CoordType columnBegin, const til::CoordType columnEnd)
+// Ensures that the storage is exclusively owned by this slice and that it covers the given columns.
+ImageSlice::Storage& ImageSlice::_prepareWrite(const til::CoordType columnBegin, const til::CoordType columnEnd)
 {
+    auto& storage = _mutableStorage();
+    const auto existingData = !storage.indices.empty() || !storage.pixels.empty();
+
     // IF the buffer is empty or isn't large enough for the requested range, we'll need to resize it.
-    if (_pixelBuffer.empty() || columnBegin < _columnBegin || columnEnd > _columnEnd)
+    if (!existingData || columnBegin < _columnBegin || columnEnd > _columnEnd)
     {
         const auto oldColumnBegin = _columnBegin;
         const auto oldPixelWidth = _pixelWidth;
-        const auto existingData = !_pixelBuffer.empty();
         _columnBegin = existingData ? std::min(_columnBegin, columnBegin) : columnBegin;
         _columnEnd = existingData ? std::max(_columnEnd, columnEnd) : columnEnd;
         _pixelWidth = (_columnEnd - _columnBegin) * _cellSize.width;
-        const auto bufferSize = _pixelWidth * _cellSize.height;
-        if (existingData)
-        {
+        const auto bufferSize = gsl::narrow_cast<size_t>(_pixelWidth * _cellSize.height);
+
+        const auto resize = [&](auto& plane) {
+            using T = typename std::decay_t<decltype(plane)>::value_type;
+
+            if (!existingData)
+            {
+                // Otherwise we just initialize the buffer to the correct size.
+                plane.assign(bufferSize, T{});
+                return;
+            }
+
             // If there is existing data in the buffer, we need to copy it
             // across to the appropriate position in the new buffer.
-            auto newPixelBuffer = std::vector<RGBQUAD>(bufferSize);
+            auto newPlane = std::vector<T>(bufferSize);
             const auto newPixelOffset = (oldColumnBegin - _columnBegin) * _cellSize.width;
-            auto newIterator = std::next(newPixelBuffer.data(), newPixelOffset);
-            auto oldIterator = _pixelBuffer.data();
+            auto newIterator = std::next(newPlane.data(), newPixelOffset);
+            auto oldIterator = plane.data();
             // Because widths are rounded up to multiples of 4, it's possible
             // that the old width will extend past the right border of the new
             // buffer, so the range that we copy must be clamped to fit.
             const auto newPixelRange = std::min(oldPixelWidth, _pixelWidth - newPixelOffset);
             for (auto i = 0; i < _cellSize.height; i++)
             {
-                std::memcpy(newIterator, oldIterator, newPixelRange * sizeof(RGBQUAD));
+                std::memcpy(newIterator, oldIterator, newPixelRange * sizeof(T));
                 std::advance(oldIterator, oldPixelWidth);
                 std::advance(newIterator, _pixelWidth);
             }
-            _pixelBuffer = std::move(newPixelBuffer);
+            plane = std::move(newPlane);
+        };
+
+        if (storage.IsIndexed())
+        {
+            resize(storage.indices);
         }
         else
         {
-            // Otherwise we just initialize the buffer to the correct size.
-            _pixelBuffer.resize(bufferSize);
+            resize(storage.pixels);
+        }
+    }
+
+    return storage;
+}
+
+// Stores the palette index for `color` in `index`, adding it to the palette if necessary.
+// Returns false if the palette is full.
+bool ImageSlice::_mapColor(Storage& storage, const RGBQUAD color, uint8_t& index)
+{
+    auto& palette = storage.palette;
+    size_t pos = 0;
+    while (pos < palette.size() && std::memcmp(&til::at(palette, pos), &color, sizeof(RGBQUAD)) != 0)
+    {
+        pos++;
+    }
+
+    if (pos == palette.size())
+    {
+        if (palette.size() >= MaxPaletteSize)
+        {
+            return false;
         }
+        palette.emplace_back(color);
     }
-    const auto pixelOffset = (columnBegin - _columnBegin) * _cellSize.width;
-    return &til::at(_pixelBuffer, pixelOffset);
+
+    index = gsl::narrow_cast<uint8_t>(pos + 1);
+    return true;
+}
+
+// Removes all colors from the palette that aren't referenced by any pixel.
+void ImageSlice::_compactPalette(Storage& storage)
+{
+    std::array<bool, 256> used{};
+    for (const auto index : storage.indices)
+    {
+        til::at(used, index) = true;
+    }
+
+    std::array<uint8_t, 256> mapping{};
+    std::vector<RGBQUAD> palette;
+    for (size_t i = 0; i < storage.palette.size(); i++)
+    {
+        if (til::at(used, i + 1))
+        {
+            palette.emplace_back(til::at(storage.palette, i));
+            til::at(mapping, i + 1) = gsl::narrow_cast<uint8_t>(palette.size());
+        }
+    }
+
+    for (auto& index : storage.indices)
+    {
+        index = til::at(mapping, index);
+    }
+    storage.palette = std::move(palette);
+}
+
+// Converts the storage from palette indices to RGBQUADs.
+void ImageSlice::_convertToPixels(Storage& storage)
+{
+    const auto lut = paletteLookupTable(storage.palette);
+    storage.pixels.resize(storage.indices.size());
+    for (size_t i = 0; i < storage.indices.size(); i++)
+    {
+        til::at(storage.pixels, i) = til::at(lut, til::at(storage.indices, i));
+    }
+    // NOTE: Assigning {} would only clear() the vectors, without freeing their memory.
+    storage.indices = std::vector<uint8_t>{};
+    storage.palette = std::vector<RGBQUAD>{};
 }
 
 void ImageSlice::CopyBlock(const TextBuffer& srcBuffer, const til::rect srcRect, TextBuffer& dstBuffer, const til::rect dstRect)
@@ -173,16 +438,7 @@ bool ImageSlice::_copyCells(const ImageSlice& srcSlice, const til::CoordType src
 
     if (dstWriteBegin < dstWriteEnd)
     {
-        auto dstIterator = MutablePixels(dstWriteBegin, dstWriteEnd);
-        auto srcIterator = srcSlice.Pixels(srcUsedBegin);
-        const auto writeCellCount = dstWriteEnd - dstWriteBegin;
-        const auto writeByteCount = sizeof(RGBQUAD) * writeCellCount * _cellSize.width;
-        for (auto y = 0; y < _cellSize.height; y++)
-        {
-            std::memmove(dstIterator, srcIterator, writeByteCount);
-            std::advance(srcIterator, srcSlice._pixelWidth);
-            std::advance(dstIterator, _pixelWidth);
-        }
+        _copyPixels(srcSlice, srcUsedBegin, dstWriteBegin, dstWriteEnd);
     }
 
     // The used destination before and after the written area must be erased.
@@ -203,6 +459,93 @@ bool ImageSlice::_copyCells(const ImageSlice& srcSlice, const til::CoordType src
     return _columnBegin >= _columnEnd;
 }
 
+// Copies the pixels of srcSlice starting at srcColumnBegin into the columns [dstColumnBegin, dstColumnEnd).
+void ImageSlice::_copyPixels(const ImageSlice& srcSlice, const til::CoordType srcColumnBegin, const til::CoordType dstColumnBegin, const til::CoordType dstColumnEnd)
+{
+    // _prepareWrite() may clone our storage or move our columns around.
+    // If srcSlice is this slice, we must only access it afterwards.
+    auto& dst = _prepareWrite(dstColumnBegin, dstColumnEnd);
+    const auto& src = *srcSlice._storage;
+    const auto srcOffset = gsl::narrow_cast<size_t>((srcColumnBegin - srcSlice._columnBegin) * _cellSize.width);
+    const auto dstOffset = gsl::narrow_cast<size_t>((dstColumnBegin - _columnBegin) * _cellSize.width);
+    const auto srcStride = gsl::narrow_cast<size_t>(srcSlice._pixelWidth);
+    const auto dstStride = gsl::narrow_cast<size_t>(_pixelWidth);
+    const auto writeCount = gsl::narrow_cast<size_t>((dstColumnEnd - dstColumnBegin) * _cellSize.width);
+    const auto height = gsl::narrow_cast<size_t>(_cellSize.height);
+
+    if (dst.IsIndexed() && src.IsIndexed())
+    {
+        if (&src == &dst)
+        {
+            for (size_t y = 0; y < height; y++)
+            {
+                std::memmove(dst.indices.data() + dstOffset + y * dstStride, src.indices.data() + srcOffset + y * srcStride, writeCount);
+            }
+            return;
+        }
+
+        // The two slices have different palettes, so we have to translate the indices.
+        std::array<uint8_t, 256> mapping{};
+        const auto mapColors = [&]() {
+            for (size_t i = 0; i < src.palette.size(); i++)
+            {
+                if (!_mapColor(dst, til::at(src.palette, i), til::at(mapping, i + 1)))
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        auto fits = mapColors();
+        if (!fits)
+        {
+            _compactPalette(dst);
+            fits = mapColors();
+        }
+
+        if (fits)
+        {
+            for (size_t y = 0; y < height; y++)
+            {
+                const auto srcRow = src.indices.data() + srcOffset + y * srcStride;
+                const auto dstRow = dst.indices.data() + dstOffset + y * dstStride;
+                for (size_t x = 0; x < writeCount; x++)
+                {
+                    dstRow[x] = til::at(mapping, srcRow[x]);
+                }
+            }
+            return;
+        }
+    }
+
+    if (dst.IsIndexed())
+    {
+        _convertToPixels(dst);
+    }
+
+    if (src.IsIndexed())
+    {
+        const auto lut = paletteLookupTable(src.palette);
+        for (size_t y = 0; y < height; y++)
+        {
+            const auto srcRow = src.indices.data() + srcOffset + y * srcStride;
+            const auto dstRow = dst.pixels.data() + dstOffset + y * dstStride;
+            for (size_t x = 0; x < writeCount; x++)
+            {
+                dstRow[x] = til::at(lut, srcRow[x]);
+            }
+        }
+    }
+    else
+    {
+        for (size_t y = 0; y < height; y++)
+        {
+            std::memmove(dst.pixels.data() + dstOffset + y * dstStride, src.pixels.data() + srcOffset + y * srcStride, writeCount * sizeof(RGBQUAD));
+        }
+    }
+}
+
 void ImageSlice::EraseBlock(TextBuffer& buffer, const til::rect rect)
 {
     for (auto y = rect.top; y < rect.bottom; y++)
@@ -259,11 +602,23 @@ bool ImageSlice::_eraseCells(const til::CoordType columnBegin, const til::CoordT
         {
             const auto eraseOffset = (eraseBegin - _columnBegin) * _cellSize.width;
             const auto eraseLength = (eraseEnd - eraseBegin) * _cellSize.width;
-            auto eraseIterator = std::next(_pixelBuffer.data(), eraseOffset);
-            for (auto y = 0; y < _cellSize.height; y++)
+            // Both, the transparent palette index and the transparent RGBQUAD are all zeros.
+            const auto erase = [&](auto& plane) {
+                auto eraseIterator = std::next(plane.data(), eraseOffset);
+                for (auto y = 0; y < _cellSize.height; y++)
+                {
+                    std::memset(eraseIterator, 0, eraseLength * sizeof(*eraseIterator));
+                    std::advance(eraseIterator, _pixelWidth);
+                }
+            };
+            auto& storage = _mutableStorage();
+            if (storage.IsIndexed())
+            {
+                erase(storage.indices);
+            }
+            else
             {
-                std::memset(eraseIterator, 0, eraseLength * sizeof(RGBQUAD));
-                std::advance(eraseIterator, _pixelWidth);
+                erase(storage.pixels);
             }
         }
         return false;
@@ -12,6 +12,7 @@ Abstract:
 #pragma once
 
 #include "til.h"
+#include <memory>
 #include <span>
 #include <vector>
 
@@ -23,6 +24,13 @@ class ImageSlice
 public:
     using Pointer = std::unique_ptr<ImageSlice>;
 
+    // A pixel of a source image whose colors are stored in a separate color table.
+    struct IndexedPixel
+    {
+        uint8_t transparent = false;
+        uint8_t colorIndex = 0;
+    };
+
     ImageSlice(const ImageSlice& rhs) = default;
     ImageSlice(const til::size cellSize) noexcept;
 
@@ -32,10 +40,13 @@ public:
     til::size CellSize() const noexcept;
     til::CoordType ColumnOffset() const noexcept;
     til::CoordType PixelWidth() const noexcept;
+    size_t PixelCount() const noexcept;
+    size_t MemoryUsage() const noexcept;
+    bool SharesStorageWith(const ImageSlice& other) const noexcept;
 
-    std::span<const RGBQUAD> Pixels() const noexcept;
-    const RGBQUAD* Pixels(const til::CoordType columnBegin) const noexcept;
-    RGBQUAD* MutablePixels(const til::CoordType columnBegin, const til::CoordType columnEnd);
+    void ExpandPixels(std::span<RGBQUAD> dst) const noexcept;
+    void WritePixels(const til::CoordType columnBegin, const til::CoordType columnEnd, const IndexedPixel* src, const size_t srcStride, const til::CoordType srcWidth, const til::CoordType srcHeight, const std::span<const RGBQUAD> colors);
+    bool Deduplicate(const ImageSlice& other) noexcept;
 
     static void CopyBlock(const TextBuffer& srcBuffer, const til::rect srcRect, TextBuffer& dstBuffer, const til::rect dstRect);
     static void CopyRow(const ROW& srcRow, ROW& dstRow);
@@ -45,12 +56,38 @@ public:
     static void EraseCells(ROW& row, const til::CoordType columnBegin, const til::CoordType columnEnd);
 
 private:
+    // Sixel images can't have more than 256 colors, which is why the pixels are stored as
+    // 8-bit indices into a palette, with index 0 being transparent. Only if a slice ends up
+    // with more than 255 distinct colors (e.g. due to multiple overlapping images), the
+    // pixels get converted to RGBQUADs and the indices and palette are discarded.
+    //
+    // The storage is shared between copies of a slice (e.g. after CopyRow() or Deduplicate())
+    // until either of them is modified, at which point _mutableStorage() clones it.
+    struct Storage
+    {
+        std::vector<uint8_t> indices;
+        std::vector<RGBQUAD> palette;
+        std::vector<RGBQUAD> pixels;
+
+        bool IsIndexed() const noexcept;
+        bool operator==(const Storage& rhs) const noexcept;
+    };
+
+    static constexpr size_t MaxPaletteSize = 255;
+
+    static bool _mapColor(Storage& storage, const RGBQUAD color, uint8_t& index);
+    static void _compactPalette(Storage& storage);
+    static void _convertToPixels(Storage& storage);
+
+    Storage& _mutableStorage();
+    Storage& _prepareWrite(const til::CoordType columnBegin, const til::CoordType columnEnd);
+    void _copyPixels(const ImageSlice& srcSlice, const til::CoordType srcColumnBegin, const til::CoordType dstColumnBegin, const til::CoordType dstColumnEnd);
     bool _copyCells(const ImageSlice& srcSlice, const til::CoordType srcColumn, const til::CoordType dstColumnBegin, const til::CoordType dstColumnEnd);
     bool _eraseCells(const til::CoordType columnBegin, const til::CoordType columnEnd);
 
     uint64_t _revision = 0;
     til::size _cellSize;
-    std::vector<RGBQUAD> _pixelBuffer;
+    std::shared_ptr<Storage> _storage;
     til::CoordType _columnBegin = 0;
     til::CoordType _columnEnd = 0;
     til::CoordType _pixelWidth = 0;
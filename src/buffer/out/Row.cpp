@@ -4,6 +4,7 @@
 #include "precomp.h"
 #include "Row.hpp"
 
+#include <bit>
 #include <isa_availability.h>
 
 #include "../../types/inc/CodepointWidthDetector.hpp"
@@ -44,6 +45,57 @@ constexpr OutIt iota_n_mut(OutIt dest, Diff count, T& val)
     return dest;
 }
 
+// Returns a pointer past the last character in [beg,end) that isn't a whitespace.
+// Returns beg if the string is all whitespace. Most rows are either entirely blank or end
+// in a long tail of whitespace, which is why this scans 8 characters at a time.
+static const wchar_t* findEndOfText(const wchar_t* beg, const wchar_t* end) noexcept
+{
+#pragma warning(push)
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if defined(TIL_SSE_INTRINSICS)
+    const auto whitespace = _mm_set1_epi16(L' ');
+
+    while (end - beg >= 8)
+    {
+        const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(end - 8));
+        // Each wchar_t results in 2 bits in the mask. Inverting it gives us the non-whitespace ones.
+        const auto mask = static_cast<unsigned long>(_mm_movemask_epi8(_mm_cmpeq_epi16(wch, whitespace))) ^ 0xffff;
+
+        if (mask)
+        {
+            unsigned long index;
+            _BitScanReverse(&index, mask);
+            return end - 8 + index / 2 + 1;
+        }
+
+        end -= 8;
+    }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+    const auto whitespace = vdupq_n_u16(L' ');
+
+    while (end - beg >= 8)
+    {
+        const auto wch = vld1q_u16(reinterpret_cast<const uint16_t*>(end - 8));
+        const auto eq = vreinterpretq_u64_u16(vceqq_u16(wch, whitespace));
+
+        // If there's any non-whitespace in this chunk, the scalar loop below will find it.
+        if ((vgetq_lane_u64(eq, 0) & vgetq_lane_u64(eq, 1)) != UINT64_MAX)
+        {
+            break;
+        }
+
+        end -= 8;
+    }
+#endif
+#pragma warning(pop)
+
+    for (; end != beg && end[-1] == L' '; --end)
+    {
+    }
+
+    return end;
+}
+
 // Same as std::fill, but purpose-built for very small `last - first`
 // where a trivial loop outperforms vectorization.
 template<typename FwdIt, typename T>
@@ -162,13 +214,15 @@ til::CoordType CharToColumnMapper::GetTrailingColumnAt(const wchar_t* str) noexc
 // Arguments:
 // - rowWidth - the width of the row, cell elements
 // - fillAttribute - the default text attribute
+// - attrTable - the table used to intern the attributes of this row
 // Return Value:
 // - constructed object
-ROW::ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute) :
+ROW::ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute, TextAttributeTable& attrTable) :
     _charsBuffer{ charsBuffer },
     _chars{ charsBuffer, rowWidth },
     _charOffsets{ charOffsetsBuffer, ::base::strict_cast<size_t>(rowWidth) + 1u },
-    _attr{ rowWidth, fillAttribute },
+    _attr{ rowWidth, attrTable.Intern(fillAttribute) },
+    _attrTable{ &attrTable },
     _columnCount{ rowWidth }
 {
     _init();
@@ -204,6 +258,16 @@ LineRendition ROW::GetLineRendition() const noexcept
     return _lineRendition;
 }
 
+void ROW::SetGeneration(const uint64_t generation) noexcept
+{
+    _generation = generation;
+}
+
+uint64_t ROW::GetGeneration() const noexcept
+{
+    return _generation;
+}
+
 // Returns the index 1 past the last (technically) valid column in the row.
 // The interplay between the old console and newer VT APIs which support line renditions is
 // still unclear so it might be necessary to add two kinds of this function in the future.
@@ -223,13 +287,15 @@ til::CoordType ROW::GetReadableColumnCount() const noexcept
 // - Attr - The default attribute (color) to fill
 // Return Value:
 // - <none>
-void ROW::Reset(const TextAttribute& attr) noexcept
+void ROW::Reset(const TextAttribute& attr)
 {
+    // Interning may throw, so do it before modifying any state.
+    const auto id = _attrTable->Intern(attr);
     _charsHeap.reset();
     _chars = { _charsBuffer, _columnCount };
     // Constructing and then moving objects into place isn't free.
     // Modifying the existing object is _much_ faster.
-    *_attr.runs().unsafe_shrink_to_size(1) = til::rle_pair{ attr, _columnCount };
+    *_attr.runs().unsafe_shrink_to_size(1) = til::rle_pair{ id, _columnCount };
     _imageSlice = nullptr;
     _lineRendition = LineRendition::SingleWidth;
     _wrapForced = false;
@@ -364,8 +430,15 @@ void ROW::CopyFrom(const ROW& source)
     };
     CopyTextFrom(state);
 
-    _attr = source.Attributes();
-    _attr.resize_trailing_extent(_columnCount);
+    if (_attrTable == source._attrTable)
+    {
+        _attr = source._attr;
+        _attr.resize_trailing_extent(_columnCount);
+    }
+    else
+    {
+        ReplaceAttributes(0, _columnCount, source.Attributes());
+    }
 }
 
 // Returns the previous possible cursor position, preceding the given column.
@@ -453,7 +526,7 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
             {
                 // Otherwise, commit this color into the run and save off the new one.
                 // Now commit the new color runs into the attr row.
-                _attr.replace(colorStarts, currentIndex, currentColor);
+                _attr.replace(colorStarts, currentIndex, _attrTable->Intern(currentColor));
                 currentColor = it->TextAttr();
                 colorUses = 1;
                 colorStarts = currentIndex;
@@ -533,7 +606,7 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
     // Now commit the final color into the attr row
     if (colorUses)
     {
-        _attr.replace(colorStarts, currentIndex, currentColor);
+        _attr.replace(colorStarts, currentIndex, _attrTable->Intern(currentColor));
     }
 
     return it;
@@ -541,12 +614,62 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
 
 void ROW::SetAttrToEnd(const til::CoordType columnBegin, const TextAttribute attr)
 {
-    _attr.replace(_clampedColumnInclusive(columnBegin), _attr.size(), attr);
+    _attr.replace(_clampedColumnInclusive(columnBegin), _attr.size(), _attrTable->Intern(attr));
 }
 
 void ROW::ReplaceAttributes(const til::CoordType beginIndex, const til::CoordType endIndex, const TextAttribute& newAttr)
 {
-    _attr.replace(_clampedColumnInclusive(beginIndex), _clampedColumnInclusive(endIndex), newAttr);
+    _attr.replace(_clampedColumnInclusive(beginIndex), _clampedColumnInclusive(endIndex), _attrTable->Intern(newAttr));
+}
+
+// Replaces the attributes in the given range with the runs in newAttrs, interning them in the process.
+// newAttrs doesn't need to be as long as the given range. The row gets padded or truncated
+// with its last attribute afterwards, the same way RowAttributes::resize_trailing_extent() does.
+void ROW::ReplaceAttributes(const til::CoordType beginIndex, const til::CoordType endIndex, const RowAttributes& newAttrs)
+{
+    RowAttributeIds::container runs;
+    runs.reserve(newAttrs.runs().size());
+    for (const auto& run : newAttrs.runs())
+    {
+        runs.emplace_back(_attrTable->Intern(run.value), run.length);
+    }
+
+    const RowAttributeIds ids{ std::move(runs) };
+    _attr.replace(_clampedColumnInclusive(beginIndex), _clampedColumnInclusive(endIndex), ids);
+    _attr.resize_trailing_extent(_columnCount);
+}
+
+// Modifies the attributes in the given range with func. It's called once per run and
+// not once per column, which makes this a lot faster than calling GetAttrByColumn()
+// and ReplaceAttributes() for each column, especially for wide ranges.
+void ROW::TransformAttributes(const til::CoordType beginIndex, const til::CoordType endIndex, const std::function<void(TextAttribute&)>& func)
+{
+    _attr.transform(_clampedColumnInclusive(beginIndex), _clampedColumnInclusive(endIndex), [&](const TextAttributeTable::Id id) {
+        // Resolve() returns a reference that Intern() invalidates, so this must be a copy.
+        auto attr = _attrTable->Resolve(id);
+        func(attr);
+        return _attrTable->Intern(attr);
+    });
+}
+
+// Sets the MarkKind of all attributes in this row, for instance to clear all marks.
+void ROW::SetMarkAttributes(const MarkKind kind)
+{
+    for (auto& run : _attr.runs())
+    {
+        auto attr = _attrTable->Resolve(run.value);
+        attr.SetMarkAttributes(kind);
+        run.value = _attrTable->Intern(attr);
+    }
+}
+
+// Called by TextBuffer while it compacts its TextAttributeTable. See TextAttributeTable::Retain().
+void ROW::RetainAttributes(TextAttributeTable& table) noexcept
+{
+    for (auto& run : _attr.runs())
+    {
+        run.value = table.Retain(run.value);
+    }
 }
 
 [[msvc::forceinline]] ROW::WriteHelper::WriteHelper(ROW& row, til::CoordType columnBegin, til::CoordType columnLimit, const std::wstring_view& chars) noexcept :
@@ -728,33 +851,46 @@ catch (...)
 
     if (const auto end = chars.end(); it != end)
     {
-        GraphemeState state{ .beg = &*it };
+        // Segmenting the text in batches is a lot faster than calling GraphemeNext()
+        // for every cluster, especially for CJK text where every cluster is 1 character.
+#pragma warning(suppress : 26494) // Variable 'ends' is uninitialized. Always initialize an object (type.5).
+        std::array<size_t, 64> ends;
+#pragma warning(suppress : 26494) // Variable 'widths' is uninitialized. Always initialize an object (type.5).
+        std::array<uint8_t, 64> widths;
 
         do
         {
-            cwd.GraphemeNext(state, chars);
+            const std::wstring_view remaining{ &*it, gsl::narrow_cast<size_t>(end - it) };
+            const auto count = cwd.GraphemeSegment(remaining, ends, widths);
+            size_t clusterBeg = 0;
 
-            const auto width = std::max(1, state.width);
-            const auto colEndNew = gsl::narrow_cast<uint16_t>(colEnd + width);
-            if (colEndNew > colLimit)
+            for (size_t i = 0; i < count; ++i)
             {
-                colEndDirty = colLimit;
-                charsConsumed = ch - chBeg;
-                return;
-            }
+                const auto width = std::max(1, static_cast<int>(til::at(widths, i)));
+                const auto colEndNew = gsl::narrow_cast<uint16_t>(colEnd + width);
+                if (colEndNew > colLimit)
+                {
+                    colEndDirty = colLimit;
+                    charsConsumed = ch - chBeg;
+                    return;
+                }
 
-            // Fill our char-offset buffer with 1 entry containing the mapping from the
-            // current column (colEnd) to the start of the glyph in the string (ch)...
-            til::at(row._charOffsets, colEnd++) = gsl::narrow_cast<uint16_t>(ch);
-            // ...followed by 0-N entries containing an indication that the
-            // columns are just a wide-glyph extension of the preceding one.
-            while (colEnd < colEndNew)
-            {
-                til::at(row._charOffsets, colEnd++) = gsl::narrow_cast<uint16_t>(ch | CharOffsetsTrailer);
+                // Fill our char-offset buffer with 1 entry containing the mapping from the
+                // current column (colEnd) to the start of the glyph in the string (ch)...
+                til::at(row._charOffsets, colEnd++) = gsl::narrow_cast<uint16_t>(ch);
+                // ...followed by 0-N entries containing an indication that the
+                // columns are just a wide-glyph extension of the preceding one.
+                while (colEnd < colEndNew)
+                {
+                    til::at(row._charOffsets, colEnd++) = gsl::narrow_cast<uint16_t>(ch | CharOffsetsTrailer);
+                }
+
+                const auto clusterEnd = til::at(ends, i);
+                ch += clusterEnd - clusterBeg;
+                clusterBeg = clusterEnd;
             }
 
-            ch += state.len;
-            it += state.len;
+            it += gsl::narrow_cast<ptrdiff_t>(clusterBeg);
         } while (it != end);
     }
 
@@ -942,19 +1078,21 @@ void ROW::_resizeChars(uint16_t colEndDirty, uint16_t chBegDirty, size_t chEndDi
     }
 }
 
-RowAttributes& ROW::Attributes() noexcept
+// Returns a decoded copy of this row's attributes.
+RowAttributes ROW::Attributes() const
 {
-    return _attr;
-}
-
-const RowAttributes& ROW::Attributes() const noexcept
-{
-    return _attr;
+    RowAttributes::container runs;
+    runs.reserve(_attr.runs().size());
+    for (const auto& run : _attr.runs())
+    {
+        runs.emplace_back(_attrTable->Resolve(run.value), run.length);
+    }
+    return RowAttributes{ std::move(runs) };
 }
 
 TextAttribute ROW::GetAttrByColumn(const til::CoordType column) const
 {
-    return _attr.at(_clampedColumn(column));
+    return _attrTable->Resolve(_attr.at(_clampedColumn(column)));
 }
 
 std::vector<uint16_t> ROW::GetHyperlinks() const
@@ -962,9 +1100,10 @@ std::vector<uint16_t> ROW::GetHyperlinks() const
     std::vector<uint16_t> ids;
     for (const auto& run : _attr.runs())
     {
-        if (run.value.IsHyperlink())
+        const auto& attr = _attrTable->Resolve(run.value);
+        if (attr.IsHyperlink())
         {
-            ids.emplace_back(run.value.GetHyperlinkId());
+            ids.emplace_back(attr.GetHyperlinkId());
         }
     }
     return ids;
@@ -1004,17 +1143,7 @@ til::CoordType ROW::GetLastNonSpaceColumn() const noexcept
     const auto text = GetText();
     const auto beg = text.data();
     const auto end = beg + text.size();
-#pragma warning(suppress : 26429) // Symbol 'it' is never tested for nullness, it can be marked as not_null (f.23).
-    auto it = end;
-
-    for (; it != beg; --it)
-    {
-        // it[-1] is safe as `it` is always greater than `beg` (loop invariant).
-        if (it[-1] != L' ')
-        {
-            break;
-        }
-    }
+    const auto it = findEndOfText(beg, end);
 
     // We're supposed to return the measurement in cells and not characters
     // and therefore simply calculating `it - beg` would be wrong.
@@ -1062,19 +1191,8 @@ til::CoordType ROW::MeasureRight() const noexcept
 bool ROW::ContainsText() const noexcept
 {
     const auto text = GetText();
-    const auto beg = text.begin();
-    const auto end = text.end();
-    auto it = beg;
-
-    for (; it != end; ++it)
-    {
-        if (*it != L' ')
-        {
-            return true;
-        }
-    }
-
-    return false;
+    const auto beg = text.data();
+    return findEndOfText(beg, beg + text.size()) != beg;
 }
 
 std::wstring_view ROW::GlyphAt(til::CoordType column) const noexcept
@@ -1133,6 +1251,24 @@ std::wstring_view ROW::GetText(til::CoordType columnBegin, til::CoordType column
     return { _chars.data() + chBeg, chEnd - chBeg };
 }
 
+// Returns true if every column in [columnBegin, columnEnd) holds exactly one wchar_t,
+// in which case the text returned by GetText() maps 1:1 onto the columns.
+bool ROW::HasOneCharPerColumn(til::CoordType columnBegin, til::CoordType columnEnd) const noexcept
+{
+    const auto colBeg = _clampedColumnInclusive(columnBegin);
+    const auto colEnd = std::max(colBeg, _clampedColumnInclusive(columnEnd));
+
+    // Only trailers share the offset of their preceding column. If there are none
+    // and the offsets grow by exactly the column count, every step must be exactly 1.
+    uint16_t flags = 0;
+    for (auto col = colBeg; col <= colEnd; ++col)
+    {
+        flags |= til::at(_charOffsets, col);
+    }
+
+    return (flags & CharOffsetsTrailer) == 0 && _uncheckedCharOffset(colEnd) - _uncheckedCharOffset(colBeg) == colEnd - colBeg;
+}
+
 til::CoordType ROW::GetLeadingColumnAtCharOffset(const ptrdiff_t offset) const noexcept
 {
     return _createCharToColumnMapper(offset).GetLeadingColumnAt(offset);
@@ -1143,24 +1279,129 @@ til::CoordType ROW::GetTrailingColumnAtCharOffset(const ptrdiff_t offset) const
     return _createCharToColumnMapper(offset).GetTrailingColumnAt(offset);
 }
 
-DelimiterClass ROW::DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept
+// Classifies every column of this row. The result only depends on the row's contents and the classifier,
+// which allows callers to cache it for as long as GetGeneration() doesn't change.
+DelimiterClassMap ROW::ClassifyDelimiters(const DelimiterClassifier& classifier) const
 {
-    const auto col = _clampedColumn(column);
-    // Safety: col is [0, _columnCount).
-    const auto glyph = _uncheckedChar(_uncheckedCharOffset(col));
+    DelimiterClassMap map;
+    map._words = (_columnCount + size_t{ 63 }) / 64;
+    map._bits.resize(map._words * 3);
+    map._columnCount = _columnCount;
+
+    const auto regulars = map._words;
+    const auto runStarts = map._words * 2;
+    auto previous = DelimiterClass::ControlChar;
 
-    if (glyph <= L' ')
+    for (uint16_t col = 0; col < _columnCount; ++col)
+    {
+        // Safety: col is [0, _columnCount).
+        const auto delimiterClass = classifier(_uncheckedChar(_uncheckedCharOffset(col)));
+        const size_t word = col / 64;
+        const auto bit = uint64_t{ 1 } << (col % 64);
+
+        if (delimiterClass == DelimiterClass::DelimiterChar)
+        {
+            til::at(map._bits, word) |= bit;
+        }
+        else if (delimiterClass == DelimiterClass::RegularChar)
+        {
+            til::at(map._bits, regulars + word) |= bit;
+        }
+
+        if (col == 0 || delimiterClass != previous)
+        {
+            til::at(map._bits, runStarts + word) |= bit;
+        }
+
+        previous = delimiterClass;
+    }
+
+    return map;
+}
+
+DelimiterClass DelimiterClassMap::At(til::CoordType column) const noexcept
+{
+    if (_columnCount <= 0)
     {
         return DelimiterClass::ControlChar;
     }
-    else if (wordDelimiters.find(glyph) != std::wstring_view::npos)
+
+    const auto col = gsl::narrow_cast<size_t>(_clampedColumn(column));
+    const auto word = col / 64;
+    const auto bit = col % 64;
+
+    if ((til::at(_bits, word) >> bit) & 1)
     {
         return DelimiterClass::DelimiterChar;
     }
-    else
+    if ((til::at(_bits, _words + word) >> bit) & 1)
     {
         return DelimiterClass::RegularChar;
     }
+    return DelimiterClass::ControlChar;
+}
+
+// Returns the first column of the run of columns that contains the given
+// column and whose cells all have the same DelimiterClass.
+til::CoordType DelimiterClassMap::RunStart(til::CoordType column) const noexcept
+{
+    if (_columnCount <= 0)
+    {
+        return 0;
+    }
+
+    const auto col = gsl::narrow_cast<size_t>(_clampedColumn(column));
+    const auto runStarts = _words * 2;
+    auto word = col / 64;
+    // Ignore the run starts past col. Column 0 always starts a run, so the loop below terminates.
+    auto bits = til::at(_bits, runStarts + word) & (~uint64_t{ 0 } >> (63 - col % 64));
+
+    while (!bits)
+    {
+        --word;
+        bits = til::at(_bits, runStarts + word);
+    }
+
+    return gsl::narrow_cast<til::CoordType>(word * 64 + std::bit_width(bits) - 1);
+}
+
+// Returns the end (exclusive) of the run of columns that contains the given
+// column and whose cells all have the same DelimiterClass.
+til::CoordType DelimiterClassMap::RunEnd(til::CoordType column) const noexcept
+{
+    if (_columnCount <= 0)
+    {
+        return 0;
+    }
+
+    // The end of the run is the start of the next one, if there's any.
+    const auto col = gsl::narrow_cast<size_t>(_clampedColumn(column)) + 1;
+    const auto runStarts = _words * 2;
+    auto word = col / 64;
+
+    if (word >= _words)
+    {
+        return _columnCount;
+    }
+
+    // Ignore the run starts up to and including the given column.
+    auto bits = til::at(_bits, runStarts + word) & (~uint64_t{ 0 } << (col % 64));
+
+    while (!bits)
+    {
+        if (++word >= _words)
+        {
+            return _columnCount;
+        }
+        bits = til::at(_bits, runStarts + word);
+    }
+
+    return gsl::narrow_cast<til::CoordType>(word * 64 + std::countr_zero(bits));
+}
+
+til::CoordType DelimiterClassMap::_clampedColumn(til::CoordType column) const noexcept
+{
+    return std::clamp(column, 0, _columnCount - 1);
 }
 
 template<typename T>
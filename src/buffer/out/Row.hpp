@@ -10,6 +10,7 @@
 #include "OutputCell.hpp"
 #include "OutputCellIterator.hpp"
 #include "Marks.hpp"
+#include "TextAttributeTable.hpp"
 
 class ROW;
 class TextBuffer;
@@ -18,6 +19,81 @@ class TextBuffer;
 // most rows will end up having at least 2 runs: The start of the line
 // with MarkKind::Output and the rest of the line with MarkKind::None.
 using RowAttributes = til::small_rle<TextAttribute, uint16_t, 2>;
+// This is how ROW stores RowAttributes internally. See TextAttributeTable.
+using RowAttributeIds = til::small_rle<TextAttributeTable::Id, uint16_t, 2>;
+
+// Iterates over the TextAttribute of each column in a ROW.
+// It resolves the interned ids stored in the ROW via the TextBuffer's TextAttributeTable.
+class RowAttributeIterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = TextAttribute;
+    using pointer = const TextAttribute*;
+    using reference = const TextAttribute&;
+    using difference_type = RowAttributeIds::const_iterator::difference_type;
+
+    RowAttributeIterator(RowAttributeIds::const_iterator it, const TextAttributeTable* table) noexcept :
+        _it{ std::move(it) },
+        _table{ table }
+    {
+    }
+
+    [[nodiscard]] reference operator*() const noexcept
+    {
+        return _table->Resolve(*_it);
+    }
+
+    [[nodiscard]] pointer operator->() const noexcept
+    {
+        return &operator*();
+    }
+
+    RowAttributeIterator& operator++() noexcept
+    {
+        ++_it;
+        return *this;
+    }
+
+    RowAttributeIterator operator++(int) noexcept
+    {
+        auto tmp = *this;
+        ++_it;
+        return tmp;
+    }
+
+    RowAttributeIterator& operator+=(const difference_type offset) noexcept
+    {
+        _it += offset;
+        return *this;
+    }
+
+    [[nodiscard]] RowAttributeIterator operator+(const difference_type offset) const noexcept
+    {
+        auto tmp = *this;
+        tmp += offset;
+        return tmp;
+    }
+
+    [[nodiscard]] difference_type operator-(const RowAttributeIterator& right) const noexcept
+    {
+        return _it - right._it;
+    }
+
+    [[nodiscard]] bool operator==(const RowAttributeIterator& right) const noexcept
+    {
+        return _it == right._it;
+    }
+
+    [[nodiscard]] bool operator!=(const RowAttributeIterator& right) const noexcept
+    {
+        return _it != right._it;
+    }
+
+private:
+    RowAttributeIds::const_iterator _it;
+    const TextAttributeTable* _table;
+};
 
 enum class DelimiterClass
 {
@@ -26,6 +102,70 @@ enum class DelimiterClass
     RegularChar
 };
 
+// Classifies characters into DelimiterClass-es. The ASCII subset of the word delimiters is turned into
+// a bitmap, so that classifying a cell is a bit test instead of a search through the delimiters.
+// Construct it once per operation, not once per cell. It must not outlive the given wordDelimiters.
+class DelimiterClassifier
+{
+public:
+    explicit DelimiterClassifier(const std::wstring_view& wordDelimiters) noexcept :
+        _wordDelimiters{ wordDelimiters }
+    {
+        for (const auto ch : wordDelimiters)
+        {
+            if (ch < 128)
+            {
+                til::at(_ascii, ch / 64) |= uint64_t{ 1 } << (ch % 64);
+            }
+            else
+            {
+                _hasNonAscii = true;
+            }
+        }
+    }
+
+    DelimiterClass operator()(const wchar_t ch) const noexcept
+    {
+        if (ch <= L' ')
+        {
+            return DelimiterClass::ControlChar;
+        }
+        if (ch < 128)
+        {
+            return (til::at(_ascii, ch / 64) >> (ch % 64)) & 1 ? DelimiterClass::DelimiterChar : DelimiterClass::RegularChar;
+        }
+        return _hasNonAscii && _wordDelimiters.find(ch) != std::wstring_view::npos ? DelimiterClass::DelimiterChar : DelimiterClass::RegularChar;
+    }
+
+private:
+    std::wstring_view _wordDelimiters;
+    std::array<uint64_t, 2> _ascii{};
+    bool _hasNonAscii = false;
+};
+
+// The DelimiterClass of every column of a ROW, as computed by ROW::ClassifyDelimiters().
+// It stores 1 bit per column and DelimiterClass, plus 1 bit marking the first column of each run
+// of equally classified columns. Finding the start or end of such a run is then a bit scan
+// over 64 columns at a time, instead of classifying one cell after another.
+class DelimiterClassMap
+{
+public:
+    DelimiterClass At(til::CoordType column) const noexcept;
+    til::CoordType RunStart(til::CoordType column) const noexcept;
+    til::CoordType RunEnd(til::CoordType column) const noexcept;
+
+private:
+    friend class ROW;
+
+    til::CoordType _clampedColumn(til::CoordType column) const noexcept;
+
+    // 3 consecutive bitmaps of _words each: DelimiterChar columns, RegularChar columns and run starts.
+    // Columns that are set in neither of the first two are ControlChar-s.
+    std::vector<uint64_t> _bits;
+    size_t _words = 0;
+    til::CoordType _columnCount = 0;
+};
+
 struct RowWriteState
 {
     // The text you want to write into the given ROW. When ReplaceText() returns,
@@ -122,7 +262,7 @@ public:
     }
 
     ROW() = default;
-    ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute);
+    ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute, TextAttributeTable& attrTable);
 
     ROW(const ROW& other) = delete;
     ROW& operator=(const ROW& other) = delete;
@@ -137,8 +277,10 @@ public:
     void SetLineRendition(const LineRendition lineRendition) noexcept;
     LineRendition GetLineRendition() const noexcept;
     til::CoordType GetReadableColumnCount() const noexcept;
+    void SetGeneration(uint64_t generation) noexcept;
+    uint64_t GetGeneration() const noexcept;
 
-    void Reset(const TextAttribute& attr) noexcept;
+    void Reset(const TextAttribute& attr);
     void CopyFrom(const ROW& source);
 
     til::CoordType NavigateToPrevious(til::CoordType column) const noexcept;
@@ -150,12 +292,15 @@ public:
     OutputCellIterator WriteCells(OutputCellIterator it, til::CoordType columnBegin, std::optional<bool> wrap = std::nullopt, std::optional<til::CoordType> limitRight = std::nullopt);
     void SetAttrToEnd(til::CoordType columnBegin, TextAttribute attr);
     void ReplaceAttributes(til::CoordType beginIndex, til::CoordType endIndex, const TextAttribute& newAttr);
+    void ReplaceAttributes(til::CoordType beginIndex, til::CoordType endIndex, const RowAttributes& newAttrs);
+    void TransformAttributes(til::CoordType beginIndex, til::CoordType endIndex, const std::function<void(TextAttribute&)>& func);
+    void SetMarkAttributes(MarkKind kind);
+    void RetainAttributes(TextAttributeTable& table) noexcept;
     void ReplaceCharacters(til::CoordType columnBegin, til::CoordType width, const std::wstring_view& chars);
     void ReplaceText(RowWriteState& state);
     void CopyTextFrom(RowCopyTextFromState& state);
 
-    RowAttributes& Attributes() noexcept;
-    const RowAttributes& Attributes() const noexcept;
+    RowAttributes Attributes() const;
     TextAttribute GetAttrByColumn(til::CoordType column) const;
     std::vector<uint16_t> GetHyperlinks() const;
     ImageSlice* SetImageSlice(ImageSlice::Pointer imageSlice) noexcept;
@@ -170,12 +315,13 @@ public:
     DbcsAttribute DbcsAttrAt(til::CoordType column) const noexcept;
     std::wstring_view GetText() const noexcept;
     std::wstring_view GetText(til::CoordType columnBegin, til::CoordType columnEnd) const noexcept;
+    bool HasOneCharPerColumn(til::CoordType columnBegin, til::CoordType columnEnd) const noexcept;
     til::CoordType GetLeadingColumnAtCharOffset(ptrdiff_t offset) const noexcept;
     til::CoordType GetTrailingColumnAtCharOffset(ptrdiff_t offset) const noexcept;
-    DelimiterClass DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept;
+    DelimiterClassMap ClassifyDelimiters(const DelimiterClassifier& classifier) const;
 
-    auto AttrBegin() const noexcept { return _attr.begin(); }
-    auto AttrEnd() const noexcept { return _attr.end(); }
+    RowAttributeIterator AttrBegin() const noexcept { return { _attr.begin(), _attrTable }; }
+    RowAttributeIterator AttrEnd() const noexcept { return { _attr.end(), _attrTable }; }
 
     const std::optional<ScrollbarData>& GetScrollbarData() const noexcept;
     void SetScrollbarData(std::optional<ScrollbarData> data) noexcept;
@@ -301,9 +447,11 @@ private:
     // In other words, _charOffsets tells us both the width in chars and width in columns.
     // See CharOffsetsTrailer for more information.
     std::span<uint16_t> _charOffsets;
-    // _attr is a run-length-encoded vector of TextAttribute with a decompressed
+    // _attr is a run-length-encoded vector of TextAttribute ids with a decompressed
     // length equal to _columnCount (= 1 TextAttribute per column).
-    RowAttributes _attr;
+    // The ids are resolved via _attrTable, which is owned by the TextBuffer.
+    RowAttributeIds _attr;
+    TextAttributeTable* _attrTable = nullptr;
     // The width of the row in visual columns.
     uint16_t _columnCount = 0;
     // Stores double-width/height (DECSWL/DECDWL/DECDHL) attributes.
@@ -317,6 +465,12 @@ private:
 
     // Stores any image content covering the row.
     ImageSlice::Pointer _imageSlice;
+
+    // Set by TextBuffer::GetMutableRowByOffset() to the buffer's mutation id whenever the row is
+    // handed out for modification. Two rows with the same non-zero generation have identical
+    // contents, which allows callers to cache values derived from them (e.g. DECRQCRA checksums).
+    // It's 0 for rows that were never modified and isn't copied by CopyFrom().
+    uint64_t _generation = 0;
 };
 
 #ifdef UNIT_TESTING
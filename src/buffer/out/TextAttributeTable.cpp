@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "TextAttributeTable.hpp"
+
+#include <til/hash.h>
+
+size_t TextAttributeTable::Hasher::operator()(const TextAttribute& attr) const noexcept
+{
+    return til::hash(attr);
+}
+
+TextAttributeTable::TextAttributeTable()
+{
+    _attrs.emplace_back();
+    _ids.emplace(_attrs.front(), DefaultId);
+}
+
+TextAttributeTable::Id TextAttributeTable::Intern(const TextAttribute& attr)
+{
+    if (attr == _lastAttr)
+    {
+        return _lastId;
+    }
+
+    Id id;
+
+    if (const auto it = _ids.find(attr); it != _ids.end())
+    {
+        id = it->second;
+    }
+    else
+    {
+        THROW_HR_IF(E_OUTOFMEMORY, _attrs.size() >= InvalidId);
+        id = gsl::narrow_cast<Id>(_attrs.size());
+        // Copy the argument before growing _attrs, in case it's a reference into it.
+        const auto copy = attr;
+        _attrs.emplace_back(copy);
+        _ids.emplace(copy, id);
+    }
+
+    _lastAttr = til::at(_attrs, id);
+    _lastId = id;
+    return id;
+}
+
+const TextAttribute& TextAttributeTable::Resolve(const Id id) const noexcept
+{
+    assert(id < _attrs.size());
+    return til::at(_attrs, id);
+}
+
+size_t TextAttributeTable::size() const noexcept
+{
+    return _attrs.size();
+}
+
+bool TextAttributeTable::WantsCompaction() const noexcept
+{
+    return _attrs.size() >= _compactionThreshold;
+}
+
+void TextAttributeTable::BeginCompaction()
+{
+    // Retain() must not fail half-way through, because the caller would otherwise be left with
+    // a mix of old and new ids. Allocating everything upfront ensures that it's noexcept.
+    _remap.assign(_attrs.size(), InvalidId);
+    _retainedAttrs.clear();
+    _retainedAttrs.reserve(_attrs.size());
+    Retain(DefaultId);
+}
+
+TextAttributeTable::Id TextAttributeTable::Retain(const Id id) noexcept
+{
+    auto& mapped = til::at(_remap, id);
+    if (mapped == InvalidId)
+    {
+        mapped = gsl::narrow_cast<Id>(_retainedAttrs.size());
+        _retainedAttrs.emplace_back(til::at(_attrs, id));
+    }
+    return mapped;
+}
+
+void TextAttributeTable::EndCompaction() noexcept
+{
+    _attrs.swap(_retainedAttrs);
+    _retainedAttrs = {};
+    _remap = {};
+
+    _lastAttr = {};
+    _lastId = DefaultId;
+    // Doubling the threshold relative to the number of live attributes
+    // ensures that the cost of compaction is amortized over many Intern() calls.
+    _compactionThreshold = std::max(MinimumCompactionThreshold, _attrs.size() * 2);
+
+    // If rebuilding the index fails, the table remains valid:
+    // Intern() will simply assign new ids to the attributes that are missing from it.
+    try
+    {
+        _ids.clear();
+        for (Id id = 0; id < gsl::narrow_cast<Id>(_attrs.size()); ++id)
+        {
+            _ids.emplace(til::at(_attrs, id), id);
+        }
+    }
+    CATCH_LOG();
+}
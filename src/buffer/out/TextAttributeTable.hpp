@@ -0,0 +1,64 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- TextAttributeTable.hpp
+
+Abstract:
+- Interns the TextAttributes used by the rows of a TextBuffer.
+- A TextAttribute is 18 bytes large, which makes a run in a ROW's attribute RLE
+  20 bytes large. Most buffers only ever contain a handful of distinct attributes
+  however, so ROW stores 32-bit ids into this table instead (8 bytes per run).
+--*/
+
+#pragma once
+
+#include "TextAttribute.hpp"
+
+class TextAttributeTable
+{
+public:
+    using Id = uint32_t;
+
+    // TextAttribute{} is always interned as id 0 and survives compaction.
+    // This allows ROW to reset itself to the default attributes without allocating.
+    static constexpr Id DefaultId = 0;
+
+    TextAttributeTable();
+
+    Id Intern(const TextAttribute& attr);
+    // NOTE: The returned reference is invalidated by Intern() and EndCompaction().
+    const TextAttribute& Resolve(Id id) const noexcept;
+    size_t size() const noexcept;
+
+    // Attributes are never removed from the table individually. Instead, once the table grew
+    // large enough, the TextBuffer walks all of its rows and calls Retain() on every id that is
+    // still in use, which assigns it a new, compacted id. The caller is expected to replace
+    // the old ids with the returned ones. Ids that weren't retained are freed in EndCompaction().
+    bool WantsCompaction() const noexcept;
+    void BeginCompaction();
+    Id Retain(Id id) noexcept;
+    void EndCompaction() noexcept;
+
+private:
+    struct Hasher
+    {
+        size_t operator()(const TextAttribute& attr) const noexcept;
+    };
+
+    static constexpr size_t MinimumCompactionThreshold = 4096;
+    static constexpr Id InvalidId = UINT32_MAX;
+
+    std::vector<TextAttribute> _attrs;
+    std::unordered_map<TextAttribute, Id, Hasher> _ids;
+    // Most writes use the TextBuffer's current attributes over and over again.
+    // Caching the last lookup allows us to skip hashing in the common case.
+    TextAttribute _lastAttr;
+    Id _lastId = DefaultId;
+    size_t _compactionThreshold = MinimumCompactionThreshold;
+
+    // These are only used between BeginCompaction() and EndCompaction().
+    std::vector<TextAttribute> _retainedAttrs;
+    std::vector<Id> _remap;
+};
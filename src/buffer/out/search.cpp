@@ -19,15 +19,32 @@ bool Search::IsStale(const Microsoft::Console::Render::IRenderData& renderData,
 void Search::Reset(Microsoft::Console::Render::IRenderData& renderData, const std::wstring_view& needle, SearchFlag flags, bool reverse)
 {
     const auto& textBuffer = renderData.GetTextBuffer();
+    Reset(renderData, needle, flags, reverse, textBuffer.SearchText(needle, flags), textBuffer.GetLastMutationId());
+}
 
+// Same as the above, but with the results of a TextBuffer::SearchText() call made by the caller. This allows it to
+// run the search on a TextBuffer::CreateSnapshot() without holding the console lock. `mutationId` must be that of
+// the searched buffer, so that IsStale() returns true if the actual buffer changed in the meantime.
+void Search::Reset(Microsoft::Console::Render::IRenderData& renderData, const std::wstring_view& needle, SearchFlag flags, bool reverse, std::optional<std::vector<til::point_span>> results, uint64_t mutationId)
+{
     _renderData = &renderData;
     _needle = needle;
     _flags = flags;
-    _lastMutationId = textBuffer.GetLastMutationId();
+    _lastMutationId = mutationId;
+
+    _ok = results.has_value();
+    _results = std::move(results).value_or(std::vector<til::point_span>{});
+
+    // The results may stem from a snapshot of a buffer that has since been resized. IsStale() makes sure
+    // they get refreshed during the next search, but until then they must not point outside the buffer.
+    if (const auto& textBuffer = renderData.GetTextBuffer(); mutationId != textBuffer.GetLastMutationId())
+    {
+        const auto bufferSize = textBuffer.GetSize();
+        std::erase_if(_results, [&](const til::point_span& span) {
+            return !bufferSize.IsInBounds(span.start) || !bufferSize.IsInBounds(span.end);
+        });
+    }
 
-    auto result = textBuffer.SearchText(needle, _flags);
-    _ok = result.has_value();
-    _results = std::move(result).value_or(std::vector<til::point_span>{});
     _index = reverse ? gsl::narrow_cast<ptrdiff_t>(_results.size()) - 1 : 0;
     _step = reverse ? -1 : 1;
 
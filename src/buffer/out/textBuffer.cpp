@@ -5,6 +5,9 @@
 #include "textBuffer.hpp"
 
 #include <til/hash.h>
+#include <til/lru_cache.h>
+#include <til/mutex.h>
+#include <til/parallel.h>
 
 #include "UTextAdapter.h"
 #include "../../types/inc/CodepointWidthDetector.hpp"
@@ -117,6 +120,8 @@ void TextBuffer::_reserve(til::size screenBufferSize, const TextAttribute& defau
     _bufferRowStride = rowStride;
     _bufferOffsetChars = rowSize;
     _bufferOffsetCharOffsets = rowSize + charsBufferSize;
+    _rowSlots.resize(h);
+    std::iota(_rowSlots.begin(), _rowSlots.end(), uint16_t{ 0 });
     _width = w;
     _height = h;
 }
@@ -149,17 +154,19 @@ void TextBuffer::_decommit() noexcept
     _destroy();
     VirtualFree(_buffer.get(), 0, MEM_DECOMMIT);
     _commitWatermark = _buffer.get();
+    _textWatermark = -1;
+    std::iota(_rowSlots.begin(), _rowSlots.end(), uint16_t{ 0 });
 }
 
 // Constructs ROWs between [_commitWatermark,until).
-void TextBuffer::_construct(const std::byte* until) noexcept
+void TextBuffer::_construct(const std::byte* until)
 {
     for (; _commitWatermark < until; _commitWatermark += _bufferRowStride)
     {
         const auto row = reinterpret_cast<ROW*>(_commitWatermark);
         const auto chars = reinterpret_cast<wchar_t*>(_commitWatermark + _bufferOffsetChars);
         const auto indices = reinterpret_cast<uint16_t*>(_commitWatermark + _bufferOffsetCharOffsets);
-        std::construct_at(row, chars, indices, _width, _initialAttributes);
+        std::construct_at(row, chars, indices, _width, _initialAttributes, *_attrTable);
     }
 }
 
@@ -172,6 +179,17 @@ void TextBuffer::_destroy() const noexcept
     }
 }
 
+// Frees all attributes in _attrTable which aren't used by any ROW anymore.
+void TextBuffer::_compactAttributes()
+{
+    _attrTable->BeginCompaction();
+    for (auto it = _buffer.get(); it < _commitWatermark; it += _bufferRowStride)
+    {
+        reinterpret_cast<ROW*>(it)->RetainAttributes(*_attrTable);
+    }
+    _attrTable->EndCompaction();
+}
+
 // This function is "direct" because it trusts the caller to properly
 // wrap the "offset" parameter modulo the _height of the buffer.
 ROW& TextBuffer::_getRowByOffsetDirect(size_t offset)
@@ -187,8 +205,8 @@ ROW& TextBuffer::_getRowByOffsetDirect(size_t offset)
     return *reinterpret_cast<ROW*>(row);
 }
 
-// See GetRowByOffset().
-ROW& TextBuffer::_getRow(til::CoordType y) const
+// Returns the position of the given row in the circular buffer. See _rowSlots for how it maps to a ROW.
+size_t TextBuffer::_getRowOffset(til::CoordType y) const noexcept
 {
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
     auto offset = (_firstRow + y) % _height;
@@ -200,10 +218,18 @@ ROW& TextBuffer::_getRow(til::CoordType y) const
         offset += _height;
     }
 
-    // We add 1 to the row offset, because row "0" is the one returned by GetScratchpadRow().
+    return gsl::narrow_cast<size_t>(offset);
+}
+
+// See GetRowByOffset().
+ROW& TextBuffer::_getRow(til::CoordType y) const
+{
+    const auto slot = til::at(_rowSlots, _getRowOffset(y));
+
+    // We add 1 to the slot, because slot "0" is the one returned by GetScratchpadRow().
     // See GetScratchpadRow() for more explanation.
 #pragma warning(suppress : 26492) // Don't use const_cast to cast away const or volatile (type.3).
-    return const_cast<TextBuffer*>(this)->_getRowByOffsetDirect(gsl::narrow_cast<size_t>(offset) + 1);
+    return const_cast<TextBuffer*>(this)->_getRowByOffsetDirect(size_t{ slot } + 1);
 }
 
 // Returns the "user-visible" index of the last committed row, which can be used
@@ -231,7 +257,18 @@ const ROW& TextBuffer::GetRowByOffset(const til::CoordType index) const
 ROW& TextBuffer::GetMutableRowByOffset(const til::CoordType index)
 {
     _lastMutationId++;
-    return _getRow(index);
+    // The caller may write anything into the row, so we have to assume that it'll contain text.
+    // Indices outside of [0,_height) wrap around and could refer to any row.
+    _textWatermark = std::max(_textWatermark, index >= 0 && index < _height ? index : _height - 1);
+    // Nothing outside of ROW holds on to attribute ids, which makes this a safe point to compact the table.
+    if (_attrTable->WantsCompaction()) [[unlikely]]
+    {
+        _compactAttributes();
+    }
+    auto& row = _getRow(index);
+    // Mutation ids are unique across buffers, which makes them suitable as row generations.
+    row.SetGeneration(_lastMutationId);
+    return row;
 }
 
 // Returns a row filled with whitespace and the current attributes, for you to freely use.
@@ -437,27 +474,35 @@ size_t TextBuffer::FitTextIntoColumns(const std::wstring_view& chars, til::Coord
 
     // The non-ASCII character we have encountered may be a combining mark, like "a^" which is then displayed as "â".
     // In order to recognize both characters as a single grapheme, we need to back up by 1 ASCII character
-    // and let GraphemeNext() find the next proper grapheme boundary.
+    // and let GraphemeSegment() find the next proper grapheme boundary.
     if (dist != 0)
     {
         dist--;
         col--;
     }
 
-#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
-    GraphemeState state{ .beg = chars.data() + dist };
+#pragma warning(suppress : 26494) // Variable 'ends' is uninitialized. Always initialize an object (type.5).
+    std::array<size_t, 64> ends;
+#pragma warning(suppress : 26494) // Variable 'widths' is uninitialized. Always initialize an object (type.5).
+    std::array<uint8_t, 64> widths;
 
     while (dist < len)
     {
-        cwd.GraphemeNext(state, chars);
-        col += state.width;
+        const auto base = dist;
+        const auto count = cwd.GraphemeSegment(chars.substr(base), ends, widths);
 
-        if (col > columnLimit)
+        for (size_t i = 0; i < count; ++i)
         {
-            break;
-        }
+            col += til::at(widths, i);
 
-        dist += state.len;
+            if (col > columnLimit)
+            {
+                columns = col;
+                return dist;
+            }
+
+            dist = base + til::at(ends, i);
+        }
     }
 
     // But if we simply ran out of text we just need to return the actual number of columns.
@@ -555,10 +600,8 @@ void TextBuffer::Insert(til::CoordType row, const TextAttribute& attributes, Row
     // Restore trailing attributes as well.
     if (const auto copyAmount = restoreState.columnEnd - restoreState.columnBegin; copyAmount > 0)
     {
-        auto& rowAttr = r.Attributes();
-        const auto& scratchAttr = scratch.Attributes();
-        const auto restoreAttr = scratchAttr.slice(gsl::narrow<uint16_t>(state.columnBegin), gsl::narrow<uint16_t>(state.columnBegin + copyAmount));
-        rowAttr.replace(gsl::narrow<uint16_t>(restoreState.columnBegin), gsl::narrow<uint16_t>(restoreState.columnEnd), restoreAttr);
+        const auto restoreAttr = scratch.Attributes().slice(gsl::narrow<uint16_t>(state.columnBegin), gsl::narrow<uint16_t>(state.columnBegin + copyAmount));
+        r.ReplaceAttributes(restoreState.columnBegin, restoreState.columnEnd, restoreAttr);
         // If there is any image content, that needs to be copied too.
         ImageSlice::CopyCells(r, state.columnBegin, r, restoreState.columnBegin, restoreState.columnEnd);
     }
@@ -624,6 +667,16 @@ void TextBuffer::FillRect(const til::rect& rect, const std::wstring_view& fill,
     }
 }
 
+// Modifies the attributes of all cells in the given rectangle with func. See ROW::TransformAttributes.
+// NOTE: This doesn't trigger a redraw, since callers often change multiple rectangles at once.
+void TextBuffer::TransformAttributes(const til::rect& rect, const std::function<void(TextAttribute&)>& func)
+{
+    for (auto y = rect.top; y < rect.bottom; ++y)
+    {
+        GetMutableRowByOffset(y).TransformAttributes(rect.left, rect.right, func);
+    }
+}
+
 // Routine Description:
 // - Writes cells to the output buffer. Writes at the cursor.
 // Arguments:
@@ -731,6 +784,10 @@ void TextBuffer::IncrementCircularBuffer(const TextAttribute& fillAttributes)
         {
             _firstRow = 0;
         }
+
+        // All rows moved up by one and the recycled row (now at the bottom) is blank.
+        // GetMutableRowByOffset(0) above ensures that this can't go below -1.
+        _textWatermark--;
     }
 }
 
@@ -751,8 +808,9 @@ til::point TextBuffer::GetLastNonSpaceCharacter(const Viewport* viewOptional) co
     const auto viewport = viewOptional ? *viewOptional : GetSize();
 
     til::point coordEndOfText;
-    // Search the given viewport by starting at the bottom.
-    coordEndOfText.y = std::min(viewport.BottomInclusive(), _estimateOffsetOfLastCommittedRow());
+    // Search the given viewport by starting at the bottom. Rows past _textWatermark are known to be blank,
+    // but we mustn't start above the viewport, as the loop below would otherwise stop too late.
+    coordEndOfText.y = std::min({ viewport.BottomInclusive(), _estimateOffsetOfLastCommittedRow(), std::max(viewport.Top(), _textWatermark) });
 
     const auto& currRow = GetRowByOffset(coordEndOfText.y);
     // The X position of the end of the valid text is the Right draw boundary (which is one beyond the final valid character)
@@ -790,6 +848,7 @@ const Viewport TextBuffer::GetSize() const noexcept
 void TextBuffer::_SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept
 {
     _firstRow = FirstRowIndex;
+    _textWatermark = _height - 1;
 }
 
 void TextBuffer::ScrollRows(const til::CoordType firstRow, til::CoordType size, const til::CoordType delta)
@@ -803,6 +862,31 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, til::CoordType size,
     // A negative size doesn't make any sense anyways.
     size = std::max(0, size);
 
+    // If the source and destination overlap, we can rotate the affected rows into place without copying
+    // them (see _rotateRows()). Only the `distance`-many rows uncovered by the scroll need to be copied,
+    // because they're expected to retain their previous contents. Use RotateRows() if that's not needed.
+    // The rotation must not wrap around onto itself, which can happen when called by ClearScrollback().
+    if (const auto distance = std::abs(delta); distance < size && size + distance <= _height)
+    {
+        if (delta < 0)
+        {
+            _rotateRows(firstRow + delta, firstRow + size, distance);
+            for (auto y = firstRow + size - distance; y < firstRow + size; ++y)
+            {
+                CopyRow(y - distance, y, *this);
+            }
+        }
+        else
+        {
+            _rotateRows(firstRow, firstRow + size + delta, size);
+            for (auto y = firstRow; y < firstRow + delta; ++y)
+            {
+                CopyRow(y + distance, y, *this);
+            }
+        }
+        return;
+    }
+
     til::CoordType y = 0;
     til::CoordType end = 0;
     til::CoordType step = 0;
@@ -862,6 +946,60 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, til::CoordType size,
     }
 }
 
+// Like ScrollRows(), but the rows uncovered by the scroll end up with the contents of the rows that were
+// scrolled over instead of retaining theirs. This avoids copying any rows at all, as long as the
+// rows fit into the buffer without wrapping around. Use this if the caller overwrites them anyways.
+void TextBuffer::RotateRows(const til::CoordType firstRow, til::CoordType size, const til::CoordType delta)
+{
+    size = std::max(0, size);
+
+    const auto distance = std::abs(delta);
+    if (delta == 0 || size == 0 || size + distance > _height)
+    {
+        ScrollRows(firstRow, size, delta);
+        return;
+    }
+
+    if (delta < 0)
+    {
+        _rotateRows(firstRow + delta, firstRow + size, distance);
+    }
+    else
+    {
+        _rotateRows(firstRow, firstRow + size + delta, size);
+    }
+}
+
+// Rotates the rows in [beg,end) to the left by count, the same way std::rotate(beg, beg + count, end) does.
+// Only the _rowSlots entries are rotated (via 3 reversals), so no ROW is moved or copied.
+void TextBuffer::_rotateRows(const til::CoordType beg, const til::CoordType end, const til::CoordType count)
+{
+    // Uncommitted slots must not be rotated, or _estimateOffsetOfLastCommittedRow() would
+    // miss rows that were moved past it. So we commit all slots in the range first.
+    uint16_t lastSlot = 0;
+    for (auto y = beg; y < end; ++y)
+    {
+        lastSlot = std::max(lastSlot, til::at(_rowSlots, _getRowOffset(y)));
+    }
+    _getRowByOffsetDirect(size_t{ lastSlot } + 1);
+
+    const auto reverse = [this](til::CoordType lo, til::CoordType hi) {
+        for (--hi; lo < hi; ++lo, --hi)
+        {
+            std::swap(til::at(_rowSlots, _getRowOffset(lo)), til::at(_rowSlots, _getRowOffset(hi)));
+        }
+    };
+
+    reverse(beg, beg + count);
+    reverse(beg + count, end);
+    reverse(beg, end);
+
+    // The rows have moved, so the same things need to be invalidated as if they had been written to.
+    const auto last = end - 1;
+    _lastMutationId++;
+    _textWatermark = std::max(_textWatermark, last >= 0 && last < _height ? last : _height - 1);
+}
+
 void TextBuffer::CopyRow(const til::CoordType srcRowIndex, const til::CoordType dstRowIndex, TextBuffer& dstBuffer) const
 {
     auto& dstRow = dstBuffer.GetMutableRowByOffset(dstRowIndex);
@@ -870,6 +1008,34 @@ void TextBuffer::CopyRow(const til::CoordType srcRowIndex, const til::CoordType
     ImageSlice::CopyRow(srcRow, dstRow);
 }
 
+// Returns a copy of the text of all committed rows of this buffer. Long-running readers like search
+// can work on such a snapshot without having to hold the console lock, which would otherwise stall
+// output processing. Row offsets and GetLastMutationId() are identical to that of this buffer,
+// so that results can be mapped back and checked for staleness. Attributes and images aren't
+// copied, because the snapshot is only meant for reading text and the copy happens under the lock.
+std::unique_ptr<TextBuffer> TextBuffer::CreateSnapshot() const
+{
+    const auto rowCount = _estimateOffsetOfLastCommittedRow() + 1;
+    auto snapshot = std::make_unique<TextBuffer>(til::size{ _width, rowCount }, _initialAttributes, 0, false, nullptr);
+
+    for (til::CoordType y = 0; y < rowCount; ++y)
+    {
+        const auto& srcRow = GetRowByOffset(y);
+        auto& dstRow = snapshot->GetMutableRowByOffset(y);
+        dstRow.SetLineRendition(srcRow.GetLineRendition());
+        dstRow.SetWrapForced(srcRow.WasWrapForced());
+
+        RowCopyTextFromState state{
+            .source = srcRow,
+            .sourceColumnLimit = srcRow.GetReadableColumnCount(),
+        };
+        dstRow.CopyTextFrom(state);
+    }
+
+    snapshot->_lastMutationId = _lastMutationId;
+    return snapshot;
+}
+
 Cursor& TextBuffer::GetCursor() noexcept
 {
     return _cursor;
@@ -1000,18 +1166,21 @@ void TextBuffer::ClearScrollback(const til::CoordType newFirstRow, const til::Co
     // Our goal is to move the viewport to the absolute start of the underlying memory buffer so that we can
     // MEM_DECOMMIT the remaining memory. _firstRow is used to make the TextBuffer behave like a circular buffer.
     // The newFirstRow parameter is relative to the _firstRow. The trick to get the content to the absolute start
-    // is to simply add _firstRow ourselves and then reset it to 0. This causes ScrollRows() to write into
+    // is to simply add _firstRow ourselves and then reset it to 0. This causes RotateRows() to write into
     // the absolute start while reading from relative coordinates. This works because GetRowByOffset()
     // operates modulo the buffer height and so the possibly-too-large startAbsolute won't be an issue.
     const auto startAbsolute = _firstRow + newFirstRow;
-    _firstRow = 0;
-    ScrollRows(startAbsolute, rowsToKeep, -startAbsolute);
+    _SetFirstRowIndex(0);
+    RotateRows(startAbsolute, rowsToKeep, -startAbsolute);
 
     const auto end = _estimateOffsetOfLastCommittedRow();
     for (auto y = rowsToKeep; y <= end; ++y)
     {
         GetMutableRowByOffset(y).Reset(_initialAttributes);
     }
+
+    // Everything past the rows we kept is blank now.
+    _textWatermark = std::min(_textWatermark, rowsToKeep - 1);
 }
 
 // Routine Description:
@@ -1047,13 +1216,16 @@ void TextBuffer::ResizeTraditional(til::size newSize)
     _bufferEnd = newBuffer._bufferEnd;
     _commitWatermark = newBuffer._commitWatermark;
     _initialAttributes = newBuffer._initialAttributes;
+    _attrTable = std::move(newBuffer._attrTable);
     _bufferRowStride = newBuffer._bufferRowStride;
     _bufferOffsetChars = newBuffer._bufferOffsetChars;
     _bufferOffsetCharOffsets = newBuffer._bufferOffsetCharOffsets;
+    _rowSlots = std::move(newBuffer._rowSlots);
     _width = newBuffer._width;
     _height = newBuffer._height;
 
     _SetFirstRowIndex(0);
+    _textWatermark = newBuffer._textWatermark;
 }
 
 void TextBuffer::SetAsActiveBuffer(const bool isActiveBuffer) noexcept
@@ -1127,18 +1299,156 @@ void TextBuffer::TriggerSelection()
     }
 }
 
+// Word navigation classifies the same rows over and over again. A screen reader moving word by word for instance
+// looks at the row it's on during every step. The DelimiterClassMap of each row is therefore cached by the row's
+// generation (see GetMutableRowByOffset()). Generations are unique across buffers, so the cache can be shared.
+struct DelimiterClassCache
+{
+    static constexpr size_t Capacity = 1024;
+
+    std::wstring wordDelimiters;
+    til::lru_cache<uint64_t, DelimiterClassMap> maps{ Capacity };
+};
+
+static til::shared_mutex<DelimiterClassCache>& delimiterClassCache()
+{
+    static til::shared_mutex<DelimiterClassCache> cache;
+    return cache;
+}
+
+// Classifies the rows visited by a single word navigation call.
+// It holds the cache lock for its entire lifetime, so it should be short-lived.
+class TextBuffer::DelimiterClassLookup
+{
+public:
+    DelimiterClassLookup(const TextBuffer& buffer, const std::wstring_view& wordDelimiters) :
+        _buffer{ buffer },
+        _classifier{ wordDelimiters },
+        _cache{ delimiterClassCache().lock() }
+    {
+        // The cached maps are only valid for the delimiters they were computed with.
+        if (_cache->wordDelimiters != wordDelimiters)
+        {
+            _cache->maps.clear();
+            _cache->wordDelimiters = wordDelimiters;
+        }
+    }
+
+    // Returns the classification of the row at the given offset (see GetRowByOffset()).
+    // The returned reference is only valid until the next call.
+    const DelimiterClassMap& Get(const til::CoordType y)
+    {
+        if (_last && y == _lastY)
+        {
+            return *_last;
+        }
+
+        const auto& row = _buffer.GetRowByOffset(y);
+        const auto generation = row.GetGeneration();
+
+        if (generation == 0)
+        {
+            // The row was never modified and there's no telling it apart from other such rows.
+            _uncached = row.ClassifyDelimiters(_classifier);
+            _last = &_uncached;
+        }
+        else if (const auto map = _cache->maps.find(generation))
+        {
+            _last = map;
+        }
+        else
+        {
+            _last = &_cache->maps.insert_or_assign(generation, row.ClassifyDelimiters(_classifier));
+        }
+
+        _lastY = y;
+        return *_last;
+    }
+
+private:
+    const TextBuffer& _buffer;
+    DelimiterClassifier _classifier;
+    til::shared_mutex<DelimiterClassCache>::guard _cache;
+    DelimiterClassMap _uncached;
+    const DelimiterClassMap* _last = nullptr;
+    til::CoordType _lastY = 0;
+};
+
 // Method Description:
 // - get delimiter class for buffer cell position
 // - used for double click selection and uia word navigation
 // Arguments:
 // - pos: the buffer cell under observation
-// - wordDelimiters: the delimiters defined as a part of the DelimiterClass::DelimiterChar
+// - lookup: classifies the cells according to the word delimiters
 // Return Value:
 // - the delimiter class for the given char
-DelimiterClass TextBuffer::_GetDelimiterClassAt(const til::point pos, const std::wstring_view wordDelimiters) const
+DelimiterClass TextBuffer::_GetDelimiterClassAt(const til::point pos, DelimiterClassLookup& lookup) const
 {
     const auto realPos = ScreenToBufferPosition(pos);
-    return GetRowByOffset(realPos.y).DelimiterClassAt(realPos.x, wordDelimiters);
+    return lookup.Get(realPos.y).At(realPos.x);
+}
+
+// Returns the first column of the run of cells in pos' row, which contains pos and whose cells all have the same delimiter class.
+// Looking at an entire row at once is a lot cheaper than calling _GetDelimiterClassAt() for each cell.
+til::CoordType TextBuffer::_GetDelimiterClassRunStartInRow(const til::point pos, DelimiterClassLookup& lookup) const
+{
+    const auto scale = IsDoubleWidthLine(pos.y) ? 1 : 0;
+    return lookup.Get(pos.y).RunStart(pos.x >> scale) << scale;
+}
+
+// Returns the end (exclusive) of the run of cells in pos' row, which contains pos and whose cells all have the same delimiter class.
+til::CoordType TextBuffer::_GetDelimiterClassRunEndInRow(const til::point pos, DelimiterClassLookup& lookup) const
+{
+    const auto scale = IsDoubleWidthLine(pos.y) ? 1 : 0;
+    const auto end = lookup.Get(pos.y).RunEnd(pos.x >> scale) << scale;
+    return std::min(end, GetSize().RightExclusive());
+}
+
+// Moves pos backwards (wrapping onto previous rows) until it's at the origin or at a cell
+// for which (delimiter class == RegularChar) is different from the given `regular`.
+void TextBuffer::_SkipCellsBackward(til::point& pos, const bool regular, DelimiterClassLookup& lookup) const
+{
+    const auto bufferSize = GetSize();
+
+    while (pos != bufferSize.Origin() && (_GetDelimiterClassAt(pos, lookup) == DelimiterClass::RegularChar) == regular)
+    {
+        if (const auto start = _GetDelimiterClassRunStartInRow(pos, lookup); start > bufferSize.Left())
+        {
+            pos.x = start - 1;
+        }
+        else if (pos.y > bufferSize.Top())
+        {
+            pos = { bufferSize.RightInclusive(), pos.y - 1 };
+        }
+        else
+        {
+            pos = bufferSize.Origin();
+        }
+    }
+}
+
+// Moves pos forwards (wrapping onto next rows) until it's at stop or at a cell
+// for which (delimiter class == RegularChar) is different from the given `regular`.
+// stop must not be before pos.
+void TextBuffer::_SkipCellsForward(til::point& pos, const til::point stop, const bool regular, DelimiterClassLookup& lookup) const
+{
+    const auto bufferSize = GetSize();
+
+    while (pos != stop && (_GetDelimiterClassAt(pos, lookup) == DelimiterClass::RegularChar) == regular)
+    {
+        if (const auto end = _GetDelimiterClassRunEndInRow(pos, lookup); pos.y == stop.y && end >= stop.x)
+        {
+            pos = stop;
+        }
+        else if (end < bufferSize.RightExclusive())
+        {
+            pos.x = end;
+        }
+        else
+        {
+            pos = { bufferSize.Left(), pos.y + 1 };
+        }
+    }
 }
 
 til::point TextBuffer::GetWordStart2(til::point pos, const std::wstring_view wordDelimiters, bool includeWhitespace, std::optional<til::point> limitOptional) const
@@ -1173,8 +1483,9 @@ til::point TextBuffer::GetWordStart2(til::point pos, const std::wstring_view wor
     // So the heuristic we use is:
     // 1. move to the beginning of the delimiter class run
     // 2. (includeWhitespace) if we were on a ControlChar, go back one more delimiter class run
-    const auto initialDelimiter = bufferSize.IsInBounds(pos) ? _GetDelimiterClassAt(pos, wordDelimiters) : DelimiterClass::ControlChar;
-    pos = _GetDelimiterClassRunStart(pos, wordDelimiters);
+    DelimiterClassLookup lookup{ *this, wordDelimiters };
+    const auto initialDelimiter = bufferSize.IsInBounds(pos) ? _GetDelimiterClassAt(pos, lookup) : DelimiterClass::ControlChar;
+    pos = _GetDelimiterClassRunStart(pos, lookup);
     if (!includeWhitespace || pos.x == bufferSize.Left())
     {
         // Special case:
@@ -1185,7 +1496,7 @@ til::point TextBuffer::GetWordStart2(til::point pos, const std::wstring_view wor
     else if (initialDelimiter == DelimiterClass::ControlChar)
     {
         bufferSize.DecrementInExclusiveBounds(pos);
-        pos = _GetDelimiterClassRunStart(pos, wordDelimiters);
+        pos = _GetDelimiterClassRunStart(pos, lookup);
     }
     return pos;
 }
@@ -1223,7 +1534,8 @@ til::point TextBuffer::GetWordEnd2(til::point pos, const std::wstring_view wordD
     // So the heuristic we use is:
     // 1. move to the end of the delimiter class run
     // 2. (includeWhitespace) if the next delimiter class run is a ControlChar, go forward one more delimiter class run
-    pos = _GetDelimiterClassRunEnd(pos, wordDelimiters);
+    DelimiterClassLookup lookup{ *this, wordDelimiters };
+    pos = _GetDelimiterClassRunEnd(pos, lookup);
     if (!includeWhitespace || pos.x == bufferSize.RightExclusive())
     {
         // Special case:
@@ -1232,10 +1544,10 @@ til::point TextBuffer::GetWordEnd2(til::point pos, const std::wstring_view wordD
         return pos;
     }
 
-    if (const auto nextDelimClass = bufferSize.IsInBounds(pos) ? _GetDelimiterClassAt(pos, wordDelimiters) : DelimiterClass::ControlChar;
+    if (const auto nextDelimClass = bufferSize.IsInBounds(pos) ? _GetDelimiterClassAt(pos, lookup) : DelimiterClass::ControlChar;
         nextDelimClass == DelimiterClass::ControlChar)
     {
-        return _GetDelimiterClassRunEnd(pos, wordDelimiters);
+        return _GetDelimiterClassRunEnd(pos, lookup);
     }
     return pos;
 }
@@ -1277,40 +1589,50 @@ bool TextBuffer::IsWordBoundary(const til::point pos, const std::wstring_view wo
 
     // we can treat text as contiguous,
     // use DecrementInBounds (not exclusive) here
+    DelimiterClassLookup lookup{ *this, wordDelimiters };
     auto prevPos = pos;
     bufferSize.DecrementInBounds(prevPos);
-    const auto prevDelimiterClass = _GetDelimiterClassAt(prevPos, wordDelimiters);
+    const auto prevDelimiterClass = _GetDelimiterClassAt(prevPos, lookup);
 
     // if we changed delimiter class
     // and the current delimiter class is not a control char,
     // we're at a word boundary
-    const auto currentDelimiterClass = _GetDelimiterClassAt(pos, wordDelimiters);
+    const auto currentDelimiterClass = _GetDelimiterClassAt(pos, lookup);
     return prevDelimiterClass != currentDelimiterClass && currentDelimiterClass != DelimiterClass::ControlChar;
 }
 
-til::point TextBuffer::_GetDelimiterClassRunStart(til::point pos, const std::wstring_view wordDelimiters) const
+til::point TextBuffer::_GetDelimiterClassRunStart(til::point pos, DelimiterClassLookup& lookup) const
 {
     const auto bufferSize = GetSize();
-    const auto initialDelimClass = bufferSize.IsInBounds(pos) ? _GetDelimiterClassAt(pos, wordDelimiters) : DelimiterClass::ControlChar;
-    for (auto nextPos = pos; nextPos != bufferSize.Origin(); pos = nextPos)
+    const auto initialDelimClass = bufferSize.IsInBounds(pos) ? _GetDelimiterClassAt(pos, lookup) : DelimiterClass::ControlChar;
+    while (pos != bufferSize.Origin())
     {
-        bufferSize.DecrementInExclusiveBounds(nextPos);
-
-        if (nextPos.x == bufferSize.RightExclusive())
+        if (pos.x == bufferSize.Left())
         {
-            // wrapped onto previous line,
+            // wrapping onto previous line,
             // check if it was forced to wrap
-            const auto& row = GetRowByOffset(nextPos.y);
+            const auto& row = GetRowByOffset(pos.y - 1);
             if (!row.WasWrapForced())
             {
                 return pos;
             }
+            pos = { bufferSize.RightExclusive(), pos.y - 1 };
+            continue;
         }
-        else if (_GetDelimiterClassAt(nextPos, wordDelimiters) != initialDelimClass)
+
+        const til::point prevPos{ pos.x - 1, pos.y };
+        if (_GetDelimiterClassAt(prevPos, lookup) != initialDelimClass)
         {
             // if we changed delim class, we're done (don't apply move)
             return pos;
         }
+
+        // skip the remaining cells of the same delim class in this row at once
+        pos.x = _GetDelimiterClassRunStartInRow(prevPos, lookup);
+        if (pos.x != bufferSize.Left())
+        {
+            return pos;
+        }
     }
     return pos;
 }
@@ -1319,31 +1641,46 @@ til::point TextBuffer::_GetDelimiterClassRunStart(til::point pos, const std::wst
 // - Get the exclusive position for the end of the current delimiter class run
 // Arguments:
 // - pos - the buffer position being within the current delimiter class
-// - wordDelimiters - what characters are we considering for the separation of words
-til::point TextBuffer::_GetDelimiterClassRunEnd(til::point pos, const std::wstring_view wordDelimiters) const
+// - lookup - classifies the cells according to the word delimiters
+til::point TextBuffer::_GetDelimiterClassRunEnd(til::point pos, DelimiterClassLookup& lookup) const
 {
     const auto bufferSize = GetSize();
-    const auto initialDelimClass = bufferSize.IsInBounds(pos) ? _GetDelimiterClassAt(pos, wordDelimiters) : DelimiterClass::ControlChar;
-    for (auto nextPos = pos; nextPos != bufferSize.BottomInclusiveRightExclusive(); pos = nextPos)
+    const auto initialDelimClass = bufferSize.IsInBounds(pos) ? _GetDelimiterClassAt(pos, lookup) : DelimiterClass::ControlChar;
+    while (pos != bufferSize.BottomInclusiveRightExclusive())
     {
-        bufferSize.IncrementInExclusiveBounds(nextPos);
-
-        if (nextPos.x == bufferSize.Left())
+        if (pos.x == bufferSize.RightExclusive())
         {
-            // wrapped onto next line,
+            // wrapping onto next line,
             // check if it was forced to wrap or switched delimiter class
+            const til::point nextPos{ bufferSize.Left(), pos.y + 1 };
             const auto& row = GetRowByOffset(pos.y);
-            if (!row.WasWrapForced() || _GetDelimiterClassAt(nextPos, wordDelimiters) != initialDelimClass)
+            if (!row.WasWrapForced() || _GetDelimiterClassAt(nextPos, lookup) != initialDelimClass)
             {
                 return pos;
             }
+            pos = nextPos;
+            continue;
+        }
+
+        const til::point nextPos{ pos.x + 1, pos.y };
+        if (nextPos.x == bufferSize.RightExclusive())
+        {
+            pos = nextPos;
+            continue;
         }
-        else if (bufferSize.IsInBounds(nextPos) && _GetDelimiterClassAt(nextPos, wordDelimiters) != initialDelimClass)
+        if (_GetDelimiterClassAt(nextPos, lookup) != initialDelimClass)
         {
             // if we changed delim class,
             // apply the move and return
             return nextPos;
         }
+
+        // skip the remaining cells of the same delim class in this row at once
+        pos.x = _GetDelimiterClassRunEndInRow(nextPos, lookup);
+        if (pos.x != bufferSize.RightExclusive())
+        {
+            return pos;
+        }
     }
     return pos;
 }
@@ -1392,13 +1729,14 @@ til::point TextBuffer::GetWordStart(const til::point target, const std::wstring_
         copy = limitOptional.value_or(bufferSize.BottomRightInclusive());
     }
 
+    DelimiterClassLookup lookup{ *this, wordDelimiters };
     if (accessibilityMode)
     {
-        return _GetWordStartForAccessibility(copy, wordDelimiters);
+        return _GetWordStartForAccessibility(copy, lookup);
     }
     else
     {
-        return _GetWordStartForSelection(copy, wordDelimiters);
+        return _GetWordStartForSelection(copy, lookup);
     }
 }
 
@@ -1406,35 +1744,29 @@ til::point TextBuffer::GetWordStart(const til::point target, const std::wstring_
 // - Helper method for GetWordStart(). Get the til::point for the beginning of the word (accessibility definition) you are on
 // Arguments:
 // - target - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
+// - lookup - classifies the cells according to the word delimiters
 // Return Value:
 // - The til::point for the first character on the current/previous READABLE "word" (inclusive)
-til::point TextBuffer::_GetWordStartForAccessibility(const til::point target, const std::wstring_view wordDelimiters) const
+til::point TextBuffer::_GetWordStartForAccessibility(const til::point target, DelimiterClassLookup& lookup) const
 {
     auto result = target;
     const auto bufferSize = GetSize();
 
     // ignore left boundary. Continue until readable text found
-    while (_GetDelimiterClassAt(result, wordDelimiters) != DelimiterClass::RegularChar)
+    _SkipCellsBackward(result, false, lookup);
+    if (_GetDelimiterClassAt(result, lookup) != DelimiterClass::RegularChar)
     {
-        if (result == bufferSize.Origin())
-        {
-            //looped around and hit origin (no word between origin and target)
-            return result;
-        }
-        bufferSize.DecrementInBounds(result);
+        //looped around and hit origin (no word between origin and target)
+        return result;
     }
 
     // make sure we expand to the left boundary or the beginning of the word
-    while (_GetDelimiterClassAt(result, wordDelimiters) == DelimiterClass::RegularChar)
+    _SkipCellsBackward(result, true, lookup);
+    if (_GetDelimiterClassAt(result, lookup) == DelimiterClass::RegularChar)
     {
-        if (result == bufferSize.Origin())
-        {
-            // first char in buffer is a RegularChar
-            // we can't move any further back
-            return result;
-        }
-        bufferSize.DecrementInBounds(result);
+        // first char in buffer is a RegularChar
+        // we can't move any further back
+        return result;
     }
 
     // move off of delimiter
@@ -1447,19 +1779,19 @@ til::point TextBuffer::_GetWordStartForAccessibility(const til::point target, co
 // - Helper method for GetWordStart(). Get the til::point for the beginning of the word (selection definition) you are on
 // Arguments:
 // - target - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
+// - lookup - classifies the cells according to the word delimiters
 // Return Value:
 // - The til::point for the first character on the current word or delimiter run (stopped by the left margin)
-til::point TextBuffer::_GetWordStartForSelection(const til::point target, const std::wstring_view wordDelimiters) const
+til::point TextBuffer::_GetWordStartForSelection(const til::point target, DelimiterClassLookup& lookup) const
 {
     auto result = target;
     const auto bufferSize = GetSize();
 
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
+    const auto initialDelimiter = _GetDelimiterClassAt(result, lookup);
     const bool isControlChar = initialDelimiter == DelimiterClass::ControlChar;
 
     // expand left until we hit the left boundary or a different delimiter class
-    while (result != bufferSize.Origin() && _GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter)
+    while (result != bufferSize.Origin() && _GetDelimiterClassAt(result, lookup) == initialDelimiter)
     {
         if (result.x == bufferSize.Left())
         {
@@ -1482,7 +1814,7 @@ til::point TextBuffer::_GetWordStartForSelection(const til::point target, const
         bufferSize.DecrementInBounds(result);
     }
 
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
+    if (_GetDelimiterClassAt(result, lookup) != initialDelimiter)
     {
         // move off of delimiter
         bufferSize.IncrementInBounds(result);
@@ -1522,13 +1854,14 @@ til::point TextBuffer::GetWordEnd(const til::point target, const std::wstring_vi
         return target;
     }
 
+    DelimiterClassLookup lookup{ *this, wordDelimiters };
     if (accessibilityMode)
     {
-        return _GetWordEndForAccessibility(target, wordDelimiters, limit);
+        return _GetWordEndForAccessibility(target, lookup, limit);
     }
     else
     {
-        return _GetWordEndForSelection(target, wordDelimiters);
+        return _GetWordEndForSelection(target, lookup);
     }
 }
 
@@ -1536,11 +1869,11 @@ til::point TextBuffer::GetWordEnd(const til::point target, const std::wstring_vi
 // - Helper method for GetWordEnd(). Get the til::point for the beginning of the next READABLE word
 // Arguments:
 // - target - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
+// - lookup - classifies the cells according to the word delimiters
 // - limit - the last "valid" position in the text buffer (to improve performance)
 // Return Value:
 // - The til::point for the first character of the next readable "word". If no next word, return one past the end of the buffer
-til::point TextBuffer::_GetWordEndForAccessibility(const til::point target, const std::wstring_view wordDelimiters, const til::point limit) const
+til::point TextBuffer::_GetWordEndForAccessibility(const til::point target, DelimiterClassLookup& lookup, const til::point limit) const
 {
     const auto bufferSize{ GetSize() };
     auto result{ target };
@@ -1556,17 +1889,14 @@ til::point TextBuffer::_GetWordEndForAccessibility(const til::point target, cons
     }
     else
     {
-        while (result != limit && result != bufferSize.BottomRightInclusive() && _GetDelimiterClassAt(result, wordDelimiters) == DelimiterClass::RegularChar)
-        {
-            // Iterate through readable text
-            bufferSize.IncrementInBounds(result);
-        }
+        // We stop at the limit or the last cell of the buffer, whichever comes first.
+        const auto stop = std::min(limit, bufferSize.BottomRightInclusive());
 
-        while (result != limit && result != bufferSize.BottomRightInclusive() && _GetDelimiterClassAt(result, wordDelimiters) != DelimiterClass::RegularChar)
-        {
-            // expand to the beginning of the NEXT word
-            bufferSize.IncrementInBounds(result);
-        }
+        // Iterate through readable text
+        _SkipCellsForward(result, stop, true, lookup);
+
+        // expand to the beginning of the NEXT word
+        _SkipCellsForward(result, stop, false, lookup);
 
         // Special case: we tried to move one past the end of the buffer
         // Manually increment onto the EndExclusive point.
@@ -1583,19 +1913,19 @@ til::point TextBuffer::_GetWordEndForAccessibility(const til::point target, cons
 // - Helper method for GetWordEnd(). Get the til::point for the beginning of the NEXT word
 // Arguments:
 // - target - a til::point on the word you are currently on
-// - wordDelimiters - what characters are we considering for the separation of words
+// - lookup - classifies the cells according to the word delimiters
 // Return Value:
 // - The til::point for the last character of the current word or delimiter run (stopped by right margin)
-til::point TextBuffer::_GetWordEndForSelection(const til::point target, const std::wstring_view wordDelimiters) const
+til::point TextBuffer::_GetWordEndForSelection(const til::point target, DelimiterClassLookup& lookup) const
 {
     const auto bufferSize = GetSize();
 
     auto result = target;
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
+    const auto initialDelimiter = _GetDelimiterClassAt(result, lookup);
     const bool isControlChar = initialDelimiter == DelimiterClass::ControlChar;
 
     // expand right until we hit the right boundary as a ControlChar or a different delimiter class
-    while (result != bufferSize.BottomRightInclusive() && _GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter)
+    while (result != bufferSize.BottomRightInclusive() && _GetDelimiterClassAt(result, lookup) == initialDelimiter)
     {
         if (result.x == bufferSize.RightInclusive())
         {
@@ -1616,7 +1946,7 @@ til::point TextBuffer::_GetWordEndForSelection(const til::point target, const st
         bufferSize.IncrementInBounds(result);
     }
 
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
+    if (_GetDelimiterClassAt(result, lookup) != initialDelimiter)
     {
         // move off of delimiter
         bufferSize.DecrementInBounds(result);
@@ -1687,7 +2017,8 @@ bool TextBuffer::MoveToNextWord(til::point& pos, const std::wstring_view wordDel
     //       This is also the inclusive start of the next word.
     const auto bufferSize{ GetSize() };
     const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
-    const auto copy{ _GetWordEndForAccessibility(pos, wordDelimiters, limit) };
+    DelimiterClassLookup lookup{ *this, wordDelimiters };
+    const auto copy{ _GetWordEndForAccessibility(pos, lookup, limit) };
 
     if (bufferSize.CompareInBounds(copy, limit, true) >= 0)
     {
@@ -2214,12 +2545,170 @@ std::string TextBuffer::GenHTML(const CopyRequest& req,
                                 const COLORREF backgroundColor,
                                 const bool isIntenseBold,
                                 std::function<std::tuple<COLORREF, COLORREF, COLORREF>(const TextAttribute&)> GetAttributeColors) const noexcept
+try
+{
+    return GenHTML(CreateCopySnapshot(req, GetAttributeColors), fontHeightPoints, fontFaceName, backgroundColor, isIntenseBold);
+}
+catch (...)
+{
+    LOG_HR(wil::ResultFromCaughtException());
+    return {};
+}
+
+// Routine Description:
+// - Generates an RTF document from the selected region of the buffer
+//   RTF 1.5 Spec: https://www.biblioscape.com/rtf15_spec.htm
+//   RTF 1.9.1 Spec: https://msopenspecs.azureedge.net/files/Archive_References/[MSFT-RTF].pdf
+// Arguments:
+// - req - the copy request having the bounds of the selected region and other related configuration flags.
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// - backgroundColor - default background color for characters, also used in padding
+// - isIntenseBold - true if being intense is treated as being bold
+// - GetAttributeColors - function to get the colors of the text attributes as they're rendered
+// Return Value:
+// - string containing the generated RTF. Empty if the copy request is invalid.
+std::string TextBuffer::GenRTF(const CopyRequest& req,
+                               const int fontHeightPoints,
+                               const std::wstring_view fontFaceName,
+                               const COLORREF backgroundColor,
+                               const bool isIntenseBold,
+                               std::function<std::tuple<COLORREF, COLORREF, COLORREF>(const TextAttribute&)> GetAttributeColors) const noexcept
+try
+{
+    return GenRTF(CreateCopySnapshot(req, GetAttributeColors), fontHeightPoints, fontFaceName, backgroundColor, isIntenseBold);
+}
+catch (...)
+{
+    LOG_HR(wil::ResultFromCaughtException());
+    return {};
+}
+
+// Routine Description:
+// - Copies the text and attributes of the selected region of the buffer into a CopySnapshot.
+//   GetAttributeColors is called exactly once for every distinct attribute.
+// Arguments:
+// - req - the copy request having the bounds of the selected region and other related configuration flags.
+// - GetAttributeColors - function to get the colors of the text attributes as they're rendered. May be empty.
+// Return Value:
+// - The snapshot. It contains no rows if the copy request is invalid.
+TextBuffer::CopySnapshot TextBuffer::CreateCopySnapshot(const CopyRequest& req, const std::function<std::tuple<COLORREF, COLORREF, COLORREF>(const TextAttribute&)>& GetAttributeColors) const
+{
+    struct AttributeHasher
+    {
+        size_t operator()(const TextAttribute& attr) const noexcept
+        {
+            return til::hash(attr);
+        }
+    };
+
+    CopySnapshot snapshot;
+
+    if (req.beg > req.end)
+    {
+        return snapshot;
+    }
+
+    std::unordered_map<TextAttribute, uint32_t, AttributeHasher> styleIndices;
+    const auto getStyleIndex = [&](const TextAttribute& attr) {
+        const auto [it, inserted] = styleIndices.emplace(attr, gsl::narrow<uint32_t>(snapshot.styles.size()));
+        if (inserted)
+        {
+            auto& style = snapshot.styles.emplace_back();
+            style.attr = attr;
+            if (GetAttributeColors)
+            {
+                std::tie(style.fg, style.bg, style.ul) = GetAttributeColors(attr);
+            }
+        }
+        return it->second;
+    };
+
+    snapshot.rows.reserve(gsl::narrow_cast<size_t>(req.end.y - req.beg.y + 1));
+
+    for (auto iRow = req.beg.y; iRow <= req.end.y; ++iRow)
+    {
+        const auto& row = GetRowByOffset(iRow);
+        const auto [rowBeg, rowEnd, addLineBreak] = _RowCopyHelper(req, iRow, row);
+        const auto rowBegU16 = gsl::narrow_cast<uint16_t>(rowBeg);
+        const auto rowEndU16 = gsl::narrow_cast<uint16_t>(rowEnd);
+        const auto runs = row.Attributes().slice(rowBegU16, rowEndU16).runs();
+
+        auto x = rowBegU16;
+        for (const auto& [attr, length] : runs)
+        {
+            const auto nextX = gsl::narrow_cast<uint16_t>(x + length);
+            snapshot.text += row.GetText(x, nextX);
+            snapshot.runs.push_back({ getStyleIndex(attr), snapshot.text.size() });
+            x = nextX;
+        }
+
+        snapshot.rows.push_back({ snapshot.runs.size(), addLineBreak });
+    }
+
+    return snapshot;
+}
+
+// Calls `func(std::string& out, size_t rowBeg, size_t rowEnd)` for consecutive chunks of the given
+// number of rows and returns the concatenation of all outputs. Huge selections are split up across
+// multiple threads, because generating formatted text for 100k+ rows can take seconds otherwise.
+template<typename Func>
+static std::string generateRowChunks(const size_t rowCount, Func&& func)
+{
+    static constexpr size_t minRowsPerChunk = 4096;
+    const auto chunkCount = til::parallel_chunk_count(rowCount, minRowsPerChunk);
+    const auto chunkBeg = [&](const size_t chunk) noexcept {
+        return rowCount * chunk / chunkCount;
+    };
+
+    std::vector<std::string> outputs(chunkCount);
+
+    if (chunkCount == 1)
+    {
+        func(outputs[0], 0, rowCount);
+        return std::move(outputs[0]);
+    }
+
+    til::parallel_for(chunkCount, [&](const size_t chunk) {
+        func(til::at(outputs, chunk), chunkBeg(chunk), chunkBeg(chunk + 1));
+    });
+
+    size_t totalSize = 0;
+    for (const auto& output : outputs)
+    {
+        totalSize += output.size();
+    }
+
+    std::string result;
+    result.reserve(totalSize);
+    for (const auto& output : outputs)
+    {
+        result += output;
+    }
+    return result;
+}
+
+// Routine Description:
+// - Generates a CF_HTML compliant structure from a snapshot of the buffer
+// Arguments:
+// - snapshot - the selected region of the buffer, as returned by CreateCopySnapshot().
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// - backgroundColor - default background color for characters, also used in padding
+// - isIntenseBold - true if being intense is treated as being bold
+// Return Value:
+// - string containing the generated HTML. Empty if the snapshot is empty.
+std::string TextBuffer::GenHTML(const CopySnapshot& snapshot,
+                                const int fontHeightPoints,
+                                const std::wstring_view fontFaceName,
+                                const COLORREF backgroundColor,
+                                const bool isIntenseBold) noexcept
 {
     // GH#5347 - Don't provide a title for the generated HTML, as many
     // web applications will paste the title first, followed by the HTML
     // content, which is unexpected.
 
-    if (req.beg > req.end)
+    if (snapshot.rows.empty())
     {
         return {};
     }
@@ -2254,122 +2743,131 @@ std::string TextBuffer::GenHTML(const CopyRequest& req,
             htmlBuilder += "\">";
         }
 
-        for (auto iRow = req.beg.y; iRow <= req.end.y; ++iRow)
+        // The markup surrounding each run only depends on its attributes,
+        // which is why we only need to generate it once per style.
+        std::vector<std::string> spanOpen;
+        std::vector<std::string_view> spanClose;
+        spanOpen.reserve(snapshot.styles.size());
+        spanClose.reserve(snapshot.styles.size());
+
+        for (const auto& [attr, fg, bg, ul] : snapshot.styles)
         {
-            const auto& row = GetRowByOffset(iRow);
-            const auto [rowBeg, rowEnd, addLineBreak] = _RowCopyHelper(req, iRow, row);
-            const auto rowBegU16 = gsl::narrow_cast<uint16_t>(rowBeg);
-            const auto rowEndU16 = gsl::narrow_cast<uint16_t>(rowEnd);
-            const auto runs = row.Attributes().slice(rowBegU16, rowEndU16).runs();
+            auto& open = spanOpen.emplace_back();
+            const auto fgHex = Utils::ColorToHexString(fg);
+            const auto bgHex = Utils::ColorToHexString(bg);
+            const auto ulHex = Utils::ColorToHexString(ul);
+            const auto ulStyle = attr.GetUnderlineStyle();
+            const auto isUnderlined = ulStyle != UnderlineStyle::NoUnderline;
+            const auto isCrossedOut = attr.IsCrossedOut();
+            const auto isOverlined = attr.IsOverlined();
+
+            open += "<SPAN STYLE=\"";
+            fmt::format_to(std::back_inserter(open), FMT_COMPILE("color:{};"), fgHex);
+            fmt::format_to(std::back_inserter(open), FMT_COMPILE("background-color:{};"), bgHex);
+
+            if (attr.IsBold(isIntenseBold))
+            {
+                open += "font-weight:bold;";
+            }
 
-            auto x = rowBegU16;
-            for (const auto& [attr, length] : runs)
+            if (attr.IsItalic())
             {
-                const auto nextX = gsl::narrow_cast<uint16_t>(x + length);
-                const auto [fg, bg, ul] = GetAttributeColors(attr);
-                const auto fgHex = Utils::ColorToHexString(fg);
-                const auto bgHex = Utils::ColorToHexString(bg);
-                const auto ulHex = Utils::ColorToHexString(ul);
-                const auto ulStyle = attr.GetUnderlineStyle();
-                const auto isUnderlined = ulStyle != UnderlineStyle::NoUnderline;
-                const auto isCrossedOut = attr.IsCrossedOut();
-                const auto isOverlined = attr.IsOverlined();
-
-                htmlBuilder += "<SPAN STYLE=\"";
-                fmt::format_to(std::back_inserter(htmlBuilder), FMT_COMPILE("color:{};"), fgHex);
-                fmt::format_to(std::back_inserter(htmlBuilder), FMT_COMPILE("background-color:{};"), bgHex);
-
-                if (attr.IsBold(isIntenseBold))
-                {
-                    htmlBuilder += "font-weight:bold;";
-                }
+                open += "font-style:italic;";
+            }
 
-                if (attr.IsItalic())
-                {
-                    htmlBuilder += "font-style:italic;";
-                }
+            if (isCrossedOut || isOverlined)
+            {
+                fmt::format_to(std::back_inserter(open),
+                               FMT_COMPILE("text-decoration:{} {} {};"),
+                               isCrossedOut ? "line-through" : "",
+                               isOverlined ? "overline" : "",
+                               fgHex);
+            }
+
+            if (isUnderlined)
+            {
+                // Since underline, overline and strikethrough use the same css property,
+                // we cannot apply different colors to them at the same time. However, we
+                // can achieve the desired result by creating a nested <span> and applying
+                // underline style and color to it.
+                open += "\"><SPAN STYLE=\"";
 
-                if (isCrossedOut || isOverlined)
+                switch (ulStyle)
                 {
-                    fmt::format_to(std::back_inserter(htmlBuilder),
-                                   FMT_COMPILE("text-decoration:{} {} {};"),
-                                   isCrossedOut ? "line-through" : "",
-                                   isOverlined ? "overline" : "",
-                                   fgHex);
+                case UnderlineStyle::NoUnderline:
+                    break;
+                case UnderlineStyle::DoublyUnderlined:
+                    fmt::format_to(std::back_inserter(open), FMT_COMPILE("text-decoration:underline double {};"), ulHex);
+                    break;
+                case UnderlineStyle::CurlyUnderlined:
+                    fmt::format_to(std::back_inserter(open), FMT_COMPILE("text-decoration:underline wavy {};"), ulHex);
+                    break;
+                case UnderlineStyle::DottedUnderlined:
+                    fmt::format_to(std::back_inserter(open), FMT_COMPILE("text-decoration:underline dotted {};"), ulHex);
+                    break;
+                case UnderlineStyle::DashedUnderlined:
+                    fmt::format_to(std::back_inserter(open), FMT_COMPILE("text-decoration:underline dashed {};"), ulHex);
+                    break;
+                case UnderlineStyle::SinglyUnderlined:
+                default:
+                    fmt::format_to(std::back_inserter(open), FMT_COMPILE("text-decoration:underline {};"), ulHex);
+                    break;
                 }
+            }
 
-                if (isUnderlined)
-                {
-                    // Since underline, overline and strikethrough use the same css property,
-                    // we cannot apply different colors to them at the same time. However, we
-                    // can achieve the desired result by creating a nested <span> and applying
-                    // underline style and color to it.
-                    htmlBuilder += "\"><SPAN STYLE=\"";
+            open += "\">";
 
-                    switch (ulStyle)
-                    {
-                    case UnderlineStyle::NoUnderline:
-                        break;
-                    case UnderlineStyle::DoublyUnderlined:
-                        fmt::format_to(std::back_inserter(htmlBuilder), FMT_COMPILE("text-decoration:underline double {};"), ulHex);
-                        break;
-                    case UnderlineStyle::CurlyUnderlined:
-                        fmt::format_to(std::back_inserter(htmlBuilder), FMT_COMPILE("text-decoration:underline wavy {};"), ulHex);
-                        break;
-                    case UnderlineStyle::DottedUnderlined:
-                        fmt::format_to(std::back_inserter(htmlBuilder), FMT_COMPILE("text-decoration:underline dotted {};"), ulHex);
-                        break;
-                    case UnderlineStyle::DashedUnderlined:
-                        fmt::format_to(std::back_inserter(htmlBuilder), FMT_COMPILE("text-decoration:underline dashed {};"), ulHex);
-                        break;
-                    case UnderlineStyle::SinglyUnderlined:
-                    default:
-                        fmt::format_to(std::back_inserter(htmlBuilder), FMT_COMPILE("text-decoration:underline {};"), ulHex);
-                        break;
-                    }
-                }
+            // close the nested span we created for underline
+            spanClose.emplace_back(isUnderlined ? "</SPAN></SPAN>" : "</SPAN>");
+        }
+
+        htmlBuilder += generateRowChunks(snapshot.rows.size(), [&](std::string& out, const size_t rowBeg, const size_t rowEnd) {
+            const auto lastRow = snapshot.rows.size() - 1;
+            auto runIdx = rowBeg == 0 ? 0 : til::at(snapshot.rows, rowBeg - 1).runEnd;
+            auto textBeg = runIdx == 0 ? 0 : til::at(snapshot.runs, runIdx - 1).textEnd;
+            std::string unescapedText;
 
-                htmlBuilder += "\">";
+            for (auto iRow = rowBeg; iRow < rowEnd; ++iRow)
+            {
+                const auto& row = til::at(snapshot.rows, iRow);
 
-                // text
-                std::string unescapedText;
-                THROW_IF_FAILED(til::u16u8(row.GetText(x, nextX), unescapedText));
-                for (const auto c : unescapedText)
+                for (; runIdx < row.runEnd; ++runIdx)
                 {
-                    switch (c)
+                    const auto& run = til::at(snapshot.runs, runIdx);
+
+                    out += til::at(spanOpen, run.style);
+
+                    // text
+                    THROW_IF_FAILED(til::u16u8(std::wstring_view{ snapshot.text }.substr(textBeg, run.textEnd - textBeg), unescapedText));
+                    for (const auto c : unescapedText)
                     {
-                    case '<':
-                        htmlBuilder += "&lt;";
-                        break;
-                    case '>':
-                        htmlBuilder += "&gt;";
-                        break;
-                    case '&':
-                        htmlBuilder += "&amp;";
-                        break;
-                    default:
-                        htmlBuilder += c;
+                        switch (c)
+                        {
+                        case '<':
+                            out += "&lt;";
+                            break;
+                        case '>':
+                            out += "&gt;";
+                            break;
+                        case '&':
+                            out += "&amp;";
+                            break;
+                        default:
+                            out += c;
+                        }
                     }
+
+                    out += til::at(spanClose, run.style);
+                    textBeg = run.textEnd;
                 }
 
-                if (isUnderlined)
+                // never add line break to the last row.
+                if (row.addLineBreak && iRow < lastRow)
                 {
-                    // close the nested span we created for underline
-                    htmlBuilder += "</SPAN>";
+                    out += "<BR>";
                 }
-
-                htmlBuilder += "</SPAN>";
-
-                // advance to next run of text
-                x = nextX;
             }
-
-            // never add line break to the last row.
-            if (addLineBreak && iRow < req.end.y)
-            {
-                htmlBuilder += "<BR>";
-            }
-        }
+        });
 
         htmlBuilder += "</DIV>";
 
@@ -2407,26 +2905,24 @@ std::string TextBuffer::GenHTML(const CopyRequest& req,
 }
 
 // Routine Description:
-// - Generates an RTF document from the selected region of the buffer
+// - Generates an RTF document from a snapshot of the buffer
 //   RTF 1.5 Spec: https://www.biblioscape.com/rtf15_spec.htm
 //   RTF 1.9.1 Spec: https://msopenspecs.azureedge.net/files/Archive_References/[MSFT-RTF].pdf
 // Arguments:
-// - req - the copy request having the bounds of the selected region and other related configuration flags.
+// - snapshot - the selected region of the buffer, as returned by CreateCopySnapshot().
 // - fontHeightPoints - the unscaled font height
 // - fontFaceName - the name of the font used
 // - backgroundColor - default background color for characters, also used in padding
 // - isIntenseBold - true if being intense is treated as being bold
-// - GetAttributeColors - function to get the colors of the text attributes as they're rendered
 // Return Value:
-// - string containing the generated RTF. Empty if the copy request is invalid.
-std::string TextBuffer::GenRTF(const CopyRequest& req,
+// - string containing the generated RTF. Empty if the snapshot is empty.
+std::string TextBuffer::GenRTF(const CopySnapshot& snapshot,
                                const int fontHeightPoints,
                                const std::wstring_view fontFaceName,
                                const COLORREF backgroundColor,
-                               const bool isIntenseBold,
-                               std::function<std::tuple<COLORREF, COLORREF, COLORREF>(const TextAttribute&)> GetAttributeColors) const noexcept
+                               const bool isIntenseBold) noexcept
 {
-    if (req.beg > req.end)
+    if (snapshot.rows.empty())
     {
         return {};
     }
@@ -2504,88 +3000,97 @@ std::string TextBuffer::GenRTF(const CopyRequest& req,
         // color. See: Spec 1.9.1, Pg. 23.
         fmt::format_to(std::back_inserter(contentBuilder), FMT_COMPILE("\\chshdng0\\chcbpat{}"), getColorTableIndex(backgroundColor));
 
-        for (auto iRow = req.beg.y; iRow <= req.end.y; ++iRow)
+        // The control words preceding each run only depend on its attributes, which is why we only need to generate
+        // them once per style. Since the styles are sorted by their first occurrence, this also results in the
+        // same color table order as if we had built it while iterating over the runs.
+        std::vector<std::string> groupOpen;
+        groupOpen.reserve(snapshot.styles.size());
+
+        for (const auto& [attr, fg, bg, ul] : snapshot.styles)
         {
-            const auto& row = GetRowByOffset(iRow);
-            const auto [rowBeg, rowEnd, addLineBreak] = _RowCopyHelper(req, iRow, row);
-            const auto rowBegU16 = gsl::narrow_cast<uint16_t>(rowBeg);
-            const auto rowEndU16 = gsl::narrow_cast<uint16_t>(rowEnd);
-            const auto runs = row.Attributes().slice(rowBegU16, rowEndU16).runs();
+            auto& open = groupOpen.emplace_back();
+            const auto fgIdx = getColorTableIndex(fg);
+            const auto bgIdx = getColorTableIndex(bg);
+            const auto ulIdx = getColorTableIndex(ul);
+            const auto ulStyle = attr.GetUnderlineStyle();
 
-            auto x = rowBegU16;
-            for (auto& [attr, length] : runs)
-            {
-                const auto nextX = gsl::narrow_cast<uint16_t>(x + length);
-                const auto [fg, bg, ul] = GetAttributeColors(attr);
-                const auto fgIdx = getColorTableIndex(fg);
-                const auto bgIdx = getColorTableIndex(bg);
-                const auto ulIdx = getColorTableIndex(ul);
-                const auto ulStyle = attr.GetUnderlineStyle();
+            // start an RTF group that can be closed later to restore the
+            // default attribute.
+            open += "{";
 
-                // start an RTF group that can be closed later to restore the
-                // default attribute.
-                contentBuilder += "{";
+            fmt::format_to(std::back_inserter(open), FMT_COMPILE("\\cf{}"), fgIdx);
+            fmt::format_to(std::back_inserter(open), FMT_COMPILE("\\chshdng0\\chcbpat{}"), bgIdx);
 
-                fmt::format_to(std::back_inserter(contentBuilder), FMT_COMPILE("\\cf{}"), fgIdx);
-                fmt::format_to(std::back_inserter(contentBuilder), FMT_COMPILE("\\chshdng0\\chcbpat{}"), bgIdx);
+            if (attr.IsBold(isIntenseBold))
+            {
+                open += "\\b";
+            }
 
-                if (attr.IsBold(isIntenseBold))
-                {
-                    contentBuilder += "\\b";
-                }
+            if (attr.IsItalic())
+            {
+                open += "\\i";
+            }
 
-                if (attr.IsItalic())
-                {
-                    contentBuilder += "\\i";
-                }
+            if (attr.IsCrossedOut())
+            {
+                open += "\\strike";
+            }
 
-                if (attr.IsCrossedOut())
-                {
-                    contentBuilder += "\\strike";
-                }
+            switch (ulStyle)
+            {
+            case UnderlineStyle::NoUnderline:
+                break;
+            case UnderlineStyle::DoublyUnderlined:
+                fmt::format_to(std::back_inserter(open), FMT_COMPILE("\\uldb\\ulc{}"), ulIdx);
+                break;
+            case UnderlineStyle::CurlyUnderlined:
+                fmt::format_to(std::back_inserter(open), FMT_COMPILE("\\ulwave\\ulc{}"), ulIdx);
+                break;
+            case UnderlineStyle::DottedUnderlined:
+                fmt::format_to(std::back_inserter(open), FMT_COMPILE("\\uld\\ulc{}"), ulIdx);
+                break;
+            case UnderlineStyle::DashedUnderlined:
+                fmt::format_to(std::back_inserter(open), FMT_COMPILE("\\uldash\\ulc{}"), ulIdx);
+                break;
+            case UnderlineStyle::SinglyUnderlined:
+            default:
+                fmt::format_to(std::back_inserter(open), FMT_COMPILE("\\ul\\ulc{}"), ulIdx);
+                break;
+            }
 
-                switch (ulStyle)
-                {
-                case UnderlineStyle::NoUnderline:
-                    break;
-                case UnderlineStyle::DoublyUnderlined:
-                    fmt::format_to(std::back_inserter(contentBuilder), FMT_COMPILE("\\uldb\\ulc{}"), ulIdx);
-                    break;
-                case UnderlineStyle::CurlyUnderlined:
-                    fmt::format_to(std::back_inserter(contentBuilder), FMT_COMPILE("\\ulwave\\ulc{}"), ulIdx);
-                    break;
-                case UnderlineStyle::DottedUnderlined:
-                    fmt::format_to(std::back_inserter(contentBuilder), FMT_COMPILE("\\uld\\ulc{}"), ulIdx);
-                    break;
-                case UnderlineStyle::DashedUnderlined:
-                    fmt::format_to(std::back_inserter(contentBuilder), FMT_COMPILE("\\uldash\\ulc{}"), ulIdx);
-                    break;
-                case UnderlineStyle::SinglyUnderlined:
-                default:
-                    fmt::format_to(std::back_inserter(contentBuilder), FMT_COMPILE("\\ul\\ulc{}"), ulIdx);
-                    break;
-                }
+            // RTF commands and the text data must be separated by a space.
+            // Otherwise, if the text begins with a space then that space will
+            // be interpreted as part of the last command, and will be lost.
+            open += " ";
+        }
 
-                // RTF commands and the text data must be separated by a space.
-                // Otherwise, if the text begins with a space then that space will
-                // be interpreted as part of the last command, and will be lost.
-                contentBuilder += " ";
+        contentBuilder += generateRowChunks(snapshot.rows.size(), [&](std::string& out, const size_t rowBeg, const size_t rowEnd) {
+            const auto lastRow = snapshot.rows.size() - 1;
+            auto runIdx = rowBeg == 0 ? 0 : til::at(snapshot.rows, rowBeg - 1).runEnd;
+            auto textBeg = runIdx == 0 ? 0 : til::at(snapshot.runs, runIdx - 1).textEnd;
 
-                const auto unescapedText = row.GetText(x, nextX); // including character at nextX
-                _AppendRTFText(contentBuilder, unescapedText);
+            for (auto iRow = rowBeg; iRow < rowEnd; ++iRow)
+            {
+                const auto& row = til::at(snapshot.rows, iRow);
 
-                contentBuilder += "}"; // close RTF group
+                for (; runIdx < row.runEnd; ++runIdx)
+                {
+                    const auto& run = til::at(snapshot.runs, runIdx);
 
-                // advance to next run of text
-                x = nextX;
-            }
+                    out += til::at(groupOpen, run.style);
+                    _AppendRTFText(out, std::wstring_view{ snapshot.text }.substr(textBeg, run.textEnd - textBeg));
+                    out += "}"; // close RTF group
 
-            // never add line break to the last row.
-            if (addLineBreak && iRow < req.end.y)
-            {
-                contentBuilder += "\\line";
+                    textBeg = run.textEnd;
+                }
+
+                // never add line break to the last row.
+                if (row.addLineBreak && iRow < lastRow)
+                {
+                    out += "\\line";
+                }
             }
-        }
+        });
 
         // add color table to the final RTF
         rtfBuilder += colorTableBuilder + "}";
@@ -3124,11 +3629,9 @@ void TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer, const View
                 ImageSlice::CopyRow(oldRow, newRow);
             }
 
-            const auto& oldAttr = oldRow.Attributes();
-            auto& newAttr = newRow.Attributes();
+            const auto oldAttr = oldRow.Attributes();
             const auto attributes = oldAttr.slice(gsl::narrow_cast<uint16_t>(oldX), oldAttr.size());
-            newAttr.replace(gsl::narrow_cast<uint16_t>(newX), newAttr.size(), attributes);
-            newAttr.resize_trailing_extent(newWidthU16);
+            newRow.ReplaceAttributes(newX, newWidthU16, attributes);
 
             if (oldY == oldCursorPos.y && oldCursorPos.x >= oldX)
             {
@@ -3184,9 +3687,7 @@ void TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer, const View
     {
         auto& oldRow = oldBuffer.GetRowByOffset(oldY);
         auto& newRow = newBuffer.GetMutableRowByOffset(newY);
-        auto& newAttr = newRow.Attributes();
-        newAttr = oldRow.Attributes();
-        newAttr.resize_trailing_extent(newWidthU16);
+        newRow.ReplaceAttributes(0, newWidthU16, oldRow.Attributes());
     }
 
     // Since we didn't use IncrementCircularBuffer() we need to compute the proper
@@ -3194,7 +3695,7 @@ void TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer, const View
     // We need to do the same for newCursorPos.y for basically the same reason.
     if (newY > newHeight)
     {
-        newBuffer._firstRow = newY % newHeight;
+        newBuffer._SetFirstRowIndex(newY % newHeight);
         // _firstRow maps from API coordinates that always start at 0,0 in the top left corner of the
         // terminal's scrollback, to the underlying buffer Y coordinate via `(y + _firstRow) % height`.
         // Here, we need to un-map the `newCursorPos.y` from the underlying Y coordinate to the API coordinate
@@ -3462,12 +3963,8 @@ void TextBuffer::ClearMarksInRange(
     for (auto y = top; y <= bottom; y++)
     {
         auto& row = GetMutableRowByOffset(y);
-        auto& runs = row.Attributes().runs();
         row.SetScrollbarData(std::nullopt);
-        for (auto& [attr, length] : runs)
-        {
-            attr.SetMarkAttributes(MarkKind::None);
-        }
+        row.SetMarkAttributes(MarkKind::None);
     }
 }
 void TextBuffer::ClearAllMarks()
@@ -3777,8 +4274,5 @@ void TextBuffer::SetScrollbarData(ScrollbarData mark, til::CoordType y)
 void TextBuffer::ManuallyMarkRowAsPrompt(til::CoordType y)
 {
     auto& row = GetMutableRowByOffset(y);
-    for (auto& [attr, len] : row.Attributes().runs())
-    {
-        attr.SetMarkAttributes(MarkKind::Prompt);
-    }
+    row.SetMarkAttributes(MarkKind::Prompt);
 }
@@ -109,6 +109,7 @@ public:
     void Replace(til::CoordType row, const TextAttribute& attributes, RowWriteState& state);
     void Insert(til::CoordType row, const TextAttribute& attributes, RowWriteState& state);
     void FillRect(const til::rect& rect, const std::wstring_view& fill, const TextAttribute& attributes);
+    void TransformAttributes(const til::rect& rect, const std::function<void(TextAttribute&)>& func);
 
     OutputCellIterator Write(const OutputCellIterator givenIt);
 
@@ -135,7 +136,9 @@ public:
     const Microsoft::Console::Types::Viewport GetSize() const noexcept;
 
     void ScrollRows(const til::CoordType firstRow, const til::CoordType size, const til::CoordType delta);
+    void RotateRows(const til::CoordType firstRow, const til::CoordType size, const til::CoordType delta);
     void CopyRow(const til::CoordType srcRow, const til::CoordType dstRow, TextBuffer& dstBuffer) const;
+    std::unique_ptr<TextBuffer> CreateSnapshot() const;
 
     til::CoordType TotalRowCount() const noexcept;
 
@@ -288,6 +291,52 @@ public:
                        const bool isIntenseBold,
                        std::function<std::tuple<COLORREF, COLORREF, COLORREF>(const TextAttribute&)> GetAttributeColors) const noexcept;
 
+    // An immutable copy of the text and attributes selected by a CopyRequest, with the attribute colors already resolved.
+    // It allows generating the HTML and RTF clipboard formats on demand without holding the console lock.
+    struct CopySnapshot
+    {
+        struct Style
+        {
+            TextAttribute attr;
+            COLORREF fg = 0;
+            COLORREF bg = 0;
+            COLORREF ul = 0;
+        };
+        struct Run
+        {
+            // Index into `styles`.
+            uint32_t style = 0;
+            // The end of the run's text in `text`. It starts where the previous run ends.
+            size_t textEnd = 0;
+        };
+        struct Row
+        {
+            // The end of the row's runs in `runs`. They start where the previous row's runs end.
+            size_t runEnd = 0;
+            bool addLineBreak = false;
+        };
+
+        std::wstring text;
+        // Every distinct attribute is only stored (and its colors resolved) once.
+        std::vector<Style> styles;
+        std::vector<Run> runs;
+        std::vector<Row> rows;
+    };
+
+    CopySnapshot CreateCopySnapshot(const CopyRequest& req, const std::function<std::tuple<COLORREF, COLORREF, COLORREF>(const TextAttribute&)>& GetAttributeColors) const;
+
+    static std::string GenHTML(const CopySnapshot& snapshot,
+                               const int fontHeightPoints,
+                               const std::wstring_view fontFaceName,
+                               const COLORREF backgroundColor,
+                               const bool isIntenseBold) noexcept;
+
+    static std::string GenRTF(const CopySnapshot& snapshot,
+                              const int fontHeightPoints,
+                              const std::wstring_view fontFaceName,
+                              const COLORREF backgroundColor,
+                              const bool isIntenseBold) noexcept;
+
     void SerializeToPath(const wchar_t* destination) const;
 
     struct PositionInformation
@@ -319,21 +368,30 @@ private:
     void _reserve(til::size screenBufferSize, const TextAttribute& defaultAttributes);
     void _commit(const std::byte* row);
     void _decommit() noexcept;
-    void _construct(const std::byte* until) noexcept;
+    void _construct(const std::byte* until);
     void _destroy() const noexcept;
+    void _compactAttributes();
+    void _rotateRows(til::CoordType beg, til::CoordType end, til::CoordType count);
     ROW& _getRowByOffsetDirect(size_t offset);
+    size_t _getRowOffset(til::CoordType y) const noexcept;
     ROW& _getRow(til::CoordType y) const;
     til::CoordType _estimateOffsetOfLastCommittedRow() const noexcept;
 
+    class DelimiterClassLookup;
+
     void _SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept;
     void _ExpandTextRow(til::inclusive_rect& selectionRow) const;
-    DelimiterClass _GetDelimiterClassAt(const til::point pos, const std::wstring_view wordDelimiters) const;
-    til::point _GetDelimiterClassRunStart(til::point pos, const std::wstring_view wordDelimiters) const;
-    til::point _GetDelimiterClassRunEnd(til::point pos, const std::wstring_view wordDelimiters) const;
-    til::point _GetWordStartForAccessibility(const til::point target, const std::wstring_view wordDelimiters) const;
-    til::point _GetWordStartForSelection(const til::point target, const std::wstring_view wordDelimiters) const;
-    til::point _GetWordEndForAccessibility(const til::point target, const std::wstring_view wordDelimiters, const til::point limit) const;
-    til::point _GetWordEndForSelection(const til::point target, const std::wstring_view wordDelimiters) const;
+    DelimiterClass _GetDelimiterClassAt(const til::point pos, DelimiterClassLookup& lookup) const;
+    til::CoordType _GetDelimiterClassRunStartInRow(const til::point pos, DelimiterClassLookup& lookup) const;
+    til::CoordType _GetDelimiterClassRunEndInRow(const til::point pos, DelimiterClassLookup& lookup) const;
+    til::point _GetDelimiterClassRunStart(til::point pos, DelimiterClassLookup& lookup) const;
+    til::point _GetDelimiterClassRunEnd(til::point pos, DelimiterClassLookup& lookup) const;
+    void _SkipCellsBackward(til::point& pos, const bool regular, DelimiterClassLookup& lookup) const;
+    void _SkipCellsForward(til::point& pos, const til::point stop, const bool regular, DelimiterClassLookup& lookup) const;
+    til::point _GetWordStartForAccessibility(const til::point target, DelimiterClassLookup& lookup) const;
+    til::point _GetWordStartForSelection(const til::point target, DelimiterClassLookup& lookup) const;
+    til::point _GetWordEndForAccessibility(const til::point target, DelimiterClassLookup& lookup, const til::point limit) const;
+    til::point _GetWordEndForSelection(const til::point target, DelimiterClassLookup& lookup) const;
     void _PruneHyperlinks();
 
     std::wstring _commandForRow(const til::CoordType rowOffset, const til::CoordType bottomInclusive, const bool clipAtCursor = false) const;
@@ -395,6 +453,9 @@ private:
     // Before TextBuffer was made to use virtual memory it initialized the entire memory arena with the initial
     // attributes right away. To ensure it continues to work the way it used to, this stores these initial attributes.
     TextAttribute _initialAttributes;
+    // Interns the attributes of all ROWs in this buffer. It's heap allocated, because ROWs store a pointer
+    // to it and ResizeTraditional() moves the ROWs of a temporary TextBuffer into this one.
+    std::unique_ptr<TextAttributeTable> _attrTable = std::make_unique<TextAttributeTable>();
     // ROW ---------------+--+--+
     // (padding)          |  |  v _bufferOffsetChars
     // ROW::_charsBuffer  |  |
@@ -404,6 +465,10 @@ private:
     size_t _bufferRowStride = 0;
     size_t _bufferOffsetChars = 0;
     size_t _bufferOffsetCharOffsets = 0;
+    // Maps each position in the circular buffer to the arena slot of the ROW it shows. Scrolling a range
+    // of rows rotates this table instead of the ROWs, because a ROW must stay in the slot its text
+    // storage lives in. Uncommitted slots are never rotated and thus always map to themselves.
+    std::vector<uint16_t> _rowSlots;
     // The width of the buffer in columns.
     uint16_t _width = 0;
     // The height of the buffer in rows, excluding the scratchpad row.
@@ -411,6 +476,10 @@ private:
 
     TextAttribute _currentAttributes;
     til::CoordType _firstRow = 0; // indexes top row (not necessarily 0)
+    // All rows past this one are known to be blank. It's an upper bound maintained by GetMutableRowByOffset()
+    // and IncrementCircularBuffer(), which allows GetLastNonSpaceCharacter() to skip scanning the empty
+    // tail of the buffer. Whenever _firstRow is changed arbitrarily, it's reset to _height - 1.
+    til::CoordType _textWatermark = -1;
     uint64_t _lastMutationId = 0;
 
     Cursor _cursor;
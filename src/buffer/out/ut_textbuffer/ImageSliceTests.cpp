@@ -0,0 +1,161 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../ImageSlice.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace
+{
+    constexpr til::size cellSize{ 10, 20 };
+    constexpr til::CoordType columns = 100;
+    constexpr auto pixelWidth = columns * cellSize.width;
+
+    std::array<RGBQUAD, 256> makeColors(const uint8_t seed)
+    {
+        std::array<RGBQUAD, 256> colors{};
+        for (size_t i = 0; i < colors.size(); i++)
+        {
+            const auto v = gsl::narrow_cast<BYTE>(i);
+            til::at(colors, i) = { v, gsl::narrow_cast<BYTE>(v ^ seed), gsl::narrow_cast<BYTE>(255 - v), 255 };
+        }
+        return colors;
+    }
+
+    // Fills the source image with up to colorCount distinct colors.
+    std::vector<ImageSlice::IndexedPixel> makeImage(const size_t colorCount)
+    {
+        std::vector<ImageSlice::IndexedPixel> image(gsl::narrow_cast<size_t>(pixelWidth * cellSize.height));
+        for (size_t i = 0; i < image.size(); i++)
+        {
+            auto& pixel = til::at(image, i);
+            pixel.transparent = (i % 7) == 0;
+            pixel.colorIndex = gsl::narrow_cast<uint8_t>(i % colorCount);
+        }
+        return image;
+    }
+
+    uint32_t toUint(const RGBQUAD quad) noexcept
+    {
+        return std::bit_cast<uint32_t>(quad);
+    }
+
+    std::vector<RGBQUAD> expand(const ImageSlice& slice)
+    {
+        std::vector<RGBQUAD> pixels(slice.PixelCount());
+        slice.ExpandPixels(pixels);
+        return pixels;
+    }
+
+    void verifyPixels(const ImageSlice& slice, const std::vector<ImageSlice::IndexedPixel>& image, const std::array<RGBQUAD, 256>& colors)
+    {
+        const auto pixels = expand(slice);
+        VERIFY_ARE_EQUAL(image.size(), pixels.size());
+        for (size_t i = 0; i < pixels.size(); i++)
+        {
+            const auto& src = til::at(image, i);
+            const auto expected = src.transparent ? 0u : toUint(til::at(colors, src.colorIndex));
+            if (expected != toUint(til::at(pixels, i)))
+            {
+                VERIFY_FAIL(NoThrowString().Format(L"pixel %zu: expected %08x, got %08x", i, expected, toUint(til::at(pixels, i))));
+            }
+        }
+    }
+}
+
+class ImageSliceTests
+{
+    TEST_CLASS(ImageSliceTests);
+
+    TEST_METHOD(WriteAndExpand);
+    TEST_METHOD(IndexedMemoryUsage);
+    TEST_METHOD(FallbackToPixels);
+    TEST_METHOD(CopyOnWrite);
+    TEST_METHOD(Deduplicate);
+};
+
+void ImageSliceTests::WriteAndExpand()
+{
+    const auto colors = makeColors(0x55);
+    const auto image = makeImage(200);
+
+    ImageSlice slice{ cellSize };
+    slice.WritePixels(0, columns, image.data(), pixelWidth, pixelWidth, cellSize.height, colors);
+    verifyPixels(slice, image, colors);
+
+    // Writing the same image with a different set of colors must remap
+    // the existing palette entries rather than corrupt the old ones.
+    const auto otherColors = makeColors(0xaa);
+    slice.WritePixels(0, columns, image.data(), pixelWidth, pixelWidth, cellSize.height, otherColors);
+    verifyPixels(slice, image, otherColors);
+}
+
+void ImageSliceTests::IndexedMemoryUsage()
+{
+    const auto colors = makeColors(0x55);
+    const auto image = makeImage(200);
+
+    ImageSlice slice{ cellSize };
+    slice.WritePixels(0, columns, image.data(), pixelWidth, pixelWidth, cellSize.height, colors);
+
+    // 1 byte per pixel plus the palette, instead of 4 bytes per pixel.
+    const auto rgbaUsage = slice.PixelCount() * sizeof(RGBQUAD);
+    VERIFY_IS_LESS_THAN(slice.MemoryUsage(), rgbaUsage / 3);
+}
+
+void ImageSliceTests::FallbackToPixels()
+{
+    const auto colors = makeColors(0x55);
+    const auto image = makeImage(256);
+
+    // A palette can only hold 255 colors (index 0 is transparent), so this must
+    // convert the slice to plain pixels without losing any of the colors.
+    ImageSlice slice{ cellSize };
+    slice.WritePixels(0, columns, image.data(), pixelWidth, pixelWidth, cellSize.height, colors);
+    verifyPixels(slice, image, colors);
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(slice.MemoryUsage(), slice.PixelCount() * sizeof(RGBQUAD));
+}
+
+void ImageSliceTests::CopyOnWrite()
+{
+    const auto colors = makeColors(0x55);
+    const auto image = makeImage(16);
+
+    ImageSlice original{ cellSize };
+    original.WritePixels(0, columns, image.data(), pixelWidth, pixelWidth, cellSize.height, colors);
+
+    ImageSlice copy{ original };
+    VERIFY_IS_TRUE(copy.SharesStorageWith(original));
+
+    std::vector<ImageSlice::IndexedPixel> overwrite(image.size(), ImageSlice::IndexedPixel{ false, 3 });
+    copy.WritePixels(0, columns, overwrite.data(), pixelWidth, pixelWidth, cellSize.height, colors);
+    VERIFY_IS_FALSE(copy.SharesStorageWith(original));
+
+    verifyPixels(original, image, colors);
+    verifyPixels(copy, overwrite, colors);
+}
+
+void ImageSliceTests::Deduplicate()
+{
+    const auto colors = makeColors(0x55);
+    const auto image = makeImage(16);
+
+    ImageSlice a{ cellSize };
+    ImageSlice b{ cellSize };
+    a.WritePixels(0, columns, image.data(), pixelWidth, pixelWidth, cellSize.height, colors);
+    b.WritePixels(0, columns, image.data(), pixelWidth, pixelWidth, cellSize.height, colors);
+    VERIFY_IS_FALSE(b.SharesStorageWith(a));
+    VERIFY_IS_TRUE(b.Deduplicate(a));
+    VERIFY_IS_TRUE(b.SharesStorageWith(a));
+
+    ImageSlice c{ cellSize };
+    c.WritePixels(0, columns / 2, image.data(), pixelWidth, pixelWidth, cellSize.height, colors);
+    VERIFY_IS_FALSE(c.Deduplicate(a));
+    VERIFY_IS_FALSE(c.SharesStorageWith(a));
+}
@@ -61,4 +61,32 @@ class UTextAdapterTests
         actual = buffer.SearchText(L"ネコ", SearchFlag::None);
         VERIFY_ARE_EQUAL(expected, actual);
     }
+
+    TEST_METHOD(Snapshot)
+    {
+        DummyRenderer renderer;
+        TextBuffer buffer{ til::size{ 24, 4 }, TextAttribute{}, 0, false, &renderer };
+
+        RowWriteState state{
+            .text = L"abc 𝒶𝒷𝒸 abc ネコちゃん",
+        };
+        buffer.Replace(2, TextAttribute{}, state);
+        VERIFY_IS_TRUE(state.text.empty());
+
+        const auto snapshot = buffer.CreateSnapshot();
+        const auto expected = buffer.SearchText(L"abc", SearchFlag::None).value();
+        VERIFY_ARE_EQUAL(static_cast<size_t>(2), expected.size());
+        VERIFY_ARE_EQUAL(buffer.GetLastMutationId(), snapshot->GetLastMutationId());
+        VERIFY_ARE_EQUAL(expected, snapshot->SearchText(L"abc", SearchFlag::None).value());
+        VERIFY_ARE_EQUAL(buffer.SearchText(L"ネコ", SearchFlag::None).value(), snapshot->SearchText(L"ネコ", SearchFlag::None).value());
+
+        // The snapshot must not be affected by modifications of the original buffer.
+        state = RowWriteState{
+            .text = L"xyz",
+        };
+        buffer.Replace(2, TextAttribute{}, state);
+        VERIFY_ARE_NOT_EQUAL(buffer.GetLastMutationId(), snapshot->GetLastMutationId());
+        VERIFY_ARE_EQUAL(static_cast<size_t>(1), buffer.SearchText(L"abc", SearchFlag::None).value().size());
+        VERIFY_ARE_EQUAL(expected, snapshot->SearchText(L"abc", SearchFlag::None).value());
+    }
 };
@@ -1188,15 +1188,15 @@ namespace winrt::TerminalApp::implementation
         else if (_currentMode == CommandPaletteMode::TabSearchMode || _currentMode == CommandPaletteMode::ActionMode || _currentMode == CommandPaletteMode::CommandlineMode)
         {
             auto pattern = std::make_shared<fzf::matcher::Pattern>(fzf::matcher::ParsePattern(searchText));
+            const std::vector<winrt::TerminalApp::FilteredCommand> commands{ begin(commandsToFilter), end(commandsToFilter) };
 
-            for (const auto& action : commandsToFilter)
-            {
-                // Update filter for all commands
-                // This will modify the highlighting but will also lead to re-computation of weight (and consequently sorting).
-                // Pay attention that it already updates the highlighting in the UI
-                auto impl = winrt::get_self<implementation::FilteredCommand>(action);
-                impl->UpdateFilter(pattern);
+            // Update filter for all commands
+            // This will modify the highlighting but will also lead to re-computation of weight (and consequently sorting).
+            // Pay attention that it already updates the highlighting in the UI
+            FilteredCommand::UpdateFilters(commands, pattern);
 
+            for (const auto& action : commands)
+            {
                 // if there is active search we skip commands with 0 weight
                 if (searchText.empty() || action.Weight() > 0)
                 {
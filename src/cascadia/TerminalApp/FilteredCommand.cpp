@@ -30,10 +30,12 @@ namespace winrt::TerminalApp::implementation
             const auto property{ e.PropertyName() };
             if (property == L"Name")
             {
+                _nameHaystack.reset();
                 _update();
             }
             else if (property == L"Subtitle")
             {
+                _subtitleHaystack.reset();
                 _update();
                 PropertyChanged.raise(*this, winrt::Windows::UI::Xaml::Data::PropertyChangedEventArgs{ L"HasSubtitle" });
             }
@@ -51,45 +53,103 @@ namespace winrt::TerminalApp::implementation
         }
     }
 
+    // Method Description:
+    // - Same as calling UpdateFilter() on each of the commands, but it matches all of them
+    //   at once. This allows it to spread the work across multiple threads if there are many.
+    void FilteredCommand::UpdateFilters(const std::vector<winrt::TerminalApp::FilteredCommand>& commands, const std::shared_ptr<fzf::matcher::Pattern>& pattern)
+    {
+        std::vector<FilteredCommand*> changed;
+        std::vector<const fzf::matcher::Haystack*> haystacks;
+        changed.reserve(commands.size());
+        haystacks.reserve(commands.size() * 2);
+
+        for (const auto& command : commands)
+        {
+            const auto impl = winrt::get_self<FilteredCommand>(command);
+            if (pattern != impl->_pattern)
+            {
+                // Preparing the haystacks calls into our Item, which must happen on this thread.
+                impl->_pattern = pattern;
+                impl->_prepareHaystacks();
+                changed.emplace_back(impl);
+                haystacks.emplace_back(&*impl->_nameHaystack);
+                haystacks.emplace_back(&*impl->_subtitleHaystack);
+            }
+        }
+
+        std::vector<std::optional<fzf::matcher::MatchResult>> results;
+        if (pattern)
+        {
+            results = fzf::matcher::MatchAll(haystacks, *pattern);
+        }
+        else
+        {
+            results.resize(haystacks.size());
+        }
+
+        for (size_t i = 0; i < changed.size(); ++i)
+        {
+            til::at(changed, i)->_apply(til::at(results, i * 2), til::at(results, i * 2 + 1));
+        }
+    }
+
     bool FilteredCommand::HasSubtitle()
     {
         return !_Item.Subtitle().empty();
     }
 
-    static std::tuple<std::vector<winrt::TerminalApp::HighlightedRun>, int32_t> _matchedSegmentsAndWeight(const std::shared_ptr<fzf::matcher::Pattern>& pattern, const winrt::hstring& haystack)
+    static std::tuple<std::vector<winrt::TerminalApp::HighlightedRun>, int32_t> _matchedSegmentsAndWeight(const std::optional<fzf::matcher::MatchResult>& match)
     {
         std::vector<winrt::TerminalApp::HighlightedRun> segments;
         int32_t weight = 0;
 
-        if (pattern && !pattern->terms.empty())
+        if (match)
         {
-            if (auto match = fzf::matcher::Match(haystack, *pattern.get()); match)
-            {
-                auto& matchResult = *match;
-                weight = matchResult.Score;
-                segments.resize(matchResult.Runs.size());
-                std::transform(matchResult.Runs.begin(), matchResult.Runs.end(), segments.begin(), [](auto&& run) -> winrt::TerminalApp::HighlightedRun {
-                    return { run.Start, run.End };
-                });
-            }
+            auto& matchResult = *match;
+            weight = matchResult.Score;
+            segments.resize(matchResult.Runs.size());
+            std::transform(matchResult.Runs.begin(), matchResult.Runs.end(), segments.begin(), [](auto&& run) -> winrt::TerminalApp::HighlightedRun {
+                return { run.Start, run.End };
+            });
         }
         return { std::move(segments), weight };
     }
 
+    // Converting the Name and Subtitle into a form suitable for matching is about as expensive
+    // as the matching itself. Since they rarely change, we only do it once, instead of on every key press.
+    void FilteredCommand::_prepareHaystacks()
+    {
+        if (!_nameHaystack)
+        {
+            _nameHaystack = fzf::matcher::PrepareHaystack(_Item.Name());
+        }
+        if (!_subtitleHaystack)
+        {
+            _subtitleHaystack = fzf::matcher::PrepareHaystack(_Item.Subtitle());
+        }
+    }
+
     void FilteredCommand::_update()
     {
-        auto itemName = _Item.Name();
-        auto [segments, weight] = _matchedSegmentsAndWeight(_pattern, itemName);
-        decltype(segments) subtitleSegments;
+        std::optional<fzf::matcher::MatchResult> nameMatch;
+        std::optional<fzf::matcher::MatchResult> subtitleMatch;
 
-        if (HasSubtitle())
+        if (_pattern && !_pattern->terms.empty())
         {
-            auto itemSubtitle = _Item.Subtitle();
-            int32_t subtitleWeight = 0;
-            std::tie(subtitleSegments, subtitleWeight) = _matchedSegmentsAndWeight(_pattern, itemSubtitle);
-            weight = std::max(weight, subtitleWeight);
+            _prepareHaystacks();
+            nameMatch = fzf::matcher::Match(*_nameHaystack, *_pattern);
+            subtitleMatch = fzf::matcher::Match(*_subtitleHaystack, *_pattern);
         }
 
+        _apply(nameMatch, subtitleMatch);
+    }
+
+    void FilteredCommand::_apply(const std::optional<fzf::matcher::MatchResult>& nameMatch, const std::optional<fzf::matcher::MatchResult>& subtitleMatch)
+    {
+        auto [segments, weight] = _matchedSegmentsAndWeight(nameMatch);
+        auto [subtitleSegments, subtitleWeight] = _matchedSegmentsAndWeight(subtitleMatch);
+        weight = std::max(weight, subtitleWeight);
+
         if (segments.empty())
         {
             NameHighlights(nullptr);
@@ -21,6 +21,7 @@ namespace winrt::TerminalApp::implementation
         FilteredCommand(const winrt::TerminalApp::IPaletteItem& item);
 
         void UpdateFilter(std::shared_ptr<fzf::matcher::Pattern> pattern);
+        static void UpdateFilters(const std::vector<winrt::TerminalApp::FilteredCommand>& commands, const std::shared_ptr<fzf::matcher::Pattern>& pattern);
 
         static int Compare(const winrt::TerminalApp::FilteredCommand& first, const winrt::TerminalApp::FilteredCommand& second);
 
@@ -34,7 +35,12 @@ namespace winrt::TerminalApp::implementation
 
     private:
         std::shared_ptr<fzf::matcher::Pattern> _pattern;
+        // Our Item's Name and Subtitle, prepared for matching. Reset when they change.
+        std::optional<fzf::matcher::Haystack> _nameHaystack;
+        std::optional<fzf::matcher::Haystack> _subtitleHaystack;
+        void _prepareHaystacks();
         void _update();
+        void _apply(const std::optional<fzf::matcher::MatchResult>& nameMatch, const std::optional<fzf::matcher::MatchResult>& subtitleMatch);
         Windows::UI::Xaml::Data::INotifyPropertyChanged::PropertyChanged_revoker _itemChangedRevoker;
 
         friend class TerminalAppLocalTests::FilteredCommandTests;
@@ -62,6 +62,8 @@ namespace winrt
 namespace clipboard
 {
     static SRWLOCK lock = SRWLOCK_INIT;
+    // Incremented for every copy, so that a copy which finishes late doesn't overwrite a newer one.
+    static std::atomic<uint64_t> generation{ 0 };
 
     struct ClipboardHandle
     {
@@ -3290,13 +3292,28 @@ namespace winrt::TerminalApp::implementation
         }
     }
 
-    void TerminalPage::_copyToClipboard(const IInspectable, const WriteToClipboardEventArgs args) const
+    safe_void_coroutine TerminalPage::_copyToClipboard(const IInspectable, const WriteToClipboardEventArgs args) const
     {
-        if (const auto clipboard = clipboard::open(_hostingHwnd.value_or(nullptr)))
+        const auto hwnd = _hostingHwnd.value_or(nullptr);
+        const auto generation = ++clipboard::generation;
+
+        // Html() and Rtf() generate their format on first access, which may take a while for large
+        // selections. Only copies that asked for them leave the UI thread. Plain text is written right away.
+        if (args.HasHtml() || args.HasRtf())
         {
-            const auto plain = args.Plain();
-            const auto html = args.Html();
-            const auto rtf = args.Rtf();
+            co_await winrt::resume_background();
+        }
+
+        const auto plain = args.Plain();
+        const auto html = args.Html();
+        const auto rtf = args.Rtf();
+
+        if (const auto clipboard = clipboard::open(hwnd))
+        {
+            if (generation != clipboard::generation.load())
+            {
+                co_return;
+            }
 
             clipboard::write(
                 { plain.data(), plain.size() },
@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "fzf.h"
 
+#include <til/parallel.h>
+
 #undef CharLower
 #undef CharUpper
 
@@ -47,16 +49,26 @@ static void foldStringUtf32(std::vector<UChar32>& str)
     }
 }
 
-static size_t trySkip(const std::vector<UChar32>& input, const UChar32 searchChar, size_t startIndex)
+static constexpr uint64_t asciiMaskOf(const UChar32 cp) noexcept
+{
+    return cp < 0x80 ? uint64_t{ 1 } << (cp & 63) : 0;
+}
+
+static uint64_t asciiMaskOf(const std::vector<UChar32>& str) noexcept
 {
-    for (size_t i = startIndex; i < input.size(); ++i)
+    uint64_t mask = 0;
+    for (const auto cp : str)
     {
-        if (input[i] == searchChar)
-        {
-            return i;
-        }
+        mask |= asciiMaskOf(cp);
     }
-    return npos;
+    return mask;
+}
+
+static size_t trySkip(const std::vector<UChar32>& input, const UChar32 searchChar, size_t startIndex)
+{
+    // std::find() is vectorized by our STL for 32-bit elements, which makes this a lot faster than a plain loop.
+    const auto it = std::find(input.begin() + startIndex, input.end(), searchChar);
+    return it == input.end() ? npos : static_cast<size_t>(it - input.begin());
 }
 
 // Unlike the equivalent in fzf, this one does more than Unicode.
@@ -116,15 +128,32 @@ static CharClass classOf(UChar32 ch)
     return s_charClassLut[u_charType(ch)];
 }
 
-static int32_t fzfFuzzyMatchV2(const std::vector<UChar32>& text, const std::vector<UChar32>& pattern, std::vector<size_t>* pos)
+// Haystack::info stores the CharClass in the lower bits and this flag in the top one.
+static constexpr uint8_t SurrogatePairFlag = 0x80;
+
+// The buffers used by fzfFuzzyMatchV2(). They're reused across calls, because allocating them
+// for every haystack is a significant cost when filtering thousands of them on every key press.
+// They're thread_local, so that MatchAll() can use them from any number of threads.
+struct Scratch
+{
+    std::vector<int16_t> initialScores;
+    std::vector<int16_t> consecutiveScores;
+    std::vector<size_t> firstOccurrenceOfEachChar;
+    std::vector<int16_t> bonuses;
+    std::vector<int16_t> scoreMatrix;
+    std::vector<int16_t> consecutiveCharMatrix;
+};
+
+static thread_local Scratch s_scratch;
+
+static int32_t fzfFuzzyMatchV2(const Haystack& haystack, const std::vector<UChar32>& pattern, std::vector<size_t>* pos)
 {
     if (pattern.size() == 0)
     {
         return 0;
     }
 
-    auto foldedText = text;
-    foldStringUtf32(foldedText);
+    const auto& foldedText = haystack.folded;
 
     size_t firstIndexOf = asciiFuzzyIndex(foldedText, pattern);
     if (firstIndexOf == npos)
@@ -132,10 +161,15 @@ static int32_t fzfFuzzyMatchV2(const std::vector<UChar32>& text, const std::vect
         return 0;
     }
 
-    auto initialScores = std::vector<int16_t>(text.size());
-    auto consecutiveScores = std::vector<int16_t>(text.size());
-    auto firstOccurrenceOfEachChar = std::vector<size_t>(pattern.size());
-    auto bonusesSpan = std::vector<int16_t>(text.size());
+    auto& scratch = s_scratch;
+    auto& initialScores = scratch.initialScores;
+    auto& consecutiveScores = scratch.consecutiveScores;
+    auto& firstOccurrenceOfEachChar = scratch.firstOccurrenceOfEachChar;
+    auto& bonusesSpan = scratch.bonuses;
+    initialScores.assign(foldedText.size(), 0);
+    consecutiveScores.assign(foldedText.size(), 0);
+    firstOccurrenceOfEachChar.assign(pattern.size(), 0);
+    bonusesSpan.assign(foldedText.size(), 0);
 
     int16_t maxScore = 0;
     size_t maxScorePos = 0;
@@ -151,12 +185,12 @@ static int32_t fzfFuzzyMatchV2(const std::vector<UChar32>& text, const std::vect
     auto lowerTextSlice = lowerText.subspan(firstIndexOf);
     auto initialScoresSlice = std::span(initialScores).subspan(firstIndexOf);
     auto consecutiveScoresSlice = std::span(consecutiveScores).subspan(firstIndexOf);
-    auto bonusesSlice = std::span(bonusesSpan).subspan(firstIndexOf, text.size() - firstIndexOf);
+    auto bonusesSlice = std::span(bonusesSpan).subspan(firstIndexOf, foldedText.size() - firstIndexOf);
 
     for (size_t i = 0; i < lowerTextSlice.size(); i++)
     {
         const auto currentChar = lowerTextSlice[i];
-        const auto currentClass = classOf(text[i + firstIndexOf]);
+        const auto currentClass = static_cast<CharClass>(haystack.info[i + firstIndexOf] & ~SurrogatePairFlag);
         const auto bonus = calculateBonus(previousClass, currentClass);
         bonusesSlice[i] = bonus;
         previousClass = currentClass;
@@ -219,11 +253,13 @@ static int32_t fzfFuzzyMatchV2(const std::vector<UChar32>& text, const std::vect
     const auto rows = pattern.size();
     auto consecutiveCharMatrixSize = width * pattern.size();
 
-    std::vector<int16_t> scoreMatrix(width * rows);
+    auto& scoreMatrix = scratch.scoreMatrix;
+    scoreMatrix.assign(width * rows, 0);
     std::copy_n(initialScores.begin() + firstOccurrenceOfFirstChar, width, scoreMatrix.begin());
     std::span scoreSpan(scoreMatrix);
 
-    std::vector<int16_t> consecutiveCharMatrix(width * rows);
+    auto& consecutiveCharMatrix = scratch.consecutiveCharMatrix;
+    consecutiveCharMatrix.assign(width * rows, 0);
     std::copy_n(consecutiveScores.begin() + firstOccurrenceOfFirstChar, width, consecutiveCharMatrix.begin());
     std::span consecutiveCharMatrixSpan(consecutiveCharMatrix);
 
@@ -364,6 +400,28 @@ Pattern fzf::matcher::ParsePattern(const std::wstring_view patternStr)
     return patObj;
 }
 
+Haystack fzf::matcher::PrepareHaystack(const std::wstring_view text)
+{
+    Haystack haystack;
+    haystack.folded = utf16ToUtf32(text);
+    haystack.info.resize(haystack.folded.size());
+
+    for (size_t i = 0; i < haystack.folded.size(); ++i)
+    {
+        auto& cp = haystack.folded[i];
+        auto info = static_cast<uint8_t>(classOf(cp));
+        if (U16_LENGTH(cp) == 2)
+        {
+            info |= SurrogatePairFlag;
+        }
+        haystack.info[i] = info;
+        cp = u_foldCase(cp, U_FOLD_CASE_DEFAULT);
+        haystack.asciiMask |= asciiMaskOf(cp);
+    }
+
+    return haystack;
+}
+
 std::optional<MatchResult> fzf::matcher::Match(std::wstring_view text, const Pattern& pattern)
 {
     if (pattern.terms.empty())
@@ -371,7 +429,25 @@ std::optional<MatchResult> fzf::matcher::Match(std::wstring_view text, const Pat
         return MatchResult{};
     }
 
-    const auto textCodePoints = utf16ToUtf32(text);
+    return Match(PrepareHaystack(text), pattern);
+}
+
+std::optional<MatchResult> fzf::matcher::Match(const Haystack& haystack, const Pattern& pattern)
+{
+    if (pattern.terms.empty())
+    {
+        return MatchResult{};
+    }
+
+    // Most haystacks don't contain all of the (ASCII) characters in the pattern.
+    // Checking that upfront is a lot cheaper than running the matcher on them.
+    for (const auto& term : pattern.terms)
+    {
+        if (const auto mask = asciiMaskOf(term); (haystack.asciiMask & mask) != mask)
+        {
+            return std::nullopt;
+        }
+    }
 
     int32_t totalScore = 0;
     std::vector<size_t> allUtf32Pos;
@@ -379,7 +455,7 @@ std::optional<MatchResult> fzf::matcher::Match(std::wstring_view text, const Pat
     for (const auto& term : pattern.terms)
     {
         std::vector<size_t> termPos;
-        auto score = fzfFuzzyMatchV2(textCodePoints, term, &termPos);
+        auto score = fzfFuzzyMatchV2(haystack, term, &termPos);
         if (score <= 0)
         {
             return std::nullopt;
@@ -399,10 +475,9 @@ std::optional<MatchResult> fzf::matcher::Match(std::wstring_view text, const Pat
     bool inRun = false;
     size_t runStart = 0;
 
-    for (size_t cpIndex = 0; cpIndex < textCodePoints.size(); cpIndex++)
+    for (size_t cpIndex = 0; cpIndex < haystack.folded.size(); cpIndex++)
     {
-        const auto cp = textCodePoints[cpIndex];
-        const size_t cpWidth = U16_LENGTH(cp);
+        const size_t cpWidth = (haystack.info[cpIndex] & SurrogatePairFlag) ? 2 : 1;
 
         const bool isMatch = (nextCodePointPos < allUtf32Pos.size() && allUtf32Pos[nextCodePointPos] == cpIndex);
         if (isMatch)
@@ -430,3 +505,25 @@ std::optional<MatchResult> fzf::matcher::Match(std::wstring_view text, const Pat
 
     return MatchResult{ totalScore, std::move(runs) };
 }
+
+std::vector<std::optional<MatchResult>> fzf::matcher::MatchAll(const std::span<const Haystack* const> haystacks, const Pattern& pattern)
+{
+    // Spawning a thread costs about as much as matching a few hundred haystacks.
+    static constexpr size_t minHaystacksPerChunk = 1024;
+    const auto count = haystacks.size();
+    const auto chunkCount = til::parallel_chunk_count(count, minHaystacksPerChunk);
+    const auto chunkBeg = [&](const size_t chunk) noexcept {
+        return count * chunk / chunkCount;
+    };
+
+    std::vector<std::optional<MatchResult>> results(count);
+
+    til::parallel_for(chunkCount, [&](const size_t chunk) {
+        for (auto i = chunkBeg(chunk), end = chunkBeg(chunk + 1); i < end; ++i)
+        {
+            results[i] = Match(*haystacks[i], pattern);
+        }
+    });
+
+    return results;
+}
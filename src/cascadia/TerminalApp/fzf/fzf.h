@@ -22,6 +22,22 @@ namespace fzf::matcher
         std::vector<std::vector<UChar32>> terms;
     };
 
+    // A haystack that was converted to UTF-32, case folded and classified ahead of time,
+    // so that it can be matched against any number of patterns without redoing that work.
+    struct Haystack
+    {
+        std::vector<UChar32> folded;
+        // The character class of each code point and whether it's a surrogate pair in UTF-16.
+        std::vector<uint8_t> info;
+        // Bit (ch % 64) is set for each ASCII character in `folded`.
+        // This allows us to reject most haystacks without looking at them.
+        uint64_t asciiMask = 0;
+    };
+
     Pattern ParsePattern(std::wstring_view patternStr);
+    Haystack PrepareHaystack(std::wstring_view text);
     std::optional<MatchResult> Match(std::wstring_view text, const Pattern& pattern);
+    std::optional<MatchResult> Match(const Haystack& haystack, const Pattern& pattern);
+    // Returns the results of Match() for each haystack. Large numbers of haystacks are split up across multiple threads.
+    std::vector<std::optional<MatchResult>> MatchAll(std::span<const Haystack* const> haystacks, const Pattern& pattern);
 }
@@ -32,6 +32,8 @@ using namespace winrt::Windows::Graphics::Display;
 using namespace winrt::Windows::System;
 using namespace winrt::Windows::ApplicationModel::DataTransfer;
 
+using LatencyStage = ::Microsoft::Console::Render::LatencyTrace::Stage;
+
 namespace winrt::Microsoft::Terminal::Control::implementation
 {
     static winrt::Microsoft::Terminal::Core::OptionalColor OptionalFromColor(const til::color& c) noexcept
@@ -150,6 +152,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             // Now create the renderer and initialize the render thread.
             auto& renderSettings = _terminal->GetRenderSettings();
             _renderer = std::make_unique<::Microsoft::Console::Render::Renderer>(renderSettings, _terminal.get());
+            _renderer->GetLatencyTrace().SetEnabled(!wil::TryGetEnvironmentVariableW<std::wstring>(L"WT_LATENCY_TRACE_DIR").empty());
 
             _renderer->SetBackgroundColorChangedCallback([this]() { _rendererBackgroundColorChanged(); });
             _renderer->SetFrameColorChangedCallback([this]() { _rendererTabColorChanged(); });
@@ -465,6 +468,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         if (_connection)
         {
             _connection.WriteInput(winrt_wstring_to_array_view(wstr));
+            _renderer->GetLatencyTrace().Mark(LatencyStage::InputWritten);
         }
     }
 
@@ -523,6 +527,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _handleControlC();
         }
 
+        // Keys that don't produce any input merely restart the sample with the next one. See LatencyTrace.
+        _renderer->GetLatencyTrace().Mark(LatencyStage::KeyEvent);
         TerminalInput::OutputType out;
         {
             const auto lock = _terminal->LockForReading();
@@ -647,6 +653,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return true;
         }
 
+        _renderer->GetLatencyTrace().Mark(LatencyStage::KeyEvent);
         TerminalInput::OutputType out;
         {
             const auto lock = _terminal->LockForWriting();
@@ -1331,7 +1338,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                                bool withControlSequences,
                                                const CopyFormat formats)
     {
-        ::Microsoft::Terminal::Core::Terminal::TextCopyData payload;
+        auto payload = std::make_shared<::Microsoft::Terminal::Core::Terminal::TextCopyData>();
         {
             const auto lock = _terminal->LockForWriting();
 
@@ -1346,15 +1353,28 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
             // extract text from buffer
             // RetrieveSelectedTextFromBuffer will lock while it's reading
-            payload = _terminal->RetrieveSelectedTextFromBuffer(singleLine, withControlSequences, copyHtml, copyRtf);
+            *payload = _terminal->RetrieveSelectedTextFromBuffer(singleLine, withControlSequences, copyHtml, copyRtf);
+        }
+
+        // The HTML and RTF formats are only generated once the handler asks for them.
+        // At that point we don't hold the terminal lock anymore.
+        std::function<std::string()> html;
+        std::function<std::string()> rtf;
+        if (payload->html)
+        {
+            html = [payload]() { return payload->GenHTML(); };
+        }
+        if (payload->rtf)
+        {
+            rtf = [payload]() { return payload->GenRTF(); };
         }
 
         WriteToClipboard.raise(
             *this,
             winrt::make<WriteToClipboardEventArgs>(
-                winrt::hstring{ payload.plainText },
-                std::move(payload.html),
-                std::move(payload.rtf)));
+                winrt::hstring{ payload->plainText },
+                std::move(html),
+                std::move(rtf)));
         return true;
     }
 
@@ -1725,12 +1745,32 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // - <none>
     SearchResults ControlCore::Search(SearchRequest request)
     {
-        const auto lock = _terminal->LockForWriting();
-
         SearchFlag flags{};
         WI_SetFlagIf(flags, SearchFlag::CaseInsensitive, !request.CaseSensitive);
         WI_SetFlagIf(flags, SearchFlag::RegularExpression, request.RegularExpression);
-        const auto searchInvalidated = _searcher.IsStale(*_terminal.get(), request.Text, flags);
+
+        // Searching through a large scrollback (especially with a regex) can take a while.
+        // We search through a snapshot of the buffer instead, so that we don't block
+        // the output processing in the meantime. Copying the rows is much cheaper.
+        std::unique_ptr<TextBuffer> snapshot;
+        {
+            const auto lock = _terminal->LockForReading();
+            if (_searcher.IsStale(*_terminal.get(), request.Text, flags))
+            {
+                snapshot = _terminal->GetTextBuffer().CreateSnapshot();
+            }
+        }
+
+        std::optional<std::vector<til::point_span>> snapshotResults;
+        if (snapshot)
+        {
+            snapshotResults = snapshot->SearchText(request.Text, flags);
+        }
+
+        const auto lock = _terminal->LockForWriting();
+        // If the buffer changed while we were searching, the results are
+        // stale, but the next search (e.g. on output idle) will catch up.
+        const auto searchInvalidated = snapshot || _searcher.IsStale(*_terminal.get(), request.Text, flags);
 
         if (searchInvalidated || !request.ResetOnly)
         {
@@ -1745,7 +1785,14 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             if (searchInvalidated)
             {
                 oldResults = _searcher.ExtractResults();
-                _searcher.Reset(*_terminal.get(), request.Text, flags, !request.GoForward);
+                if (snapshot)
+                {
+                    _searcher.Reset(*_terminal.get(), request.Text, flags, !request.GoForward, std::move(snapshotResults), snapshot->GetLastMutationId());
+                }
+                else
+                {
+                    _searcher.Reset(*_terminal.get(), request.Text, flags, !request.GoForward);
+                }
                 _terminal->SetSearchHighlights(_searcher.Results());
             }
 
@@ -1801,11 +1848,37 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
             // Ensure Close() doesn't hang, waiting for MidiAudio to finish playing an hour long song.
             _midiAudio.BeginSkip();
+
+            _writeLatencyTrace();
         }
 
         _closeConnection();
     }
 
+    // Method Description:
+    // - If the WT_LATENCY_TRACE_DIR environment variable is set, this writes the latency
+    //   histograms of this control (see LatencyTrace) into a new file in that directory.
+    void ControlCore::_writeLatencyTrace() const
+    {
+        try
+        {
+            const auto dir = wil::TryGetEnvironmentVariableW<std::wstring>(L"WT_LATENCY_TRACE_DIR");
+            if (dir.empty())
+            {
+                return;
+            }
+
+            const auto path = fmt::format(FMT_COMPILE(L"{}\\latency-{}-{:x}.txt"), dir, GetCurrentProcessId(), reinterpret_cast<uintptr_t>(this));
+            const auto text = til::u16u8(_renderer->GetLatencyTrace().Format());
+
+            const wil::unique_handle file{ CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+            THROW_LAST_ERROR_IF(!file);
+            DWORD written = 0;
+            THROW_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), text.data(), gsl::narrow<DWORD>(text.size()), &written, nullptr));
+        }
+        CATCH_LOG();
+    }
+
     void ControlCore::PersistToPath(const wchar_t* path) const
     {
         const auto lock = _terminal->LockForReading();
@@ -2196,9 +2269,16 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         try
         {
+            // The connection calls us right after reading the output from the PTY.
+            auto& latencyTrace = _renderer->GetLatencyTrace();
+            latencyTrace.Mark(LatencyStage::OutputRead);
+
             {
                 const auto lock = _terminal->LockForWriting();
                 _terminal->Write(hstr);
+                // The renderer marks PaintStarted while holding this lock. Marking this stage
+                // before releasing it ensures that the next frame is the one that shows this output.
+                latencyTrace.Mark(LatencyStage::OutputParsed);
             }
 
             if (!_pendingResponses.empty())
@@ -2417,6 +2497,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // - <none>
     void ControlCore::WindowVisibilityChanged(const bool showOrHide)
     {
+        // There's no point in painting frames that nobody can see.
+        _renderer->SetVisibilityHint(showOrHide);
+
         if (_initializedTerminal.load(std::memory_order_relaxed))
         {
             // show is true, hide is false
@@ -2439,6 +2522,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // - This is related to work done for GH#2988.
     void ControlCore::GotFocus()
     {
+        _renderer->SetFocusHint(true);
+
         const auto shared = _shared.lock_shared();
         if (shared->focusChanged)
         {
@@ -2449,6 +2534,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // See GotFocus.
     void ControlCore::LostFocus()
     {
+        _renderer->SetFocusHint(false);
+
         const auto shared = _shared.lock_shared();
         if (shared->focusChanged)
         {
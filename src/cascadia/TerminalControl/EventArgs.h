@@ -66,11 +66,32 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         {
         }
 
+        // The formatted representations are only generated on first access,
+        // so that handlers which don't need them don't pay for them.
+        WriteToClipboardEventArgs(winrt::hstring&& plain, std::function<std::string()>&& html, std::function<std::string()>&& rtf) :
+            _plain(std::move(plain)),
+            _htmlGenerator(std::move(html)),
+            _rtfGenerator(std::move(rtf))
+        {
+        }
+
         winrt::hstring Plain() const noexcept { return _plain; }
-        winrt::com_array<uint8_t> Html() noexcept { return _cast(_html); }
-        winrt::com_array<uint8_t> Rtf() noexcept { return _cast(_rtf); }
+        winrt::com_array<uint8_t> Html() { return _cast(_generate(_html, _htmlGenerator)); }
+        winrt::com_array<uint8_t> Rtf() { return _cast(_generate(_rtf, _rtfGenerator)); }
+        bool HasHtml() const noexcept { return _htmlGenerator || !_html.empty(); }
+        bool HasRtf() const noexcept { return _rtfGenerator || !_rtf.empty(); }
 
     private:
+        static const std::string& _generate(std::string& str, std::function<std::string()>& generator)
+        {
+            if (generator)
+            {
+                str = generator();
+                generator = nullptr;
+            }
+            return str;
+        }
+
         static winrt::com_array<uint8_t> _cast(const std::string& str)
         {
             const auto beg = reinterpret_cast<const uint8_t*>(str.data());
@@ -81,6 +102,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         winrt::hstring _plain;
         std::string _html;
         std::string _rtf;
+        std::function<std::string()> _htmlGenerator;
+        std::function<std::string()> _rtfGenerator;
     };
 
     struct PasteFromClipboardEventArgs : public PasteFromClipboardEventArgsT<PasteFromClipboardEventArgs>
@@ -190,7 +190,7 @@ try
                     if (publicTerminal->_terminal->IsSelectionActive())
                     {
                         const auto bufferData = publicTerminal->_terminal->RetrieveSelectedTextFromBuffer(false, false, true, true);
-                        LOG_IF_FAILED(publicTerminal->_CopyTextToSystemClipboard(bufferData.plainText, bufferData.html, bufferData.rtf));
+                        LOG_IF_FAILED(publicTerminal->_CopyTextToSystemClipboard(bufferData.plainText, bufferData.GenHTML(), bufferData.GenRTF()));
                         publicTerminal->_ClearSelection();
                         return 0;
                     }
@@ -10,6 +10,7 @@
 #include "../../types/inc/colorTable.hpp"
 #include "../../buffer/out/search.h"
 #include "../../buffer/out/UTextAdapter.h"
+#include "tracing.hpp"
 
 #include <til/hash.h>
 #include <til/regex.h>
@@ -964,16 +965,97 @@ void Terminal::_assertUnlocked() const noexcept
 #endif
 }
 
+void Terminal::InstrumentedLock::lock() noexcept
+{
+    _lock.lock();
+
+    if (_lock.recursion_depth() == 1)
+    {
+        _acquired = std::chrono::steady_clock::now();
+        _reader = false;
+    }
+}
+
+void Terminal::InstrumentedLock::unlock() noexcept
+{
+    if (_lock.recursion_depth() == 1)
+    {
+        const auto held = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _acquired);
+        auto& entry = _reader ? _statistics.readers : _statistics.writers;
+        entry.count++;
+        entry.total += held;
+        entry.max = std::max(entry.max, held);
+
+        if (TraceLoggingProviderEnabled(g_hCTerminalCoreProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
+        {
+            TraceLoggingWrite(
+                g_hCTerminalCoreProvider,
+                "LockHeld",
+                TraceLoggingDescription("The terminal lock was released"),
+                TraceLoggingBool(_reader, "reader"),
+                TraceLoggingInt64(held.count(), "durationUs"),
+                TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+        }
+    }
+
+    _lock.unlock();
+}
+
+// Attributes the current (outermost) acquisition of the lock to a reader.
+// Recursive acquisitions by readers while a writer holds the lock are counted towards the writer.
+void Terminal::InstrumentedLock::mark_reader() noexcept
+{
+    if (_lock.recursion_depth() == 1)
+    {
+        _reader = true;
+    }
+}
+
+uint32_t Terminal::InstrumentedLock::is_locked() const noexcept
+{
+    return _lock.is_locked();
+}
+
+Terminal::InstrumentedLock::Suspension Terminal::InstrumentedLock::suspend() noexcept
+{
+    return Suspension{ *this };
+}
+
+Terminal::InstrumentedLock::Suspension::Suspension(InstrumentedLock& lock) noexcept :
+    _saved{ lock.is_locked() ? &lock : nullptr, std::chrono::steady_clock::now() - lock._acquired, lock._reader },
+    _suspension{ lock._lock.suspend() }
+{
+}
+
+Terminal::InstrumentedLock::Suspension::SavedAcquisition::~SavedAcquisition()
+{
+    if (lock)
+    {
+        // Continue measuring where we left off, as if the lock had never been suspended.
+        lock->_acquired = std::chrono::steady_clock::now() - held;
+        lock->_reader = reader;
+    }
+}
+
+const Terminal::LockHoldStatistics& Terminal::InstrumentedLock::statistics() const noexcept
+{
+    return _statistics;
+}
+
 // Method Description:
 // - Acquire a read lock on the terminal.
 // Return Value:
 // - a shared_lock which can be used to unlock the terminal. The shared_lock
 //      will release this lock when it's destructed.
-[[nodiscard]] std::unique_lock<til::recursive_ticket_lock> Terminal::LockForReading() const noexcept
+[[nodiscard]] std::unique_lock<Terminal::InstrumentedLock> Terminal::LockForReading() const noexcept
 {
-#pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'recursive_ticket_lock>()' which may throw exceptions (f.6).
+#pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'InstrumentedLock>()' which may throw exceptions (f.6).
+#pragma warning(suppress : 26492) // Don't use const_cast to cast away const or volatile
+    std::unique_lock lock{ const_cast<InstrumentedLock&>(_readWriteLock) };
 #pragma warning(suppress : 26492) // Don't use const_cast to cast away const or volatile
-    return std::unique_lock{ const_cast<til::recursive_ticket_lock&>(_readWriteLock) };
+    const_cast<InstrumentedLock&>(_readWriteLock).mark_reader();
+    return lock;
 }
 
 // Method Description:
@@ -981,17 +1063,26 @@ void Terminal::_assertUnlocked() const noexcept
 // Return Value:
 // - a unique_lock which can be used to unlock the terminal. The unique_lock
 //      will release this lock when it's destructed.
-[[nodiscard]] std::unique_lock<til::recursive_ticket_lock> Terminal::LockForWriting() noexcept
+[[nodiscard]] std::unique_lock<Terminal::InstrumentedLock> Terminal::LockForWriting() noexcept
 {
-#pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'recursive_ticket_lock>()' which may throw exceptions (f.6).
+#pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'InstrumentedLock>()' which may throw exceptions (f.6).
     return std::unique_lock{ _readWriteLock };
 }
 
+// Method Description:
+// - Returns how long the terminal lock has been held for so far, by readers and writers.
+//   The caller must hold the lock. The current acquisition isn't included yet.
+Terminal::LockHoldStatistics Terminal::GetLockStatistics() const noexcept
+{
+    _assertLocked();
+    return _readWriteLock.statistics();
+}
+
 // Method Description:
 // - Get a reference to the terminal's read/write lock.
 // Return Value:
 // - a ticket_lock which can be used to manually lock or unlock the terminal.
-til::recursive_ticket_lock_suspension Terminal::SuspendLock() noexcept
+Terminal::InstrumentedLock::Suspension Terminal::SuspendLock() noexcept
 {
     return _readWriteLock.suspend();
 }
@@ -104,11 +104,76 @@ public:
     // Write comes from the PTY and goes to our parser to be stored in the output buffer
     void Write(std::wstring_view stringView);
 
+    // How long the terminal lock was held for, split up by readers (LockForReading, LockConsole)
+    // and writers (LockForWriting). Only the outermost acquisition of the recursive lock is counted.
+    struct LockHoldStatistics
+    {
+        struct Entry
+        {
+            uint64_t count = 0;
+            std::chrono::microseconds total{};
+            std::chrono::microseconds max{};
+        };
+
+        Entry readers;
+        Entry writers;
+    };
+
+    // A recursive_ticket_lock that measures for how long it's being held.
+    // Since readers and writers currently still exclude each other,
+    // this helps finding readers that stall the output processing.
+    class InstrumentedLock
+    {
+    public:
+        // Suspends the lock for as long as it exists. See til::recursive_ticket_lock_suspension.
+        // The time during which the lock is suspended isn't counted as being held.
+        class Suspension
+        {
+        public:
+            explicit Suspension(InstrumentedLock& lock) noexcept;
+
+            Suspension(const Suspension&) = delete;
+            Suspension& operator=(const Suspension&) = delete;
+            Suspension(Suspension&&) = delete;
+            Suspension& operator=(Suspension&&) = delete;
+
+        private:
+            // Other threads may take the lock while it's suspended and overwrite the measurement
+            // of the current acquisition. This saves it and restores it once the lock was reacquired,
+            // which is why it must be declared before (and thus get destroyed after) _suspension.
+            struct SavedAcquisition
+            {
+                InstrumentedLock* lock = nullptr;
+                std::chrono::steady_clock::duration held{};
+                bool reader = false;
+
+                ~SavedAcquisition();
+            };
+
+            SavedAcquisition _saved;
+            til::recursive_ticket_lock_suspension _suspension;
+        };
+
+        void lock() noexcept;
+        void unlock() noexcept;
+        void mark_reader() noexcept;
+        uint32_t is_locked() const noexcept;
+        Suspension suspend() noexcept;
+        const LockHoldStatistics& statistics() const noexcept;
+
+    private:
+        til::recursive_ticket_lock _lock;
+        std::chrono::steady_clock::time_point _acquired{};
+        bool _reader = false;
+        LockHoldStatistics _statistics;
+    };
+
     void _assertLocked() const noexcept;
     void _assertUnlocked() const noexcept;
-    [[nodiscard]] std::unique_lock<til::recursive_ticket_lock> LockForReading() const noexcept;
-    [[nodiscard]] std::unique_lock<til::recursive_ticket_lock> LockForWriting() noexcept;
-    til::recursive_ticket_lock_suspension SuspendLock() noexcept;
+    [[nodiscard]] std::unique_lock<InstrumentedLock> LockForReading() const noexcept;
+    [[nodiscard]] std::unique_lock<InstrumentedLock> LockForWriting() noexcept;
+    InstrumentedLock::Suspension SuspendLock() noexcept;
+    LockHoldStatistics GetLockStatistics() const noexcept;
 
     til::CoordType GetBufferHeight() const noexcept;
 
@@ -296,8 +361,20 @@ public:
     struct TextCopyData
     {
         std::wstring plainText;
-        std::string html;
-        std::string rtf;
+
+        // Generating HTML and RTF is expensive for large selections. Instead of doing that
+        // while holding the terminal lock, we only copy the selected text and attributes
+        // and defer the formatting until GenHTML()/GenRTF() are called.
+        std::shared_ptr<const TextBuffer::CopySnapshot> snapshot;
+        std::wstring fontName;
+        int fontSizePt = 0;
+        COLORREF bgColor = 0;
+        bool isIntenseBold = false;
+        bool html = false;
+        bool rtf = false;
+
+        std::string GenHTML() const;
+        std::string GenRTF() const;
     };
 
     void MultiClickSelection(const til::point viewportPos, SelectionExpansion expansionMode);
@@ -337,7 +414,7 @@ private:
     //
     // But we can abuse the fact that the surrounding members rarely change and are huge
     // (std::function is like 64 bytes) to create some natural padding without wasting space.
-    til::recursive_ticket_lock _readWriteLock;
+    InstrumentedLock _readWriteLock;
 
     std::function<void(const int, const int, const int)> _pfnScrollPositionChanged;
     std::function<void()> _pfnTaskbarProgressChanged;
@@ -941,7 +941,8 @@ void Terminal::ClearSelection()
 // - html: also get text in HTML format
 // - rtf: also get text in RTF format
 // Return Value:
-// - Plain and formatted selected text from buffer. Empty string represents no data for that format.
+// - Plain text and a snapshot of the selection from which the formatted text can be generated.
+//   Unlike this function, TextCopyData::GenHTML/GenRTF don't need to be called under the terminal lock.
 // - If extended to multiple lines, each line is separated by \r\n
 Terminal::TextCopyData Terminal::RetrieveSelectedTextFromBuffer(const bool singleLine, const bool withControlSequences, const bool html, const bool rtf) const
 {
@@ -972,24 +973,46 @@ Terminal::TextCopyData Terminal::RetrieveSelectedTextFromBuffer(const bool singl
 
     if (html || rtf)
     {
-        const auto bgColor = _renderSettings.GetAttributeColors({}).second;
-        const auto isIntenseBold = _renderSettings.GetRenderMode(::Microsoft::Console::Render::RenderSettings::Mode::IntenseIsBold);
-        const auto fontSizePt = _fontInfo.GetUnscaledSize().height; // already in points
-        const auto& fontName = _fontInfo.GetFaceName();
-
-        if (html)
-        {
-            data.html = textBuffer.GenHTML(req, fontSizePt, fontName, bgColor, isIntenseBold, GetAttributeColors);
-        }
-        if (rtf)
-        {
-            data.rtf = textBuffer.GenRTF(req, fontSizePt, fontName, bgColor, isIntenseBold, GetAttributeColors);
-        }
+        data.snapshot = std::make_shared<const TextBuffer::CopySnapshot>(textBuffer.CreateCopySnapshot(req, GetAttributeColors));
+        data.fontName = _fontInfo.GetFaceName();
+        data.fontSizePt = _fontInfo.GetUnscaledSize().height; // already in points
+        data.bgColor = _renderSettings.GetAttributeColors({}).second;
+        data.isIntenseBold = _renderSettings.GetRenderMode(::Microsoft::Console::Render::RenderSettings::Mode::IntenseIsBold);
+        data.html = html;
+        data.rtf = rtf;
     }
 
     return data;
 }
 
+// Method Description:
+// - Generates the HTML representation of the selection captured by RetrieveSelectedTextFromBuffer.
+//   This doesn't access the terminal and may be called without holding its lock.
+// Return Value:
+// - The HTML or an empty string if HTML wasn't requested.
+std::string Terminal::TextCopyData::GenHTML() const
+{
+    if (!html || !snapshot)
+    {
+        return {};
+    }
+    return TextBuffer::GenHTML(*snapshot, fontSizePt, fontName, bgColor, isIntenseBold);
+}
+
+// Method Description:
+// - Generates the RTF representation of the selection captured by RetrieveSelectedTextFromBuffer.
+//   This doesn't access the terminal and may be called without holding its lock.
+// Return Value:
+// - The RTF or an empty string if RTF wasn't requested.
+std::string Terminal::TextCopyData::GenRTF() const
+{
+    if (!rtf || !snapshot)
+    {
+        return {};
+    }
+    return TextBuffer::GenRTF(*snapshot, fontSizePt, fontName, bgColor, isIntenseBold);
+}
+
 // Method Description:
 // - convert viewport position to the corresponding location on the buffer
 // Arguments:
@@ -237,6 +237,7 @@ const std::wstring_view Terminal::GetConsoleTitle() const noexcept
 void Terminal::LockConsole() noexcept
 {
     _readWriteLock.lock();
+    _readWriteLock.mark_reader();
 }
 
 // Method Description:
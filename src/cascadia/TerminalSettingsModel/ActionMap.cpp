@@ -61,6 +61,57 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         return hasher.finalize();
     }
 
+    // Method Description:
+    // - Adds the given key chord to the table, unless it already contains it.
+    // Arguments:
+    // - keys: the key chord to add
+    // - cmd: the command the key chord resolves to, or nullptr if it's explicitly unbound
+    void KeyChordDispatchTable::Insert(const Control::KeyChord& keys, const Model::Command& cmd)
+    {
+        if (const auto [slot, inserted] = _slots.insert(_pack(keys)); inserted)
+        {
+            slot->index = gsl::narrow<uint32_t>(_commands.size());
+            _commands.emplace_back(cmd);
+        }
+    }
+
+    // Method Description:
+    // - Same as ActionMap::_GetActionByKeyChordInternal()
+    // Return Value:
+    // - the command with the given key chord
+    // - nullptr if the key chord is explicitly unbound
+    // - nullopt if it is not bound
+    std::optional<Model::Command> KeyChordDispatchTable::Lookup(const Control::KeyChord& keys) const
+    {
+        if (const auto slot = _slots.lookup(_pack(keys)))
+        {
+            return til::at(_commands, slot->index);
+        }
+        return std::nullopt;
+    }
+
+    size_t KeyChordDispatchTable::Size() const noexcept
+    {
+        return _commands.size();
+    }
+
+    // Packs a KeyChord into an integer that is equal for two KeyChords, if and only if KeyChord::Equals() is true.
+    // Like KeyChord::Hash() it contains either the Vkey or the ScanCode, with the latter being tagged by bit 32.
+    // As such the result is never 0, because a KeyChord without a Vkey is tagged.
+    uint64_t KeyChordDispatchTable::_pack(const Control::KeyChord& keys)
+    {
+        auto packed = static_cast<uint64_t>(static_cast<uint32_t>(keys.Modifiers())) << 33;
+        if (const auto vkey = keys.Vkey())
+        {
+            packed |= static_cast<uint32_t>(vkey);
+        }
+        else
+        {
+            packed |= (uint64_t{ 1 } << 32) | static_cast<uint32_t>(keys.ScanCode());
+        }
+        return packed;
+    }
+
     winrt::hstring ActionArgFactory::GetNameForAction(Model::ShortcutAction action)
     {
         return GetNameForAction(action, GetLibraryResourceLoader().ResourceContext());
@@ -346,6 +397,10 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         {
             _KeyMap.insert_or_assign(key, cmdID);
         }
+
+        // This is the last step of loading the settings, after which all layers are complete.
+        // Build the _KeyChordDispatchTable now, so that the first key press doesn't have to.
+        _RefreshKeyBindingCaches();
     }
 
     bool ActionMap::FixupsAppliedDuringLoad() const
@@ -646,6 +701,32 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         _ResolvedKeyToActionMapCache = single_threaded_map(std::move(resolvedKeyToActionMap));
         _GlobalHotkeysCache = single_threaded_map(std::move(globalHotkeys));
         _AllCommandsCache = single_threaded_vector(std::move(allCommandsVector));
+
+        _RefreshKeyChordDispatchTable();
+    }
+
+    // Method Description:
+    // - Rebuilds the _KeyChordDispatchTable from the cumulative caches, which must be up to date.
+    void ActionMap::_RefreshKeyChordDispatchTable()
+    {
+        KeyChordDispatchTable table;
+
+        for (const auto& [keys, cmdID] : _CumulativeKeyToActionMapCache)
+        {
+            // Same as _GetActionByKeyChordInternal(): An empty ID, or one
+            // without a command, means that the keys are explicitly unbound.
+            Model::Command cmd{ nullptr };
+            if (!cmdID.empty())
+            {
+                if (const auto idCmdPair = _CumulativeIDToActionMapCache.find(cmdID); idCmdPair != _CumulativeIDToActionMapCache.end())
+                {
+                    cmd = idCmdPair->second;
+                }
+            }
+            table.Insert(keys, cmd);
+        }
+
+        _KeyChordDispatchTable.emplace(std::move(table));
     }
 
     com_ptr<ActionMap> ActionMap::Copy() const
@@ -704,6 +785,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         _NameMapCache = nullptr;
         _GlobalHotkeysCache = nullptr;
         _ResolvedKeyToActionMapCache = nullptr;
+        _KeyChordDispatchTable.reset();
 
         // Handle nested commands
         const auto cmdImpl{ get_self<Command>(cmd) };
@@ -885,6 +967,11 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
     // - nullopt if it is not bound
     std::optional<Model::Command> ActionMap::_GetActionByKeyChordInternal(const Control::KeyChord& keys) const
     {
+        if (_KeyChordDispatchTable)
+        {
+            return _KeyChordDispatchTable->Lookup(keys);
+        }
+
         if (const auto actionIDOptional = _GetActionIdByKeyChordInternal(keys))
         {
             if (!actionIDOptional->empty())
@@ -972,6 +1059,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
             _KeyMap.insert_or_assign(oldKeys, L"");
         }
 
+        _KeyChordDispatchTable.reset();
         return true;
     }
 
@@ -983,6 +1071,9 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
     // - <none>
     void ActionMap::DeleteKeyBinding(const KeyChord& keys)
     {
+        // GetActionByKeyChord() below must not use the outdated table.
+        _KeyChordDispatchTable.reset();
+
         if (auto keyPair = _KeyMap.find(keys); keyPair != _KeyMap.end())
         {
             // this keychord is bound in our layer, delete it
@@ -20,6 +20,8 @@ Author(s):
 #include "IInheritable.h"
 #include "Command.h"
 
+#include <til/flat_set.h>
+
 // fwdecl unittest classes
 namespace SettingsModelUnitTests
 {
@@ -48,6 +50,60 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         }
     };
 
+    // An immutable snapshot of the key chords of all layers of an ActionMap and the commands they resolve to.
+    // _GetActionByKeyChordInternal() walks all layers and calls KeyChord::Hash/Equals over the ABI for each of them,
+    // for every key press, before the key is sent to the shell. Looking up a key chord in this table is a single
+    // probe into an open-addressing hash table in the common case instead.
+    class KeyChordDispatchTable
+    {
+    public:
+        void Insert(const Control::KeyChord& keys, const Model::Command& cmd);
+        std::optional<Model::Command> Lookup(const Control::KeyChord& keys) const;
+        size_t Size() const noexcept;
+
+    private:
+        struct Slot
+        {
+            // 0 marks an empty slot. See _pack().
+            uint64_t keys = 0;
+            uint32_t index = 0;
+        };
+
+        struct SlotHashTrait
+        {
+            static bool occupied(const Slot& slot) noexcept
+            {
+                return slot.keys != 0;
+            }
+
+            static constexpr size_t hash(const uint64_t keys) noexcept
+            {
+                return til::flat_set_hash_integer(gsl::narrow_cast<size_t>(keys ^ (keys >> 32)));
+            }
+
+            static size_t hash(const Slot& slot) noexcept
+            {
+                return hash(slot.keys);
+            }
+
+            static bool equals(const Slot& slot, const uint64_t keys) noexcept
+            {
+                return slot.keys == keys;
+            }
+
+            static void assign(Slot& slot, const uint64_t keys) noexcept
+            {
+                slot.keys = keys;
+            }
+        };
+
+        static uint64_t _pack(const Control::KeyChord& keys);
+
+        til::linear_flat_set<Slot, SlotHashTrait> _slots;
+        // Indexed by Slot::index. Explicitly unbound key chords map to nullptr.
+        std::vector<Model::Command> _commands;
+    };
+
     struct ActionArgFactory
     {
         ActionArgFactory() = default;
@@ -111,6 +167,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         std::optional<Model::Command> _GetActionByKeyChordInternal(const Control::KeyChord& keys) const;
 
         void _RefreshKeyBindingCaches();
+        void _RefreshKeyChordDispatchTable();
         void _PopulateAvailableActionsWithStandardCommands(std::unordered_map<hstring, Model::ActionAndArgs>& availableActions, std::unordered_set<InternalActionID>& visitedActionIDs) const;
         void _PopulateNameMapWithSpecialCommands(std::unordered_map<hstring, Model::Command>& nameMap) const;
         void _PopulateNameMapWithStandardCommands(std::unordered_map<hstring, Model::Command>& nameMap) const;
@@ -156,6 +213,12 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         Windows::Foundation::Collections::IMap<Control::KeyChord, Model::Command> _ResolvedKeyToActionMapCache{ nullptr };
         Windows::Foundation::Collections::IVector<Model::Command> _AllCommandsCache{ nullptr };
 
+        // _KeyChordDispatchTable contains the same data as _ResolvedKeyToActionMapCache (plus explicitly unbound key chords),
+        // but is optimized for GetActionByKeyChord(). It's rebuilt whenever inheritance is finalized or the key binding
+        // caches are refreshed and reset whenever this layer is modified. GetActionByKeyChord() falls back to walking
+        // the layers while it's empty.
+        std::optional<KeyChordDispatchTable> _KeyChordDispatchTable;
+
         til::shared_mutex<std::unordered_map<std::filesystem::path, std::unordered_map<hstring, Model::Command>>> _cwdLocalSnippetsCache{};
 
         std::set<std::string> _changeLog;
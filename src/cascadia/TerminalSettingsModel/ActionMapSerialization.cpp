@@ -102,6 +102,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
 
                 // any existing keybinding with the same keychord in this layer will get overwritten
                 _KeyMap.insert_or_assign(keys, idJson);
+                _KeyChordDispatchTable.reset();
 
                 if (!_changeLog.contains(KeysKey.data()))
                 {
@@ -0,0 +1,388 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "BinaryJsonCache.h"
+
+#include <til/io.h>
+
+// The file consists of a header followed by the entries:
+//   header: Magic, FormatVersion, entry count (uint32_t)
+//   entry:  til::hash() of the text, size of the text, size of the data (uint64_t each), data
+// Bump the FormatVersion whenever the encoding changes.
+static constexpr uint32_t Magic = 0x434a5457; // "WTJC"
+static constexpr uint32_t FormatVersion = 1;
+
+// The encoding of a value starts with a tag byte. Its low bits contain the Json::ValueType,
+// while the CommentFlag bits indicate which comments follow. After that come its offsets
+// (see Json::Value::getOffsetStart) and its comments. Finally the value itself follows:
+// * int:    zigzag varint
+// * uint:   varint
+// * real:   8 bytes
+// * string: varint length + bytes
+// * bool:   1 byte
+// * array:  varint count + values
+// * object: varint count + (string, value) pairs
+static constexpr uint8_t TypeMask = 0x0f;
+static constexpr uint8_t CommentFlag = 0x10;
+static constexpr std::array commentPlacements{ Json::commentBefore, Json::commentAfterOnSameLine, Json::commentAfter };
+// Same as jsoncpp's default stackLimit, which means that decoding never fails due to it for valid documents.
+static constexpr size_t MaxDepth = 1000;
+
+using namespace winrt::Microsoft::Terminal::Settings::Model;
+
+namespace
+{
+    struct Encoder
+    {
+        std::string out;
+
+        void writeRaw(const void* data, size_t size)
+        {
+            out.append(static_cast<const char*>(data), size);
+        }
+
+        void writeVarint(uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<char>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        void writeString(const std::string_view& str)
+        {
+            writeVarint(str.size());
+            out.append(str);
+        }
+
+        void writeValue(const Json::Value& value)
+        {
+            const auto type = value.type();
+            auto tag = static_cast<uint8_t>(type);
+            for (size_t i = 0; i < commentPlacements.size(); ++i)
+            {
+                if (value.hasComment(til::at(commentPlacements, i)))
+                {
+                    tag |= CommentFlag << i;
+                }
+            }
+
+            out.push_back(static_cast<char>(tag));
+            writeVarint(gsl::narrow_cast<uint64_t>(value.getOffsetStart()));
+            writeVarint(gsl::narrow_cast<uint64_t>(value.getOffsetLimit()));
+
+            for (size_t i = 0; i < commentPlacements.size(); ++i)
+            {
+                if (tag & (CommentFlag << i))
+                {
+                    writeString(value.getComment(til::at(commentPlacements, i)));
+                }
+            }
+
+            switch (type)
+            {
+            case Json::nullValue:
+                break;
+            case Json::intValue:
+            {
+                const auto v = value.asLargestInt();
+                writeVarint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+                break;
+            }
+            case Json::uintValue:
+                writeVarint(value.asLargestUInt());
+                break;
+            case Json::realValue:
+            {
+                const auto v = value.asDouble();
+                writeRaw(&v, sizeof(v));
+                break;
+            }
+            case Json::stringValue:
+            {
+                const char* beg = nullptr;
+                const char* end = nullptr;
+                value.getString(&beg, &end);
+                writeString({ beg, gsl::narrow_cast<size_t>(end - beg) });
+                break;
+            }
+            case Json::booleanValue:
+                out.push_back(value.asBool() ? 1 : 0);
+                break;
+            case Json::arrayValue:
+                writeVarint(value.size());
+                for (const auto& element : value)
+                {
+                    writeValue(element);
+                }
+                break;
+            case Json::objectValue:
+                writeVarint(value.size());
+                for (auto it = value.begin(), end = value.end(); it != end; ++it)
+                {
+                    writeString(it.name());
+                    writeValue(*it);
+                }
+                break;
+            }
+        }
+    };
+
+    struct Decoder
+    {
+        const char* it;
+        const char* end;
+
+        void readRaw(void* data, size_t size)
+        {
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), size > gsl::narrow_cast<size_t>(end - it));
+            memcpy(data, it, size);
+            it += size;
+        }
+
+        uint8_t readByte()
+        {
+            uint8_t b;
+            readRaw(&b, 1);
+            return b;
+        }
+
+        uint64_t readVarint()
+        {
+            uint64_t value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7)
+            {
+                const auto b = readByte();
+                value |= static_cast<uint64_t>(b & 0x7f) << shift;
+                if (!(b & 0x80))
+                {
+                    return value;
+                }
+            }
+            THROW_HR(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+        }
+
+        std::string_view readString()
+        {
+            const auto size = readVarint();
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), size > gsl::narrow_cast<uint64_t>(end - it));
+            const std::string_view str{ it, gsl::narrow_cast<size_t>(size) };
+            it += size;
+            return str;
+        }
+
+        void readValue(Json::Value& value, size_t depth)
+        {
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), depth > MaxDepth);
+
+            const auto tag = readByte();
+            const auto type = static_cast<Json::ValueType>(tag & TypeMask);
+            const auto offsetStart = readVarint();
+            const auto offsetLimit = readVarint();
+
+            std::array<std::string_view, commentPlacements.size()> comments;
+            for (size_t i = 0; i < commentPlacements.size(); ++i)
+            {
+                if (tag & (CommentFlag << i))
+                {
+                    til::at(comments, i) = readString();
+                }
+            }
+
+            switch (type)
+            {
+            case Json::nullValue:
+                value = Json::Value{};
+                break;
+            case Json::intValue:
+            {
+                const auto v = readVarint();
+                value = static_cast<Json::LargestInt>((v >> 1) ^ (~(v & 1) + 1));
+                break;
+            }
+            case Json::uintValue:
+                value = static_cast<Json::LargestUInt>(readVarint());
+                break;
+            case Json::realValue:
+            {
+                double v;
+                readRaw(&v, sizeof(v));
+                value = v;
+                break;
+            }
+            case Json::stringValue:
+            {
+                const auto str = readString();
+                value = Json::Value{ str.data(), str.data() + str.size() };
+                break;
+            }
+            case Json::booleanValue:
+                value = readByte() != 0;
+                break;
+            case Json::arrayValue:
+            {
+                // Every value takes up at least 3 bytes, which protects us against absurd allocations.
+                const auto count = readVarint();
+                THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), count > gsl::narrow_cast<uint64_t>(end - it) / 3);
+                value = Json::Value{ Json::arrayValue };
+                value.resize(gsl::narrow_cast<Json::ArrayIndex>(count));
+                for (Json::ArrayIndex i = 0; i < value.size(); ++i)
+                {
+                    readValue(value[i], depth + 1);
+                }
+                break;
+            }
+            case Json::objectValue:
+            {
+                const auto count = readVarint();
+                value = Json::Value{ Json::objectValue };
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    const auto key = readString();
+                    readValue(*value.demand(key.data(), key.data() + key.size()), depth + 1);
+                }
+                break;
+            }
+            default:
+                THROW_HR(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+            }
+
+            // The assignments above reset these, which is why they're applied last.
+            value.setOffsetStart(gsl::narrow_cast<ptrdiff_t>(offsetStart));
+            value.setOffsetLimit(gsl::narrow_cast<ptrdiff_t>(offsetLimit));
+
+            for (size_t i = 0; i < commentPlacements.size(); ++i)
+            {
+                if (const auto& comment = til::at(comments, i); !comment.empty())
+                {
+                    value.setComment(std::string{ comment }, til::at(commentPlacements, i));
+                }
+            }
+        }
+    };
+}
+
+// Reads the cache at the given path. A cache that can't be read,
+// or that was written by a different version, is treated like an empty one.
+BinaryJsonCache::BinaryJsonCache(std::filesystem::path path) :
+    _path{ std::move(path) }
+{
+    try
+    {
+        _file = til::io::read_file_as_utf8_string_if_exists(_path);
+
+        Decoder decoder{ _file.data(), _file.data() + _file.size() };
+        uint32_t header[3]{};
+        decoder.readRaw(&header[0], sizeof(header));
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), header[0] != Magic || header[1] != FormatVersion);
+
+        for (uint32_t i = 0; i < header[2]; ++i)
+        {
+            uint64_t entryHeader[3]{};
+            decoder.readRaw(&entryHeader[0], sizeof(entryHeader));
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), entryHeader[2] > gsl::narrow_cast<uint64_t>(decoder.end - decoder.it));
+
+            auto& entry = _entries[entryHeader[0]];
+            entry.contentSize = entryHeader[1];
+            entry.data = { decoder.it, gsl::narrow_cast<size_t>(entryHeader[2]) };
+            decoder.it += entry.data.size();
+        }
+    }
+    catch (...)
+    {
+        // A missing file is expected on the first launch and isn't worth logging.
+        if (!_file.empty())
+        {
+            LOG_CAUGHT_EXCEPTION();
+        }
+        _entries.clear();
+        _dirty = true;
+    }
+}
+
+// Returns the cached Json::Value for the given JSON text, if there's one.
+std::optional<Json::Value> BinaryJsonCache::TryGet(const std::string_view content)
+{
+    const auto it = _entries.find(til::hash(content));
+    if (it == _entries.end() || it->second.contentSize != content.size())
+    {
+        return std::nullopt;
+    }
+
+    try
+    {
+        auto json = Decode(it->second.data);
+        it->second.used = true;
+        return json;
+    }
+    CATCH_LOG()
+
+    _entries.erase(it);
+    _dirty = true;
+    return std::nullopt;
+}
+
+// Caches the given Json::Value, which must be the result of parsing the given JSON text.
+void BinaryJsonCache::Set(const std::string_view content, const Json::Value& json)
+{
+    auto& entry = _entries[til::hash(content)];
+    entry.contentSize = content.size();
+    entry.buffer = Encode(json);
+    entry.data = entry.buffer;
+    entry.used = true;
+    _dirty = true;
+}
+
+// Writes the cache back to disk, if it changed or contains entries that weren't used since it was read.
+// Errors are only logged, as the cache is merely an optimization.
+void BinaryJsonCache::Save()
+{
+    const auto allUsed = std::all_of(_entries.begin(), _entries.end(), [](const auto& kv) { return kv.second.used; });
+    if (!_dirty && allUsed)
+    {
+        return;
+    }
+
+    try
+    {
+        const auto count = std::count_if(_entries.begin(), _entries.end(), [](const auto& kv) { return kv.second.used; });
+
+        Encoder encoder;
+        const uint32_t header[3]{ Magic, FormatVersion, gsl::narrow<uint32_t>(count) };
+        encoder.writeRaw(&header[0], sizeof(header));
+
+        for (const auto& [hash, entry] : _entries)
+        {
+            if (entry.used)
+            {
+                const uint64_t entryHeader[3]{ hash, entry.contentSize, entry.data.size() };
+                encoder.writeRaw(&entryHeader[0], sizeof(entryHeader));
+                encoder.writeRaw(entry.data.data(), entry.data.size());
+            }
+        }
+
+        til::io::write_utf8_string_to_file_atomic(_path, encoder.out);
+        _dirty = false;
+    }
+    CATCH_LOG()
+}
+
+std::string BinaryJsonCache::Encode(const Json::Value& json)
+{
+    Encoder encoder;
+    encoder.writeValue(json);
+    return std::move(encoder.out);
+}
+
+// Throws if the data is malformed.
+Json::Value BinaryJsonCache::Decode(const std::string_view data)
+{
+    Decoder decoder{ data.data(), data.data() + data.size() };
+    Json::Value json;
+    decoder.readValue(json, 0);
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), decoder.it != decoder.end);
+    return json;
+}
@@ -0,0 +1,51 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- BinaryJsonCache
+
+Abstract:
+- Caches parsed JSON documents in a compact binary format, keyed by a hash
+  of their text. With large settings files and many fragments, parsing them
+  with jsoncpp is a noticeable part of the startup time. Decoding the binary
+  format skips the tokenization, unescaping and number parsing, while still
+  producing an identical Json::Value, including the comments and the offsets
+  that are used for error messages.
+- The cache file is read at once during construction. Save() only writes back
+  the documents that were requested since, so stale ones don't accumulate.
+
+--*/
+
+#pragma once
+
+namespace winrt::Microsoft::Terminal::Settings::Model
+{
+    class BinaryJsonCache
+    {
+    public:
+        explicit BinaryJsonCache(std::filesystem::path path);
+
+        std::optional<Json::Value> TryGet(std::string_view content);
+        void Set(std::string_view content, const Json::Value& json);
+        void Save();
+
+        static std::string Encode(const Json::Value& json);
+        static Json::Value Decode(std::string_view data);
+
+    private:
+        struct Entry
+        {
+            uint64_t contentSize = 0;
+            // Points into _file, unless the entry was added by Set(), in which case it's stored in buffer.
+            std::string_view data;
+            std::string buffer;
+            bool used = false;
+        };
+
+        std::filesystem::path _path;
+        std::string _file;
+        std::unordered_map<uint64_t, Entry> _entries;
+        bool _dirty = false;
+    };
+};
@@ -29,6 +29,7 @@ Author(s):
 namespace winrt::Microsoft::Terminal::Settings::Model
 {
     class IDynamicProfileGenerator;
+    class BinaryJsonCache;
 }
 
 namespace winrt::Microsoft::Terminal::Settings::Model::implementation
@@ -83,7 +84,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
     {
         static SettingsLoader Default(const std::string_view& userJSON, const std::string_view& inboxJSON);
         static std::vector<Model::ExtensionPackage> LoadExtensionPackages();
-        SettingsLoader(const std::string_view& userJSON, const std::string_view& inboxJSON);
+        SettingsLoader(const std::string_view& userJSON, const std::string_view& inboxJSON, BinaryJsonCache* jsonCache = nullptr);
 
         void GenerateProfiles();
         void GenerateExtensionPackagesFromProfileGenerators();
@@ -117,6 +118,14 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
             std::wstring_view jsonFilename;
             FragmentScope scope;
         };
+        struct GeneratorJob
+        {
+            const IDynamicProfileGenerator* generator = nullptr;
+            std::vector<winrt::com_ptr<implementation::Profile>> profiles;
+            std::wstring stamp;
+            // The profiles were loaded from the GeneratedProfilesCache and the generator doesn't need to run.
+            bool cached = false;
+        };
         SettingsLoader() = default;
 
         static std::pair<size_t, size_t> _lineAndColumnFromPosition(const std::string_view& string, const size_t position);
@@ -126,12 +135,16 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         std::span<const winrt::com_ptr<implementation::Profile>> _getNonUserOriginProfiles() const;
         void _parse(const OriginTag origin, const winrt::hstring& source, const std::string_view& content, ParsedSettings& settings);
         void _parseFragment(const winrt::hstring& source, const winrt::hstring& sourceBasePath, const std::string_view& content, ParsedSettings& settings, const std::optional<ParseFragmentMetadata>& fragmentMeta);
-        static JsonSettings _parseJson(const std::string_view& content);
+        JsonSettings _parseJson(const std::string_view& content);
         static winrt::com_ptr<implementation::Profile> _parseProfile(const OriginTag origin, const winrt::hstring& source, const Json::Value& profileJson);
         void _appendProfile(winrt::com_ptr<Profile>&& profile, const winrt::guid& guid, ParsedSettings& settings);
         void _addUserProfileParent(const winrt::com_ptr<implementation::Profile>& profile);
         bool _addOrMergeUserColorScheme(const winrt::com_ptr<implementation::ColorScheme>& colorScheme);
+        static std::vector<std::unique_ptr<IDynamicProfileGenerator>> _createGenerators();
         static void _executeGenerator(const IDynamicProfileGenerator& generator, std::vector<winrt::com_ptr<implementation::Profile>>& profilesList);
+        static void _executeGenerators(std::span<GeneratorJob> jobs);
+        static void _refreshGeneratedProfilesCache(std::filesystem::path cachePath, std::wstring cacheKey, std::vector<std::unique_ptr<IDynamicProfileGenerator>>&& generators, std::span<const GeneratorJob> jobs);
+        std::wstring _generatedProfilesCacheKey() const;
         winrt::com_ptr<implementation::ExtensionPackage> _registerFragment(const winrt::Microsoft::Terminal::Settings::Model::FragmentSettings& fragment, FragmentScope scope);
         Json::StreamWriterBuilder _getJsonStyledWriter();
 
@@ -139,6 +152,8 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         std::set<std::string> themesChangeLog;
         // See _getNonUserOriginProfiles().
         size_t _userProfileCount = 0;
+        // Optional. Used by _parseJson() to skip parsing documents it has seen before.
+        BinaryJsonCache* _jsonCache = nullptr;
     };
 
     struct CascadiaSettings : CascadiaSettingsT<CascadiaSettings>
@@ -153,6 +168,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         static winrt::hstring ApplicationDisplayName();
         static winrt::hstring ApplicationVersion();
         static bool IsPortableMode();
+        static void CancelBackgroundTasks();
 
         CascadiaSettings() noexcept = default;
         CascadiaSettings(const winrt::hstring& userJSON, const winrt::hstring& inboxJSON);
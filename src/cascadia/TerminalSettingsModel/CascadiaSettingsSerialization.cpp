@@ -9,6 +9,7 @@
 #include <shlobj.h>
 #include <til/latch.h>
 #include <til/io.h>
+#include <til/parallel.h>
 
 #include "resource.h"
 
@@ -21,8 +22,11 @@
 #endif
 
 #include "ApplicationState.h"
+#include "BinaryJsonCache.h"
 #include "DefaultTerminal.h"
 #include "FileUtils.h"
+#include "GeneratedProfilesCache.h"
+#include "../../types/inc/utils.hpp"
 
 #include "ProfileEntry.h"
 #include "FolderEntry.h"
@@ -36,6 +40,18 @@ using namespace winrt::Microsoft::Terminal::Settings::Model::implementation;
 
 static constexpr std::wstring_view SettingsFilename{ L"settings.json" };
 static constexpr std::wstring_view DefaultsFilename{ L"defaults.json" };
+static constexpr std::wstring_view GeneratedProfilesCacheFilename{ L"generated-profiles.json" };
+static constexpr std::wstring_view SettingsCacheFilename{ L"settings-cache.bin" };
+
+// Owns the thread started by SettingsLoader::_refreshGeneratedProfilesCache().
+// CascadiaSettings::CancelBackgroundTasks() stops and joins it during shutdown.
+// Otherwise, the std::jthread destructor does so when the module gets unloaded.
+struct GeneratedProfilesCacheRefresh
+{
+    std::jthread thread;
+    bool started = false;
+};
+static til::shared_mutex<GeneratedProfilesCacheRefresh> s_generatedProfilesCacheRefresh;
 
 static constexpr std::string_view ProfilesKey{ "profiles" };
 static constexpr std::string_view DefaultSettingsKey{ "defaults" };
@@ -145,7 +161,9 @@ std::vector<Model::ExtensionPackage> SettingsLoader::LoadExtensionPackages()
 //
 // This constructor only handles parsing the two given JSON strings.
 // At a minimum you should do at least everything that SettingsLoader::Default does.
-SettingsLoader::SettingsLoader(const std::string_view& userJSON, const std::string_view& inboxJSON)
+// The jsonCache must outlive the SettingsLoader, or at least its last call to FinalizeLayering().
+SettingsLoader::SettingsLoader(const std::string_view& userJSON, const std::string_view& inboxJSON, BinaryJsonCache* jsonCache) :
+    _jsonCache{ jsonCache }
 {
     _parse(OriginTag::InBox, {}, inboxJSON, inboxSettings);
 
@@ -208,41 +226,122 @@ Json::StreamWriterBuilder SettingsLoader::_getJsonStyledWriter()
 
 // Generate dynamic profiles and add them to the list of "inbox" profiles
 // (meaning profiles specified by the application rather by the user).
+//
+// Generators whose cache stamp didn't change since the last launch are skipped and their
+// profiles are loaded from the GeneratedProfilesCache instead. All others run concurrently.
 void SettingsLoader::GenerateProfiles()
 {
-    auto generateProfiles = [&](const IDynamicProfileGenerator& generator) {
-        if (!_ignoredNamespaces.contains(generator.GetNamespace()))
+    const auto start = std::chrono::steady_clock::now();
+    auto generators = _createGenerators();
+    std::vector<GeneratorJob> jobs;
+    jobs.reserve(generators.size());
+
+    for (const auto& generator : generators)
+    {
+        if (!_ignoredNamespaces.contains(generator->GetNamespace()))
         {
-            const auto oldProfileCount = inboxSettings.profiles.size();
-            _executeGenerator(generator, inboxSettings.profiles);
-            return oldProfileCount != inboxSettings.profiles.size();
+            jobs.emplace_back().generator = generator.get();
         }
-        return false;
-    };
+    }
+
+    // Just like with the elevated-state.json, an elevated instance shouldn't
+    // trust a file that an unelevated one can write to. See ApplicationState.
+    const auto cachePath = GetBaseSettingsPath() / GeneratedProfilesCacheFilename;
+    const auto cacheKey = _generatedProfilesCacheKey();
+    std::optional<GeneratedProfilesCache> cache;
+    if (!::Microsoft::Console::Utils::IsRunningElevated())
+    {
+        cache.emplace(cachePath, cacheKey);
+
+        for (auto& job : jobs)
+        {
+            try
+            {
+                job.stamp = job.generator->GetCacheStamp();
+            }
+            CATCH_LOG();
+
+            job.cached = cache->TryGet(job.generator->GetNamespace(), job.stamp, job.profiles);
+        }
+    }
+
+    _executeGenerators(jobs);
 
-    // Generate profiles for each generator and add them to the inbox settings.
-    // Be sure to update the same list below.
-    generateProfiles(PowershellCoreProfileGenerator{});
-    generateProfiles(WslDistroGenerator{});
-    generateProfiles(AzureCloudShellGenerator{});
-    generateProfiles(VisualStudioGenerator{});
 #if TIL_FEATURE_DYNAMICSSHPROFILES_ENABLED
-    sshProfilesGenerated = generateProfiles(SshHostGenerator{});
+    const auto sshNamespace = SshHostGenerator{}.GetNamespace();
 #endif
+    size_t cachedCount = 0;
+
+    // Add the profiles to the inbox settings in the order of the generators, just like when they ran one after another.
+    for (auto& job : jobs)
+    {
+#if TIL_FEATURE_DYNAMICSSHPROFILES_ENABLED
+        if (job.generator->GetNamespace() == sshNamespace)
+        {
+            sshProfilesGenerated = !job.profiles.empty();
+        }
+#endif
+
+        if (job.cached)
+        {
+            cachedCount++;
+        }
+        else if (cache)
+        {
+            try
+            {
+                cache->Set(job.generator->GetNamespace(), job.stamp, job.profiles);
+            }
+            CATCH_LOG();
+        }
+
+        inboxSettings.profiles.insert(inboxSettings.profiles.end(), std::make_move_iterator(job.profiles.begin()), std::make_move_iterator(job.profiles.end()));
+    }
+
+    TraceLoggingWrite(
+        g_hSettingsModelProvider,
+        "DynamicProfilesGenerated",
+        TraceLoggingDescription("Event emitted once the dynamic profiles are generated during settings load"),
+        TraceLoggingUInt64(gsl::narrow_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()), "DurationUs", "Time it took to generate the profiles"),
+        TraceLoggingUInt32(gsl::narrow_cast<uint32_t>(jobs.size()), "Generators", "Number of generators that aren't disabled"),
+        TraceLoggingUInt32(gsl::narrow_cast<uint32_t>(cachedCount), "CachedGenerators", "Number of generators whose profiles were loaded from the cache"),
+        TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+        TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+
+    if (cache)
+    {
+        cache->Save();
+
+        if (cachedCount)
+        {
+            _refreshGeneratedProfilesCache(cachePath, cacheKey, std::move(generators), jobs);
+        }
+    }
 }
 
 // Generate ExtensionPackage objects from the profile generators.
 void SettingsLoader::GenerateExtensionPackagesFromProfileGenerators()
 {
-    auto generateExtensionPackages = [&](const IDynamicProfileGenerator& generator) {
-        std::vector<winrt::com_ptr<implementation::Profile>> profilesList;
-        _executeGenerator(generator, profilesList);
+    const auto generators = _createGenerators();
+    std::vector<GeneratorJob> jobs;
+    jobs.reserve(generators.size());
+
+    for (const auto& generator : generators)
+    {
+        jobs.emplace_back().generator = generator.get();
+    }
+
+    _executeGenerators(jobs);
+
+    for (const auto& job : jobs)
+    {
+        const auto& generator = *job.generator;
 
         // These are needed for the FragmentSettings object
         std::vector<Model::FragmentProfileEntry> profileEntries;
         Json::Value profilesListJson{ Json::ValueType::arrayValue };
 
-        for (const auto& profile : profilesList)
+        for (const auto& profile : job.profiles)
         {
             const auto profileJson = profile->ToJson();
             profilesListJson.append(profileJson);
@@ -259,17 +358,7 @@ void SettingsLoader::GenerateExtensionPackagesFromProfileGenerators()
         auto extPkg = _registerFragment(std::move(*generatorExtension), FragmentScope::Machine);
         extPkg->DisplayName(hstring{ generator.GetDisplayName() });
         extPkg->Icon(hstring{ generator.GetIcon() });
-    };
-
-    // Generate extension package objects for each generator.
-    // Be sure to update the same list above.
-    generateExtensionPackages(PowershellCoreProfileGenerator{});
-    generateExtensionPackages(WslDistroGenerator{});
-    generateExtensionPackages(AzureCloudShellGenerator{});
-    generateExtensionPackages(VisualStudioGenerator{});
-#if TIL_FEATURE_DYNAMICSSHPROFILES_ENABLED
-    generateExtensionPackages(SshHostGenerator{});
-#endif
+    }
 }
 
 // A new settings.json gets a special treatment:
@@ -1012,7 +1101,29 @@ void SettingsLoader::_parseFragment(const winrt::hstring& source, const winrt::h
 
 SettingsLoader::JsonSettings SettingsLoader::_parseJson(const std::string_view& content)
 {
-    auto root = content.empty() ? Json::Value{ Json::ValueType::objectValue } : _parseJSON(content);
+    Json::Value root{ Json::ValueType::objectValue };
+
+    if (!content.empty())
+    {
+        if (auto cached = _jsonCache ? _jsonCache->TryGet(content) : std::nullopt)
+        {
+            root = std::move(*cached);
+        }
+        else
+        {
+            root = _parseJSON(content);
+
+            if (_jsonCache)
+            {
+                try
+                {
+                    _jsonCache->Set(content, root);
+                }
+                CATCH_LOG();
+            }
+        }
+    }
+
     const auto& colorSchemes = _getJSONValue(root, SchemesKey);
     const auto& themes = _getJSONValue(root, ThemesKey);
     const auto& profilesObject = _getJSONValue(root, ProfilesKey);
@@ -1142,6 +1253,20 @@ bool SettingsLoader::_addOrMergeUserColorScheme(const winrt::com_ptr<implementat
     return true;
 }
 
+// Returns all dynamic profile generators. Their order determines the order of the generated profiles.
+std::vector<std::unique_ptr<IDynamicProfileGenerator>> SettingsLoader::_createGenerators()
+{
+    std::vector<std::unique_ptr<IDynamicProfileGenerator>> generators;
+    generators.emplace_back(std::make_unique<PowershellCoreProfileGenerator>());
+    generators.emplace_back(std::make_unique<WslDistroGenerator>());
+    generators.emplace_back(std::make_unique<AzureCloudShellGenerator>());
+    generators.emplace_back(std::make_unique<VisualStudioGenerator>());
+#if TIL_FEATURE_DYNAMICSSHPROFILES_ENABLED
+    generators.emplace_back(std::make_unique<SshHostGenerator>());
+#endif
+    return generators;
+}
+
 // As the name implies it executes a generator.
 // Generated profiles are added to .inboxSettings. Used by GenerateProfiles().
 void SettingsLoader::_executeGenerator(const IDynamicProfileGenerator& generator, std::vector<winrt::com_ptr<implementation::Profile>>& profilesList)
@@ -1168,6 +1293,130 @@ void SettingsLoader::_executeGenerator(const IDynamicProfileGenerator& generator
     }
 }
 
+// Runs the generators of all jobs that aren't cached. Most of them spend their time waiting on the
+// registry, the file system or COM servers, which is why each of them gets a thread of its own.
+// The first one runs on the calling thread, as it would otherwise just sit there and wait.
+void SettingsLoader::_executeGenerators(std::span<GeneratorJob> jobs)
+{
+    std::vector<GeneratorJob*> pending;
+    pending.reserve(jobs.size());
+
+    for (auto& job : jobs)
+    {
+        if (!job.cached)
+        {
+            pending.emplace_back(&job);
+        }
+    }
+
+    // parallel_for() runs jobs on the calling thread if it fails to spawn a thread for them.
+    // That thread is already initialized for COM and may not be in the MTA.
+    const auto callerThread = std::this_thread::get_id();
+
+    til::parallel_for(pending.size(), [&](const size_t i) {
+        auto& job = *til::at(pending, i);
+
+        if (std::this_thread::get_id() == callerThread)
+        {
+            _executeGenerator(*job.generator, job.profiles);
+            return;
+        }
+
+        try
+        {
+            // VisualStudioGenerator for instance enumerates the VS instances via COM.
+            const auto coInit = wil::CoInitializeEx(COINIT_MULTITHREADED);
+            _executeGenerator(*job.generator, job.profiles);
+        }
+        CATCH_LOG();
+    });
+}
+
+// A cache stamp is a heuristic and may miss changes that affect a generator's output.
+// To make up for that, the cached generators run once per process in the background anyway.
+// The updated cache is then picked up by the next settings reload or launch.
+void SettingsLoader::_refreshGeneratedProfilesCache(std::filesystem::path cachePath, std::wstring cacheKey, std::vector<std::unique_ptr<IDynamicProfileGenerator>>&& generators, std::span<const GeneratorJob> jobs)
+{
+    const auto refresh = s_generatedProfilesCacheRefresh.lock();
+    if (refresh->started)
+    {
+        return;
+    }
+    refresh->started = true;
+
+    try
+    {
+        std::vector<GeneratorJob> refreshJobs;
+        for (const auto& job : jobs)
+        {
+            if (job.cached)
+            {
+                refreshJobs.emplace_back().generator = job.generator;
+            }
+        }
+
+        refresh->thread = std::jthread{ [cachePath = std::move(cachePath), cacheKey = std::move(cacheKey), generators = std::move(generators), jobs = std::move(refreshJobs)](const std::stop_token& stop) mutable {
+            try
+            {
+                const auto coInit = wil::CoInitializeEx(COINIT_MULTITHREADED);
+
+                for (auto& job : jobs)
+                {
+                    // The stamp may have changed since GenerateProfiles() computed it.
+                    try
+                    {
+                        job.stamp = job.generator->GetCacheStamp();
+                    }
+                    CATCH_LOG();
+                }
+
+                if (stop.stop_requested())
+                {
+                    return;
+                }
+
+                _executeGenerators(jobs);
+
+                if (stop.stop_requested())
+                {
+                    return;
+                }
+
+                // A settings reload may have saved the cache since it was read by GenerateProfiles().
+                // Re-reading it ensures that we only replace the entries of the generators that ran here.
+                GeneratedProfilesCache cache{ cachePath, cacheKey };
+                for (const auto& job : jobs)
+                {
+                    cache.Set(job.generator->GetNamespace(), job.stamp, job.profiles);
+                }
+
+                cache.Save();
+            }
+            CATCH_LOG();
+        } };
+    }
+    CATCH_LOG();
+}
+
+// Stops any background work started while loading the settings and waits for it to finish.
+// This is called during shutdown, so that the process doesn't get torn down in the middle of it.
+void CascadiaSettings::CancelBackgroundTasks()
+{
+    std::jthread thread;
+    {
+        const auto refresh = s_generatedProfilesCacheRefresh.lock();
+        thread = std::move(refresh->thread);
+    }
+    // std::jthread's destructor requests the stop and joins the thread.
+}
+
+// Everything that affects the output of all generators alike. See GeneratedProfilesCache.
+std::wstring SettingsLoader::_generatedProfilesCacheKey() const
+{
+    // The profile names are localized, which is why the language is part of the key.
+    return fmt::format(FMT_COMPILE(L"{};{};{}"), std::wstring_view{ CascadiaSettings::ApplicationVersion() }, std::wstring_view{ userSettings.globals->Language() }, GetUserDefaultUILanguage());
+}
+
 winrt::com_ptr<ExtensionPackage> SettingsLoader::_registerFragment(const winrt::Microsoft::Terminal::Settings::Model::FragmentSettings& fragment, FragmentScope scope)
 {
     winrt::com_ptr<ExtensionPackage> extPkg{ nullptr };
@@ -1243,7 +1492,16 @@ try
     const auto settingsStringView = (firstTimeSetup && !releaseSettingExists) ? LoadStringResource(IDR_USER_DEFAULTS) : settingsString;
     auto mustWriteToDisk = firstTimeSetup;
 
-    SettingsLoader loader{ settingsStringView, LoadStringResource(IDR_DEFAULTS) };
+    // The parsed settings.json, defaults.json and fragments are cached across launches.
+    // Like with the GeneratedProfilesCache, elevated instances don't use this cache,
+    // because it's writable by unelevated processes.
+    std::optional<BinaryJsonCache> jsonCache;
+    if (!::Microsoft::Console::Utils::IsRunningElevated())
+    {
+        jsonCache.emplace(GetBaseSettingsPath() / SettingsCacheFilename);
+    }
+
+    SettingsLoader loader{ settingsStringView, LoadStringResource(IDR_DEFAULTS), jsonCache ? &*jsonCache : nullptr };
 
     winrt::hstring baseUserSettingsPath{ GetBaseSettingsPath().native() };
     loader.userSettings.baseLayerProfile->SourceBasePath = baseUserSettingsPath;
@@ -1271,6 +1529,12 @@ try
     loader.FindFragmentsAndMergeIntoUserSettings(false /*generateExtensionPackages*/);
     loader.FinalizeLayering();
 
+    // FinalizeLayering() is the last step that parses JSON.
+    if (jsonCache)
+    {
+        jsonCache->Save();
+    }
+
     // DisableDeletedProfiles returns true whenever we encountered any new generated/dynamic profiles.
     // Similarly FixupUserSettings returns true, when it encountered settings that were patched up.
     mustWriteToDisk |= loader.DisableDeletedProfiles();
@@ -28,3 +28,14 @@ winrt::com_ptr<winrt::Microsoft::Terminal::Settings::Model::implementation::Prof
     profile->Icon(winrt::hstring{ iconPath });
     return profile;
 }
+
+// Method Description:
+// - Helper function for building the return value of IDynamicProfileGenerator::GetCacheStamp()
+//   out of the last write times of files and registry keys.
+// Arguments:
+// - stamp: the stamp to append to.
+// - time: the time to append.
+void AppendCacheStamp(std::wstring& stamp, const FILETIME& time)
+{
+    fmt::format_to(std::back_inserter(stamp), FMT_COMPILE(L"{:08x}{:08x};"), time.dwHighDateTime, time.dwLowDateTime);
+}
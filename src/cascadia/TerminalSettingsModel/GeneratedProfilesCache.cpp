@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "GeneratedProfilesCache.h"
+
+#include <til/io.h>
+
+static constexpr std::string_view KeyKey{ "key" };
+static constexpr std::string_view GeneratorsKey{ "generators" };
+static constexpr std::string_view StampKey{ "stamp" };
+static constexpr std::string_view ProfilesKey{ "profiles" };
+
+using namespace winrt::Microsoft::Terminal::Settings::Model;
+
+// Reads the cache at the given path. A cache that can't be read, or that
+// was written with a different key, is treated like an empty one.
+GeneratedProfilesCache::GeneratedProfilesCache(std::filesystem::path path, const std::wstring_view key) :
+    _path{ std::move(path) }
+{
+    const auto keyU8 = til::u16u8(key);
+
+    try
+    {
+        const auto content = til::io::read_file_as_utf8_string_if_exists(_path);
+        if (!content.empty())
+        {
+            Json::Value root;
+            std::string errs;
+            const std::unique_ptr<Json::CharReader> reader{ Json::CharReaderBuilder{}.newCharReader() };
+
+            if (reader->parse(content.data(), content.data() + content.size(), &root, &errs) &&
+                root.isObject() &&
+                root[JsonKey(KeyKey)].asString() == keyU8)
+            {
+                _root = std::move(root);
+            }
+        }
+    }
+    CATCH_LOG()
+
+    if (!_root.isObject())
+    {
+        _root = Json::Value{ Json::ValueType::objectValue };
+        _root[JsonKey(KeyKey)] = keyU8;
+        // Ensures that the new key gets persisted, even if none of the generators can be cached.
+        _dirty = true;
+    }
+}
+
+// Appends the cached profiles of the given generator to the list and returns true,
+// if the cache contains an entry for that generator with the given stamp.
+bool GeneratedProfilesCache::TryGet(const std::wstring_view generatorNamespace, const std::wstring_view stamp, std::vector<winrt::com_ptr<implementation::Profile>>& profiles) const
+{
+    if (stamp.empty())
+    {
+        return false;
+    }
+
+    try
+    {
+        const auto& entry = _root[JsonKey(GeneratorsKey)][til::u16u8(generatorNamespace)];
+        const auto& list = entry[JsonKey(ProfilesKey)];
+
+        if (entry[JsonKey(StampKey)].asString() != til::u16u8(stamp) || !list.isArray())
+        {
+            return false;
+        }
+
+        // Same as SettingsLoader::_executeGenerator() does for freshly generated profiles.
+        const winrt::hstring source{ generatorNamespace };
+        std::vector<winrt::com_ptr<implementation::Profile>> cached;
+        cached.reserve(list.size());
+
+        for (const auto& json : list)
+        {
+            auto profile = implementation::Profile::FromJson(json);
+            profile->Origin(OriginTag::Generated);
+            profile->Source(source);
+            cached.emplace_back(std::move(profile));
+        }
+
+        profiles.insert(profiles.end(), std::make_move_iterator(cached.begin()), std::make_move_iterator(cached.end()));
+        return true;
+    }
+    CATCH_LOG()
+
+    return false;
+}
+
+// Replaces the cache entry of the given generator. An empty stamp removes it.
+void GeneratedProfilesCache::Set(const std::wstring_view generatorNamespace, const std::wstring_view stamp, const std::span<const winrt::com_ptr<implementation::Profile>> profiles)
+{
+    const auto generatorNamespaceU8 = til::u16u8(generatorNamespace);
+    auto& generators = _root[JsonKey(GeneratorsKey)];
+
+    if (stamp.empty())
+    {
+        if (generators.isMember(generatorNamespaceU8))
+        {
+            generators.removeMember(generatorNamespaceU8);
+            _dirty = true;
+        }
+        return;
+    }
+
+    Json::Value list{ Json::ValueType::arrayValue };
+    for (const auto& profile : profiles)
+    {
+        list.append(profile->ToJson());
+    }
+
+    Json::Value entry{ Json::ValueType::objectValue };
+    entry[JsonKey(StampKey)] = til::u16u8(stamp);
+    entry[JsonKey(ProfilesKey)] = std::move(list);
+
+    auto& existing = generators[generatorNamespaceU8];
+    if (existing != entry)
+    {
+        existing = std::move(entry);
+        _dirty = true;
+    }
+}
+
+// Writes the cache back to disk, if it was modified since it was read.
+// Errors are only logged, as the cache is merely an optimization.
+void GeneratedProfilesCache::Save()
+{
+    if (!_dirty)
+    {
+        return;
+    }
+
+    try
+    {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        til::io::write_utf8_string_to_file_atomic(_path, Json::writeString(builder, _root));
+        _dirty = false;
+    }
+    CATCH_LOG()
+}
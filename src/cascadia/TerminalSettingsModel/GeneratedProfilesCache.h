@@ -0,0 +1,40 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- GeneratedProfilesCache
+
+Abstract:
+- Persists the profiles of the dynamic profile generators across launches.
+  Some generators spend a considerable amount of time discovering their
+  profiles (enumerating Visual Studio instances, parsing ssh configs, etc.),
+  all before the first window can be shown. If a generator's cache stamp
+  (see IDynamicProfileGenerator::GetCacheStamp) is unchanged since the
+  previous launch, its profiles are loaded from this cache instead.
+- The entire cache is invalidated whenever its key changes. The key covers
+  everything that affects all generators alike, like the application version.
+
+--*/
+
+#pragma once
+
+#include "Profile.h"
+
+namespace winrt::Microsoft::Terminal::Settings::Model
+{
+    class GeneratedProfilesCache
+    {
+    public:
+        GeneratedProfilesCache(std::filesystem::path path, std::wstring_view key);
+
+        bool TryGet(std::wstring_view generatorNamespace, std::wstring_view stamp, std::vector<winrt::com_ptr<implementation::Profile>>& profiles) const;
+        void Set(std::wstring_view generatorNamespace, std::wstring_view stamp, std::span<const winrt::com_ptr<implementation::Profile>> profiles);
+        void Save();
+
+    private:
+        std::filesystem::path _path;
+        Json::Value _root;
+        bool _dirty = false;
+    };
+};
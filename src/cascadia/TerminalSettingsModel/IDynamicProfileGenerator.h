@@ -33,5 +33,14 @@ namespace winrt::Microsoft::Terminal::Settings::Model
         virtual std::wstring_view GetDisplayName() const noexcept = 0;
         virtual std::wstring_view GetIcon() const noexcept = 0;
         virtual void GenerateProfiles(std::vector<winrt::com_ptr<implementation::Profile>>& profiles) const = 0;
+
+        // Returns a string that changes whenever the generated profiles might change, for instance
+        // the last write time of the files the generator reads. It must be much cheaper to compute
+        // than GenerateProfiles(), because the profiles get loaded from the GeneratedProfilesCache
+        // if the stamp is the same as last time. An empty string means the generator must always run.
+        virtual std::wstring GetCacheStamp() const
+        {
+            return {};
+        }
     };
 };
@@ -166,3 +166,31 @@ void SshHostGenerator::GenerateProfiles(std::vector<winrt::com_ptr<implementatio
         }
     }
 }
+
+// Method Description:
+// - Builds the stamp for the GeneratedProfilesCache out of the path to ssh.exe
+//   and the last write times of the two config files.
+// Arguments:
+// - <none>
+// Return Value:
+// - The cache stamp, or an empty string if OpenSSH isn't installed.
+std::wstring SshHostGenerator::GetCacheStamp() const
+{
+    std::wstring stamp;
+    if (!_tryFindSshExePath(stamp))
+    {
+        return {};
+    }
+
+    stamp.push_back(L';');
+
+    for (const auto& path : { SSH_SYSTEM_CONFIG_PATH, SSH_USER_CONFIG_PATH })
+    {
+        // A missing config file leaves the time zeroed, which serves as a stamp just as well.
+        WIN32_FILE_ATTRIBUTE_DATA data{};
+        GetFileAttributesExW(wil::ExpandEnvironmentStringsW<std::wstring>(path.data()).c_str(), GetFileExInfoStandard, &data);
+        AppendCacheStamp(stamp, data.ftLastWriteTime);
+    }
+
+    return stamp;
+}
@@ -27,6 +27,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model
         std::wstring_view GetDisplayName() const noexcept override;
         std::wstring_view GetIcon() const noexcept override;
         void GenerateProfiles(std::vector<winrt::com_ptr<implementation::Profile>>& profiles) const override;
+        std::wstring GetCacheStamp() const override;
 
     private:
         static const std::wregex _configKeyValueRegex;
@@ -12,6 +12,8 @@ using namespace winrt::Microsoft::Terminal::Settings::Model;
 
 std::wstring_view VisualStudioGenerator::Namespace{ L"Windows.Terminal.VisualStudio" };
 static constexpr std::wstring_view IconPath{ L"ms-appx:///ProfileGeneratorIcons/VisualStudio.png" };
+// The Visual Studio Installer maintains a state.json in a subdirectory for each installed instance.
+static constexpr std::wstring_view InstancesPath{ L"%ProgramData%\\Microsoft\\VisualStudio\\Packages\\_Instances" };
 
 std::wstring_view VisualStudioGenerator::GetNamespace() const noexcept
 {
@@ -44,3 +46,30 @@ void VisualStudioGenerator::GenerateProfiles(std::vector<winrt::com_ptr<implemen
         hidden = true;
     }
 }
+
+// Enumerating the instances via COM is slow, but any change to them
+// (installation, update, removal) rewrites their state.json files.
+std::wstring VisualStudioGenerator::GetCacheStamp() const
+{
+    const std::filesystem::path instancesPath{ wil::ExpandEnvironmentStringsW<std::wstring>(InstancesPath.data()) };
+    std::error_code ec;
+    std::filesystem::directory_iterator it{ instancesPath, ec };
+    if (ec)
+    {
+        // Visual Studio isn't installed, in which case GenerateProfiles() is cheap anyway.
+        return {};
+    }
+
+    std::wstring stamp;
+    for (const auto& entry : it)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA data{};
+        if (GetFileAttributesExW((entry.path() / L"state.json").c_str(), GetFileExInfoStandard, &data))
+        {
+            stamp.append(entry.path().filename().native());
+            stamp.push_back(L';');
+            AppendCacheStamp(stamp, data.ftLastWriteTime);
+        }
+    }
+    return stamp;
+}
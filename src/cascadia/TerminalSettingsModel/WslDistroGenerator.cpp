@@ -256,3 +256,49 @@ void WslDistroGenerator::GenerateProfiles(std::vector<winrt::com_ptr<implementat
         }
     }
 }
+
+// Method Description:
+// - Builds the stamp for the GeneratedProfilesCache out of the last write times of the
+//   Lxss key and its subkeys. The former changes whenever a distro gets (un)registered
+//   and the latter whenever a distro gets renamed.
+// Arguments:
+// - <none>
+// Return Value:
+// - The cache stamp, or an empty string if WSL isn't installed.
+std::wstring WslDistroGenerator::GetCacheStamp() const
+{
+    const auto wslRootKey{ openWslRegKey() };
+    if (!wslRootKey)
+    {
+        return {};
+    }
+
+    FILETIME lastWriteTime{};
+    if (RegQueryInfoKeyW(wslRootKey.get(), nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &lastWriteTime) != ERROR_SUCCESS)
+    {
+        return {};
+    }
+
+    // The generated commandlines depend on the OS version as well.
+    std::wstring stamp{ isWslDashDashCdAvailableForLinuxPaths() ? L"cd;" : L";" };
+    AppendCacheStamp(stamp, lastWriteTime);
+
+    wchar_t buffer[39]; // a {GUID} is 38 chars long
+    for (DWORD i = 0;; i++)
+    {
+        DWORD length = 39;
+        const auto result = RegEnumKeyExW(wslRootKey.get(), i, &buffer[0], &length, nullptr, nullptr, nullptr, &lastWriteTime);
+        if (result == ERROR_NO_MORE_ITEMS)
+        {
+            break;
+        }
+
+        // getWslGuids() ignores subkeys that aren't GUIDs, which is what ERROR_MORE_DATA indicates.
+        if (result == ERROR_SUCCESS)
+        {
+            AppendCacheStamp(stamp, lastWriteTime);
+        }
+    }
+
+    return stamp;
+}
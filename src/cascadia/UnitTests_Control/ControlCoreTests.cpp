@@ -48,6 +48,8 @@ namespace ControlUnitTests
 
         TEST_METHOD(TestSimpleClickSelection);
 
+        TEST_METHOD(TestCopyOnlyOffersRequestedFormats);
+
         TEST_CLASS_SETUP(ModuleSetup)
         {
             winrt::init_apartment(winrt::apartment_type::single_threaded);
@@ -810,4 +812,39 @@ namespace ControlUnitTests
         }
         VERIFY_IS_TRUE(gotSelectionUpdate);
     }
+
+    void ControlCoreTests::TestCopyOnlyOffersRequestedFormats()
+    {
+        // The clipboard handler only generates HTML and RTF (on a background thread)
+        // if HasHtml() or HasRtf() return true. Plain text copies must not offer them.
+
+        auto [settings, conn] = _createSettingsAndConnection();
+        Log::Comment(L"Create ControlCore object");
+        auto core = createCore(*settings, *conn);
+        VERIFY_IS_NOT_NULL(core);
+        _standardInit(core);
+
+        conn->WriteInput(winrt_wstring_to_array_view(L"Foo"));
+        core->SelectAll();
+
+        Control::WriteToClipboardEventArgs copied{ nullptr };
+        core->WriteToClipboard([&](auto&& /*sender*/, auto&& args) {
+            copied = args;
+        });
+
+        Log::Comment(L"Copy as plain text");
+        VERIFY_IS_TRUE(core->CopySelectionToClipboard(false, false, Control::CopyFormat::None));
+        VERIFY_IS_NOT_NULL(copied);
+        VERIFY_IS_FALSE(copied.HasHtml());
+        VERIFY_IS_FALSE(copied.HasRtf());
+        VERIFY_ARE_EQUAL(0u, copied.Html().size());
+        VERIFY_ARE_EQUAL(0u, copied.Rtf().size());
+
+        Log::Comment(L"Copy as plain text and HTML");
+        VERIFY_IS_TRUE(core->CopySelectionToClipboard(false, false, Control::CopyFormat::HTML));
+        VERIFY_IS_TRUE(copied.HasHtml());
+        VERIFY_IS_FALSE(copied.HasRtf());
+        VERIFY_ARE_NOT_EQUAL(0u, copied.Html().size());
+        VERIFY_ARE_EQUAL(0u, copied.Rtf().size());
+    }
 }
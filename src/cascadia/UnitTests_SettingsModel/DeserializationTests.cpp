@@ -5,6 +5,7 @@
 
 #include "../TerminalSettingsModel/ColorScheme.h"
 #include "../TerminalSettingsModel/CascadiaSettings.h"
+#include "../TerminalSettingsModel/BinaryJsonCache.h"
 #include "../TerminalSettingsModel/resource.h"
 #include "JsonTestClass.h"
 #include "TestUtils.h"
@@ -68,6 +69,8 @@ namespace SettingsModelUnitTests
 
         TEST_METHOD(MigrateReloadEnvVars);
 
+        TEST_METHOD(BinaryJsonCacheRoundtrip);
+
     private:
         static winrt::com_ptr<implementation::CascadiaSettings> createSettings(const std::string_view& userJSON)
         {
@@ -2328,4 +2331,82 @@ namespace SettingsModelUnitTests
         VERIFY_IS_TRUE(settings->ProfileDefaults().HasReloadEnvironmentVariables());
         VERIFY_IS_FALSE(settings->ProfileDefaults().ReloadEnvironmentVariables());
     }
+
+    void DeserializationTests::BinaryJsonCacheRoundtrip()
+    {
+        static constexpr std::string_view settingsString{ R"({
+            // The default profile
+            "defaultProfile": "{6239a42c-0000-49a3-80bd-e8fdd045185c}",
+            "initialRows": 30,
+            "minimumTabWidth": -1,
+            "opacity": 0.5,
+            "copyOnSelect": true,
+            "startupActions": null,
+            "profiles": [
+                {
+                    "name": "profile\u00e4",
+                    "guid": "{6239a42c-0000-49a3-80bd-e8fdd045185c}",
+                    "historySize": 18446744073709551615
+                }
+            ]
+        })" };
+
+        const auto path = std::filesystem::temp_directory_path() / L"BinaryJsonCacheRoundtrip.bin";
+        const auto cleanup = wil::scope_exit([&]() {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        });
+
+        const auto json = VerifyParseSucceeded(settingsString);
+
+        Log::Comment(L"Decoding must produce the same document, including the comments and offsets");
+        {
+            const auto decoded = BinaryJsonCache::Decode(BinaryJsonCache::Encode(json));
+            VERIFY_ARE_EQUAL(toString(json), toString(decoded));
+            VERIFY_ARE_EQUAL(json["defaultProfile"].getComment(Json::commentBefore), decoded["defaultProfile"].getComment(Json::commentBefore));
+            VERIFY_ARE_EQUAL(json["profiles"][0]["historySize"].getOffsetStart(), decoded["profiles"][0]["historySize"].getOffsetStart());
+            VERIFY_ARE_EQUAL(json["profiles"][0]["historySize"].getOffsetLimit(), decoded["profiles"][0]["historySize"].getOffsetLimit());
+        }
+
+        Log::Comment(L"Malformed data must be rejected");
+        {
+            const auto encoded = BinaryJsonCache::Encode(json);
+            VERIFY_THROWS(BinaryJsonCache::Decode(std::string_view{ encoded }.substr(0, encoded.size() / 2)), wil::ResultException);
+        }
+
+        {
+            BinaryJsonCache cache{ path };
+            VERIFY_IS_FALSE(cache.TryGet(settingsString).has_value());
+            cache.Set(settingsString, json);
+            cache.Save();
+        }
+
+        Log::Comment(L"The cache must survive a roundtrip through the file system");
+        {
+            BinaryJsonCache cache{ path };
+            const auto cached = cache.TryGet(settingsString);
+            VERIFY_IS_TRUE(cached.has_value());
+            VERIFY_ARE_EQUAL(toString(json), toString(*cached));
+
+            std::string modified{ settingsString };
+            modified.back() = ' ';
+            VERIFY_IS_FALSE(cache.TryGet(modified).has_value());
+        }
+
+        Log::Comment(L"SettingsLoader must produce the same result with and without a warm cache");
+        {
+            BinaryJsonCache cache{ path };
+            implementation::SettingsLoader cold{ settingsString, implementation::LoadStringResource(IDR_DEFAULTS), &cache };
+            cold.FinalizeLayering();
+            cache.Save();
+
+            BinaryJsonCache warmCache{ path };
+            implementation::SettingsLoader warm{ settingsString, implementation::LoadStringResource(IDR_DEFAULTS), &warmCache };
+            warm.FinalizeLayering();
+
+            const auto coldSettings = winrt::make_self<implementation::CascadiaSettings>(std::move(cold));
+            const auto warmSettings = winrt::make_self<implementation::CascadiaSettings>(std::move(warm));
+            VERIFY_ARE_EQUAL(toString(coldSettings->ToJson()), toString(warmSettings->ToJson()));
+        }
+    }
 }
@@ -6,6 +6,7 @@
 #include "../TerminalSettingsModel/ColorScheme.h"
 #include "../TerminalSettingsModel/CascadiaSettings.h"
 #include "../TerminalSettingsModel/ActionMap.h"
+#include "../TerminalSettingsModel/resource.h"
 #include "JsonTestClass.h"
 #include "TestUtils.h"
 
@@ -40,6 +41,11 @@ namespace SettingsModelUnitTests
         TEST_METHOD(TestMoveTabArgs);
         TEST_METHOD(TestGetKeyBindingForAction);
         TEST_METHOD(KeybindingsWithoutVkey);
+        TEST_METHOD(DispatchTableMatchesLayers);
+
+        BEGIN_TEST_METHOD(DispatchTableBenchmark)
+            TEST_METHOD_PROPERTY(L"Ignore", L"true")
+        END_TEST_METHOD()
     };
 
     void KeyBindingsTests::KeyChords()
@@ -808,4 +814,102 @@ namespace SettingsModelUnitTests
         const auto action = actionMap->GetActionByKeyChord({ VirtualKeyModifiers::Shift, 0, 255 });
         VERIFY_IS_NOT_NULL(action);
     }
+
+    void KeyBindingsTests::DispatchTableMatchesLayers()
+    {
+        const auto parentJson = VerifyParseSucceeded(R"!([
+            { "command": "copy", "id": "Test.Copy", "keys": "ctrl+c" },
+            { "command": "paste", "id": "Test.Paste", "keys": "ctrl+v" },
+            { "command": "newTab", "id": "Test.NewTab", "keys": "ctrl+t" },
+            { "command": "quakeMode", "id": "Test.NoVKey", "keys": "shift+sc(255)" }
+        ])!");
+        const auto childJson = VerifyParseSucceeded(R"!([
+            { "command": "closePane", "id": "Test.ClosePane", "keys": "ctrl+c" },
+            { "command": "unbound", "keys": "ctrl+v" },
+            { "keys": "ctrl+d", "id": "Test.Missing" },
+            { "keys": "ctrl+shift+t", "id": "Test.NewTab" }
+        ])!");
+
+        const std::array keyChords{
+            KeyChord{ VirtualKeyModifiers::Control, static_cast<int32_t>('C'), 0 },
+            KeyChord{ VirtualKeyModifiers::Control, static_cast<int32_t>('V'), 0 },
+            KeyChord{ VirtualKeyModifiers::Control, static_cast<int32_t>('T'), 0 },
+            KeyChord{ VirtualKeyModifiers::Control, static_cast<int32_t>('D'), 0 },
+            KeyChord{ VirtualKeyModifiers::Control | VirtualKeyModifiers::Shift, static_cast<int32_t>('T'), 0 },
+            KeyChord{ VirtualKeyModifiers::Shift, 0, 255 },
+            KeyChord{ VirtualKeyModifiers::Control, static_cast<int32_t>('X'), 0 },
+        };
+        const auto& ctrlShiftT = til::at(keyChords, 4);
+
+        const auto parent = winrt::make_self<implementation::ActionMap>();
+        parent->LayerJson(parentJson, OriginTag::InBox);
+        const auto child = winrt::make_self<implementation::ActionMap>();
+        child->LayerJson(childJson, OriginTag::User);
+        child->AddLeastImportantParent(parent);
+        child->_FinalizeInheritance();
+
+        Log::Comment(L"Finalizing the inheritance should build the dispatch table");
+        VERIFY_IS_TRUE(child->_KeyChordDispatchTable.has_value());
+        VERIFY_IS_NOT_NULL(child->GetActionByKeyChord(ctrlShiftT));
+
+        Log::Comment(L"Modifying the ActionMap should reset it");
+        child->DeleteKeyBinding(ctrlShiftT);
+        VERIFY_IS_FALSE(child->_KeyChordDispatchTable.has_value());
+        VERIFY_IS_NULL(child->GetActionByKeyChord(ctrlShiftT));
+
+        Log::Comment(L"The dispatch table should return the same results as walking the layers");
+        child->_RefreshKeyBindingCaches();
+        VERIFY_IS_TRUE(child->_KeyChordDispatchTable.has_value());
+
+        const auto table = std::move(*child->_KeyChordDispatchTable);
+        child->_KeyChordDispatchTable.reset();
+
+        for (const auto& keys : keyChords)
+        {
+            const auto expected = child->_GetActionByKeyChordInternal(keys);
+            const auto actual = table.Lookup(keys);
+            VERIFY_ARE_EQUAL(expected.has_value(), actual.has_value());
+            if (expected)
+            {
+                VERIFY_IS_TRUE(*expected == *actual);
+            }
+        }
+    }
+
+    void KeyBindingsTests::DispatchTableBenchmark()
+    {
+        const auto settings = winrt::make_self<implementation::CascadiaSettings>(std::string_view{ "{}" }, implementation::LoadStringResource(IDR_DEFAULTS));
+        const auto actionMap = winrt::get_self<implementation::ActionMap>(settings->GlobalSettings().ActionMap());
+
+        // Typing mostly consists of key chords that aren't bound to anything,
+        // which is the worst case when walking the layers.
+        std::vector<KeyChord> keyChords;
+        for (int32_t vkey = 'A'; vkey <= 'Z'; ++vkey)
+        {
+            keyChords.emplace_back(VirtualKeyModifiers::None, vkey, 0);
+            keyChords.emplace_back(VirtualKeyModifiers::Control | VirtualKeyModifiers::Shift, vkey, 0);
+        }
+
+        static constexpr size_t iterations = 10000;
+        const auto measure = [&](const wchar_t* name) {
+            const auto beg = std::chrono::steady_clock::now();
+            size_t hits = 0;
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                for (const auto& keys : keyChords)
+                {
+                    hits += static_cast<bool>(actionMap->GetActionByKeyChord(keys));
+                }
+            }
+            const auto end = std::chrono::steady_clock::now();
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - beg).count();
+            Log::Comment(NoThrowString().Format(L"%s: %lldns per lookup, %zu hits", name, ns / static_cast<long long>(iterations * keyChords.size()), hits));
+        };
+
+        VERIFY_IS_TRUE(actionMap->_KeyChordDispatchTable.has_value());
+        measure(L"dispatch table");
+
+        actionMap->_KeyChordDispatchTable.reset();
+        measure(L"layers");
+    }
 }
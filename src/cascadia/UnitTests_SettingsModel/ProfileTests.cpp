@@ -5,6 +5,7 @@
 
 #include "../TerminalSettingsModel/ColorScheme.h"
 #include "../TerminalSettingsModel/CascadiaSettings.h"
+#include "../TerminalSettingsModel/GeneratedProfilesCache.h"
 #include "../TerminalSettingsModel/resource.h"
 #include "JsonTestClass.h"
 
@@ -31,6 +32,7 @@ namespace SettingsModelUnitTests
         TEST_METHOD(TestGenGuidsForProfiles);
         TEST_METHOD(TestCorrectOldDefaultShellPaths);
         TEST_METHOD(ProfileDefaultsProhibitedSettings);
+        TEST_METHOD(GeneratedProfilesCacheRoundtrip);
     };
 
     void ProfileTests::ProfileGeneratesGuid()
@@ -532,4 +534,55 @@ namespace SettingsModelUnitTests
         VERIFY_ARE_NOT_EQUAL(L"Default Profile Source", allProfiles.GetAt(2).Source());
         VERIFY_ARE_NOT_EQUAL(L"foo.exe", allProfiles.GetAt(2).Commandline());
     }
+
+    void ProfileTests::GeneratedProfilesCacheRoundtrip()
+    {
+        static constexpr std::wstring_view generatorNamespace{ L"Windows.Terminal.Test" };
+
+        const auto path = std::filesystem::temp_directory_path() / L"GeneratedProfilesCacheRoundtrip.json";
+        const auto cleanup = wil::scope_exit([&]() {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        });
+
+        {
+            auto profile = implementation::Profile::FromJson(VerifyParseSucceeded(R"({
+                "name": "Generated",
+                "guid": "{6239a42c-1111-49a3-80bd-e8fdd045185c}",
+                "commandline": "generated.exe",
+                "hidden": true
+            })"));
+            const std::vector profiles{ profile };
+
+            GeneratedProfilesCache cache{ path, L"key" };
+            cache.Set(generatorNamespace, L"stamp", profiles);
+            cache.Save();
+        }
+
+        {
+            const GeneratedProfilesCache cache{ path, L"key" };
+            std::vector<winrt::com_ptr<implementation::Profile>> profiles;
+
+            VERIFY_IS_FALSE(cache.TryGet(generatorNamespace, L"other stamp", profiles));
+            VERIFY_IS_FALSE(cache.TryGet(generatorNamespace, L"", profiles));
+            VERIFY_IS_FALSE(cache.TryGet(L"Windows.Terminal.Other", L"stamp", profiles));
+            VERIFY_ARE_EQUAL(0u, profiles.size());
+
+            VERIFY_IS_TRUE(cache.TryGet(generatorNamespace, L"stamp", profiles));
+            VERIFY_ARE_EQUAL(1u, profiles.size());
+            VERIFY_ARE_EQUAL(L"Generated", profiles[0]->Name());
+            VERIFY_ARE_EQUAL(Utils::GuidFromString(L"{6239a42c-1111-49a3-80bd-e8fdd045185c}"), static_cast<GUID>(profiles[0]->Guid()));
+            VERIFY_ARE_EQUAL(L"generated.exe", profiles[0]->Commandline());
+            VERIFY_IS_TRUE(profiles[0]->Hidden());
+            VERIFY_ARE_EQUAL(L"Windows.Terminal.Test", profiles[0]->Source());
+            VERIFY_ARE_EQUAL(OriginTag::Generated, profiles[0]->Origin());
+        }
+
+        {
+            // A different key invalidates all entries.
+            const GeneratedProfilesCache cache{ path, L"other key" };
+            std::vector<winrt::com_ptr<implementation::Profile>> profiles;
+            VERIFY_IS_FALSE(cache.TryGet(generatorNamespace, L"stamp", profiles));
+        }
+    }
 }
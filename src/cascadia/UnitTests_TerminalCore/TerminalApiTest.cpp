@@ -41,6 +41,8 @@ namespace TerminalCoreUnitTests
 
         TEST_METHOD(SetTaskbarProgress);
         TEST_METHOD(SetWorkingDirectory);
+
+        TEST_METHOD(LockStatistics);
     };
 };
 
@@ -477,3 +479,42 @@ void TerminalCoreUnitTests::TerminalApiTest::SetWorkingDirectory()
     stateMachine.ProcessString(L"\x1b]9;9;D:\\中文\x1b\\");
     VERIFY_ARE_EQUAL(term.GetWorkingDirectory(), L"D:\\中文");
 }
+
+void TerminalApiTest::LockStatistics()
+{
+    Terminal term{ Terminal::TestDummyMarker{} };
+    DummyRenderer renderer{ &term };
+    term.Create({ 100, 100 }, 0, renderer);
+
+    // Acquiring the lock here counts as a reader once it's released at the end of the lambda.
+    const auto before = [&]() {
+        const auto lock = term.LockForReading();
+        return term.GetLockStatistics();
+    }();
+
+    {
+        const auto lock = term.LockForReading();
+        // Recursive acquisitions are attributed to the outermost holder.
+        const auto inner = term.LockForWriting();
+    }
+    {
+        const auto lock = term.LockForWriting();
+    }
+    term.LockConsole();
+    term.UnlockConsole();
+    {
+        // Whoever takes the lock while it's suspended is counted separately,
+        // and the suspended holder is still counted as a reader afterwards.
+        const auto lock = term.LockForReading();
+        {
+            const auto suspension = term.SuspendLock();
+            std::thread{ [&]() { const auto lock = term.LockForWriting(); } }.join();
+        }
+    }
+
+    const auto lock = term.LockForWriting();
+    const auto after = term.GetLockStatistics();
+    VERIFY_ARE_EQUAL(before.readers.count + 4, after.readers.count);
+    VERIFY_ARE_EQUAL(before.writers.count + 2, after.writers.count);
+    VERIFY_IS_TRUE(after.readers.max <= after.readers.total);
+}
@@ -500,6 +500,7 @@ void WindowEmperor::HandleCommandlineArgs(int nCmdShow)
     }
 
     _finalizeSessionPersistence();
+    CascadiaSettings::CancelBackgroundTasks();
 
     if (_notificationIconShown)
     {
@@ -67,6 +67,11 @@ namespace TerminalAppUnitTests
         TEST_METHOD(SurrogatePair_ToUtf16Pos_ConsecutiveChars);
         TEST_METHOD(SurrogatePair_ToUtf16Pos_PreferConsecutiveChars);
         TEST_METHOD(SurrogatePair_ToUtf16Pos_GapAndBoundary);
+        TEST_METHOD(MatchAllMatchesEachHaystack);
+
+        BEGIN_TEST_METHOD(MatchAllBenchmark)
+            TEST_METHOD_PROPERTY(L"Ignore", L"true")
+        END_TEST_METHOD()
     };
 
     void AssertScoreAndRuns(std::wstring_view patternText, std::wstring_view text, int expectedScore, const std::vector<fzf::matcher::TextRun>& expectedRuns)
@@ -74,6 +79,15 @@ namespace TerminalAppUnitTests
         const auto pattern = fzf::matcher::ParsePattern(patternText);
         const auto match = fzf::matcher::Match(text, pattern);
 
+        // Matching a prepared haystack must yield the exact same result.
+        const auto prepared = fzf::matcher::Match(fzf::matcher::PrepareHaystack(text), pattern);
+        VERIFY_ARE_EQUAL(match.has_value(), prepared.has_value());
+        if (match)
+        {
+            VERIFY_ARE_EQUAL(match->Score, prepared->Score);
+            VERIFY_ARE_EQUAL(match->Runs.size(), prepared->Runs.size());
+        }
+
         if (expectedScore == 0 && expectedRuns.empty())
         {
             VERIFY_ARE_EQUAL(std::nullopt, match);
@@ -565,4 +579,146 @@ namespace TerminalAppUnitTests
 
         VERIFY_IS_GREATER_THAN(consecutiveScore, gapScore);
     }
+
+    // Generates haystacks like "Snippet 123: git checkout -b feature/abc-123".
+    static std::vector<std::wstring> generateHaystacks(const size_t count)
+    {
+        static constexpr std::wstring_view commands[]{ L"git checkout -b", L"git commit -m", L"docker compose up", L"kubectl get pods -n", L"Get-ChildItem -Recurse", L"ssh -L 8080:localhost:80" };
+        static constexpr std::wstring_view words[]{ L"feature", L"Release", L"hotfix", L"\u00e9cole", L"\u03bb\u03cc\u03b3\u03bf\u03c2", L"main", L"staging" };
+
+        std::vector<std::wstring> haystacks;
+        haystacks.reserve(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::wstring text{ L"Snippet " };
+            text.append(std::to_wstring(i));
+            text.append(L": ");
+            text.append(commands[i % std::size(commands)]);
+            text.push_back(L' ');
+            text.append(words[(i / 7) % std::size(words)]);
+            text.push_back(L'/');
+            text.append(words[(i / 3) % std::size(words)]);
+            text.push_back(L'-');
+            text.append(std::to_wstring(i * 7919 % 1000));
+            haystacks.emplace_back(std::move(text));
+        }
+
+        return haystacks;
+    }
+
+    void FzfTests::MatchAllMatchesEachHaystack()
+    {
+        // Enough haystacks to be split across multiple threads.
+        const auto texts = generateHaystacks(5000);
+        std::vector<fzf::matcher::Haystack> haystacks;
+        std::vector<const fzf::matcher::Haystack*> pointers;
+        haystacks.reserve(texts.size());
+        pointers.reserve(texts.size());
+
+        for (const auto& text : texts)
+        {
+            pointers.emplace_back(&haystacks.emplace_back(fzf::matcher::PrepareHaystack(text)));
+        }
+
+        // The expected values were recorded with the matcher before MatchAll() and PrepareHaystack() existed.
+        struct Expected
+        {
+            std::wstring_view pattern;
+            size_t matches;
+            int64_t scoreSum;
+            size_t sampleIndex;
+            int32_t sampleScore;
+        };
+        static constexpr Expected expectations[]{
+            { L"", 5000, 0, 4999, 0 },
+            { L"git", 2756, 201253, 42, 80 },
+            { L"sn 42 fea", 252, 42043, 4242, 192 },
+            { L"\u00c9COLE", 1326, 169728, 9, 128 },
+            { L"zzz", 0, 0, 0, 0 },
+        };
+
+        for (const auto& expected : expectations)
+        {
+            const auto pattern = fzf::matcher::ParsePattern(expected.pattern);
+            const auto results = fzf::matcher::MatchAll(pointers, pattern);
+            VERIFY_ARE_EQUAL(texts.size(), results.size());
+
+            size_t matches = 0;
+            int64_t scoreSum = 0;
+            for (const auto& result : results)
+            {
+                if (result)
+                {
+                    matches++;
+                    scoreSum += result->Score;
+                }
+            }
+
+            VERIFY_ARE_EQUAL(expected.matches, matches);
+            VERIFY_ARE_EQUAL(expected.scoreSum, scoreSum);
+
+            if (expected.matches)
+            {
+                const auto& sample = results[expected.sampleIndex];
+                VERIFY_IS_TRUE(sample.has_value());
+                VERIFY_ARE_EQUAL(expected.sampleScore, sample->Score);
+            }
+        }
+    }
+
+    // Simulates typing queries into a palette with 10k entries. Run it with /runIgnoredTests.
+    void FzfTests::MatchAllBenchmark()
+    {
+        const auto texts = generateHaystacks(10000);
+        static constexpr std::wstring_view queries[]{ L"g", L"gi", L"git", L"git ", L"git c", L"git co", L"git com", L"git comm", L"git commi", L"git commit", L"git commit h", L"git commit ho" };
+
+        const auto measure = [](const wchar_t* name, auto&& func) {
+            const auto beg = std::chrono::steady_clock::now();
+            size_t matches = 0;
+            for (const auto query : queries)
+            {
+                matches += func(fzf::matcher::ParsePattern(query));
+            }
+            const auto end = std::chrono::steady_clock::now();
+            const auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - beg).count();
+            Log::Comment(NoThrowString().Format(L"%s: %lldus per query, %zu matches", name, us / static_cast<long long>(std::size(queries)), matches));
+        };
+
+        measure(L"Match(text)", [&](const fzf::matcher::Pattern& pattern) {
+            size_t matches = 0;
+            for (const auto& text : texts)
+            {
+                matches += fzf::matcher::Match(text, pattern).has_value();
+            }
+            return matches;
+        });
+
+        std::vector<fzf::matcher::Haystack> haystacks;
+        std::vector<const fzf::matcher::Haystack*> pointers;
+        haystacks.reserve(texts.size());
+        pointers.reserve(texts.size());
+        for (const auto& text : texts)
+        {
+            pointers.emplace_back(&haystacks.emplace_back(fzf::matcher::PrepareHaystack(text)));
+        }
+
+        measure(L"Match(haystack)", [&](const fzf::matcher::Pattern& pattern) {
+            size_t matches = 0;
+            for (const auto& haystack : haystacks)
+            {
+                matches += fzf::matcher::Match(haystack, pattern).has_value();
+            }
+            return matches;
+        });
+
+        measure(L"MatchAll", [&](const fzf::matcher::Pattern& pattern) {
+            size_t matches = 0;
+            for (const auto& result : fzf::matcher::MatchAll(pointers, pattern))
+            {
+                matches += result.has_value();
+            }
+            return matches;
+        });
+    }
 }
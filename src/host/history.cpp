@@ -20,6 +20,8 @@
 
 #include "../interactivity/inc/ServiceLocator.hpp"
 
+#include <til/hash.h>
+
 #pragma hdrstop
 
 using Microsoft::Console::Interactivity::ServiceLocator;
@@ -78,6 +80,20 @@ bool CommandHistory::IsAppNameMatch(const std::wstring_view other) const
     return CompareStringOrdinal(_appName.data(), gsl::narrow<int>(_appName.size()), other.data(), gsl::narrow<int>(other.size()), TRUE) == CSTR_EQUAL;
 }
 
+CommandHistory::IndexEntry CommandHistory::_MakeIndexEntry(const std::wstring_view command) noexcept
+{
+    IndexEntry entry;
+    entry.hash = til::hash(command);
+
+    const auto count = std::min<size_t>(command.size(), 4);
+    for (size_t i = 0; i < count; ++i)
+    {
+        entry.prefix |= static_cast<uint64_t>(til::at(command, i)) << (16 * i);
+    }
+
+    return entry;
+}
+
 // Routine Description:
 // - This routine is called when escape is entered or a command is added.
 void CommandHistory::_Reset()
@@ -121,20 +137,27 @@ void CommandHistory::_Reset()
             if (GetNumberOfCommands() == _maxCommands)
             {
                 _commands.erase(_commands.cbegin());
+                _index.erase(_index.cbegin());
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
                 --LastDisplayed;
             }
 
-            // add newCommand to array
+            // add newCommand to array. _index must stay in sync with _commands,
+            // so undo its emplace_back() if the one for _commands throws.
+            _index.emplace_back(_MakeIndexEntry(newCommand));
+            auto popIndex = wil::scope_exit([&]() noexcept {
+                _index.pop_back();
+            });
             if (!reuse.empty())
             {
-                _commands.emplace_back(reuse);
+                _commands.emplace_back(std::move(reuse));
             }
             else
             {
                 _commands.emplace_back(newCommand);
             }
+            popIndex.release();
 
             if (LastDisplayed == -1 ||
                 _commands.at(LastDisplayed).size() != newCommand.size() ||
@@ -211,6 +234,7 @@ std::wstring_view CommandHistory::GetLastCommand() const
 void CommandHistory::Empty()
 {
     _commands.clear();
+    _index.clear();
     LastDisplayed = -1;
     WI_SetFlag(Flags, CLE_RESET);
 }
@@ -244,6 +268,7 @@ void CommandHistory::Realloc(const Index commands)
     }
 
     _commands.resize(std::min(_commands.size(), gsl::narrow_cast<size_t>(std::max(0, commands))));
+    _index.resize(_commands.size());
 
     WI_SetFlag(Flags, CLE_RESET);
     LastDisplayed = GetNumberOfCommands() - 1;
@@ -349,6 +374,7 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         if (!SameApp)
         {
             BestCandidate->_commands.clear();
+            BestCandidate->_index.clear();
             BestCandidate->LastDisplayed = -1;
             BestCandidate->_appName = appName;
         }
@@ -414,6 +440,7 @@ std::wstring CommandHistory::Remove(const Index iDel)
 
     const auto str = std::move(_commands.at(iDel));
     _commands.erase(_commands.begin() + iDel);
+    _index.erase(_index.begin() + iDel);
 
     if (LastDisplayed == iDel)
     {
@@ -457,14 +484,25 @@ std::wstring CommandHistory::Remove(const Index iDel)
 
     try
     {
+        const auto exactMatch = WI_IsFlagSet(options, MatchOptions::ExactMatch);
+        const auto given = _MakeIndexEntry(givenCommand);
+        // Only the first min(4, givenCommand.size()) code units of the prefix are compared.
+        const auto prefixMask = givenCommand.size() >= 4 ? UINT64_MAX : (UINT64_C(1) << (16 * givenCommand.size())) - 1;
+
         for (size_t i = 0; i < _commands.size(); i++)
         {
-            const auto& storedCommand = _commands.at(indexFound);
-            if ((WI_IsFlagClear(options, MatchOptions::ExactMatch) && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
+            const auto& entry = _index.at(indexFound);
+            const auto candidate = exactMatch ? entry.hash == given.hash : ((entry.prefix ^ given.prefix) & prefixMask) == 0;
+
+            if (candidate)
             {
-                if (til::starts_with(storedCommand, givenCommand))
+                const auto& storedCommand = _commands.at(indexFound);
+                if ((!exactMatch && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
                 {
-                    return true;
+                    if (til::starts_with(storedCommand, givenCommand))
+                    {
+                        return true;
+                    }
                 }
             }
 
@@ -496,6 +534,7 @@ void CommandHistory::Swap(const Index indexA, const Index indexB)
         indexB >= 0 && indexB < num)
     {
         std::swap(_commands.at(indexA), _commands.at(indexB));
+        std::swap(_index.at(indexA), _index.at(indexB));
     }
 }
 
@@ -63,6 +63,18 @@ public:
     void Swap(const Index indexA, const Index indexB);
 
 private:
+    // A compact, contiguous summary of each entry in _commands, kept at the same indices.
+    // Searching the history compares these first and only touches the actual strings
+    // on a likely hit, which avoids chasing one heap pointer per entry during a scan.
+    struct IndexEntry
+    {
+        // til::hash of the entire command. Used for exact matches (duplicate suppression).
+        size_t hash = 0;
+        // The first 4 UTF-16 code units of the command, zero padded. Used for prefix matches (F8).
+        uint64_t prefix = 0;
+    };
+
+    static IndexEntry _MakeIndexEntry(std::wstring_view command) noexcept;
     void _Reset();
 
     // _Next and _Prev go to the next and prev command
@@ -76,6 +88,7 @@ private:
     // NOTE: In conhost v1 this used to be a circular buffer because removal at the
     // start is a very common operation. It seems this was lost in the C++ refactor.
     std::vector<std::wstring> _commands;
+    std::vector<IndexEntry> _index;
     Index _maxCommands = 0;
 
     std::wstring _appName;
@@ -17,6 +17,181 @@ using Microsoft::Console::Interactivity::ServiceLocator;
 using Microsoft::Console::VirtualTerminal::TerminalInput;
 using namespace Microsoft::Console;
 
+bool InputStorage::empty() const noexcept
+{
+    return _size == 0;
+}
+
+size_t InputStorage::size() const noexcept
+{
+    return _size;
+}
+
+void InputStorage::clear() noexcept
+{
+    _chunks.clear();
+    _size = 0;
+}
+
+void InputStorage::push_back(const INPUT_RECORD& record)
+{
+    _writableChunk(false).records.push_back(record);
+    _size++;
+}
+
+void InputStorage::append(std::wstring_view text)
+{
+    while (!text.empty())
+    {
+        auto& chunk = _writableChunk(true);
+        const auto count = std::min(text.size(), ChunkCapacity - chunk.text.size());
+        chunk.text.append(text.substr(0, count));
+        text = text.substr(count);
+        _size += count;
+    }
+}
+
+void InputStorage::append(InputStorage&& other)
+{
+    for (auto& chunk : other._chunks)
+    {
+        _chunks.emplace_back(std::move(chunk));
+    }
+    _size += other._size;
+    other.clear();
+}
+
+// Removes the first `count` records (or characters) from the storage.
+void InputStorage::pop_front(size_t count) noexcept
+{
+    count = std::min(count, _size);
+    _size -= count;
+
+    while (count != 0)
+    {
+        auto& chunk = _chunks.front();
+        const auto available = chunk.end() - chunk.offset;
+
+        if (count < available)
+        {
+            chunk.offset += count;
+            break;
+        }
+
+        count -= available;
+        _chunks.pop_front();
+    }
+}
+
+INPUT_RECORD InputStorage::front() const
+{
+    return operator[](0);
+}
+
+INPUT_RECORD InputStorage::back() const
+{
+    return operator[](_size - 1);
+}
+
+INPUT_RECORD InputStorage::operator[](size_t index) const
+{
+    THROW_HR_IF(E_BOUNDS, index >= _size);
+
+    for (const auto& chunk : _chunks)
+    {
+        const auto available = chunk.end() - chunk.offset;
+        if (index < available)
+        {
+            return chunk.at(chunk.offset + index);
+        }
+        index -= available;
+    }
+
+    THROW_HR(E_UNEXPECTED);
+}
+
+INPUT_RECORD* InputStorage::frontRecord() noexcept
+{
+    if (_chunks.empty() || _chunks.front().isText)
+    {
+        return nullptr;
+    }
+    auto& chunk = _chunks.front();
+    return &chunk.records[chunk.offset];
+}
+
+INPUT_RECORD* InputStorage::backRecord() noexcept
+{
+    if (_chunks.empty() || _chunks.back().isText)
+    {
+        return nullptr;
+    }
+    return &_chunks.back().records.back();
+}
+
+std::wstring_view InputStorage::frontText() const noexcept
+{
+    if (_chunks.empty() || !_chunks.front().isText)
+    {
+        return {};
+    }
+    const auto& chunk = _chunks.front();
+    return std::wstring_view{ chunk.text }.substr(chunk.offset);
+}
+
+// Text runs only consist of key events, so they're left untouched.
+void InputStorage::removeNonKeyRecords()
+{
+    for (auto it = _chunks.begin(); it != _chunks.end();)
+    {
+        if (!it->isText)
+        {
+            auto& records = it->records;
+            const auto beg = records.begin() + gsl::narrow_cast<ptrdiff_t>(it->offset);
+            const auto newEnd = std::remove_if(beg, records.end(), [](const INPUT_RECORD& event) {
+                return event.EventType != KEY_EVENT;
+            });
+            _size -= gsl::narrow_cast<size_t>(records.end() - newEnd);
+            records.erase(newEnd, records.end());
+
+            if (records.size() == it->offset)
+            {
+                it = _chunks.erase(it);
+                continue;
+            }
+        }
+        ++it;
+    }
+}
+
+size_t InputStorage::Chunk::end() const noexcept
+{
+    return isText ? text.size() : records.size();
+}
+
+INPUT_RECORD InputStorage::Chunk::at(size_t index) const noexcept
+{
+    return isText ? SynthesizeKeyEvent(true, 1, 0, 0, til::at(text, index), 0) : til::at(records, index);
+}
+
+// Returns the chunk at the end of the storage if it's of the given kind and has space left,
+// or appends a new chunk otherwise.
+InputStorage::Chunk& InputStorage::_writableChunk(bool isText)
+{
+    if (!_chunks.empty())
+    {
+        auto& chunk = _chunks.back();
+        if (chunk.isText == isText && chunk.end() < ChunkCapacity)
+        {
+            return chunk;
+        }
+    }
+
+    auto& chunk = _chunks.emplace_back();
+    chunk.isText = isText;
+    return chunk;
+}
+
 // Routine Description:
 // - This method creates an input buffer.
 // Arguments:
@@ -216,6 +391,67 @@ void InputBuffer::Cache(bool isUnicode, InputEventQueue& source, size_t expected
     }
 }
 
+// Returns the plain text run at the front of the input buffer, if any. This allows ReadConsole to
+// consume pasted text in bulk instead of going through INPUT_RECORDs one character at a time.
+// The result is empty if the buffer doesn't start with text or if events are still cached.
+std::wstring_view InputBuffer::PeekText() const noexcept
+{
+    if (!_cachedInputEvents.empty())
+    {
+        return {};
+    }
+    return _storage.frontText();
+}
+
+// Removes `count` characters previously returned by PeekText().
+void InputBuffer::DiscardText(size_t count)
+{
+    assert(count <= PeekText().size());
+
+    _storage.pop_front(count);
+
+    if (_storage.empty())
+    {
+        ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+    }
+}
+
+// Same as `Consume`, but the source is the plain text run at the front of the input buffer.
+// Returns true if any input was consumed, which may be nothing but a skipped linefeed.
+// If it returns false the caller needs to fall back to Read().
+bool InputBuffer::ConsumeText(bool isUnicode, std::span<char>& target)
+{
+    auto text = PeekText();
+    if (text.empty())
+    {
+        return false;
+    }
+
+    // GetChar() ignores linefeeds outside of VT input mode and so do we.
+    // We only consume up to the next linefeed here and skip it afterwards.
+    const auto vtInputMode = IsInVirtualTerminalInputMode();
+    if (!vtInputMode)
+    {
+        text = text.substr(0, text.find(UNICODE_LINEFEED));
+    }
+
+    auto remaining = text;
+    Consume(isUnicode, remaining, target);
+    auto consumed = text.size() - remaining.size();
+
+    if (!vtInputMode && remaining.empty())
+    {
+        const auto rest = PeekText().substr(consumed);
+        if (!rest.empty() && rest.front() == UNICODE_LINEFEED)
+        {
+            consumed++;
+        }
+    }
+
+    DiscardText(consumed);
+    return consumed != 0;
+}
+
 void InputBuffer::_switchReadingMode(ReadingMode mode)
 {
     if (_readingMode != mode)
@@ -346,10 +582,7 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const INPUT_RECORD& event) {
-        return event.EventType != KEY_EVENT;
-    });
-    _storage.erase(newEnd, _storage.end());
+    _storage.removeNonKeyRecords();
 }
 
 // Routine Description:
@@ -390,14 +623,18 @@ try
         ConsumeCached(Unicode, AmountToRead, OutEvents);
     }
 
-    auto it = _storage.begin();
-    const auto end = _storage.end();
+    size_t consumed = 0;
+    WORD remainingRepeat = 0;
 
-    while (it != end && OutEvents.size() < AmountToRead)
-    {
-        if (it->EventType == KEY_EVENT)
+    _storage.visit([&](const INPUT_RECORD& record) {
+        if (OutEvents.size() >= AmountToRead)
         {
-            auto event = *it;
+            return false;
+        }
+
+        if (record.EventType == KEY_EVENT)
+        {
+            auto event = record;
             WORD repeat = 1;
 
             // for stream reads we need to split any key events that have been coalesced
@@ -440,21 +677,28 @@ try
 
             if (repeat && !Peek)
             {
-                it->Event.KeyEvent.wRepeatCount = repeat;
-                break;
+                remainingRepeat = repeat;
+                return false;
             }
         }
         else
         {
-            OutEvents.push_back(*it);
+            OutEvents.push_back(record);
         }
 
-        ++it;
-    }
+        consumed++;
+        return true;
+    });
 
     if (!Peek)
     {
-        _storage.erase(_storage.begin(), it);
+        _storage.pop_front(consumed);
+
+        // Only INPUT_RECORD chunks can hold key events with a repeat count above 1.
+        if (remainingRepeat)
+        {
+            _storage.frontRecord()->Event.KeyEvent.wRepeatCount = remainingRepeat;
+        }
     }
 
     Cache(Unicode, OutEvents, AmountToRead);
@@ -499,17 +743,14 @@ size_t InputBuffer::Prepend(const std::span<const INPUT_RECORD>& inEvents)
         // this way to handle any coalescing that might occur.
 
         // get all of the existing records, "emptying" the buffer
-        std::deque<INPUT_RECORD> existingStorage;
-        existingStorage.swap(_storage);
+        auto existingStorage = std::move(_storage);
+        _storage.clear();
 
         // write the prepend records
         size_t prependEventsWritten;
         _WriteBuffer(inEvents, prependEventsWritten);
 
-        for (const auto& event : existingStorage)
-        {
-            _storage.push_back(event);
-        }
+        _storage.append(std::move(existingStorage));
 
         return prependEventsWritten;
     }
@@ -746,7 +987,14 @@ void InputBuffer::_WriteBuffer(const std::span<const INPUT_RECORD>& inEvents, _O
 // redundant/out of date with the most current state).
 bool InputBuffer::_CoalesceEvent(const INPUT_RECORD& inEvent) noexcept
 {
-    auto& lastEvent = _storage.back();
+    // Text runs aren't coalesced with individual records.
+    const auto lastRecord = _storage.backRecord();
+    if (!lastRecord)
+    {
+        return false;
+    }
+
+    auto& lastEvent = *lastRecord;
 
     if (lastEvent.EventType == MOUSE_EVENT && inEvent.EventType == MOUSE_EVENT)
     {
@@ -791,11 +1039,19 @@ bool InputBuffer::IsInVirtualTerminalInputMode() const
     return WI_IsFlagSet(InputMode, ENABLE_VIRTUAL_TERMINAL_INPUT);
 }
 
+// Plain text is stored as-is and only expanded into key down events if a reader asks for INPUT_RECORDs.
+// Null characters are the only exception, as they need to be converted into a key event with a proper control state.
 void InputBuffer::_writeString(const std::wstring_view& text)
 {
-    for (const auto& wch : text)
+    auto remaining = text;
+
+    while (!remaining.empty())
     {
-        if (wch == UNICODE_NULL)
+        const auto nul = std::min(remaining.find(UNICODE_NULL), remaining.size());
+        _storage.append(remaining.substr(0, nul));
+        remaining = remaining.substr(nul);
+
+        if (!remaining.empty())
         {
             // Convert null byte back to input event with proper control state
             const auto zeroKey = OneCoreSafeVkKeyScanW(0);
@@ -803,10 +1059,9 @@ void InputBuffer::_writeString(const std::wstring_view& text)
             WI_SetFlagIf(ctrlState, SHIFT_PRESSED, WI_IsFlagSet(zeroKey, 0x100));
             WI_SetFlagIf(ctrlState, LEFT_CTRL_PRESSED, WI_IsFlagSet(zeroKey, 0x200));
             WI_SetFlagIf(ctrlState, LEFT_ALT_PRESSED, WI_IsFlagSet(zeroKey, 0x400));
-            _storage.push_back(SynthesizeKeyEvent(true, 1, LOBYTE(zeroKey), 0, wch, ctrlState));
-            continue;
+            _storage.push_back(SynthesizeKeyEvent(true, 1, LOBYTE(zeroKey), 0, UNICODE_NULL, ctrlState));
+            remaining = remaining.substr(1);
         }
-        _storage.push_back(SynthesizeKeyEvent(true, 1, 0, 0, wch, 0));
     }
 }
 
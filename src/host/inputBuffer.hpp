@@ -17,6 +17,75 @@ namespace Microsoft::Console::Render
     class Renderer;
 }
 
+// Pending input is stored as a queue of chunks. Each chunk either holds INPUT_RECORDs
+// or a run of plain UTF-16 text as written by InputBuffer::WriteString(). Text runs are only
+// expanded into KEY_EVENT records when a reader asks for records (ReadConsoleInput), while
+// ReadConsole can copy them straight into the client's buffer. This avoids turning each pasted
+// character into a 20 byte INPUT_RECORD, only to turn it back into a character later.
+//
+// Chunks are capped in size, so that a reader that keeps draining the front of the
+// queue while a writer keeps appending to it doesn't keep a single chunk alive forever.
+class InputStorage
+{
+public:
+    bool empty() const noexcept;
+    size_t size() const noexcept;
+    void clear() noexcept;
+
+    void push_back(const INPUT_RECORD& record);
+    void append(std::wstring_view text);
+    void append(InputStorage&& other);
+    void pop_front(size_t count) noexcept;
+
+    INPUT_RECORD front() const;
+    INPUT_RECORD back() const;
+    INPUT_RECORD operator[](size_t index) const;
+
+    // Returns the first/last record, if the storage starts/ends with an INPUT_RECORD chunk.
+    INPUT_RECORD* frontRecord() noexcept;
+    INPUT_RECORD* backRecord() noexcept;
+    // Returns the text run at the front of the storage, if it starts with a text chunk.
+    std::wstring_view frontText() const noexcept;
+
+    void removeNonKeyRecords();
+
+    // Calls func(const INPUT_RECORD&) for each stored record in order, until it returns false.
+    template<typename Func>
+    void visit(Func&& func) const
+    {
+        for (const auto& chunk : _chunks)
+        {
+            for (auto i = chunk.offset, end = chunk.end(); i < end; ++i)
+            {
+                if (!func(chunk.at(i)))
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr size_t ChunkCapacity = 4096;
+
+    struct Chunk
+    {
+        std::wstring text;
+        std::vector<INPUT_RECORD> records;
+        // Number of already consumed units at the start of `text` or `records`.
+        size_t offset = 0;
+        bool isText = false;
+
+        size_t end() const noexcept;
+        INPUT_RECORD at(size_t index) const noexcept;
+    };
+
+    Chunk& _writableChunk(bool isText);
+
+    std::deque<Chunk> _chunks;
+    size_t _size = 0;
+};
+
 class InputBuffer final : public ConsoleObjectHeader
 {
 public:
@@ -33,6 +102,10 @@ public:
     size_t ConsumeCached(bool isUnicode, size_t count, InputEventQueue& target);
     size_t PeekCached(bool isUnicode, size_t count, InputEventQueue& target);
     void Cache(bool isUnicode, InputEventQueue& source, size_t expectedSourceSize);
+    // Bulk text APIs
+    std::wstring_view PeekText() const noexcept;
+    void DiscardText(size_t count);
+    bool ConsumeText(bool isUnicode, std::span<char>& target);
 
     // storage API for partial dbcs bytes being written to the buffer
     bool IsWritePartialByteSequenceAvailable() const noexcept;
@@ -79,7 +152,7 @@ private:
     std::deque<INPUT_RECORD> _cachedInputEvents;
     ReadingMode _readingMode = ReadingMode::StringA;
 
-    std::deque<INPUT_RECORD> _storage;
+    InputStorage _storage;
     INPUT_RECORD _writePartialByteSequence{};
     bool _writePartialByteSequenceAvailable = false;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
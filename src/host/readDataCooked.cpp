@@ -431,6 +431,25 @@ void COOKED_READ_DATA::_readCharInputLoop()
     while (_state == State::Accumulating)
     {
         const auto hasPopup = !_popups.empty();
+
+        // Fast path: Plain text at the front of the input buffer (for instance from a paste)
+        // can be inserted in one go, as long as it doesn't contain any control characters.
+        if (!hasPopup && _insertMode)
+        {
+            const auto text = _pInputBuffer->PeekText();
+            const auto end = std::find_if(text.begin(), text.end(), [](wchar_t wch) {
+                return wch < L' ' || wch == EXTKEY_ERASE_PREV_WORD;
+            });
+            const auto count = gsl::narrow_cast<size_t>(end - text.begin());
+
+            if (count != 0)
+            {
+                _replace(_bufferCursor, 0, text.data(), count);
+                _pInputBuffer->DiscardText(count);
+                continue;
+            }
+        }
+
         auto charOrVkey = UNICODE_NULL;
         auto commandLineEditingKeys = false;
         auto popupKeys = false;
@@ -917,22 +936,44 @@ void COOKED_READ_DATA::_redisplay()
     til::point cursorPositionFinal;
     til::point pagerPromptEnd;
     std::vector<Line> lines;
+    size_t resumeLine = 0;
 
     // FYI: This loop does not loop. It exists because goto is considered evil
     // and if MSVC says that then that must be true.
     for (;;)
     {
-        cursorPositionFinal = { originInViewport.x, 0 };
+        // Lines that lie entirely in front of both, the dirty part of the buffer and the cursor, haven't changed since the
+        // last call. Instead of laying them out again, we resume the layout at the start of the last line in front of them.
+        // This keeps the cost of a keystroke proportional to the size of the change and not the size of the buffer.
+        resumeLine = 0;
+        if (_layoutWidth == size.width && _layoutOriginX == originInViewport.x)
+        {
+            const auto cleanEnd = std::min(_bufferDirtyBeg, _bufferCursor);
+            const auto it = std::lower_bound(_layoutLineOffsets.begin(), _layoutLineOffsets.end(), cleanEnd);
+            resumeLine = gsl::narrow_cast<size_t>(std::max<ptrdiff_t>(0, it - _layoutLineOffsets.begin() - 1));
+        }
+
+        _layoutWidth = size.width;
+        _layoutOriginX = originInViewport.x;
+        _layoutLineOffsets.resize(resumeLine + 1);
+
+        // The skipped lines are filled in as placeholders that aren't dirty. If we end up needing their contents
+        // after all (for instance because scrolling the pager uncovered them), _layoutPlaceholderLine() fills them in.
+        lines.resize(resumeLine, Line{ {}, 0, size.width, size.width });
+
+        const auto resumeOffset = _layoutLineOffsets[resumeLine];
+        const auto resumeColumn = resumeLine == 0 ? originInViewport.x : 0;
+        cursorPositionFinal = { resumeColumn, gsl::narrow_cast<til::CoordType>(resumeLine) };
 
         // Construct the first line manually so that it starts at the correct horizontal position.
-        LayoutResult res{ .column = cursorPositionFinal.x };
-        lines.emplace_back(std::wstring{}, 0, cursorPositionFinal.x, cursorPositionFinal.x);
+        LayoutResult res{ .column = resumeColumn };
+        lines.emplace_back(std::wstring{}, 0, resumeColumn, resumeColumn);
 
         // Split the buffer into 3 segments, so that we can find the row/column coordinates of
         // the cursor within the buffer, as well as the start of the dirty parts of the buffer.
         const size_t offsets[]{
-            0,
-            std::min(_bufferDirtyBeg, _bufferCursor),
+            resumeOffset,
+            std::max(resumeOffset, std::min(_bufferDirtyBeg, _bufferCursor)),
             std::max(_bufferDirtyBeg, _bufferCursor),
             npos,
         };
@@ -953,6 +994,7 @@ void COOKED_READ_DATA::_redisplay()
                 if (res.column >= size.width)
                 {
                     lines.emplace_back();
+                    _layoutLineOffsets.emplace_back(offsets[i] + beg);
                 }
 
                 auto& line = lines.back();
@@ -1199,7 +1241,12 @@ void COOKED_READ_DATA::_redisplay()
         // Mark each row that has been uncovered by the scroll as dirty.
         for (auto i = beg; i < end; i++)
         {
-            auto& line = lines.at(i + pagerContentTop);
+            const auto index = gsl::narrow_cast<size_t>(i + pagerContentTop);
+            auto& line = lines.at(index);
+            if (index < resumeLine)
+            {
+                _layoutPlaceholderLine(line, index, size.width);
+            }
             line.dirtyBegOffset = 0;
             line.dirtyBegColumn = 0;
         }
@@ -1383,6 +1430,14 @@ outerLoopExit:
     };
 }
 
+// Lays out a line that _redisplay() skipped, because it was unchanged since the previous call.
+void COOKED_READ_DATA::_layoutPlaceholderLine(Line& line, size_t index, til::CoordType columnLimit) const
+{
+    const auto column = index == 0 ? _layoutOriginX : 0;
+    line.text.clear();
+    line.columns = _layoutLine(line.text, _buffer, _layoutLineOffsets.at(index), column, columnLimit).column;
+}
+
 void COOKED_READ_DATA::_appendCUP(std::wstring& output, til::point pos)
 {
     fmt::format_to(std::back_inserter(output), FMT_COMPILE(L"\x1b[{};{}H"), pos.y + 1, pos.x + 1);
@@ -137,6 +137,7 @@ private:
     void _setCursorPosition(size_t position) noexcept;
     void _redisplay();
     LayoutResult _layoutLine(std::wstring& output, const std::wstring_view& input, size_t inputOffset, til::CoordType columnBegin, til::CoordType columnLimit) const;
+    void _layoutPlaceholderLine(Line& line, size_t index, til::CoordType columnLimit) const;
     static void _appendCUP(std::wstring& output, til::point pos);
     void _appendPopupAttr(std::wstring& output) const;
 
@@ -168,6 +169,12 @@ private:
     bool _redrawPending = false;
     bool _clearPending = false;
 
+    // The buffer offset at which each line of the prompt started during the last _redisplay(),
+    // as well as the layout parameters it was computed for. Allows us to skip unchanged lines.
+    std::vector<size_t> _layoutLineOffsets;
+    til::CoordType _layoutWidth = -1;
+    til::CoordType _layoutOriginX = -1;
+
     std::optional<til::point> _originInViewport;
     // This value is in the pager coordinate space. (0,0) is the first character of the
     // first line, independent on where the prompt actually appears on the screen.
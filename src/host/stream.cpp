@@ -417,6 +417,14 @@ try
 
     while (writer.size() >= charSize)
     {
+        // Plain text (for instance from a paste) can be copied over in bulk.
+        // ConsumeText() may have only skipped a linefeed, so check whether anything was actually written.
+        if (inputBuffer.ConsumeText(unicode, writer))
+        {
+            noDataReadYet = writer.size() == buffer.size();
+            continue;
+        }
+
         wchar_t wch;
         // We don't need to wait for input if `ConsumeCached` read something already, which is
         // indicated by the writer having been advanced (= it's shorter than the original buffer).
@@ -0,0 +1,177 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+// The headers that the atlas renderer's precompiled header would otherwise provide.
+#include <d2d1_3.h>
+#include <d3d11_2.h>
+#include <dwrite_3.h>
+#include <dxgi1_3.h>
+
+#include "../../renderer/atlas/BuiltinGlyphs.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console::Render::Atlas;
+using namespace Microsoft::Console::Render::Atlas::BuiltinGlyphs;
+
+// The builtin glyph rasterizer doesn't depend on a GPU or Direct2D,
+// which allows us to test it headless, unlike most of the atlas renderer.
+class BuiltinGlyphsTests
+{
+    TEST_CLASS(BuiltinGlyphsTests);
+
+    static u8 pixel(const GlyphMask& mask, const size_t x, const size_t y)
+    {
+        return til::at(mask.coverage, y * mask.width + x);
+    }
+
+    // Checks whether b is a mirror image of a, flipped horizontally (flipX) and/or vertically (flipY).
+    static bool isMirrored(const GlyphMask& a, const GlyphMask& b, const bool flipX, const bool flipY)
+    {
+        for (size_t y = 0; y < a.height; ++y)
+        {
+            for (size_t x = 0; x < a.width; ++x)
+            {
+                const auto bx = flipX ? a.width - 1 - x : x;
+                const auto by = flipY ? a.height - 1 - y : y;
+                if (pixel(a, x, y) != pixel(b, bx, by))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    TEST_METHOD(AllGlyphsHaveCoverage)
+    {
+        static constexpr std::array<std::pair<u16, u16>, 4> sizes{ { { 8, 16 }, { 9, 19 }, { 10, 20 }, { 16, 32 } } };
+
+        for (const auto& [width, height] : sizes)
+        {
+            const auto check = [&](const char32_t first, const u32 count) {
+                for (auto ch = first; ch < first + count; ++ch)
+                {
+                    const auto mask = RasterizeBuiltinGlyph(ch, width, height);
+                    VERIFY_ARE_EQUAL(width, mask.width);
+                    VERIFY_ARE_EQUAL(height, mask.height);
+                    VERIFY_ARE_EQUAL(static_cast<size_t>(width) * height, mask.coverage.size());
+                    // Every glyph in the table draws something, no matter how small the cell.
+                    VERIFY_IS_TRUE(std::ranges::any_of(mask.coverage, [](auto c) { return c != 0; }), NoThrowString().Format(L"U+%04X at %ux%u", ch, width, height));
+                }
+            };
+            check(BoxDrawing_FirstChar, BoxDrawing_CharCount);
+            check(Powerline_FirstChar, Powerline_CharCount);
+        }
+    }
+
+    TEST_METHOD(BlockElements)
+    {
+        static constexpr u16 width = 16;
+        static constexpr u16 height = 32;
+
+        // U+2581-2587: LOWER ONE EIGHTH BLOCK to LOWER SEVEN EIGHTHS BLOCK
+        // U+2589-258F: LEFT SEVEN EIGHTHS BLOCK to LEFT ONE EIGHTH BLOCK
+        // At a cell size divisible by 8 they're pixel exact.
+        for (size_t n = 1; n <= 7; ++n)
+        {
+            const auto lower = RasterizeBuiltinGlyph(0x2580 + gsl::narrow_cast<char32_t>(n), width, height);
+            const auto left = RasterizeBuiltinGlyph(0x2590 - gsl::narrow_cast<char32_t>(n), width, height);
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    const u8 expectedLower = y >= height - n * height / 8 ? 255 : 0;
+                    const u8 expectedLeft = x < n * width / 8 ? 255 : 0;
+                    VERIFY_ARE_EQUAL(expectedLower, pixel(lower, x, y));
+                    VERIFY_ARE_EQUAL(expectedLeft, pixel(left, x, y));
+                }
+            }
+        }
+
+        // U+2598 QUADRANT UPPER LEFT
+        const auto quadrant = RasterizeBuiltinGlyph(0x2598, width, height);
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                const u8 expected = x < width / 2 && y < height / 2 ? 255 : 0;
+                VERIFY_ARE_EQUAL(expected, pixel(quadrant, x, y));
+            }
+        }
+    }
+
+    TEST_METHOD(Symmetry)
+    {
+        // At this size the stroke width is even, which allows lines to be centered exactly.
+        static constexpr u16 width = 12;
+        static constexpr u16 height = 24;
+        const auto glyph = [](const char32_t ch) { return RasterizeBuiltinGlyph(ch, width, height); };
+
+        // Glyphs that are symmetric to themselves.
+        for (const char32_t ch : { 0x2500, 0x2502, 0x253C, 0x2550, 0x2551, 0x256C, 0x2573 })
+        {
+            const auto mask = glyph(ch);
+            VERIFY_IS_TRUE(isMirrored(mask, mask, true, false), NoThrowString().Format(L"U+%04X", ch));
+            VERIFY_IS_TRUE(isMirrored(mask, mask, false, true), NoThrowString().Format(L"U+%04X", ch));
+        }
+
+        // U+258C LEFT HALF BLOCK and U+2590 RIGHT HALF BLOCK
+        VERIFY_IS_TRUE(isMirrored(glyph(0x258C), glyph(0x2590), true, false));
+        // U+2580 UPPER HALF BLOCK and U+2584 LOWER HALF BLOCK
+        VERIFY_IS_TRUE(isMirrored(glyph(0x2580), glyph(0x2584), false, true));
+        // U+2571 and U+2572, the two diagonals
+        VERIFY_IS_TRUE(isMirrored(glyph(0x2571), glyph(0x2572), true, false));
+        // U+256D-2570, the 4 rounded corners
+        VERIFY_IS_TRUE(isMirrored(glyph(0x256D), glyph(0x256E), true, false));
+        VERIFY_IS_TRUE(isMirrored(glyph(0x256D), glyph(0x2570), false, true));
+        VERIFY_IS_TRUE(isMirrored(glyph(0x256D), glyph(0x256F), true, true));
+        // U+E0B0/E0B2 (solid triangles) and U+E0B4/E0B6 (solid semicircles) of Powerline
+        VERIFY_IS_TRUE(isMirrored(glyph(0xE0B0), glyph(0xE0B2), true, false));
+        VERIFY_IS_TRUE(isMirrored(glyph(0xE0B0), glyph(0xE0B0), false, true));
+        VERIFY_IS_TRUE(isMirrored(glyph(0xE0B4), glyph(0xE0B6), true, false));
+    }
+
+    TEST_METHOD(SimpleShapes)
+    {
+        // U+2588 FULL BLOCK
+        const auto fullBlock = RasterizeBuiltinGlyph(0x2588, 9, 19);
+        VERIFY_IS_TRUE(std::ranges::all_of(fullBlock.coverage, [](auto c) { return c == 255; }));
+        VERIFY_IS_TRUE(fullBlock.shade == Shade::Filled100);
+
+        // U+2592 MEDIUM SHADE
+        const auto mediumShade = RasterizeBuiltinGlyph(0x2592, 9, 19);
+        VERIFY_IS_TRUE(std::ranges::all_of(mediumShade.coverage, [](auto c) { return c == 255; }));
+        VERIFY_IS_TRUE(mediumShade.shade == Shade::Filled050);
+
+        // U+2500 BOX DRAWINGS LIGHT HORIZONTAL: At a width of 12 the line is 2px wide, centered vertically.
+        const auto horizontal = RasterizeBuiltinGlyph(0x2500, 12, 24);
+        for (size_t y = 0; y < 24; ++y)
+        {
+            const u8 expected = y == 11 || y == 12 ? 255 : 0;
+            for (size_t x = 0; x < 12; ++x)
+            {
+                VERIFY_ARE_EQUAL(expected, til::at(horizontal.coverage, y * 12 + x));
+            }
+        }
+    }
+
+    TEST_METHOD(SharedCache)
+    {
+        const auto a = GetBuiltinGlyphMask(0x256D, 9, 19);
+        const auto b = GetBuiltinGlyphMask(0x256D, 9, 19);
+        const auto c = GetBuiltinGlyphMask(0x256D, 10, 20);
+        VERIFY_IS_NOT_NULL(a.get());
+        VERIFY_ARE_EQUAL(a.get(), b.get());
+        VERIFY_ARE_NOT_EQUAL(a.get(), c.get());
+        VERIFY_IS_TRUE(a->coverage == RasterizeBuiltinGlyph(0x256D, 9, 19).coverage);
+
+        VERIFY_IS_NULL(GetBuiltinGlyphMask(L'A', 9, 19).get());
+    }
+};
@@ -242,6 +242,89 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2, history->GetNumberOfCommands());
     }
 
+    TEST_METHOD(FindMatchingCommandAfterReordering)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        VERIFY_SUCCEEDED(history->Add(L"dir", false));
+        VERIFY_SUCCEEDED(history->Add(L"dir /w", false));
+        VERIFY_SUCCEEDED(history->Add(L"ipconfig /all", false));
+        VERIFY_SUCCEEDED(history->Add(L"ipconfig", false));
+        VERIFY_SUCCEEDED(history->Add(L"cd ..", false));
+
+        // The search index must follow the commands around.
+        history->Swap(0, 4);
+        VERIFY_ARE_EQUAL(L"dir", history->GetNth(4));
+
+        static constexpr auto options = CommandHistory::MatchOptions::JustLooking;
+        CommandHistory::Index index;
+
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ip", 4, index, options));
+        VERIFY_ARE_EQUAL(3, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig ", 4, index, options));
+        VERIFY_ARE_EQUAL(2, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir", 4, index, options));
+        VERIFY_ARE_EQUAL(1, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig", 4, index, options | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(3, index);
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"dirx", 4, index, options));
+
+        history->Remove(3);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ip", 3, index, options));
+        VERIFY_ARE_EQUAL(2, index);
+    }
+
+    // Measures F8-style prefix searches and Add() with duplicate suppression in a large history.
+    TEST_METHOD(FindMatchingCommandBenchmark)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"Ignore", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        static constexpr CommandHistory::Index commands = 999;
+        static constexpr int iterations = 10000;
+
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+        history->Realloc(commands);
+
+        for (CommandHistory::Index i = 0; i < commands; ++i)
+        {
+            std::wstring command{ til::at(_manyHistoryItems, i % _manyHistoryItems.size()) };
+            command.append(L" ").append(std::to_wstring(i));
+            VERIFY_SUCCEEDED(history->Add(command, false));
+        }
+        VERIFY_ARE_EQUAL(commands, history->GetNumberOfCommands());
+
+        static constexpr auto options = CommandHistory::MatchOptions::JustLooking;
+        static constexpr std::wstring_view prefixes[]{ L"dir /w 9", L"zzz", L"ping 127.0.0.1 1", L"cd" };
+        CommandHistory::Index index;
+        size_t found = 0;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        for (auto i = 0; i < iterations; ++i)
+        {
+            // Most of these match far back in the history or not at all, so that they scan most of it.
+            found += history->FindMatchingCommand(til::at(prefixes, i % std::size(prefixes)), commands - 1, index, options);
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        for (auto i = 0; i < iterations; ++i)
+        {
+            // Re-adding the oldest command searches for its duplicate and moves it to the end.
+            const std::wstring oldest{ history->GetNth(0) };
+            VERIFY_SUCCEEDED(history->Add(oldest, true));
+        }
+        const auto t2 = std::chrono::steady_clock::now();
+
+        VERIFY_ARE_EQUAL(commands, history->GetNumberOfCommands());
+        Log::Comment(NoThrowString().Format(
+            L"prefix search: %lldns (%zu found), deduplicating Add: %lldns",
+            std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / iterations,
+            found,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / iterations));
+    }
+
 private:
     const std::array<std::wstring, 5> _manyApps = {
         L"foo.exe",
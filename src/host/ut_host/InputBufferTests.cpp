@@ -6,6 +6,8 @@
 #include "../../inc/consoletaeftemplates.hpp"
 #include "CommonState.hpp"
 
+#include "stream.h"
+#include "inputReadHandleData.h"
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../types/inc/IInputEvent.hpp"
 
@@ -121,7 +123,7 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const auto& pMouseEvent = inputBuffer._storage.front().Event.MouseEvent;
+        const auto pMouseEvent = inputBuffer._storage.front().Event.MouseEvent;
         VERIFY_ARE_EQUAL(pMouseEvent.dwMousePosition.X, static_cast<SHORT>(RECORD_INSERT_COUNT));
         VERIFY_ARE_EQUAL(pMouseEvent.dwMousePosition.Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
@@ -614,4 +616,81 @@ class InputBufferTests
         VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(outEvents.front().Event.KeyEvent.wRepeatCount, 1u);
     }
+
+    TEST_METHOD(WrittenTextIsReadAsKeyEvents)
+    {
+        InputBuffer inputBuffer;
+        InputEventQueue outEvents;
+
+        inputBuffer.WriteString(L"ab");
+        inputBuffer.Write(MakeKeyEvent(true, 1, L'c', 0, L'c', 0));
+        inputBuffer.WriteString(L"d");
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 4u);
+
+        VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents,
+                                           3,
+                                           false,
+                                           false,
+                                           true,
+                                           false));
+        VERIFY_ARE_EQUAL(outEvents.size(), 3u);
+        VERIFY_ARE_EQUAL(outEvents[0], SynthesizeKeyEvent(true, 1, 0, 0, L'a', 0));
+        VERIFY_ARE_EQUAL(outEvents[1], SynthesizeKeyEvent(true, 1, 0, 0, L'b', 0));
+        VERIFY_ARE_EQUAL(outEvents[2], MakeKeyEvent(true, 1, L'c', 0, L'c', 0));
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer.PeekText(), L"d");
+    }
+
+    TEST_METHOD(ConsumeTextCopiesTextInBulk)
+    {
+        InputBuffer inputBuffer;
+        wchar_t buffer[4]{};
+        std::span target{ reinterpret_cast<char*>(&buffer[0]), sizeof(buffer) };
+
+        inputBuffer.WriteString(L"abc\ndef");
+        inputBuffer.Write(MakeKeyEvent(true, 1, L'g', 0, L'g', 0));
+
+        // Linefeeds are skipped outside of VT input mode, just like GetChar() does.
+        VERIFY_IS_TRUE(inputBuffer.ConsumeText(true, target));
+        VERIFY_ARE_EQUAL(std::wstring_view(&buffer[0], 3), L"abc");
+        VERIFY_ARE_EQUAL(inputBuffer.PeekText(), L"def");
+
+        VERIFY_IS_TRUE(inputBuffer.ConsumeText(true, target));
+        VERIFY_ARE_EQUAL(std::wstring_view(&buffer[0], 4), L"abcd");
+        VERIFY_IS_TRUE(target.empty());
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 3u);
+
+        inputBuffer.DiscardText(2);
+        VERIFY_IS_FALSE(inputBuffer.ConsumeText(true, target));
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
+    }
+
+    TEST_METHOD(RawReadSkipsLeadingLinefeed)
+    {
+        InputBuffer inputBuffer;
+        INPUT_READ_HANDLE_DATA readHandleState;
+        wchar_t buffer[1]{};
+        size_t bytesRead = 0;
+
+        inputBuffer.WriteString(L"\nabc");
+
+        // The skipped linefeed must not count as data, or the read returns zero bytes (EOF).
+        VERIFY_NT_SUCCESS(ReadCharacterInput(inputBuffer, { reinterpret_cast<char*>(&buffer[0]), sizeof(buffer) }, bytesRead, readHandleState, true));
+        VERIFY_ARE_EQUAL(bytesRead, sizeof(wchar_t));
+        VERIFY_ARE_EQUAL(buffer[0], L'a');
+        VERIFY_ARE_EQUAL(inputBuffer.PeekText(), L"bc");
+    }
+
+    TEST_METHOD(RawReadWaitsAfterLoneLinefeed)
+    {
+        InputBuffer inputBuffer;
+        INPUT_READ_HANDLE_DATA readHandleState;
+        wchar_t buffer[1]{};
+        size_t bytesRead = 0;
+
+        inputBuffer.WriteString(L"\n");
+
+        VERIFY_ARE_EQUAL(ReadCharacterInput(inputBuffer, { reinterpret_cast<char*>(&buffer[0]), sizeof(buffer) }, bytesRead, readHandleState, true), CONSOLE_STATUS_WAIT);
+        VERIFY_ARE_EQUAL(bytesRead, 0u);
+    }
 };
@@ -0,0 +1,206 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../../renderer/base/LatencyTrace.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console::Render;
+using namespace std::chrono_literals;
+
+class LatencyTraceTests
+{
+    TEST_CLASS(LatencyTraceTests);
+
+    using Stage = LatencyTrace::Stage;
+    using Timeline = LatencyTrace::Timeline;
+
+    static constexpr LatencyTrace::clock::time_point epoch{ 100s };
+
+    static void markAt(LatencyTrace& trace, const Stage stage, const std::chrono::microseconds offset)
+    {
+        trace._markAt(stage, epoch + offset);
+    }
+
+    static uint32_t sampleCount(const Timeline& timeline, const Stage histogram)
+    {
+        uint32_t count = 0;
+        for (const auto& bucket : til::at(timeline.histograms, static_cast<size_t>(histogram)))
+        {
+            count += bucket.load();
+        }
+        return count;
+    }
+
+    static uint32_t bucketCount(const Timeline& timeline, const Stage histogram, const size_t bucket)
+    {
+        return til::at(til::at(timeline.histograms, static_cast<size_t>(histogram)), bucket).load();
+    }
+
+    TEST_METHOD(DisabledByDefault)
+    {
+        LatencyTrace trace;
+
+        for (const auto stage : { Stage::OutputRead, Stage::OutputParsed, Stage::PaintStarted, Stage::Presented })
+        {
+            trace.Mark(stage);
+        }
+
+        VERIFY_IS_TRUE(trace._output.next.load() == Stage::OutputRead);
+        VERIFY_ARE_EQUAL(0u, sampleCount(trace._output, Stage::OutputRead));
+
+        trace.SetEnabled(true);
+        trace.Mark(Stage::OutputRead);
+        VERIFY_IS_TRUE(trace._output.next.load() == Stage::OutputParsed);
+    }
+
+    TEST_METHOD(RecordsStagesIntoLog2Buckets)
+    {
+        LatencyTrace trace;
+
+        markAt(trace, Stage::OutputRead, 0us);
+        markAt(trace, Stage::OutputParsed, 3us);
+        markAt(trace, Stage::PaintStarted, 100us);
+        markAt(trace, Stage::Presented, 1100us);
+
+        // Bucket i counts [2^i, 2^(i+1)) microseconds.
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._output, Stage::OutputParsed, 1)); // 3us
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._output, Stage::PaintStarted, 6)); // 97us
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._output, Stage::Presented, 9)); // 1000us
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._output, Stage::OutputRead, 10)); // 1100us in total
+        VERIFY_IS_TRUE(trace._output.next.load() == Stage::OutputRead);
+
+        // The input timeline waits for a key press and must have ignored all of the above.
+        VERIFY_ARE_EQUAL(0u, sampleCount(trace._input, Stage::KeyEvent));
+
+        markAt(trace, Stage::KeyEvent, 0us);
+        markAt(trace, Stage::InputWritten, 50us);
+        markAt(trace, Stage::OutputRead, 60us);
+        markAt(trace, Stage::OutputParsed, 61us);
+        markAt(trace, Stage::PaintStarted, 61us);
+        markAt(trace, Stage::Presented, 63us);
+
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._input, Stage::InputWritten, 5)); // 50us
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._input, Stage::OutputRead, 3)); // 10us
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._input, Stage::OutputParsed, 0)); // 1us
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._input, Stage::PaintStarted, 0)); // 0us
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._input, Stage::Presented, 1)); // 2us
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._input, Stage::KeyEvent, 5)); // 63us in total
+
+        // The output timeline saw the second half of the key press as well.
+        VERIFY_ARE_EQUAL(2u, sampleCount(trace._output, Stage::OutputRead));
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._output, Stage::OutputRead, 1)); // 3us in total
+    }
+
+    TEST_METHOD(IgnoresStagesOutOfOrder)
+    {
+        LatencyTrace trace;
+
+        // Nothing to paint for the output timeline yet.
+        markAt(trace, Stage::PaintStarted, 0us);
+        markAt(trace, Stage::Presented, 0us);
+        VERIFY_IS_TRUE(trace._output.next.load() == Stage::OutputRead);
+
+        // A key press that didn't produce any input is superseded by the next one.
+        markAt(trace, Stage::KeyEvent, 0us);
+        markAt(trace, Stage::KeyEvent, 500us);
+        markAt(trace, Stage::InputWritten, 510us);
+        VERIFY_IS_TRUE(trace._input.next.load() == Stage::OutputRead);
+
+        // ...but once input was written, further key presses must not restart the sample.
+        markAt(trace, Stage::KeyEvent, 520us);
+        VERIFY_IS_TRUE(trace._input.next.load() == Stage::OutputRead);
+
+        markAt(trace, Stage::OutputRead, 530us);
+        markAt(trace, Stage::OutputParsed, 540us);
+        markAt(trace, Stage::PaintStarted, 550us);
+        markAt(trace, Stage::Presented, 560us);
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._input, Stage::InputWritten, 3)); // 10us
+        VERIFY_ARE_EQUAL(1u, bucketCount(trace._input, Stage::KeyEvent, 5)); // 60us in total
+    }
+
+    TEST_METHOD(DropsImplausibleSamples)
+    {
+        LatencyTrace trace;
+
+        // A stage longer than a second.
+        markAt(trace, Stage::OutputRead, 0us);
+        markAt(trace, Stage::OutputParsed, 2s);
+        markAt(trace, Stage::PaintStarted, 2s);
+        markAt(trace, Stage::Presented, 2s);
+
+        // A stage that went back in time.
+        markAt(trace, Stage::OutputRead, 10us);
+        markAt(trace, Stage::OutputParsed, 5us);
+        markAt(trace, Stage::PaintStarted, 20us);
+        markAt(trace, Stage::Presented, 30us);
+
+        VERIFY_ARE_EQUAL(2u, trace._output.dropped.load());
+        VERIFY_ARE_EQUAL(0u, sampleCount(trace._output, Stage::OutputRead));
+        VERIFY_ARE_EQUAL(0u, sampleCount(trace._output, Stage::OutputParsed));
+    }
+
+    TEST_METHOD(FormatsPercentiles)
+    {
+        LatencyTrace trace;
+
+        for (auto i = 0; i < 10; ++i)
+        {
+            // 9 samples with 100us (bucket 6) and 1 with 1000us (bucket 9) in total.
+            const auto total = i == 9 ? 1000us : 100us;
+            const auto beg = std::chrono::microseconds{ i * 10'000 };
+            markAt(trace, Stage::OutputRead, beg);
+            markAt(trace, Stage::OutputParsed, beg);
+            markAt(trace, Stage::PaintStarted, beg);
+            markAt(trace, Stage::Presented, beg + total);
+        }
+
+        const auto text = trace.Format();
+        Log::Comment(text.c_str());
+        VERIFY_ARE_NOT_EQUAL(std::wstring::npos, text.find(L"OutputRead -> Presented: 10 samples, p50 < 128us, p90 < 128us, p99 < 1024us\n"));
+        VERIFY_ARE_NOT_EQUAL(std::wstring::npos, text.find(L" <128us:9 <1024us:1\n"));
+        VERIFY_ARE_NOT_EQUAL(std::wstring::npos, text.find(L"KeyEvent -> Presented: 0 samples\n"));
+    }
+
+    TEST_METHOD(MarksConcurrently)
+    {
+        LatencyTrace trace;
+        std::vector<std::thread> threads;
+
+        // Each thread uses its own time base, 10s apart, so that a sample mixing
+        // the stages of several threads gets dropped. All others must be exact.
+        for (auto t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&trace, base = std::chrono::microseconds{ t * 10s }]() {
+                for (auto i = 0; i < 10'000; ++i)
+                {
+                    markAt(trace, Stage::OutputRead, base);
+                    markAt(trace, Stage::OutputParsed, base + 3us);
+                    markAt(trace, Stage::PaintStarted, base + 100us);
+                    markAt(trace, Stage::Presented, base + 1100us);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        const auto& timeline = trace._output;
+        const auto samples = sampleCount(timeline, Stage::OutputRead);
+        Log::Comment(NoThrowString().Format(L"%u samples, %u dropped", samples, timeline.dropped.load()));
+
+        VERIFY_IS_TRUE(timeline.next.load() <= Stage::Presented);
+        VERIFY_IS_GREATER_THAN(samples + timeline.dropped.load(), 0u);
+        VERIFY_ARE_EQUAL(samples, bucketCount(timeline, Stage::OutputRead, 10));
+        VERIFY_ARE_EQUAL(samples, bucketCount(timeline, Stage::OutputParsed, 1));
+        VERIFY_ARE_EQUAL(samples, bucketCount(timeline, Stage::PaintStarted, 6));
+        VERIFY_ARE_EQUAL(samples, bucketCount(timeline, Stage::Presented, 9));
+        VERIFY_ARE_EQUAL(samples, sampleCount(timeline, Stage::Presented));
+    }
+};
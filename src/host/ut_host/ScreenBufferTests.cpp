@@ -258,6 +258,7 @@ class ScreenBufferTests
 
     TEST_METHOD(DelayedWrapReset);
     TEST_METHOD(MultilineWrap);
+    TEST_METHOD(OutputScrolledOutOfBuffer);
 
     TEST_METHOD(EraseColorMode);
 
@@ -8208,6 +8209,82 @@ void ScreenBufferTests::MultilineWrap()
     VERIFY_IS_TRUE(_ValidateLineContains(bottomRow + 3, L"4", bufferAttr));
 }
 
+void ScreenBufferTests::OutputScrolledOutOfBuffer()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    auto& stateMachine = si.GetStateMachine();
+    const auto& textBuffer = si.GetTextBuffer();
+    const auto width = textBuffer.GetSize().Width();
+    const auto height = textBuffer.GetSize().Height();
+
+    // Text that is followed by more line feeds than the buffer has rows isn't written into
+    // the buffer, if it's all processed at once. The result should be indistinguishable
+    // from processing the same output one line at a time, which prevents that.
+    std::vector<std::wstring> lines;
+    for (auto i = 0; i < height * 3; i++)
+    {
+        auto line = L"\x1b[3" + std::to_wstring(i % 8) + L"mLine " + std::to_wstring(i);
+        if (i % 7 == 0)
+        {
+            // Wrap some of the lines across multiple rows.
+            line.append(gsl::narrow_cast<size_t>(width + i % width), L'-');
+        }
+        if (i % 50 == 0)
+        {
+            line += L"\x1b]2;Title " + std::to_wstring(i) + L"\x07";
+        }
+        if (i == height * 2)
+        {
+            // Moving the cursor up must prevent the preceding text from being skipped.
+            line += L"\x1b[10A";
+        }
+        line += L"\r\n";
+        lines.emplace_back(std::move(line));
+    }
+    lines.emplace_back(L"Tail");
+
+    const auto snapshot = [&]() {
+        std::vector<std::tuple<std::wstring, bool, TextAttribute>> rows;
+        for (til::CoordType y = 0; y < height; y++)
+        {
+            const auto& row = textBuffer.GetRowByOffset(y);
+            rows.emplace_back(row.GetText(), row.WasWrapForced(), row.GetAttrByColumn(0));
+        }
+        return std::tuple{ std::move(rows), textBuffer.GetCursor().GetPosition(), si.GetViewport().Origin() };
+    };
+
+    Log::Comment(L"Process the output one line at a time, twice, so that the buffer ends up in a steady state.");
+    for (auto pass = 0; pass < 2; pass++)
+    {
+        for (const auto& line : lines)
+        {
+            stateMachine.ProcessString(line);
+        }
+    }
+    const auto expected = snapshot();
+
+    Log::Comment(L"Process the same output all at once.");
+    std::wstring output;
+    for (const auto& line : lines)
+    {
+        output += line;
+    }
+    stateMachine.ProcessString(output);
+    const auto actual = snapshot();
+
+    VERIFY_ARE_EQUAL(std::get<1>(expected), std::get<1>(actual));
+    VERIFY_ARE_EQUAL(std::get<2>(expected), std::get<2>(actual));
+    for (til::CoordType y = 0; y < height; y++)
+    {
+        const auto& [expectedText, expectedWrap, expectedAttr] = til::at(std::get<0>(expected), y);
+        const auto& [actualText, actualWrap, actualAttr] = til::at(std::get<0>(actual), y);
+        VERIFY_ARE_EQUAL(expectedText, actualText);
+        VERIFY_ARE_EQUAL(expectedWrap, actualWrap);
+        VERIFY_ARE_EQUAL(expectedAttr, actualAttr);
+    }
+}
+
 void ScreenBufferTests::EraseColorMode()
 {
     BEGIN_TEST_METHOD_PROPERTIES()
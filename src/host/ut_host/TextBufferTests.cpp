@@ -95,6 +95,7 @@ class TextBufferTests
     void TestLastNonSpace(const til::CoordType cursorPosY);
 
     TEST_METHOD(TestGetLastNonSpaceCharacter);
+    TEST_METHOD(TestLastNonSpaceCharacterWatermark);
 
     TEST_METHOD(TestIncrementCircularBuffer);
 
@@ -131,6 +132,8 @@ class TextBufferTests
 
     TEST_METHOD(ResizeTraditionalRotationPreservesHighUnicode);
     TEST_METHOD(ScrollBufferRotationPreservesHighUnicode);
+    TEST_METHOD(ScrollRowsWithOverlap);
+    TEST_METHOD(RotateRows);
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
@@ -138,16 +141,20 @@ class TextBufferTests
     TEST_METHOD(TestOverwriteChars);
     TEST_METHOD(TestReplace);
     TEST_METHOD(TestInsert);
+    TEST_METHOD(TestAttributeInterning);
 
     TEST_METHOD(TestAppendRTFText);
 
     void WriteLinesToBuffer(const std::vector<std::wstring>& text, TextBuffer& buffer);
     TEST_METHOD(GetWordBoundaries);
     TEST_METHOD(MoveByWord);
+    TEST_METHOD(MoveByWordAcrossBlankRows);
+    TEST_METHOD(ClassifyDelimiters);
     TEST_METHOD(GetGlyphBoundaries);
 
     TEST_METHOD(GetTextRects);
     TEST_METHOD(GetPlainText);
+    TEST_METHOD(CreateCopySnapshot);
 
     TEST_METHOD(HyperlinkTrim);
     TEST_METHOD(NoHyperlinkTrim);
@@ -430,6 +437,44 @@ void TextBufferTests::TestGetLastNonSpaceCharacter()
     TestLastNonSpace(14);
 }
 
+void TextBufferTests::TestLastNonSpaceCharacterWatermark()
+{
+    TextBuffer buffer{ { 80, 20 }, TextAttribute{ 0x07 }, 12, false, &_renderer };
+
+    Log::Comment(L"An empty buffer");
+    VERIFY_ARE_EQUAL(til::point{}, buffer.GetLastNonSpaceCharacter());
+    VERIFY_ARE_EQUAL(-1, buffer._textWatermark);
+
+    Log::Comment(L"Text followed by more than 8 whitespace (= a full SIMD chunk)");
+    RowWriteState state{ .text = L"abcdefghijk", .columnBegin = 20 };
+    buffer.GetMutableRowByOffset(5).ReplaceText(state);
+    VERIFY_ARE_EQUAL(31, buffer.GetRowByOffset(5).MeasureRight());
+    VERIFY_IS_TRUE(buffer.GetRowByOffset(5).ContainsText());
+    VERIFY_IS_FALSE(buffer.GetRowByOffset(4).ContainsText());
+    VERIFY_ARE_EQUAL((til::point{ 30, 5 }), buffer.GetLastNonSpaceCharacter());
+    VERIFY_ARE_EQUAL(5, buffer._textWatermark);
+
+    Log::Comment(L"Text at the very end of a row");
+    buffer.GetMutableRowByOffset(7).ReplaceCharacters(79, 1, L"z");
+    VERIFY_ARE_EQUAL((til::point{ 79, 7 }), buffer.GetLastNonSpaceCharacter());
+
+    Log::Comment(L"Scrolling moves the watermark along with the text");
+    buffer.IncrementCircularBuffer();
+    VERIFY_ARE_EQUAL(6, buffer._textWatermark);
+    VERIFY_ARE_EQUAL((til::point{ 79, 6 }), buffer.GetLastNonSpaceCharacter());
+
+    Log::Comment(L"Viewports that end above or start below the watermark");
+    const auto top = Viewport::FromInclusive({ 0, 0, 79, 5 });
+    VERIFY_ARE_EQUAL((til::point{ 30, 4 }), buffer.GetLastNonSpaceCharacter(&top));
+    const auto bottom = Viewport::FromInclusive({ 0, 10, 79, 19 });
+    VERIFY_ARE_EQUAL((til::point{ 0, 10 }), buffer.GetLastNonSpaceCharacter(&bottom));
+
+    Log::Comment(L"Clearing the scrollback");
+    buffer.ClearScrollback(5, 3);
+    VERIFY_ARE_EQUAL(2, buffer._textWatermark);
+    VERIFY_ARE_EQUAL((til::point{ 79, 1 }), buffer.GetLastNonSpaceCharacter());
+}
+
 void TextBufferTests::TestIncrementCircularBuffer()
 {
     auto& textBuffer = GetTbi();
@@ -453,7 +498,7 @@ void TextBufferTests::TestIncrementCircularBuffer()
             iNextRowIndex = 0;
         }
 
-        textBuffer._firstRow = iRowToTestIndex;
+        textBuffer._SetFirstRowIndex(iRowToTestIndex);
 
         // fill first row with some stuff
         auto& FirstRow = textBuffer.GetMutableRowByOffset(0);
@@ -1696,6 +1741,130 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
     VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
 }
 
+// Overlapping full-width scrolls rotate the rows instead of copying them.
+// This ensures that the result is identical to copying them one by one.
+void TextBufferTests::ScrollRowsWithOverlap()
+{
+    static constexpr til::CoordType height = 10;
+
+    struct Test
+    {
+        til::CoordType firstRow;
+        til::CoordType size;
+        til::CoordType delta;
+    };
+    static constexpr std::array tests{
+        Test{ 2, 5, -1 },
+        Test{ 2, 5, -2 },
+        Test{ 2, 5, 1 },
+        Test{ 2, 5, 3 },
+        Test{ 0, 9, 1 },
+        Test{ 1, 9, -1 },
+    };
+
+    for (const auto& t : tests)
+    {
+        Log::Comment(NoThrowString().Format(L"firstRow=%d size=%d delta=%d", t.firstRow, t.size, t.delta));
+
+        // The rows are wider than the buffer is tall, so that each row ends in whitespace.
+        TextBuffer buffer{ { height + 2, height }, TextAttribute{ 0x07 }, 12, false, &_renderer };
+        std::vector<std::wstring> expected;
+
+        for (til::CoordType y = 0; y < height; ++y)
+        {
+            auto text = std::wstring(gsl::narrow_cast<size_t>(y + 1), gsl::narrow_cast<wchar_t>(L'a' + y));
+            text.resize(height + 2, L' ');
+
+            RowWriteState state{ .text = text };
+            auto& row = buffer.GetMutableRowByOffset(y);
+            row.ReplaceText(state);
+            row.ReplaceAttributes(0, y + 1, TextAttribute{ gsl::narrow_cast<WORD>(y + 1) });
+
+            expected.emplace_back(std::move(text));
+        }
+
+        for (auto y = 0; y < t.size; ++y)
+        {
+            til::at(expected, t.firstRow + t.delta + y) = buffer.GetRowByOffset(t.firstRow + y).GetText();
+        }
+
+        buffer.ScrollRows(t.firstRow, t.size, t.delta);
+
+        for (til::CoordType y = 0; y < height; ++y)
+        {
+            const auto& row = buffer.GetRowByOffset(y);
+            const auto& text = til::at(expected, y);
+            VERIFY_ARE_EQUAL(text, row.GetText());
+
+            // The attributes must have moved along with the text.
+            const auto length = gsl::narrow_cast<til::CoordType>(text.find(L' '));
+            VERIFY_ARE_EQUAL(TextAttribute{ gsl::narrow_cast<WORD>(length) }, row.GetAttrByColumn(0));
+        }
+    }
+}
+
+// RotateRows() moves the ROWs into place without copying them, including the rows uncovered by the scroll.
+void TextBufferTests::RotateRows()
+{
+    static constexpr til::CoordType height = 10;
+
+    struct Test
+    {
+        til::CoordType firstRow;
+        til::CoordType size;
+        til::CoordType delta;
+    };
+    static constexpr std::array tests{
+        Test{ 2, 5, -1 },
+        Test{ 2, 5, -2 },
+        Test{ 2, 5, 3 },
+        Test{ 0, 9, 1 },
+        Test{ 3, 2, -3 },
+        Test{ 1, 3, 5 },
+    };
+
+    for (const auto& t : tests)
+    {
+        Log::Comment(NoThrowString().Format(L"firstRow=%d size=%d delta=%d", t.firstRow, t.size, t.delta));
+
+        TextBuffer buffer{ { height + 2, height }, TextAttribute{ 0x07 }, 12, false, &_renderer };
+        std::vector<std::wstring> expectedText;
+        std::vector<const ROW*> expectedRows;
+
+        for (til::CoordType y = 0; y < height; ++y)
+        {
+            auto text = std::wstring(gsl::narrow_cast<size_t>(y + 1), gsl::narrow_cast<wchar_t>(L'a' + y));
+            text.resize(height + 2, L' ');
+
+            RowWriteState state{ .text = text };
+            auto& row = buffer.GetMutableRowByOffset(y);
+            row.ReplaceText(state);
+
+            expectedText.emplace_back(std::move(text));
+            expectedRows.emplace_back(&row);
+        }
+
+        // The same rotation that RotateRows() is documented to perform.
+        const auto beg = t.delta < 0 ? t.firstRow + t.delta : t.firstRow;
+        const auto end = t.firstRow + t.size + std::max(0, t.delta);
+        const auto mid = t.delta < 0 ? beg - t.delta : beg + t.size;
+        std::rotate(expectedText.begin() + beg, expectedText.begin() + mid, expectedText.begin() + end);
+        std::rotate(expectedRows.begin() + beg, expectedRows.begin() + mid, expectedRows.begin() + end);
+
+        const auto mutationId = buffer.GetLastMutationId();
+        buffer.RotateRows(t.firstRow, t.size, t.delta);
+        VERIFY_ARE_NOT_EQUAL(mutationId, buffer.GetLastMutationId());
+
+        for (til::CoordType y = 0; y < height; ++y)
+        {
+            const auto& row = buffer.GetRowByOffset(y);
+            VERIFY_ARE_EQUAL(til::at(expectedText, y), row.GetText());
+            // Each ROW must have stayed where it was in memory (and thus next to its text storage).
+            VERIFY_IS_TRUE(til::at(expectedRows, y) == &row);
+        }
+    }
+}
+
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
 // characters from the Unicode Storage buffer
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
@@ -1973,6 +2142,51 @@ void TextBufferTests::TestInsert()
     VERIFY_ARE_EQUAL(expectedAttr, actualAttr);
 }
 
+void TextBufferTests::TestAttributeInterning()
+{
+    static constexpr til::CoordType height = 100;
+    static constexpr til::CoordType iterations = 10000;
+
+    TextBuffer buffer{ { 10, height }, TextAttribute{ 0x07 }, 12, false, &_renderer };
+
+    const auto makeAttr = [](til::CoordType i) {
+        TextAttribute attr;
+        attr.SetForeground(RGB(i & 0xff, (i >> 8) & 0xff, 0));
+        return attr;
+    };
+
+    Log::Comment(L"Writing more unique attributes than the table holds before it gets compacted");
+    for (til::CoordType i = 0; i < iterations; ++i)
+    {
+        auto& row = buffer.GetMutableRowByOffset(i % height);
+        row.ReplaceAttributes(0, 5, makeAttr(i));
+        row.ReplaceAttributes(5, 10, TextAttribute{ 0x1f });
+    }
+
+    Log::Comment(L"Ensuring that compaction preserved the attributes that are still in use");
+    for (til::CoordType y = 0; y < height; ++y)
+    {
+        const auto& row = buffer.GetRowByOffset(y);
+        VERIFY_ARE_EQUAL(makeAttr(iterations - height + y), row.GetAttrByColumn(0));
+        VERIFY_ARE_EQUAL(TextAttribute{ 0x1f }, row.GetAttrByColumn(9));
+    }
+    VERIFY_IS_LESS_THAN(buffer._attrTable->size(), 4097u);
+
+    Log::Comment(L"Ensuring that copying rows between buffers re-interns their attributes");
+    TextBuffer other{ { 10, height }, TextAttribute{ 0x07 }, 12, false, &_renderer };
+    buffer.CopyRow(0, 0, other);
+    VERIFY_ARE_EQUAL(buffer.GetRowByOffset(0).Attributes(), other.GetRowByOffset(0).Attributes());
+    // TextAttribute{}, the initial attributes and the 2 attributes of the copied row.
+    VERIFY_ARE_EQUAL(4u, other._attrTable->size());
+
+    Log::Comment(NoThrowString().Format(
+        L"Bytes per run: %zu interned, %zu uninterned. Runs in %d rows: %zu",
+        sizeof(RowAttributeIds::rle_type),
+        sizeof(RowAttributes::rle_type),
+        height,
+        gsl::narrow_cast<size_t>(height) * 2));
+}
+
 void TextBufferTests::TestAppendRTFText()
 {
     {
@@ -2330,6 +2544,78 @@ void TextBufferTests::MoveByWord()
     }
 }
 
+void TextBufferTests::MoveByWordAcrossBlankRows()
+{
+    til::size bufferSize{ 80, 9001 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, &_renderer);
+
+    // Word navigation skips entire runs of whitespace at once. Make sure that
+    // this works across many rows and lands on the same cells as before.
+    std::vector<std::wstring> text{ L"word" };
+    text.resize(100);
+    text.emplace_back(L"  next");
+    WriteLinesToBuffer(text, *_buffer);
+
+    const std::wstring_view delimiters = L" ";
+    const auto lastCharPos = _buffer->GetLastNonSpaceCharacter();
+
+    til::point pos{ 0, 0 };
+    VERIFY_IS_TRUE(_buffer->MoveToNextWord(pos, delimiters, lastCharPos));
+    VERIFY_ARE_EQUAL(til::point(2, 100), pos);
+    VERIFY_IS_TRUE(_buffer->MoveToPreviousWord(pos, delimiters));
+    VERIFY_ARE_EQUAL(til::point(0, 0), pos);
+
+    VERIFY_ARE_EQUAL(til::point(0, 0), _buffer->GetWordStart({ 40, 50 }, delimiters, true));
+    VERIFY_ARE_EQUAL(til::point(0, 50), _buffer->GetWordStart({ 40, 50 }, delimiters, false));
+
+    // The rows' classification is cached. Modifying a row must invalidate it.
+    _buffer->GetMutableRowByOffset(50).ReplaceCharacters(40, 1, L"x");
+    VERIFY_ARE_EQUAL(til::point(40, 50), _buffer->GetWordStart({ 40, 50 }, delimiters, false));
+    VERIFY_ARE_EQUAL(til::point(41, 50), _buffer->GetWordStart({ 45, 50 }, delimiters, false));
+}
+
+void TextBufferTests::ClassifyDelimiters()
+{
+    const DelimiterClassifier classifier{ L" /\\()\"'-.,:;<>~!@#$%^&*|+=[]{}~?\u2502" };
+
+    VERIFY_IS_TRUE(classifier(L'\0') == DelimiterClass::ControlChar);
+    VERIFY_IS_TRUE(classifier(L'\t') == DelimiterClass::ControlChar);
+    VERIFY_IS_TRUE(classifier(L' ') == DelimiterClass::ControlChar);
+    VERIFY_IS_TRUE(classifier(L'/') == DelimiterClass::DelimiterChar);
+    VERIFY_IS_TRUE(classifier(L'~') == DelimiterClass::DelimiterChar);
+    VERIFY_IS_TRUE(classifier(L'\u2502') == DelimiterClass::DelimiterChar);
+    VERIFY_IS_TRUE(classifier(L'a') == DelimiterClass::RegularChar);
+    VERIFY_IS_TRUE(classifier(L'_') == DelimiterClass::RegularChar);
+    VERIFY_IS_TRUE(classifier(L'\x7f') == DelimiterClass::RegularChar);
+    VERIFY_IS_TRUE(classifier(L'\u00e9') == DelimiterClass::RegularChar);
+
+    // Runs are found 64 columns at a time. Place a few of them across such boundaries.
+    auto buffer = std::make_unique<TextBuffer>(til::size{ 150, 1 }, TextAttribute{ 0x7f }, 12u, false, &_renderer);
+    WriteLinesToBuffer({ std::wstring(60, L' ') + L"abc/def" }, *buffer);
+    const auto map = buffer->GetRowByOffset(0).ClassifyDelimiters(classifier);
+
+    VERIFY_IS_TRUE(map.At(10) == DelimiterClass::ControlChar);
+    VERIFY_ARE_EQUAL(0, map.RunStart(10));
+    VERIFY_ARE_EQUAL(60, map.RunEnd(10));
+    VERIFY_IS_TRUE(map.At(62) == DelimiterClass::RegularChar);
+    VERIFY_ARE_EQUAL(60, map.RunStart(62));
+    VERIFY_ARE_EQUAL(63, map.RunEnd(60));
+    VERIFY_IS_TRUE(map.At(63) == DelimiterClass::DelimiterChar);
+    VERIFY_ARE_EQUAL(63, map.RunStart(63));
+    VERIFY_ARE_EQUAL(64, map.RunEnd(63));
+    VERIFY_IS_TRUE(map.At(64) == DelimiterClass::RegularChar);
+    VERIFY_ARE_EQUAL(64, map.RunStart(66));
+    VERIFY_ARE_EQUAL(67, map.RunEnd(64));
+    VERIFY_ARE_EQUAL(67, map.RunStart(149));
+    VERIFY_ARE_EQUAL(150, map.RunEnd(100));
+
+    // Out of bounds columns are clamped.
+    VERIFY_ARE_EQUAL(0, map.RunStart(-1));
+    VERIFY_ARE_EQUAL(150, map.RunEnd(1000));
+}
+
 void TextBufferTests::GetGlyphBoundaries()
 {
     struct ExpectedResult
@@ -2690,6 +2976,51 @@ void TextBufferTests::GetPlainText()
 
 // This tests that when we increment the circular buffer, obsolete hyperlink references
 // are removed from the hyperlink map
+void TextBufferTests::CreateCopySnapshot()
+{
+    til::size bufferSize{ 10, 20 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, &_renderer);
+
+    const std::vector<std::wstring> bufferText = { L"12345",
+                                                   L"  345",
+                                                   L"123  ",
+                                                   L"  3  " };
+    WriteLinesToBuffer(bufferText, *_buffer);
+    _buffer->GetMutableRowByOffset(1).ReplaceAttributes(0, 3, TextAttribute{ 0x1f });
+
+    const auto req = TextBuffer::CopyRequest{ *_buffer, { 0, 0 }, { 5, 4 }, false, true, true, false };
+
+    size_t colorLookups = 0;
+    const auto GetAttributeColors = [&](const TextAttribute& attr) {
+        ++colorLookups;
+        const auto color = static_cast<COLORREF>(attr.GetLegacyAttributes());
+        return std::tuple{ color, color, color };
+    };
+
+    const auto snapshot = _buffer->CreateCopySnapshot(req, GetAttributeColors);
+
+    Log::Comment(L"Every distinct attribute is resolved exactly once.");
+    VERIFY_ARE_EQUAL(static_cast<size_t>(2), snapshot.styles.size());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(2), colorLookups);
+    VERIFY_ARE_EQUAL(static_cast<size_t>(req.end.y - req.beg.y + 1), snapshot.rows.size());
+
+    Log::Comment(L"The second row starts with a run in the 0x1f attribute.");
+    const auto& secondRowRun = snapshot.runs.at(snapshot.rows.at(0).runEnd);
+    VERIFY_ARE_EQUAL(TextAttribute{ 0x1f }, snapshot.styles.at(secondRowRun.style).attr);
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"12345  3" }, std::wstring_view{ snapshot.text }.substr(0, 8));
+
+    Log::Comment(L"Generating from the snapshot is equivalent to generating from the buffer.");
+    const auto expectedHtml = _buffer->GenHTML(req, 12, L"Consolas", 0, false, GetAttributeColors);
+    const auto expectedRtf = _buffer->GenRTF(req, 12, L"Consolas", 0, false, GetAttributeColors);
+    const auto actualHtml = TextBuffer::GenHTML(snapshot, 12, L"Consolas", 0, false);
+    const auto actualRtf = TextBuffer::GenRTF(snapshot, 12, L"Consolas", 0, false);
+    VERIFY_IS_FALSE(expectedHtml.empty());
+    VERIFY_ARE_EQUAL(std::string_view{ expectedHtml }, std::string_view{ actualHtml });
+    VERIFY_ARE_EQUAL(std::string_view{ expectedRtf }, std::string_view{ actualRtf });
+}
+
 void TextBufferTests::HyperlinkTrim()
 {
     // Set up a text buffer for us
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+namespace til
+{
+    // A map with a fixed capacity, which evicts the least recently used entry once it's full.
+    // Both find() and insert_or_assign() count as a "use". find() additionally keeps track of
+    // the number of hits and misses, so that callers can judge whether the cache pays off.
+    //
+    // This class isn't thread-safe. Wrap it in a til::shared_mutex if it needs to be shared.
+    template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+    class lru_cache
+    {
+        // The entries are stored in a list sorted from most to least recently used,
+        // which allows us to move an entry to the front without invalidating the map.
+        // The map in turn refers to the keys in the list instead of storing a copy.
+        using list_type = std::list<std::pair<const K, V>>;
+        using key_ref = std::reference_wrapper<const K>;
+
+        struct ref_hash : Hash
+        {
+            size_t operator()(const K& key) const noexcept(noexcept(std::declval<const Hash&>()(key)))
+            {
+                return Hash::operator()(key);
+            }
+        };
+
+        struct ref_equal : KeyEqual
+        {
+            bool operator()(const K& lhs, const K& rhs) const noexcept(noexcept(std::declval<const KeyEqual&>()(lhs, rhs)))
+            {
+                return KeyEqual::operator()(lhs, rhs);
+            }
+        };
+
+    public:
+        explicit lru_cache(size_t capacity) :
+            _capacity{ std::max<size_t>(capacity, 1) }
+        {
+        }
+
+        lru_cache(const lru_cache&) = delete;
+        lru_cache& operator=(const lru_cache&) = delete;
+
+        size_t size() const noexcept
+        {
+            return _map.size();
+        }
+
+        size_t capacity() const noexcept
+        {
+            return _capacity;
+        }
+
+        uint64_t hits() const noexcept
+        {
+            return _hits;
+        }
+
+        uint64_t misses() const noexcept
+        {
+            return _misses;
+        }
+
+        // Returns a pointer to the value for the given key or nullptr if there's none.
+        // The pointer remains valid until the entry is evicted or the cache is cleared.
+        V* find(const K& key)
+        {
+            const auto it = _map.find(key);
+            if (it == _map.end())
+            {
+                _misses++;
+                return nullptr;
+            }
+
+            _hits++;
+            _list.splice(_list.begin(), _list, it->second);
+            return &it->second->second;
+        }
+
+        V& insert_or_assign(const K& key, V value)
+        {
+            if (const auto it = _map.find(key); it != _map.end())
+            {
+                _list.splice(_list.begin(), _list, it->second);
+                return it->second->second = std::move(value);
+            }
+
+            if (_map.size() >= _capacity)
+            {
+                _map.erase(_list.back().first);
+                _list.pop_back();
+            }
+
+            _list.emplace_front(key, std::move(value));
+            try
+            {
+                _map.emplace(_list.front().first, _list.begin());
+            }
+            catch (...)
+            {
+                _list.pop_front();
+                throw;
+            }
+            return _list.front().second;
+        }
+
+        void clear() noexcept
+        {
+            _map.clear();
+            _list.clear();
+        }
+
+    private:
+        list_type _list;
+        std::unordered_map<key_ref, typename list_type::iterator, ref_hash, ref_equal> _map;
+        size_t _capacity = 0;
+        uint64_t _hits = 0;
+        uint64_t _misses = 0;
+    };
+}
@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace til
+{
+    // Returns how many chunks `itemCount` items should be split into, such that each chunk has at least
+    // `minItemsPerChunk` items (spawning a thread isn't free) and there aren't more chunks than CPU cores.
+    inline size_t parallel_chunk_count(const size_t itemCount, const size_t minItemsPerChunk) noexcept
+    {
+        const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        return std::clamp<size_t>(itemCount / std::max<size_t>(minItemsPerChunk, 1), 1, cores);
+    }
+
+    // Calls `func(i)` for each i in [0, count) on a thread of its own and returns once all of them returned.
+    // func(0) runs on the calling thread, as it would otherwise just sit there and wait. If a thread
+    // can't be spawned, its call runs on the calling thread instead. Once all calls have finished,
+    // the exception thrown by the lowest index (if any) is rethrown.
+    template<typename Func>
+    void parallel_for(const size_t count, Func&& func)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        std::vector<std::exception_ptr> errors(count);
+        const auto run = [&](const size_t i) noexcept {
+            try
+            {
+                func(i);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        };
+
+        {
+            std::vector<std::thread> threads;
+            threads.reserve(count - 1);
+
+            for (size_t i = 1; i < count; ++i)
+            {
+                try
+                {
+                    threads.emplace_back(run, i);
+                }
+                catch (...)
+                {
+                    run(i);
+                }
+            }
+
+            run(0);
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        for (const auto& error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+}
@@ -286,6 +286,16 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         return !(lhs == rhs);
     }
 
+    // A single edit for basic_rle::replace_ranges():
+    // Replaces the range [start_index, end_index) with value.
+    template<typename T, typename S>
+    struct rle_edit
+    {
+        S start_index{};
+        S end_index{};
+        T value{};
+    };
+
     template<typename T, typename S = std::size_t, typename Container = std::vector<rle_pair<T, S>>>
     class basic_rle
     {
@@ -303,6 +313,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
         using rle_type = rle_pair<value_type, size_type>;
+        using edit_type = rle_edit<value_type, size_type>;
         using container = Container;
 
         // We don't check anywhere whether a size_type value is negative.
@@ -491,6 +502,113 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             _replace_unchecked(start_index, end_index, replacements._runs);
         }
 
+        // Applies all edits at once, with the same result as calling replace() for each of them.
+        // The edits must be sorted by their start_index and must not overlap.
+        // Calling replace() shifts all trailing runs around for each edit, whereas
+        // this function builds the new runs in a single pass over the old ones.
+        // If an end_index is larger than size() it's set to size().
+        void replace_ranges(const std::span<const edit_type> edits)
+        {
+            if (edits.empty())
+            {
+                return;
+            }
+
+            container runs;
+            runs.reserve(_runs.size() + 2 * edits.size());
+
+            const auto append = [&](const value_type& value, const size_type length) {
+                if (!length)
+                {
+                    return;
+                }
+                if (!runs.empty() && runs.back().value == value)
+                {
+                    runs.back().length += length;
+                }
+                else
+                {
+                    runs.emplace_back(value, length);
+                }
+            };
+
+            // Everything in front of pos has been written to runs already.
+            // it points to the run that contains pos and it_pos is the index that run starts at.
+            auto it = _runs.begin();
+            size_type it_pos = 0;
+            size_type pos = 0;
+
+            // Copies the existing runs in the range [pos, index) over.
+            const auto copy_until = [&](const size_type index) {
+                while (pos < index)
+                {
+                    const auto it_end = gsl::narrow_cast<size_type>(it_pos + it->length);
+                    const auto end = std::min(it_end, index);
+                    append(it->value, gsl::narrow_cast<size_type>(end - pos));
+                    pos = end;
+
+                    if (pos == it_end)
+                    {
+                        it_pos = it_end;
+                        ++it;
+                    }
+                }
+            };
+
+            for (const auto& edit : edits)
+            {
+                auto end_index = edit.end_index;
+                _check_indices(edit.start_index, end_index);
+
+                if (edit.start_index < pos)
+                {
+                    throw std::out_of_range("edits must be sorted and must not overlap");
+                }
+
+                copy_until(edit.start_index);
+                append(edit.value, gsl::narrow_cast<size_type>(end_index - edit.start_index));
+
+                // Skip over the replaced runs.
+                while (it != _runs.end() && gsl::narrow_cast<size_type>(it_pos + it->length) <= end_index)
+                {
+                    it_pos += it->length;
+                    ++it;
+                }
+                pos = end_index;
+            }
+
+            copy_until(_total_length);
+            _runs = std::move(runs);
+        }
+
+        // Replaces each value in the range [start_index, end_index) with func(value).
+        // func is called once per run, not once per position. Runs that end up
+        // with the same value as their neighbors are merged with them.
+        // If end_index is larger than size() it's set to size().
+        // start_index must be smaller or equal to end_index.
+        template<typename Func>
+        void transform(size_type start_index, size_type end_index, Func&& func)
+        {
+            _check_indices(start_index, end_index);
+
+            if (start_index == end_index)
+            {
+                return;
+            }
+
+            // Split the runs at the boundaries, so that the range consists of whole runs.
+            const auto first = _split(start_index);
+            const auto last = _split(end_index);
+
+            for (auto it = _runs.begin() + first, end = _runs.begin() + last; it != end; ++it)
+            {
+                it->value = func(std::as_const(it->value));
+            }
+
+            // Only the transformed runs and their neighbors can have become mergeable.
+            _compact(first ? first - 1 : 0, std::min(last + 1, _runs.size()));
+        }
+
         // Replaces every instance of old_value in this vector with new_value.
         void replace_values(const value_type& old_value, const value_type& new_value)
         {
@@ -689,6 +807,51 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             }
         }
 
+        // Merges adjacent runs with equal values in the range of runs [first, last).
+        void _compact(const size_t first, const size_t last)
+        {
+            const auto begin = _runs.begin() + first;
+            const auto end = _runs.begin() + last;
+
+            if (begin == end)
+            {
+                return;
+            }
+
+            auto ref = begin;
+            for (auto it = begin; ++it != end;)
+            {
+                if (ref->value == it->value)
+                {
+                    ref->length += it->length;
+                }
+                else
+                {
+                    *++ref = std::move(*it);
+                }
+            }
+
+            _runs.erase(++ref, end);
+        }
+
+        // Ensures that a run starts at the given index by splitting the run that contains it.
+        // Returns the offset of that run in _runs, or _runs.size() if index is equal to size().
+        size_t _split(const size_type index)
+        {
+            rle_scanner scanner(_runs.begin(), _runs.end());
+            auto [it, pos] = scanner.scan(index);
+
+            if (pos)
+            {
+                auto tail = *it;
+                tail.length = gsl::narrow_cast<size_type>(it->length - pos);
+                it->length = pos;
+                it = _runs.insert(it + 1, std::move(tail));
+            }
+
+            return gsl::narrow_cast<size_t>(it - _runs.begin());
+        }
+
         inline void _check_indices(size_type start_index, size_type& end_index)
         {
             if (end_index > _total_length)
@@ -292,6 +292,12 @@ static constexpr TsfDataProvider s_tsfDataProvider;
 
         gci.GetCursorBlinker().FocusStart();
 
+        // The focused renderer gets painted before any others and isn't throttled.
+        if (g.pRender)
+        {
+            g.pRender->SetFocusHint(true);
+        }
+
         HandleFocusEvent(TRUE);
 
         if (!g.tsf)
@@ -319,6 +325,11 @@ static constexpr TsfDataProvider s_tsfDataProvider;
         gci.GetActiveOutputBuffer().GetTextBuffer().GetCursor().SetIsOn(false);
         gci.GetCursorBlinker().FocusEnd();
 
+        if (g.pRender)
+        {
+            g.pRender->SetFocusHint(false);
+        }
+
         HandleFocusEvent(FALSE);
 
         break;
@@ -851,6 +851,7 @@ void AtlasEngine::_resolveFontMetrics(const FontInfoDesired& fontInfoDesired, Fo
         fontMetrics->fontFallback = std::move(fontFallback);
         fontMetrics->fontFallback.try_query_to(fontMetrics->fontFallback1.put());
         fontMetrics->fontName = std::move(primaryFontName);
+        fontMetrics->fontFamilies = faceName;
         fontMetrics->fontSize = fontSizeInPx;
         fontMetrics->cellSize = { cellWidth, cellHeight };
         fontMetrics->fontWeight = fontWeightU16;
@@ -4,6 +4,8 @@
 #include "pch.h"
 #include "AtlasEngine.h"
 
+#include <til/hash.h>
+#include <til/lru_cache.h>
 #include <til/unicode.h>
 
 #include "Backend.h"
@@ -560,22 +562,24 @@ try
     if (b.revision != revision)
     {
         const auto srcHeight = std::max(0, srcCellSize.height);
-        const auto pixels = imageSlice.Pixels();
+        const auto pixelCount = imageSlice.PixelCount();
         const auto expectedSize = gsl::narrow_cast<size_t>(srcWidth) * gsl::narrow_cast<size_t>(srcHeight);
 
         // Sanity check.
-        if (pixels.size() != expectedSize)
+        if (pixelCount != expectedSize)
         {
             assert(false);
             return S_OK;
         }
 
-        if (b.source.size() != pixels.size())
+        if (b.source.size() != pixelCount)
         {
-            b.source = Buffer<u32, 32>{ pixels.size() };
+            b.source = Buffer<u32, 32>{ pixelCount };
         }
 
-        memcpy(b.source.data(), pixels.data(), pixels.size_bytes());
+        // ImageSlice stores palette indices, which we only expand into RGBA when the slice changed.
+        static_assert(sizeof(u32) == sizeof(RGBQUAD));
+        imageSlice.ExpandPixels({ reinterpret_cast<RGBQUAD*>(b.source.data()), pixelCount });
         b.revision = revision;
         b.sourceSize.x = srcWidth;
         b.sourceSize.y = srcHeight;
@@ -759,6 +763,8 @@ void AtlasEngine::_recreateFontDependentResources()
             _api.textFormatAxes[i] = { fontAxisValues.data(), fontAxisValues.size() };
         }
     }
+
+    _api.shapingFontId = _internShapingFont();
 }
 
 void AtlasEngine::_recreateCellCountDependentResources()
@@ -864,9 +870,145 @@ void AtlasEngine::_flushBufferLine()
     }
 }
 
+struct AtlasEngine::ShapingCache
+{
+    // A typical line of text takes up about 1-2KB per entry.
+    static constexpr size_t Capacity = 2048;
+    // We don't track which font ids are still in use. Instead we simply start
+    // over once there are too many. Cache entries that use one of the
+    // forgotten ids will get evicted eventually as they go unused.
+    static constexpr size_t MaxFontIds = 64;
+
+    til::lru_cache<ShapingCacheKey, std::shared_ptr<const ShapedRun>, ShapingCacheKeyHash> runs{ Capacity };
+    std::unordered_map<std::string, u64> fontIds;
+    u64 nextFontId = 1;
+};
+
+size_t AtlasEngine::ShapingCacheKeyHash::operator()(const ShapingCacheKey& key) const noexcept
+{
+    til::hasher h;
+    h.write(key.fontId);
+    h.write(key.attributes);
+    h.write(key.text);
+    h.write(key.columns.data(), key.columns.size());
+    return h.finalize();
+}
+
+til::shared_mutex<AtlasEngine::ShapingCache>& AtlasEngine::_shapingCache()
+{
+    static til::shared_mutex<ShapingCache> cache;
+    return cache;
+}
+
+AtlasEngine::ShapingCacheStats AtlasEngine::GetShapingCacheStats() noexcept
+{
+    const auto cache = _shapingCache().lock_shared();
+    return { cache->runs.hits(), cache->runs.misses(), cache->runs.size() };
+}
+
+// Returns a process-wide id for all the font settings that affect the result of _shapeRegularText().
+// AtlasEngine instances with identical font settings get the same id and thus share cache entries.
+u64 AtlasEngine::_internShapingFont() const
+{
+    const auto& font = *_p.s->font;
+    std::string descriptor;
+    const auto append = [&](const void* data, size_t size) {
+        descriptor.append(static_cast<const char*>(data), size);
+    };
+    const auto appendVector = [&](const auto& vec) {
+        const auto size = vec.size();
+        append(&size, sizeof(size));
+        append(vec.data(), size * sizeof(vec[0]));
+    };
+
+    // The font collection is either the system one or FontCache::GetCached(). Both are effectively
+    // process-wide singletons. If they weren't, we'd simply fail to share entries between instances.
+    const auto fontCollection = font.fontCollection.get();
+    append(&fontCollection, sizeof(fontCollection));
+    appendVector(font.fontFamilies);
+    appendVector(_p.userLocaleName);
+    appendVector(font.fontFeatures);
+    appendVector(font.fontAxisValues);
+    append(&font.fontSize, sizeof(font.fontSize));
+    append(&font.fontWeight, sizeof(font.fontWeight));
+    append(&font.cellSize.x, sizeof(font.cellSize.x));
+
+    const auto cache = _shapingCache().lock();
+    if (const auto it = cache->fontIds.find(descriptor); it != cache->fontIds.end())
+    {
+        return it->second;
+    }
+    if (cache->fontIds.size() >= ShapingCache::MaxFontIds)
+    {
+        cache->fontIds.clear();
+    }
+    const auto id = cache->nextFontId++;
+    cache->fontIds.emplace(std::move(descriptor), id);
+    return id;
+}
+
 void AtlasEngine::_mapRegularText(size_t offBeg, size_t offEnd)
 {
     auto& row = *_p.rows[_api.lastPaintBufferLineCoord.y];
+    const auto colBeg = _api.bufferLineColumn[offBeg];
+
+    auto& key = _api.shapingCacheKey;
+    key.fontId = _api.shapingFontId;
+    key.attributes = _api.attributes;
+    key.text.assign(_api.bufferLine.data() + offBeg, offEnd - offBeg);
+    key.columns.clear();
+    for (auto i = offBeg; i <= offEnd; ++i)
+    {
+        key.columns.emplace_back(gsl::narrow_cast<u16>(_api.bufferLineColumn[i] - colBeg));
+    }
+
+    std::shared_ptr<const ShapedRun> run;
+    {
+        const auto cache = _shapingCache().lock();
+        if (const auto cached = cache->runs.find(key))
+        {
+            run = *cached;
+        }
+    }
+    if (!run)
+    {
+        run = _shapeRegularText(offBeg, offEnd);
+        _shapingCache().lock()->runs.insert_or_assign(key, run);
+    }
+
+    const auto glyphsBeg = row.glyphIndices.size();
+    for (const auto& m : run->mappings)
+    {
+        const auto glyphsFrom = glyphsBeg + m.glyphsFrom;
+        const auto glyphsTo = glyphsBeg + m.glyphsTo;
+
+        // IDWriteFontFallback::MapCharacters() isn't just awfully slow,
+        // it can also repeatedly return the same font face again and again. :)
+        if (row.mappings.empty() || row.mappings.back().fontFace != m.fontFace)
+        {
+            row.mappings.emplace_back(m.fontFace, glyphsFrom, glyphsTo);
+        }
+        else
+        {
+            row.mappings.back().glyphsTo = glyphsTo;
+        }
+    }
+
+    row.glyphIndices.insert(row.glyphIndices.end(), run->glyphIndices.begin(), run->glyphIndices.end());
+    row.glyphAdvances.insert(row.glyphAdvances.end(), run->glyphAdvances.begin(), run->glyphAdvances.end());
+    row.glyphOffsets.insert(row.glyphOffsets.end(), run->glyphOffsets.begin(), run->glyphOffsets.end());
+
+    const auto shift = gsl::narrow_cast<u8>(row.lineRendition != LineRendition::SingleWidth);
+    const auto colors = _p.foregroundBitmap.begin() + _p.colorBitmapRowStride * _api.lastPaintBufferLineCoord.y;
+    for (const auto col : run->glyphColumns)
+    {
+        row.colors.emplace_back(colors[static_cast<size_t>(colBeg + col) << shift]);
+    }
+}
+
+std::shared_ptr<const AtlasEngine::ShapedRun> AtlasEngine::_shapeRegularText(size_t offBeg, size_t offEnd)
+{
+    const auto run = std::make_shared<ShapedRun>();
 
     for (u32 idx = gsl::narrow_cast<u32>(offBeg), mappedEnd = 0; idx < offEnd; idx = mappedEnd)
     {
@@ -877,11 +1019,11 @@ void AtlasEngine::_mapRegularText(size_t offBeg, size_t offEnd)
 
         if (!mappedFontFace)
         {
-            _mapReplacementCharacter(idx, mappedEnd, row);
+            _mapReplacementCharacter(idx, mappedEnd, *run);
             continue;
         }
 
-        const auto initialIndicesCount = row.glyphIndices.size();
+        const auto initialIndicesCount = run->glyphIndices.size();
 
         // GetTextComplexity() returns as many glyph indices as its textLength parameter (here: mappedLength).
         // This block ensures that the buffer has sufficient capacity. It also initializes the glyphProps buffer because it and
@@ -906,47 +1048,52 @@ void AtlasEngine::_mapRegularText(size_t offBeg, size_t offEnd)
 
                 if (isTextSimple)
                 {
-                    const auto shift = gsl::narrow_cast<u8>(row.lineRendition != LineRendition::SingleWidth);
-                    const auto colors = _p.foregroundBitmap.begin() + _p.colorBitmapRowStride * _api.lastPaintBufferLineCoord.y;
-
                     for (size_t i = 0; i < complexityLength; ++i)
                     {
                         const auto col1 = _api.bufferLineColumn[idx + i + 0];
                         const auto col2 = _api.bufferLineColumn[idx + i + 1];
                         const auto glyphAdvance = (col2 - col1) * _p.s->font->cellSize.x;
-                        const auto fg = colors[static_cast<size_t>(col1) << shift];
-                        row.glyphIndices.emplace_back(_api.glyphIndices[i]);
-                        row.glyphAdvances.emplace_back(static_cast<f32>(glyphAdvance));
-                        row.glyphOffsets.emplace_back();
-                        row.colors.emplace_back(fg);
+                        run->glyphIndices.emplace_back(_api.glyphIndices[i]);
+                        run->glyphAdvances.emplace_back(static_cast<f32>(glyphAdvance));
+                        run->glyphOffsets.emplace_back();
+                        run->glyphColumns.emplace_back(col1);
                     }
                 }
                 else
                 {
-                    _mapComplex(mappedFontFace.get(), idx, complexityLength, row);
+                    _mapComplex(mappedFontFace.get(), idx, complexityLength, *run);
                 }
             }
         }
         else
         {
-            _mapComplex(mappedFontFace.get(), idx, mappedLength, row);
+            _mapComplex(mappedFontFace.get(), idx, mappedLength, *run);
         }
 
-        const auto indicesCount = row.glyphIndices.size();
+        const auto indicesCount = run->glyphIndices.size();
         if (indicesCount > initialIndicesCount)
         {
             // IDWriteFontFallback::MapCharacters() isn't just awfully slow,
             // it can also repeatedly return the same font face again and again. :)
-            if (row.mappings.empty() || row.mappings.back().fontFace != mappedFontFace)
+            if (run->mappings.empty() || run->mappings.back().fontFace != mappedFontFace)
             {
-                row.mappings.emplace_back(std::move(mappedFontFace), gsl::narrow_cast<u32>(initialIndicesCount), gsl::narrow_cast<u32>(indicesCount));
+                run->mappings.emplace_back(std::move(mappedFontFace), gsl::narrow_cast<u32>(initialIndicesCount), gsl::narrow_cast<u32>(indicesCount));
             }
             else
             {
-                row.mappings.back().glyphsTo = gsl::narrow_cast<u32>(indicesCount);
+                run->mappings.back().glyphsTo = gsl::narrow_cast<u32>(indicesCount);
             }
         }
     }
+
+    // The code above records absolute columns, but cached runs must be independent of their position.
+    const auto colBeg = _api.bufferLineColumn[offBeg];
+    for (auto& col : run->glyphColumns)
+    {
+        col = gsl::narrow_cast<u16>(col - colBeg);
+    }
+
+    return run;
 }
 
 void AtlasEngine::_mapBuiltinGlyphs(size_t offBeg, size_t offEnd)
@@ -1024,7 +1171,7 @@ void AtlasEngine::_mapCharacters(const wchar_t* text, const u32 textLength, u32*
     assert(scale == 1);
 }
 
-void AtlasEngine::_mapComplex(IDWriteFontFace2* mappedFontFace, u32 idx, u32 length, ShapedRow& row)
+void AtlasEngine::_mapComplex(IDWriteFontFace2* mappedFontFace, u32 idx, u32 length, ShapedRun& run)
 {
     _api.analysisResults.clear();
 
@@ -1134,8 +1281,6 @@ void AtlasEngine::_mapComplex(IDWriteFontFace2* mappedFontFace, u32 idx, u32 len
 
         _api.clusterMap[a.textLength] = gsl::narrow_cast<u16>(actualGlyphCount);
 
-        const auto shift = gsl::narrow_cast<u8>(row.lineRendition != LineRendition::SingleWidth);
-        const auto colors = _p.foregroundBitmap.begin() + _p.colorBitmapRowStride * _api.lastPaintBufferLineCoord.y;
         auto prevCluster = _api.clusterMap[0];
         size_t beg = 0;
 
@@ -1147,9 +1292,8 @@ void AtlasEngine::_mapComplex(IDWriteFontFace2* mappedFontFace, u32 idx, u32 len
                 continue;
             }
 
-            const size_t col1 = _api.bufferLineColumn[a.textPosition + beg];
-            const size_t col2 = _api.bufferLineColumn[a.textPosition + i];
-            const auto fg = colors[col1 << shift];
+            const auto col1 = _api.bufferLineColumn[a.textPosition + beg];
+            const auto col2 = _api.bufferLineColumn[a.textPosition + i];
 
             const auto expectedAdvance = (col2 - col1) * _p.s->font->cellSize.x;
             f32 actualAdvance = 0;
@@ -1159,19 +1303,19 @@ void AtlasEngine::_mapComplex(IDWriteFontFace2* mappedFontFace, u32 idx, u32 len
             }
             _api.glyphAdvances[nextCluster - 1] += expectedAdvance - actualAdvance;
 
-            row.colors.insert(row.colors.end(), nextCluster - prevCluster, fg);
+            run.glyphColumns.insert(run.glyphColumns.end(), nextCluster - prevCluster, col1);
 
             prevCluster = nextCluster;
             beg = i;
         }
 
-        row.glyphIndices.insert(row.glyphIndices.end(), _api.glyphIndices.begin(), _api.glyphIndices.begin() + actualGlyphCount);
-        row.glyphAdvances.insert(row.glyphAdvances.end(), _api.glyphAdvances.begin(), _api.glyphAdvances.begin() + actualGlyphCount);
-        row.glyphOffsets.insert(row.glyphOffsets.end(), _api.glyphOffsets.begin(), _api.glyphOffsets.begin() + actualGlyphCount);
+        run.glyphIndices.insert(run.glyphIndices.end(), _api.glyphIndices.begin(), _api.glyphIndices.begin() + actualGlyphCount);
+        run.glyphAdvances.insert(run.glyphAdvances.end(), _api.glyphAdvances.begin(), _api.glyphAdvances.begin() + actualGlyphCount);
+        run.glyphOffsets.insert(run.glyphOffsets.end(), _api.glyphOffsets.begin(), _api.glyphOffsets.begin() + actualGlyphCount);
     }
 }
 
-void AtlasEngine::_mapReplacementCharacter(u32 from, u32 to, ShapedRow& row)
+void AtlasEngine::_mapReplacementCharacter(u32 from, u32 to, ShapedRun& run)
 {
     if (!_api.replacementCharacterLookedUp)
     {
@@ -1202,9 +1346,7 @@ void AtlasEngine::_mapReplacementCharacter(u32 from, u32 to, ShapedRow& row)
 
     auto pos = from;
     auto col1 = _api.bufferLineColumn[from];
-    auto initialIndicesCount = row.glyphIndices.size();
-    const auto shift = gsl::narrow_cast<u8>(row.lineRendition != LineRendition::SingleWidth);
-    const auto colors = _p.foregroundBitmap.begin() + _p.colorBitmapRowStride * _api.lastPaintBufferLineCoord.y;
+    auto initialIndicesCount = run.glyphIndices.size();
 
     while (pos < to)
     {
@@ -1214,21 +1356,21 @@ void AtlasEngine::_mapReplacementCharacter(u32 from, u32 to, ShapedRow& row)
             continue;
         }
 
-        row.glyphIndices.emplace_back(_api.replacementCharacterGlyphIndex);
-        row.glyphAdvances.emplace_back(static_cast<f32>((col2 - col1) * _p.s->font->cellSize.x));
-        row.glyphOffsets.emplace_back();
-        row.colors.emplace_back(colors[static_cast<size_t>(col1) << shift]);
+        run.glyphIndices.emplace_back(_api.replacementCharacterGlyphIndex);
+        run.glyphAdvances.emplace_back(static_cast<f32>((col2 - col1) * _p.s->font->cellSize.x));
+        run.glyphOffsets.emplace_back();
+        run.glyphColumns.emplace_back(col1);
 
         col1 = col2;
     }
 
     {
-        const auto indicesCount = row.glyphIndices.size();
+        const auto indicesCount = run.glyphIndices.size();
         const auto fontFace = _api.replacementCharacterFontFace.get();
 
         if (indicesCount > initialIndicesCount)
         {
-            row.mappings.emplace_back(fontFace, gsl::narrow_cast<u32>(initialIndicesCount), gsl::narrow_cast<u32>(indicesCount));
+            run.mappings.emplace_back(fontFace, gsl::narrow_cast<u32>(initialIndicesCount), gsl::narrow_cast<u32>(indicesCount));
         }
     }
 }
@@ -6,6 +6,7 @@
 #include <dwrite_3.h>
 #include <d3d11_2.h>
 #include <dxgi1_3.h>
+#include <til/mutex.h>
 
 #include "common.h"
 
@@ -78,17 +79,63 @@ namespace Microsoft::Console::Render::Atlas
         [[nodiscard]] HRESULT SetWindowSize(til::size pixels) noexcept;
         [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& pfiFontInfoDesired, FontInfo& fiFontInfo, const std::unordered_map<std::wstring_view, float>& features, const std::unordered_map<std::wstring_view, float>& axes) noexcept;
 
+        struct ShapingCacheStats
+        {
+            u64 hits = 0;
+            u64 misses = 0;
+            size_t size = 0;
+        };
+        static ShapingCacheStats GetShapingCacheStats() noexcept;
+
     private:
+        // The result of _mapRegularText() for a run of text, minus the colors, which are looked up by
+        // glyphColumns when the run is appended to a ShapedRow. Font fallback and shaping are expensive
+        // and identical runs are common (prompts, status bars, log prefixes, etc.), which is why
+        // the results are cached process-wide and shared between all AtlasEngine instances.
+        struct ShapedRun
+        {
+            // glyphsFrom/glyphsTo are relative to the start of the run.
+            std::vector<FontMapping> mappings;
+            std::vector<u16> glyphIndices;
+            std::vector<f32> glyphAdvances;
+            std::vector<DWRITE_GLYPH_OFFSET> glyphOffsets;
+            // The column of each glyph relative to the start of the run.
+            std::vector<u16> glyphColumns;
+        };
+
+        struct ShapingCacheKey
+        {
+            // See _internShapingFont().
+            u64 fontId = 0;
+            FontRelevantAttributes attributes = FontRelevantAttributes::None;
+            std::wstring text;
+            // The columns of each character relative to the start of the run (+1 for the end).
+            std::vector<u16> columns;
+
+            bool operator==(const ShapingCacheKey& rhs) const = default;
+        };
+
+        struct ShapingCacheKeyHash
+        {
+            size_t operator()(const ShapingCacheKey& key) const noexcept;
+        };
+
+        struct ShapingCache;
+
+        static til::shared_mutex<ShapingCache>& _shapingCache();
+
         // AtlasEngine.cpp
         ATLAS_ATTR_COLD void _handleSettingsUpdate();
         void _recreateFontDependentResources();
         void _recreateCellCountDependentResources();
         void _flushBufferLine();
+        u64 _internShapingFont() const;
         void _mapRegularText(size_t offBeg, size_t offEnd);
+        std::shared_ptr<const ShapedRun> _shapeRegularText(size_t offBeg, size_t offEnd);
         void _mapBuiltinGlyphs(size_t offBeg, size_t offEnd);
         void _mapCharacters(const wchar_t* text, u32 textLength, u32* mappedLength, IDWriteFontFace2** mappedFontFace) const;
-        void _mapComplex(IDWriteFontFace2* mappedFontFace, u32 idx, u32 length, ShapedRow& row);
-        ATLAS_ATTR_COLD void _mapReplacementCharacter(u32 from, u32 to, ShapedRow& row);
+        void _mapComplex(IDWriteFontFace2* mappedFontFace, u32 idx, u32 length, ShapedRun& run);
+        ATLAS_ATTR_COLD void _mapReplacementCharacter(u32 from, u32 to, ShapedRun& run);
         void _fillColorBitmap(const size_t y, const size_t x1, const size_t x2, const u32 fgColor, const u32 bgColor) noexcept;
         [[nodiscard]] HRESULT _drawHighlighted(std::span<const til::point_span>& highlights, const u16 row, const u16 begX, const u16 endX, const u32 fgColor, const u32 bgColor) noexcept;
 
@@ -151,6 +198,11 @@ namespace Microsoft::Console::Render::Atlas
             Buffer<f32> glyphAdvances;
             Buffer<DWRITE_GLYPH_OFFSET> glyphOffsets;
 
+            // The shaping cache key for the current font settings and
+            // the key for the current _mapRegularText() call, reused to avoid allocations.
+            u64 shapingFontId = 0;
+            ShapingCacheKey shapingCacheKey;
+
             wil::com_ptr<IDWriteFontFallback> systemFontFallback;
             wil::com_ptr<IDWriteFontFace2> replacementCharacterFontFace;
             u16 replacementCharacterGlyphIndex = 0;
@@ -120,9 +120,7 @@ void BackendD2D::_handleSettingsUpdate(const RenderingPayload& p)
         _renderTarget->SetDpi(dpi, dpi);
         _renderTarget->SetTextAntialiasMode(static_cast<D2D1_TEXT_ANTIALIAS_MODE>(p.s->font->antialiasingMode));
 
-        _builtinGlyphsRenderTarget.reset();
         _builtinGlyphsBitmap.reset();
-        _builtinGlyphsRenderTargetActive = false;
     }
 
     if (renderTargetChanged || fontChanged || cellCountChanged || backgroundColorChanged)
@@ -348,7 +346,7 @@ f32 BackendD2D::_drawBuiltinGlyphs(const RenderingPayload& p, const ShapedRow* r
     const f32 cellBottom = cellTop + p.s->font->cellSize.y;
     const f32 cellWidth = p.s->font->cellSize.x;
 
-    _prepareBuiltinGlyphRenderTarget(p);
+    _prepareBuiltinGlyphBitmap(p);
 
     for (size_t i = m.glyphsFrom; i < m.glyphsTo; ++i)
     {
@@ -381,7 +379,7 @@ f32 BackendD2D::_drawBuiltinGlyphs(const RenderingPayload& p, const ShapedRow* r
     return baselineX;
 }
 
-void BackendD2D::_prepareBuiltinGlyphRenderTarget(const RenderingPayload& p)
+void BackendD2D::_prepareBuiltinGlyphBitmap(const RenderingPayload& p)
 {
     // If we don't have support for ID2D1SpriteBatch none of the related members will be initialized or used.
     // We can just early-return in that case.
@@ -390,10 +388,10 @@ void BackendD2D::_prepareBuiltinGlyphRenderTarget(const RenderingPayload& p)
         return;
     }
 
-    // If the render target is already created, all of the below has already been done in a previous frame.
+    // If the bitmap is already created, all of the below has already been done in a previous frame.
     // Once the relevant settings change for some reason (primarily the font->cellSize), then _handleSettingsUpdate()
-    // will reset the render target which will cause us to skip this condition and re-initialize it below.
-    if (_builtinGlyphsRenderTarget)
+    // will reset the bitmap which will cause us to skip this condition and re-initialize it below.
+    if (_builtinGlyphsBitmap)
     {
         return;
     }
@@ -419,23 +417,17 @@ void BackendD2D::_prepareBuiltinGlyphRenderTarget(const RenderingPayload& p)
     const auto u = cellCountU * cellWidth;
     const auto v = cellCountV * cellHeight;
 
-    const D2D1_SIZE_F sizeF{ static_cast<f32>(u), static_cast<f32>(v) };
-    const D2D1_SIZE_U sizeU{ gsl::narrow_cast<UINT32>(u), gsl::narrow_cast<UINT32>(v) };
-    static constexpr D2D1_PIXEL_FORMAT format{ DXGI_FORMAT_A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED };
-    wil::com_ptr<ID2D1BitmapRenderTarget> target;
-    THROW_IF_FAILED(_renderTarget->CreateCompatibleRenderTarget(&sizeF, &sizeU, &format, D2D1_COMPATIBLE_RENDER_TARGET_OPTIONS_NONE, target.addressof()));
-
-    THROW_IF_FAILED(target->GetBitmap(_builtinGlyphsBitmap.put()));
-    _builtinGlyphsRenderTarget = target.query<ID2D1DeviceContext>();
+    const D2D1_SIZE_U size{ gsl::narrow_cast<UINT32>(u), gsl::narrow_cast<UINT32>(v) };
+    const D2D1_BITMAP_PROPERTIES props{
+        .pixelFormat = { DXGI_FORMAT_A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED },
+        .dpiX = static_cast<f32>(p.s->font->dpi),
+        .dpiY = static_cast<f32>(p.s->font->dpi),
+    };
+    // The initial contents of the bitmap are undefined, but that's fine, because
+    // _prepareBuiltinGlyph() fills each cell before a sprite may refer to it.
+    THROW_IF_FAILED(_renderTarget->CreateBitmap(size, nullptr, 0, &props, _builtinGlyphsBitmap.put()));
     _builtinGlyphsBitmapCellCountU = cellCountU;
     memset(&_builtinGlyphsReady[0], 0, sizeof(_builtinGlyphsReady));
-
-    _builtinGlyphsRenderTarget->BeginDraw();
-    _builtinGlyphsRenderTargetActive = true;
-
-    // The initial contents of the bitmap are undefined.
-    // -> We need to define them. :)
-    _builtinGlyphsRenderTarget->Clear();
 }
 
 D2D1_RECT_U BackendD2D::_prepareBuiltinGlyph(const RenderingPayload& p, char32_t ch, u32 off)
@@ -452,28 +444,26 @@ D2D1_RECT_U BackendD2D::_prepareBuiltinGlyph(const RenderingPayload& p, char32_t
         return rectU;
     }
 
-    static constexpr D2D1_COLOR_F shadeColorMap[] = {
-        { 1, 1, 1, 0.25f }, // Shape_Filled025
-        { 1, 1, 1, 0.50f }, // Shape_Filled050
-        { 1, 1, 1, 0.75f }, // Shape_Filled075
-        { 1, 1, 1, 1.00f }, // Shape_Filled100
+    // Unlike BackendD3D we don't have a shader that could draw the shades as a pixel pattern,
+    // so we simply draw them translucent (as alpha = coverage * shade).
+    static constexpr u32 shadeAlphaMap[] = {
+        64, // Shade::Filled025
+        128, // Shade::Filled050
+        191, // Shade::Filled075
+        255, // Shade::Filled100
     };
 
-    if (!_builtinGlyphsRenderTargetActive)
+    if (const auto mask = BuiltinGlyphs::GetBuiltinGlyphMask(ch, static_cast<u16>(w), static_cast<u16>(h)))
     {
-        _builtinGlyphsRenderTarget->BeginDraw();
-        _builtinGlyphsRenderTargetActive = true;
+        const auto shadeAlpha = shadeAlphaMap[static_cast<size_t>(mask->shade)];
+        Buffer<u8> alpha{ mask->coverage.size() };
+        for (size_t i = 0; i < alpha.size(); ++i)
+        {
+            alpha[i] = static_cast<u8>((mask->coverage[i] * shadeAlpha + 127) / 255);
+        }
+        THROW_IF_FAILED(_builtinGlyphsBitmap->CopyFromMemory(&rectU, alpha.data(), w));
     }
 
-    const auto brush = _brushWithColor(0xffffffff);
-    const D2D1_RECT_F rectF{
-        static_cast<f32>(rectU.left),
-        static_cast<f32>(rectU.top),
-        static_cast<f32>(rectU.right),
-        static_cast<f32>(rectU.bottom),
-    };
-    BuiltinGlyphs::DrawBuiltinGlyph(p.d2dFactory.get(), _builtinGlyphsRenderTarget.get(), brush, shadeColorMap, rectF, ch);
-
     _builtinGlyphsReady[off] = true;
     return rectU;
 }
@@ -487,12 +477,6 @@ void BackendD2D::_flushBuiltinGlyphs()
         return;
     }
 
-    if (_builtinGlyphsRenderTargetActive)
-    {
-        THROW_IF_FAILED(_builtinGlyphsRenderTarget->EndDraw());
-        _builtinGlyphsRenderTargetActive = false;
-    }
-
     if (const auto count = _builtinGlyphBatch->GetSpriteCount(); count > 0)
     {
         _renderTarget4->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
@@ -21,7 +21,7 @@ namespace Microsoft::Console::Render::Atlas
         void _drawBackground(const RenderingPayload& p);
         void _drawText(RenderingPayload& p);
         ATLAS_ATTR_COLD f32 _drawBuiltinGlyphs(const RenderingPayload& p, const ShapedRow* row, const FontMapping& m, f32 baselineY, f32 baselineX);
-        void _prepareBuiltinGlyphRenderTarget(const RenderingPayload& p);
+        void _prepareBuiltinGlyphBitmap(const RenderingPayload& p);
         D2D1_RECT_U _prepareBuiltinGlyph(const RenderingPayload& p, char32_t ch, u32 off);
         void _flushBuiltinGlyphs();
         ATLAS_ATTR_COLD f32 _drawTextPrepareLineRendition(const RenderingPayload& p, const ShapedRow* row, f32 baselineY) const noexcept;
@@ -48,11 +48,9 @@ namespace Microsoft::Console::Render::Atlas
         wil::com_ptr<ID2D1BitmapBrush> _backgroundBrush;
         til::generation_t _backgroundBitmapGeneration;
 
-        wil::com_ptr<ID2D1DeviceContext> _builtinGlyphsRenderTarget;
         wil::com_ptr<ID2D1Bitmap> _builtinGlyphsBitmap;
         wil::com_ptr<ID2D1SpriteBatch> _builtinGlyphBatch;
         u32 _builtinGlyphsBitmapCellCountU = 0;
-        bool _builtinGlyphsRenderTargetActive = false;
         bool _builtinGlyphsReady[BuiltinGlyphs::TotalCharCount]{};
 
         wil::com_ptr<ID2D1Bitmap> _cursorBitmap;
@@ -351,6 +351,7 @@ void BackendD3D::_updateFontDependents(const RenderingPayload& p)
     }
 
     _softFontBitmap.reset();
+    _builtinGlyphBitmap.reset();
 }
 
 void BackendD3D::_d2dRenderTargetUpdateFontSettings(const RenderingPayload& p) const noexcept
@@ -1610,13 +1611,45 @@ BackendD3D::AtlasGlyphEntry* BackendD3D::_drawBuiltinGlyph(const RenderingPayloa
         //   R: stretch the checkerboard pattern (Shape_Filled050) horizontally
         //   G: invert the pixels
         //   B: overrides the above and fills it
-        static constexpr D2D1_COLOR_F shadeColorMap[] = {
-            { 1, 0, 0, 1 }, // Shape_Filled025
-            { 0, 0, 0, 1 }, // Shape_Filled050
-            { 1, 1, 0, 1 }, // Shape_Filled075
-            { 1, 1, 1, 1 }, // Shape_Filled100
+        //
+        // The colors are in the B8G8R8A8 order of our glyph atlas and the coverage of the mask is used as the alpha.
+        static constexpr u32 shadeColorMap[] = {
+            0xff0000, // Shade::Filled025
+            0x000000, // Shade::Filled050
+            0xffff00, // Shade::Filled075
+            0xffffff, // Shade::Filled100
         };
-        BuiltinGlyphs::DrawBuiltinGlyph(p.d2dFactory.get(), _d2dRenderTarget.get(), _brush.get(), shadeColorMap, r, glyphIndex);
+        if (const auto mask = BuiltinGlyphs::GetBuiltinGlyphMask(glyphIndex, static_cast<u16>(rect.w), static_cast<u16>(rect.h)))
+        {
+            if (!_builtinGlyphBitmap)
+            {
+                // Builtin glyphs are at most twice the cell size in either direction (DECDWL/DECDHL).
+                // Each mask gets uploaded into the top-left corner of this bitmap and drawn from there,
+                // because creating a bitmap per glyph is a lot more expensive than reusing one.
+                const D2D1_SIZE_U size{
+                    static_cast<UINT32>(p.s->font->cellSize.x) * 2,
+                    static_cast<UINT32>(p.s->font->cellSize.y) * 2,
+                };
+                const D2D1_BITMAP_PROPERTIES1 bitmapProperties{
+                    .pixelFormat = { DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED },
+                    .dpiX = static_cast<f32>(p.s->font->dpi),
+                    .dpiY = static_cast<f32>(p.s->font->dpi),
+                };
+                THROW_IF_FAILED(_d2dRenderTarget->CreateBitmap(size, nullptr, 0, &bitmapProperties, _builtinGlyphBitmap.addressof()));
+            }
+
+            const auto color = shadeColorMap[static_cast<size_t>(mask->shade)];
+            Buffer<u32> pixels{ mask->coverage.size() };
+            for (size_t i = 0; i < pixels.size(); ++i)
+            {
+                pixels[i] = u32ColorPremultiply(color | static_cast<u32>(mask->coverage[i]) << 24);
+            }
+
+            const D2D1_RECT_U dstRect{ 0, 0, static_cast<UINT32>(rect.w), static_cast<UINT32>(rect.h) };
+            const D2D1_RECT_F srcRect{ 0, 0, static_cast<f32>(rect.w), static_cast<f32>(rect.h) };
+            THROW_IF_FAILED(_builtinGlyphBitmap->CopyFromMemory(&dstRect, pixels.data(), dstRect.right * 4));
+            _d2dRenderTarget->DrawBitmap(_builtinGlyphBitmap.get(), &r, 1, D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR, &srcRect, nullptr);
+        }
         shadingType = ShadingType::TextBuiltinGlyph;
     }
 
@@ -308,6 +308,7 @@ namespace Microsoft::Console::Render::Atlas
         wil::com_ptr<ID2D1SolidColorBrush> _emojiBrush;
         wil::com_ptr<ID2D1SolidColorBrush> _brush;
         wil::com_ptr<ID2D1Bitmap1> _softFontBitmap;
+        wil::com_ptr<ID2D1Bitmap1> _builtinGlyphBitmap;
         bool _d2dBeganDrawing = false;
         bool _fontChangedResetGlyphAtlas = false;
 
@@ -4,6 +4,8 @@
 #include "pch.h"
 #include "BuiltinGlyphs.h"
 
+#include <til/mutex.h>
+
 // Disable a bunch of warnings which get in the way of writing performant code.
 #pragma warning(disable : 26429) // Symbol 'data' is never tested for nullness, it can be marked as not_null (f.23).
 #pragma warning(disable : 26446) // Prefer to use gsl::at() instead of unchecked subscript operator (bounds.4).
@@ -1080,30 +1082,460 @@ i32 BuiltinGlyphs::GetBitmapCellIndex(char32_t codepoint) noexcept
     return -1;
 }
 
-void BuiltinGlyphs::DrawBuiltinGlyph(ID2D1Factory* factory, ID2D1DeviceContext* renderTarget, ID2D1SolidColorBrush* brush, const D2D1_COLOR_F (&shadeColorMap)[4], const D2D1_RECT_F& rect, char32_t codepoint)
+// cos(i * pi/2 / ArcSegments) for i in [0, ArcSegments]. sin() is the same table in reverse.
+// These are constants and not computed via cosf() so that the rasterized glyphs are
+// bit-for-bit identical no matter which C runtime we're built with.
+static constexpr u32 ArcSegments = 16;
+static constexpr f32 ArcCos[ArcSegments + 1] = {
+    1.000000000f,
+    0.995184727f,
+    0.980785280f,
+    0.956940336f,
+    0.923879533f,
+    0.881921264f,
+    0.831469612f,
+    0.773010453f,
+    0.707106781f,
+    0.634393284f,
+    0.555570233f,
+    0.471396737f,
+    0.382683432f,
+    0.290284677f,
+    0.195090322f,
+    0.098017140f,
+    0.000000000f,
+};
+
+namespace
 {
-    renderTarget->PushAxisAlignedClip(&rect, D2D1_ANTIALIAS_MODE_ALIASED);
-    const auto restoreD2D = wil::scope_exit([&]() {
-        renderTarget->PopAxisAlignedClip();
-    });
+    // A scanline rasterizer with analytic (= exact area) coverage, similar to the one used by font-rs and
+    // stb_truetype. Every edge adds the signed area it covers to the accumulation buffer and the prefix sum over
+    // each row then yields the coverage of each pixel. Shapes are added with AddPolygon() and friends and are
+    // then composited into the destination with Flush(), which makes successive shapes behave like successive
+    // draw calls in Direct2D. Since the winding of overlapping polygons adds up, all polygons within a shape
+    // must have the same winding, except for holes, which are simply added with the opposite winding.
+    struct Rasterizer
+    {
+        Rasterizer(const u16 width, const u16 height) :
+            _width{ width },
+            _height{ height },
+            _stride{ width + size_t{ 2 } },
+            _accumulation(_stride * height),
+            _coverage(size_t{ width } * height)
+        {
+        }
+
+        void AddPolygon(const f32x2* points, const size_t count, const bool hole)
+        {
+            if (count < 3)
+            {
+                return;
+            }
+
+            // The shoelace formula tells us the winding of the polygon. We want it to be positive,
+            // unless it's a hole, in which case we want it to be negative.
+            f32 area = 0;
+            for (size_t i = 0, j = count - 1; i < count; j = i++)
+            {
+                area += (points[j].x - points[i].x) * (points[j].y + points[i].y);
+            }
+
+            const auto reverse = (area < 0) != hole;
+            for (size_t i = 0, j = count - 1; i < count; j = i++)
+            {
+                if (reverse)
+                {
+                    _addEdge(points[i], points[j]);
+                }
+                else
+                {
+                    _addEdge(points[j], points[i]);
+                }
+            }
+        }
+
+        void AddRect(const f32 left, const f32 top, const f32 right, const f32 bottom, const bool hole)
+        {
+            if (left < right && top < bottom)
+            {
+                const f32x2 points[]{ { left, top }, { right, top }, { right, bottom }, { left, bottom } };
+                AddPolygon(&points[0], 4, hole);
+            }
+        }
+
+        // Adds a line of the given width with flat caps, just like ID2D1RenderTarget::DrawLine().
+        void AddLine(const f32x2 beg, const f32x2 end, const f32 lineWidth)
+        {
+            const auto n = _normal(beg, end, lineWidth * 0.5f);
+            const f32x2 points[]{
+                { beg.x + n.x, beg.y + n.y },
+                { end.x + n.x, end.y + n.y },
+                { end.x - n.x, end.y - n.y },
+                { beg.x - n.x, beg.y - n.y },
+            };
+            AddPolygon(&points[0], 4, false);
+        }
+
+        // Adds a stroked, open path with miter joins, just like ID2D1RenderTarget::DrawGeometry() with the default stroke style.
+        void AddPolyline(const f32x2* points, const size_t count, const f32 lineWidth)
+        {
+            const auto lineWidthHalf = lineWidth * 0.5f;
+
+            for (size_t i = 1; i < count; ++i)
+            {
+                AddLine(points[i - 1], points[i], lineWidth);
+            }
+
+            // The line segments leave a wedge shaped gap on the outside of each corner, which the miter fills.
+            for (size_t i = 1; i + 1 < count; ++i)
+            {
+                const auto n0 = _normal(points[i - 1], points[i], 1.0f);
+                const auto n1 = _normal(points[i], points[i + 1], 1.0f);
+                const auto denominator = 1.0f + n0.x * n1.x + n0.y * n1.y;
+                if (denominator <= 0.0f)
+                {
+                    continue;
+                }
+
+                // The normals point to the inside of the corner if they're facing the same way as the
+                // change in direction, which is given by the difference between the normals (rotated by 90°).
+                const auto turn = n0.x * n1.y - n0.y * n1.x;
+                const auto sign = turn > 0 ? -lineWidthHalf : lineWidthHalf;
+                const auto& p = points[i];
+                const f32x2 a{ p.x + n0.x * sign, p.y + n0.y * sign };
+                const f32x2 b{ p.x + n1.x * sign, p.y + n1.y * sign };
+                const auto miterScale = sign / denominator;
+                const f32x2 miter{ p.x + (n0.x + n1.x) * miterScale, p.y + (n0.y + n1.y) * miterScale };
+
+                // Direct2D's default miter limit is 10 times half the line width (here: squared).
+                // Past that the corner gets beveled, which is just the triangle without the miter.
+                const auto miterLengthSquared = 2.0f / denominator;
+                if (miterLengthSquared <= 100.0f)
+                {
+                    const f32x2 join[]{ p, a, miter, b };
+                    AddPolygon(&join[0], 4, false);
+                }
+                else
+                {
+                    const f32x2 join[]{ p, a, b };
+                    AddPolygon(&join[0], 3, false);
+                }
+            }
+        }
+
+        // Adds a rectangle with the given corner radius. The radius is clamped to half the size of the rectangle.
+        void AddRoundRect(const f32 left, const f32 top, const f32 right, const f32 bottom, f32 radius, const bool hole)
+        {
+            if (!(left < right && top < bottom))
+            {
+                return;
+            }
+
+            radius = std::min(radius, std::min(right - left, bottom - top) * 0.5f);
+            if (radius <= 0.0f)
+            {
+                AddRect(left, top, right, bottom, hole);
+                return;
+            }
+
+            f32x2 points[4 * (ArcSegments + 1)];
+            size_t count = 0;
+            // The corners in clockwise order (in a Y-down coordinate system), starting at the top right.
+            const f32x2 centers[]{
+                { right - radius, top + radius },
+                { right - radius, bottom - radius },
+                { left + radius, bottom - radius },
+                { left + radius, top + radius },
+            };
+            for (u32 quadrant = 0; quadrant < 4; ++quadrant)
+            {
+                for (u32 i = 0; i <= ArcSegments; ++i)
+                {
+                    points[count++] = _arcPoint(centers[quadrant], radius, radius, quadrant + 3, i);
+                }
+            }
+            AddPolygon(&points[0], count, hole);
+        }
+
+        void AddEllipse(const f32x2 center, const f32 radiusX, const f32 radiusY, const bool hole)
+        {
+            if (radiusX <= 0.0f || radiusY <= 0.0f)
+            {
+                return;
+            }
+
+            f32x2 points[4 * ArcSegments];
+            size_t count = 0;
+            for (u32 quadrant = 0; quadrant < 4; ++quadrant)
+            {
+                for (u32 i = 0; i < ArcSegments; ++i)
+                {
+                    points[count++] = _arcPoint(center, radiusX, radiusY, quadrant, i);
+                }
+            }
+            AddPolygon(&points[0], count, hole);
+        }
+
+        // Composites the shapes added since the last call on top of the previous ones.
+        void Flush() noexcept
+        {
+            for (size_t y = 0; y < _height; ++y)
+            {
+                const auto acc = _accumulation.data() + y * _stride;
+                const auto dst = _coverage.data() + y * _width;
+                f32 sum = 0;
+
+                for (size_t x = 0; x < _width; ++x)
+                {
+                    sum += acc[x];
+                    const auto src = std::min(1.0f, fabsf(sum));
+                    // Premultiplied source-over blending.
+                    dst[x] = src + dst[x] * (1.0f - src);
+                }
+            }
+
+            std::fill(_accumulation.begin(), _accumulation.end(), 0.0f);
+        }
+
+        void Finish(u8* dst) const noexcept
+        {
+            for (const auto c : _coverage)
+            {
+                *dst++ = static_cast<u8>(c * 255.0f + 0.5f);
+            }
+        }
+
+    private:
+        static f32x2 _normal(const f32x2 beg, const f32x2 end, const f32 length) noexcept
+        {
+            const auto dx = end.x - beg.x;
+            const auto dy = end.y - beg.y;
+            const auto len = sqrtf(dx * dx + dy * dy);
+            if (len <= 0.0f)
+            {
+                return {};
+            }
+            const auto scale = length / len;
+            return { -dy * scale, dx * scale };
+        }
+
+        // Returns the i-th point of the arc for the given quadrant (0 = bottom right, going clockwise).
+        static f32x2 _arcPoint(const f32x2 center, const f32 radiusX, const f32 radiusY, const u32 quadrant, const u32 i) noexcept
+        {
+            const auto c = ArcCos[i];
+            const auto s = ArcCos[ArcSegments - i];
+            f32 x, y;
+            switch (quadrant & 3)
+            {
+            case 0:
+                x = c, y = s;
+                break;
+            case 1:
+                x = -s, y = c;
+                break;
+            case 2:
+                x = -c, y = -s;
+                break;
+            default:
+                x = s, y = -c;
+                break;
+            }
+            return { center.x + x * radiusX, center.y + y * radiusY };
+        }
+
+        void _addEdge(f32x2 p0, f32x2 p1)
+        {
+            const auto w = static_cast<f32>(_width);
+            const auto h = static_cast<f32>(_height);
+
+            // Clip the edge vertically. Anything above or below the bitmap doesn't affect its coverage.
+            if (p0.y == p1.y || (p0.y <= 0 && p1.y <= 0) || (p0.y >= h && p1.y >= h))
+            {
+                return;
+            }
+            const auto clipY = [](f32x2& p, const f32x2 other, const f32 y) {
+                p.x += (other.x - p.x) * (y - p.y) / (other.y - p.y);
+                p.y = y;
+            };
+            if (p0.y < 0)
+            {
+                clipY(p0, p1, 0);
+            }
+            else if (p0.y > h)
+            {
+                clipY(p0, p1, h);
+            }
+            if (p1.y < 0)
+            {
+                clipY(p1, p0, 0);
+            }
+            else if (p1.y > h)
+            {
+                clipY(p1, p0, h);
+            }
+
+            // Horizontally, the parts of the edge to the left of the bitmap still affect the coverage of every pixel
+            // to their right. Those parts can be moved onto the left edge without changing the result. The same is
+            // true for the right side, except that those parts don't affect anything and end up in the padding.
+            f32x2 points[4]{ p0 };
+            size_t count = 1;
+            const auto splitX = [&](const f32 x) {
+                const auto& a = points[count - 1];
+                if ((a.x < x && p1.x > x) || (a.x > x && p1.x < x))
+                {
+                    points[count++] = { x, a.y + (p1.y - a.y) * (x - a.x) / (p1.x - a.x) };
+                }
+            };
+            if (p0.x < p1.x)
+            {
+                splitX(0);
+                splitX(w);
+            }
+            else
+            {
+                splitX(w);
+                splitX(0);
+            }
+            points[count++] = p1;
+
+            for (size_t i = 1; i < count; ++i)
+            {
+                auto a = points[i - 1];
+                auto b = points[i];
+                a.x = std::clamp(a.x, 0.0f, w);
+                b.x = std::clamp(b.x, 0.0f, w);
+                _accumulateLine(a, b);
+            }
+        }
+
+        void _accumulateLine(f32x2 p0, f32x2 p1) noexcept
+        {
+            if (p0.y == p1.y)
+            {
+                return;
+            }
+
+            auto dir = 1.0f;
+            if (p0.y > p1.y)
+            {
+                std::swap(p0, p1);
+                dir = -1.0f;
+            }
+
+            const auto dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+            auto x = p0.x;
+            const auto yBeg = static_cast<size_t>(p0.y);
+            const auto yEnd = std::min(static_cast<size_t>(ceilf(p1.y)), size_t{ _height });
+
+            for (auto y = yBeg; y < yEnd; ++y)
+            {
+                const auto row = _accumulation.data() + y * _stride;
+                const auto yf = static_cast<f32>(y);
+                const auto dy = std::min(yf + 1.0f, p1.y) - std::max(yf, p0.y);
+                // Clamping guards against rounding errors pushing x outside of the bitmap.
+                const auto xNext = std::clamp(x + dxdy * dy, 0.0f, static_cast<f32>(_width));
+                const auto d = dy * dir;
+                const auto x0 = std::min(x, xNext);
+                const auto x1 = std::max(x, xNext);
+                const auto x0floor = floorf(x0);
+                const auto x0i = static_cast<size_t>(x0floor);
+                const auto x1ceil = ceilf(x1);
+                const auto x1i = static_cast<size_t>(x1ceil);
+
+                if (x1i <= x0i + 1)
+                {
+                    // The edge is within a single pixel column.
+                    const auto xmf = 0.5f * (x + xNext) - x0floor;
+                    row[x0i] += d - d * xmf;
+                    row[x0i + 1] += d * xmf;
+                }
+                else
+                {
+                    // The edge spans multiple columns. The first and last one get a triangle shaped
+                    // area and every column in between gets an equal share of the remaining area.
+                    const auto s = 1.0f / (x1 - x0);
+                    const auto x0f = x0 - x0floor;
+                    const auto a0 = 0.5f * s * (1.0f - x0f) * (1.0f - x0f);
+                    const auto x1f = x1 - x1ceil + 1.0f;
+                    const auto am = 0.5f * s * x1f * x1f;
+
+                    row[x0i] += d * a0;
+                    if (x1i == x0i + 2)
+                    {
+                        row[x0i + 1] += d * (1.0f - a0 - am);
+                    }
+                    else
+                    {
+                        const auto a1 = s * (1.5f - x0f);
+                        row[x0i + 1] += d * (a1 - a0);
+                        for (auto xi = x0i + 2; xi < x1i - 1; ++xi)
+                        {
+                            row[xi] += d * s;
+                        }
+                        const auto a2 = a1 + static_cast<f32>(x1i - x0i - 3) * s;
+                        row[x1i - 1] += d * (1.0f - a2 - am);
+                    }
+                    row[x1i] += d * am;
+                }
+
+                x = xNext;
+            }
+        }
+
+        size_t _width;
+        size_t _height;
+        size_t _stride;
+        // _stride is 2 larger than _width, because edges on the right edge of the bitmap
+        // accumulate into the next column, and the one after if the x coordinate is exactly _width.
+        std::vector<f32> _accumulation;
+        std::vector<f32> _coverage;
+    };
+
+    // The masks only depend on the cell size (the line width is derived from the cell width),
+    // which tends to be identical across all panes and windows of a process. Caching them process-wide
+    // means that they're rasterized once per cell size, instead of once per backend and atlas reset.
+    struct GlyphMaskCache
+    {
+        struct Entry
+        {
+            u16 width = 0;
+            u16 height = 0;
+            u64 lastUse = 0;
+            std::shared_ptr<const GlyphMask> masks[TotalCharCount];
+        };
+
+        // Zooming or moving windows between monitors with different DPIs results in a handful of
+        // different cell sizes. We retain a few of them, but not an unbounded amount.
+        static constexpr size_t MaxEntries = 8;
+
+        std::vector<Entry> entries;
+        u64 useCounter = 0;
+    };
+}
+
+GlyphMask BuiltinGlyphs::RasterizeBuiltinGlyph(char32_t codepoint, u16 width, u16 height)
+{
+    GlyphMask mask{
+        .width = width,
+        .height = height,
+        .coverage = std::vector<u8>(size_t{ width } * height),
+    };
 
     const auto instructions = GetInstructions(codepoint);
-    if (!instructions)
+    if (!instructions || !width || !height)
     {
-        assert(false); // If everything in AtlasEngine works correctly, then this function should not get called when !IsBuiltinGlyph(codepoint).
-        renderTarget->Clear(nullptr);
-        return;
+        assert(instructions); // If everything in AtlasEngine works correctly, then this function should not get called when !IsBuiltinGlyph(codepoint).
+        return mask;
     }
 
-    const auto rectX = rect.left;
-    const auto rectY = rect.top;
-    const auto rectW = rect.right - rect.left;
-    const auto rectH = rect.bottom - rect.top;
+    const auto rectW = static_cast<f32>(width);
+    const auto rectH = static_cast<f32>(height);
     // 1/6th of the cell width roughly matches the thin line width that Cascadia Mono
     // uses for its box drawing characters. Same for the corner radius factor.
     const auto lightLineWidth = std::max(1.0f, roundf(rectW / 6.0f));
     const auto cornerRadius = std::min(lightLineWidth * 5.0f, std::min(rectW, rectH) * 0.5f);
-    D2D1_POINT_2F geometryPoints[2 * InstructionsPerGlyph];
+    Rasterizer rasterizer{ width, height };
+    f32x2 geometryPoints[2 * InstructionsPerGlyph];
     size_t geometryPointsCount = 0;
 
     for (size_t i = 0; i < InstructionsPerGlyph; ++i)
@@ -1134,18 +1566,12 @@ void BuiltinGlyphs::DrawBuiltinGlyph(ID2D1Factory* factory, ID2D1DeviceContext*
         const auto lineOffsetX = isHollowRect || isLineX ? lineWidthHalf : 0.0f;
         const auto lineOffsetY = isHollowRect || isLineY ? lineWidthHalf : 0.0f;
 
-        // Direct2D draws strokes centered on the path. In order to make them pixel-perfect we need to round the
+        // Strokes are centered on the path. In order to make them pixel-perfect we need to round the
         // coordinates to whole pixels, but offset by half the stroke width (= the radius of the stroke).
-        //
-        // All floats up to this point will be highly "consistent" between different `rect`s of identical size and
-        // different shapes, because the above calculations work with only a small set of constant floats.
-        // However, the addition of a potentially fractional begX/Y with a highly variable `rect` position is different.
-        // Rounding beg/endX/Y first ensures that we continue to get a consistent behavior between calls.
-        // This is particularly noticeable at smaller font sizes, where the line width is just a pixel or two.
-        const auto begXabs = rectX + roundf(begX - lineOffsetX) + lineOffsetX;
-        const auto begYabs = rectY + roundf(begY - lineOffsetY) + lineOffsetY;
-        const auto endXabs = rectX + roundf(endX + lineOffsetX) - lineOffsetX;
-        const auto endYabs = rectY + roundf(endY + lineOffsetY) - lineOffsetY;
+        const auto begXabs = roundf(begX - lineOffsetX) + lineOffsetX;
+        const auto begYabs = roundf(begY - lineOffsetY) + lineOffsetY;
+        const auto endXabs = roundf(endX + lineOffsetX) - lineOffsetX;
+        const auto endYabs = roundf(endY + lineOffsetY) - lineOffsetY;
 
         switch (shape)
         {
@@ -1153,48 +1579,29 @@ void BuiltinGlyphs::DrawBuiltinGlyph(ID2D1Factory* factory, ID2D1DeviceContext*
         case Shape_Filled050:
         case Shape_Filled075:
         case Shape_Filled100:
-        {
-            const auto brushColor = brush->GetColor();
-            brush->SetColor(&shadeColorMap[shape]);
-
-            const D2D1_RECT_F r{ begXabs, begYabs, endXabs, endYabs };
-            renderTarget->FillRectangle(&r, brush);
-
-            brush->SetColor(&brushColor);
+            // The shades are only ever used on their own, which allows us to store them as a property of the entire mask.
+            mask.shade = static_cast<Shade>(shape);
+            rasterizer.AddRect(begXabs, begYabs, endXabs, endYabs, false);
             break;
-        }
         case Shape_LightLine:
         case Shape_HeavyLine:
-        {
-            const D2D1_POINT_2F beg{ begXabs, begYabs };
-            const D2D1_POINT_2F end{ endXabs, endYabs };
-            renderTarget->DrawLine(beg, end, brush, lineWidth, nullptr);
+            rasterizer.AddLine({ begXabs, begYabs }, { endXabs, endYabs }, lineWidth);
             break;
-        }
         case Shape_EmptyRect:
-        {
-            const D2D1_RECT_F r{ begXabs, begYabs, endXabs, endYabs };
-            renderTarget->DrawRectangle(&r, brush, lineWidth, nullptr);
+            rasterizer.AddRect(begXabs - lineWidthHalf, begYabs - lineWidthHalf, endXabs + lineWidthHalf, endYabs + lineWidthHalf, false);
+            rasterizer.AddRect(begXabs + lineWidthHalf, begYabs + lineWidthHalf, endXabs - lineWidthHalf, endYabs - lineWidthHalf, true);
             break;
-        }
         case Shape_RoundRect:
-        {
-            const D2D1_ROUNDED_RECT rr{ { begXabs, begYabs, endXabs, endYabs }, cornerRadius, cornerRadius };
-            renderTarget->DrawRoundedRectangle(&rr, brush, lineWidth, nullptr);
+            rasterizer.AddRoundRect(begXabs - lineWidthHalf, begYabs - lineWidthHalf, endXabs + lineWidthHalf, endYabs + lineWidthHalf, cornerRadius + lineWidthHalf, false);
+            rasterizer.AddRoundRect(begXabs + lineWidthHalf, begYabs + lineWidthHalf, endXabs - lineWidthHalf, endYabs - lineWidthHalf, cornerRadius - lineWidthHalf, true);
             break;
-        }
         case Shape_FilledEllipsis:
-        {
-            const D2D1_ELLIPSE e{ { rectX + begX, rectY + begY }, endX, endY };
-            renderTarget->FillEllipse(&e, brush);
+            rasterizer.AddEllipse({ begX, begY }, endX, endY, false);
             break;
-        }
         case Shape_EmptyEllipsis:
-        {
-            const D2D1_ELLIPSE e{ { rectX + begX, rectY + begY }, endX, endY };
-            renderTarget->DrawEllipse(&e, brush, lineWidth, nullptr);
+            rasterizer.AddEllipse({ begX, begY }, endX + lineWidthHalf, endY + lineWidthHalf, false);
+            rasterizer.AddEllipse({ begX, begY }, endX - lineWidthHalf, endY - lineWidthHalf, true);
             break;
-        }
         case Shape_ClosedFilledPath:
         case Shape_OpenLinePath:
             if (instruction.begX)
@@ -1205,35 +1612,67 @@ void BuiltinGlyphs::DrawBuiltinGlyph(ID2D1Factory* factory, ID2D1DeviceContext*
             {
                 geometryPoints[geometryPointsCount++] = { endXabs, endYabs };
             }
-            break;
+            continue;
         }
+
+        rasterizer.Flush();
     }
 
     if (geometryPointsCount)
     {
-        const auto shape = instructions[0].shape;
-        const auto beginType = shape == Shape_ClosedFilledPath ? D2D1_FIGURE_BEGIN_FILLED : D2D1_FIGURE_BEGIN_HOLLOW;
-        const auto endType = shape == Shape_ClosedFilledPath ? D2D1_FIGURE_END_CLOSED : D2D1_FIGURE_END_OPEN;
-
-        wil::com_ptr<ID2D1PathGeometry> geometry;
-        THROW_IF_FAILED(factory->CreatePathGeometry(geometry.addressof()));
+        if (instructions[0].shape == Shape_ClosedFilledPath)
+        {
+            rasterizer.AddPolygon(&geometryPoints[0], geometryPointsCount, false);
+        }
+        else
+        {
+            rasterizer.AddPolyline(&geometryPoints[0], geometryPointsCount, lightLineWidth);
+        }
+        rasterizer.Flush();
+    }
 
-        wil::com_ptr<ID2D1GeometrySink> sink;
-        THROW_IF_FAILED(geometry->Open(sink.addressof()));
+    rasterizer.Finish(mask.coverage.data());
+    return mask;
+}
 
-        sink->BeginFigure(geometryPoints[0], beginType);
-        sink->AddLines(&geometryPoints[1], static_cast<UINT32>(geometryPointsCount - 1));
-        sink->EndFigure(endType);
+std::shared_ptr<const GlyphMask> BuiltinGlyphs::GetBuiltinGlyphMask(char32_t codepoint, u16 width, u16 height)
+{
+    const auto index = GetBitmapCellIndex(codepoint);
+    if (index < 0)
+    {
+        return nullptr;
+    }
 
-        THROW_IF_FAILED(sink->Close());
+    static til::shared_mutex<GlyphMaskCache> cache;
+    const auto guard = cache.lock();
+    auto& entries = guard->entries;
 
-        if (beginType == D2D1_FIGURE_BEGIN_FILLED)
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const auto& e) {
+        return e.width == width && e.height == height;
+    });
+    if (it == entries.end())
+    {
+        if (entries.size() < GlyphMaskCache::MaxEntries)
         {
-            renderTarget->FillGeometry(geometry.get(), brush, nullptr);
+            it = entries.emplace(entries.end());
         }
         else
         {
-            renderTarget->DrawGeometry(geometry.get(), brush, lightLineWidth, nullptr);
+            it = std::min_element(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+                return a.lastUse < b.lastUse;
+            });
+            *it = {};
         }
+        it->width = width;
+        it->height = height;
+    }
+
+    it->lastUse = ++guard->useCounter;
+
+    auto& mask = it->masks[index];
+    if (!mask)
+    {
+        mask = std::make_shared<const GlyphMask>(RasterizeBuiltinGlyph(codepoint, width, height));
     }
+    return mask;
 }
@@ -7,8 +7,32 @@
 
 namespace Microsoft::Console::Render::Atlas::BuiltinGlyphs
 {
+    // The light, medium and dark shade glyphs (U+2591-2593) are the only ones that aren't simply
+    // opaque wherever they're covered. It's up to the backends to decide how they want to render them.
+    enum class Shade : u8
+    {
+        Filled025,
+        Filled050,
+        Filled075,
+        Filled100,
+    };
+
+    // An 8-bit coverage mask of a single glyph. It doesn't depend on Direct2D or any other graphics API.
+    struct GlyphMask
+    {
+        u16 width = 0;
+        u16 height = 0;
+        Shade shade = Shade::Filled100;
+        // width * height coverage values, row by row.
+        std::vector<u8> coverage;
+    };
+
     bool IsBuiltinGlyph(char32_t codepoint) noexcept;
-    void DrawBuiltinGlyph(ID2D1Factory* factory, ID2D1DeviceContext* renderTarget, ID2D1SolidColorBrush* brush, const D2D1_COLOR_F (&shadeColorMap)[4], const D2D1_RECT_F& rect, char32_t codepoint);
+    // The line width and all other metrics are derived from the given cell size.
+    GlyphMask RasterizeBuiltinGlyph(char32_t codepoint, u16 width, u16 height);
+    // Same as RasterizeBuiltinGlyph(), but cached process-wide, so that all panes and backends
+    // with the same cell size share a single copy. Returns nullptr if !IsBuiltinGlyph(codepoint).
+    std::shared_ptr<const GlyphMask> GetBuiltinGlyphMask(char32_t codepoint, u16 width, u16 height);
 
     inline constexpr char32_t BoxDrawing_FirstChar = 0x2500;
     inline constexpr u32 BoxDrawing_CharCount = 0xA0;
@@ -352,6 +352,8 @@ namespace Microsoft::Console::Render::Atlas
         wil::com_ptr<IDWriteFontFallback> fontFallback;
         wil::com_ptr<IDWriteFontFallback1> fontFallback1; // optional, might be nullptr
         std::wstring fontName;
+        // The comma-separated list of fonts fontName was resolved from. The remaining ones are used for font fallback.
+        std::wstring fontFamilies;
         std::vector<DWRITE_FONT_FEATURE> fontFeatures;
         std::vector<DWRITE_FONT_AXIS_VALUE> fontAxisValues;
         f32 fontSize = 0;
@@ -0,0 +1,167 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "LatencyTrace.hpp"
+
+#include <bit>
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+static constexpr std::array<const wchar_t*, 6> stageNames{
+    L"KeyEvent",
+    L"InputWritten",
+    L"OutputRead",
+    L"OutputParsed",
+    L"PaintStarted",
+    L"Presented",
+};
+
+void LatencyTrace::SetEnabled(const bool enabled) noexcept
+{
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void LatencyTrace::Mark(const Stage stage) noexcept
+{
+    if (_enabled.load(std::memory_order_relaxed))
+    {
+        _markAt(stage, clock::now());
+    }
+}
+
+void LatencyTrace::_markAt(const Stage stage, const clock::time_point time) noexcept
+{
+    _mark(_input, stage, time);
+    _mark(_output, stage, time);
+}
+
+// Returns a human-readable summary of all histograms. The percentiles are the upper bounds of their buckets.
+std::wstring LatencyTrace::Format() const
+{
+    std::wstring out;
+    _formatTimeline(out, L"input", _input);
+    _formatTimeline(out, L"output", _output);
+    return out;
+}
+
+void LatencyTrace::_mark(Timeline& timeline, const Stage stage, const clock::time_point time) noexcept
+{
+    if (stage < timeline.first)
+    {
+        return;
+    }
+
+    const auto successor = static_cast<Stage>(static_cast<uint8_t>(stage) + 1);
+    auto expected = stage;
+
+    // The first stage may restart a sample that didn't progress any further,
+    // for instance if a key press didn't result in any input being written.
+    if (stage == timeline.first && timeline.next.load(std::memory_order_relaxed) == successor)
+    {
+        expected = successor;
+    }
+
+    // Mark() gets called from the input, output and render threads. Claiming the timeline
+    // ensures that only one of them updates `times` and that a sample gets recorded once.
+    if (!timeline.next.compare_exchange_strong(expected, Busy, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    til::at(timeline.times, static_cast<size_t>(stage)).store(time.time_since_epoch().count(), std::memory_order_relaxed);
+
+    if (stage != Stage::Presented)
+    {
+        timeline.next.store(successor, std::memory_order_release);
+        return;
+    }
+
+    _record(timeline);
+    timeline.next.store(timeline.first, std::memory_order_release);
+}
+
+void LatencyTrace::_record(Timeline& timeline) noexcept
+{
+    const auto first = static_cast<size_t>(timeline.first);
+    std::array<clock::duration, StageCount> durations{};
+
+    for (auto i = first + 1; i < StageCount; ++i)
+    {
+        const auto beg = til::at(timeline.times, i - 1).load(std::memory_order_relaxed);
+        const auto end = til::at(timeline.times, i).load(std::memory_order_relaxed);
+        const clock::duration duration{ end - beg };
+
+        if (duration < clock::duration::zero() || duration > MaxStageDuration)
+        {
+            timeline.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        til::at(durations, i) = duration;
+        til::at(durations, first) += duration;
+    }
+
+    for (auto i = first; i < StageCount; ++i)
+    {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(til::at(durations, i)).count();
+        const auto bucket = std::min<size_t>(std::bit_width(gsl::narrow_cast<uint64_t>(std::max<int64_t>(us, 1))) - 1, BucketCount - 1);
+        til::at(til::at(timeline.histograms, i), bucket).fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void LatencyTrace::_formatTimeline(std::wstring& out, const wchar_t* name, const Timeline& timeline)
+{
+    const auto first = static_cast<size_t>(timeline.first);
+
+    fmt::format_to(std::back_inserter(out), FMT_COMPILE(L"{} (dropped {} samples)\n"), name, timeline.dropped.load(std::memory_order_relaxed));
+
+    for (auto i = first; i < StageCount; ++i)
+    {
+        const auto& histogram = til::at(timeline.histograms, i);
+        std::array<uint32_t, BucketCount> counts{};
+        uint64_t total = 0;
+
+        for (size_t b = 0; b < BucketCount; ++b)
+        {
+            til::at(counts, b) = til::at(histogram, b).load(std::memory_order_relaxed);
+            total += til::at(counts, b);
+        }
+
+        const auto from = til::at(stageNames, i == first ? first : i - 1);
+        const auto to = til::at(stageNames, i == first ? StageCount - 1 : i);
+        fmt::format_to(std::back_inserter(out), FMT_COMPILE(L"  {} -> {}: {} samples"), from, to, total);
+
+        if (total)
+        {
+            for (const auto percentile : { 50u, 90u, 99u })
+            {
+                const auto threshold = (total * percentile + 99) / 100;
+                uint64_t sum = 0;
+                size_t b = 0;
+                for (; b < BucketCount - 1; ++b)
+                {
+                    sum += til::at(counts, b);
+                    if (sum >= threshold)
+                    {
+                        break;
+                    }
+                }
+                fmt::format_to(std::back_inserter(out), FMT_COMPILE(L", p{} < {}us"), percentile, uint64_t{ 2 } << b);
+            }
+
+            out.append(L"\n   ");
+            for (size_t b = 0; b < BucketCount; ++b)
+            {
+                if (const auto count = til::at(counts, b))
+                {
+                    fmt::format_to(std::back_inserter(out), FMT_COMPILE(L" <{}us:{}"), uint64_t{ 2 } << b, count);
+                }
+            }
+        }
+
+        out.push_back(L'\n');
+    }
+}
@@ -0,0 +1,84 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- LatencyTrace.hpp
+
+Abstract:
+- Samples how long it takes for input and output to make it onto the screen.
+- There are two timelines, one per row below. Each one traces at most one sample at a time:
+    Input:  KeyEvent -> InputWritten -> OutputRead -> OutputParsed -> PaintStarted -> Presented
+    Output:                             OutputRead -> OutputParsed -> PaintStarted -> Presented
+  A stage that gets marked while a timeline waits for a different one is ignored.
+  This makes Mark() cheap enough to be called for every key press, PTY read and frame.
+- Tracing is disabled by default, in which case Mark() doesn't even read the clock.
+- The input timeline assumes that the first output after a key press is its echo.
+  It's an approximation, which is why samples with implausibly long stages are dropped.
+--*/
+
+#pragma once
+
+class LatencyTraceTests;
+
+namespace Microsoft::Console::Render
+{
+    class LatencyTrace
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        enum class Stage : uint8_t
+        {
+            KeyEvent,
+            InputWritten,
+            OutputRead,
+            OutputParsed,
+            PaintStarted,
+            Presented,
+        };
+
+        void SetEnabled(bool enabled) noexcept;
+        void Mark(Stage stage) noexcept;
+        std::wstring Format() const;
+
+    private:
+        static constexpr size_t StageCount = static_cast<size_t>(Stage::Presented) + 1;
+        // Timeline::next holds this while a thread updates the timeline. Marks arriving meanwhile are ignored.
+        static constexpr Stage Busy = static_cast<Stage>(StageCount);
+        // Bucket i counts the durations in [2^i, 2^(i+1)) microseconds.
+        // The first one also counts those below 1us and the last one those above ~8s.
+        static constexpr size_t BucketCount = 24;
+        static constexpr clock::duration MaxStageDuration = std::chrono::seconds{ 1 };
+
+        using Histogram = std::array<std::atomic<uint32_t>, BucketCount>;
+
+        struct Timeline
+        {
+            explicit Timeline(Stage first) noexcept :
+                first{ first },
+                next{ first }
+            {
+            }
+
+            const Stage first;
+            std::atomic<Stage> next;
+            std::array<std::atomic<clock::rep>, StageCount> times{};
+            // histograms[i] counts the time from stage i - 1 to stage i, while
+            // histograms[first] counts the time from the first to the last stage.
+            std::array<Histogram, StageCount> histograms{};
+            std::atomic<uint32_t> dropped{ 0 };
+        };
+
+        void _markAt(Stage stage, clock::time_point time) noexcept;
+        static void _mark(Timeline& timeline, Stage stage, clock::time_point time) noexcept;
+        static void _record(Timeline& timeline) noexcept;
+        static void _formatTimeline(std::wstring& out, const wchar_t* name, const Timeline& timeline);
+
+        std::atomic<bool> _enabled{ false };
+        Timeline _input{ Stage::KeyEvent };
+        Timeline _output{ Stage::OutputRead };
+
+        friend class ::LatencyTraceTests;
+    };
+}
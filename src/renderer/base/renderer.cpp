@@ -88,6 +88,10 @@ IRenderData* Renderer::GetRenderData() const noexcept
             _pData->UnlockConsole();
         });
 
+        // Marked while holding the lock, so that we only ever pick up
+        // output that was fully parsed before this frame started.
+        _latencyTrace.Mark(LatencyTrace::Stage::PaintStarted);
+
         if (_isSynchronizingOutput)
         {
             _synchronizeWithOutput();
@@ -116,6 +120,7 @@ IRenderData* Renderer::GetRenderData() const noexcept
         RETURN_IF_FAILED(pEngine->Present());
     }
 
+    _latencyTrace.Mark(LatencyTrace::Stage::Presented);
     return S_OK;
 }
 
@@ -1484,3 +1489,35 @@ void Renderer::WaitUntilCanRender()
         pEngine->WaitUntilCanRender();
     }
 }
+
+// Method Description:
+// - Tells the render thread whether this renderer has the keyboard focus.
+//   The frames of the focused renderer get painted before those of any other.
+void Renderer::SetFocusHint(const bool focused) noexcept
+{
+    _thread.SetFocusHint(focused);
+}
+
+// Method Description:
+// - Tells the render thread whether this renderer is visible.
+//   Invisible renderers don't get painted until they become visible again.
+void Renderer::SetVisibilityHint(const bool visible) noexcept
+{
+    _thread.SetVisibilityHint(visible);
+}
+
+// Method Description:
+// - Returns the number of painted frames, coalesced notifications and the scheduling latency.
+RenderThreadStatistics Renderer::GetFrameStatistics() const noexcept
+{
+    return _thread.GetStatistics();
+}
+
+// Method Description:
+// - Returns the trace of how long input and output take to be presented by this renderer.
+//   The renderer marks the PaintStarted and Presented stages, while the owner of the
+//   renderer is expected to mark the earlier ones. See LatencyTrace.
+LatencyTrace& Renderer::GetLatencyTrace() noexcept
+{
+    return _latencyTrace;
+}
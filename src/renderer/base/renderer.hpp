@@ -19,6 +19,7 @@ Author(s):
 #include "../inc/IRenderEngine.hpp"
 #include "../inc/RenderSettings.hpp"
 
+#include "LatencyTrace.hpp"
 #include "thread.hpp"
 
 #include "../../buffer/out/textBuffer.hpp"
@@ -67,6 +68,10 @@ namespace Microsoft::Console::Render
 
         void EnablePainting();
         void WaitUntilCanRender();
+        void SetFocusHint(const bool focused) noexcept;
+        void SetVisibilityHint(const bool visible) noexcept;
+        RenderThreadStatistics GetFrameStatistics() const noexcept;
+        LatencyTrace& GetLatencyTrace() noexcept;
 
         void AddRenderEngine(_In_ IRenderEngine* const pEngine);
         void RemoveRenderEngine(_In_ IRenderEngine* const pEngine);
@@ -132,6 +137,7 @@ namespace Microsoft::Console::Render
         til::point_span _lastSelectionPaintSpan{};
         size_t _lastSelectionPaintSize{};
         std::vector<til::rect> _lastSelectionRectsByViewport{};
+        LatencyTrace _latencyTrace;
 
         // Ordered last, so that it gets destroyed first.
         // This ensures that the render thread stops accessing us.
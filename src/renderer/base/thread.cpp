@@ -20,87 +20,304 @@ RenderThread::~RenderThread()
     TriggerTeardown();
 }
 
-DWORD WINAPI RenderThread::s_ThreadProc(_In_ LPVOID lpParameter)
+void RenderThread::NotifyPaint() noexcept
+{
+    RenderScheduler::Instance().Notify(*this);
+}
+
+// Allows the RenderScheduler to paint this renderer.
+void RenderThread::EnablePainting() noexcept
+{
+    RenderScheduler::Instance().Enable(*this);
+}
+
+// This function is meant to only be called by `Renderer`. You should use `TriggerTeardown()` instead,
+// even if you plan to call `EnablePainting()` later, because that ensures proper synchronization.
+void RenderThread::DisablePainting() noexcept
+{
+    RenderScheduler::Instance().Disable(*this);
+}
+
+// Stops painting this renderer, and waits for any frame that's currently being painted to finish.
+void RenderThread::TriggerTeardown() noexcept
+{
+    RenderScheduler::Instance().Teardown(*this);
+}
+
+// The focused renderer gets painted before any others and isn't throttled to BackgroundFrameInterval.
+void RenderThread::SetFocusHint(const bool focused) noexcept
+{
+    RenderScheduler::Instance().SetFocused(*this, focused);
+}
+
+// Renderers that aren't visible (for instance because their window is minimized) don't get painted.
+void RenderThread::SetVisibilityHint(const bool visible) noexcept
+{
+    RenderScheduler::Instance().SetVisible(*this, visible);
+}
+
+RenderThreadStatistics RenderThread::GetStatistics() const noexcept
+{
+    return RenderScheduler::Instance().GetStatistics(*this);
+}
+
+RenderScheduler& RenderScheduler::Instance()
+{
+    // The worker threads may still be waiting on our condition variables when the process exits.
+    // Intentionally leaking the instance ensures that it never gets destroyed underneath them.
+    static const auto instance = new RenderScheduler();
+    return *instance;
+}
+
+void RenderScheduler::Notify(RenderThread& client) noexcept
+{
+    const std::lock_guard guard{ _mutex };
+
+    if (client._pending)
+    {
+        client._statistics.coalescedNotifications++;
+        return;
+    }
+
+    client._pending = true;
+    client._notifyTime = clock::now();
+    if (_scheduleLocked(client))
+    {
+        _wakeLocked();
+    }
+}
+
+void RenderScheduler::Enable(RenderThread& client) noexcept
 {
-    const auto pContext = static_cast<RenderThread*>(lpParameter);
+    const std::lock_guard guard{ _mutex };
+    client._enabled = true;
+    if (_scheduleLocked(client))
+    {
+        _wakeLocked();
+    }
+}
+
+void RenderScheduler::Disable(RenderThread& client) noexcept
+{
+    const std::lock_guard guard{ _mutex };
+    client._enabled = false;
+    _unscheduleLocked(client);
+}
+
+void RenderScheduler::Teardown(RenderThread& client) noexcept
+{
+    std::unique_lock guard{ _mutex };
+    client._enabled = false;
+    _unscheduleLocked(client);
+    // Once this returns, no worker thread will access the client (or its renderer) anymore.
+    _paintFinished.wait(guard, [&]() noexcept { return !client._painting; });
+}
+
+void RenderScheduler::SetFocused(RenderThread& client, const bool focused) noexcept
+{
+    const std::lock_guard guard{ _mutex };
+    client._focused = focused;
+    // The client may have been queued but not yet due, or deferred in favor of the
+    // previously focused renderer. Let the worker threads reevaluate their choice.
+    _workAvailable.notify_all();
+}
+
+void RenderScheduler::SetVisible(RenderThread& client, const bool visible) noexcept
+{
+    const std::lock_guard guard{ _mutex };
+    client._visible = visible;
+    _workAvailable.notify_all();
+}
+
+RenderThreadStatistics RenderScheduler::GetStatistics(const RenderThread& client) noexcept
+{
+    const std::lock_guard guard{ _mutex };
+    return client._statistics;
+}
+
+DWORD WINAPI RenderScheduler::s_ThreadProc(_In_ LPVOID lpParameter)
+{
+    const auto pContext = static_cast<RenderScheduler*>(lpParameter);
     return pContext->_ThreadProc();
 }
 
-DWORD WINAPI RenderThread::_ThreadProc()
+DWORD WINAPI RenderScheduler::_ThreadProc()
 {
+    std::unique_lock guard{ _mutex };
+
     while (true)
     {
-        _enable.wait();
+        auto now = clock::now();
+        auto wakeup = clock::time_point::max();
+        const auto client = _popLocked(now, wakeup);
+
+        if (!client)
+        {
+            // If there's nothing to do for a while, we exit, so that a process
+            // without any renderers doesn't keep its render threads around forever.
+            if (wakeup == clock::time_point::max())
+            {
+                wakeup = now + IdleThreadTimeout;
+            }
+
+            _idleThreads++;
+            const auto status = _workAvailable.wait_until(guard, wakeup);
+            _idleThreads--;
+
+            if (status == std::cv_status::timeout && _queue.empty())
+            {
+                _threadCount--;
+                return S_OK;
+            }
+            continue;
+        }
 
-        // Between waiting on _hEvent and calling PaintFrame() there should be a minimal delay,
+        // Between picking a client and calling PaintFrame() there should be a minimal delay,
         // so that a key press progresses to a drawing operation as quickly as possible.
-        // As such, we wait for the renderer to complete _before_ waiting on `_redraw`.
-        renderer->WaitUntilCanRender();
+        // As such, we wait for the renderer to complete _before_ consuming the pending frame,
+        // which also folds any notifications that arrive in the meantime into this frame.
+        // Waiting on a disabled or hidden client would only park a thread that other clients could use.
+        auto paint = client->_enabled && client->_visible;
+        if (paint)
+        {
+            guard.unlock();
+            client->renderer->WaitUntilCanRender();
+            guard.lock();
+            paint = client->_enabled && client->_visible;
+        }
 
-        _redraw.wait();
-        if (!_keepRunning.load(std::memory_order_relaxed))
+        if (paint)
         {
-            break;
+            now = clock::now();
+            const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - client->_notifyTime);
+            auto& stats = client->_statistics;
+            stats.frames++;
+            stats.totalLatency += latency;
+            stats.maxLatency = std::max(stats.maxLatency, latency);
+            client->_pending = false;
+            client->_paintTime = now;
+
+            guard.unlock();
+            LOG_IF_FAILED(client->renderer->PaintFrame());
+            guard.lock();
         }
 
-        LOG_IF_FAILED(renderer->PaintFrame());
+        client->_painting = false;
+        // Any NotifyPaint() during PaintFrame() results in another frame. The renderer also relies
+        // on this to animate the cursor, shaders, etc. There's no need to wake up another thread
+        // for it, as this one is about to look for work anyway.
+        _scheduleLocked(*client);
+        _paintFinished.notify_all();
     }
+}
 
-    return S_OK;
+// Puts the client into the queue if it has a pending frame and isn't queued or painted already.
+// Returns true if the client was newly queued.
+bool RenderScheduler::_scheduleLocked(RenderThread& client) noexcept
+{
+    if (!client._enabled || !client._pending || client._queued || client._painting)
+    {
+        return false;
+    }
+
+    try
+    {
+        _queue.emplace_back(&client);
+    }
+    CATCH_LOG_RETURN_VAL(false);
+
+    client._queued = true;
+    return true;
 }
 
-void RenderThread::NotifyPaint() noexcept
+void RenderScheduler::_wakeLocked() noexcept
 {
-    _redraw.SetEvent();
+    // The busy threads may be blocked in WaitUntilCanRender() or PaintFrame() of a slow renderer
+    // for a long time. Instead of making the newly queued client wait for them, it gets a new thread.
+    if (_idleThreads == 0)
+    {
+        _spawnThreadLocked();
+    }
+
+    // Idle threads may be waiting for a background renderer to become due,
+    // so we need to wake all of them to ensure that they pick the right client.
+    _workAvailable.notify_all();
 }
 
-// Spawns a new rendering thread if none exists yet.
-void RenderThread::EnablePainting() noexcept
+void RenderScheduler::_unscheduleLocked(RenderThread& client) noexcept
 {
-    const auto guard = _threadMutex.lock_exclusive();
+    if (client._queued)
+    {
+        std::erase(_queue, &client);
+        client._queued = false;
+    }
+}
 
-    _enable.SetEvent();
+// Returns the client that should be painted next, or nullptr if none is due yet.
+// In the latter case, wakeup is set to the time at which the next client will be due.
+RenderThread* RenderScheduler::_popLocked(const clock::time_point now, clock::time_point& wakeup) noexcept
+{
+    auto best = _queue.end();
 
-    if (!_thread)
+    for (auto it = _queue.begin(); it != _queue.end(); ++it)
     {
-        _keepRunning.store(true, std::memory_order_relaxed);
+        const auto client = *it;
 
-        _thread.reset(CreateThread(nullptr, 0, s_ThreadProc, this, 0, nullptr));
-        THROW_LAST_ERROR_IF(!_thread);
+        // Invisible clients stay in the queue, so that SetVisible() doesn't need to requeue them.
+        if (!client->_enabled || !client->_visible)
+        {
+            continue;
+        }
+
+        if (!client->_focused)
+        {
+            const auto due = client->_paintTime + BackgroundFrameInterval;
+            if (due > now)
+            {
+                wakeup = std::min(wakeup, due);
+                continue;
+            }
+        }
 
-        // SetThreadDescription only works on 1607 and higher. If we cannot find it,
-        // then it's no big deal. Just skip setting the description.
-        const auto func = GetProcAddressByFunctionDeclaration(GetModuleHandleW(L"kernel32.dll"), SetThreadDescription);
-        if (func)
+        // The focused client goes first. Otherwise, the one that's been waiting the longest.
+        if (best == _queue.end() ||
+            client->_focused > (*best)->_focused ||
+            (client->_focused == (*best)->_focused && client->_notifyTime < (*best)->_notifyTime))
         {
-            LOG_IF_FAILED(func(_thread.get(), L"Rendering Output Thread"));
+            best = it;
         }
     }
-}
 
-// This function is meant to only be called by `Renderer`. You should use `TriggerTeardown()` instead,
-// even if you plan to call `EnablePainting()` later, because that ensures proper synchronization.
-void RenderThread::DisablePainting() noexcept
-{
-    _enable.ResetEvent();
+    if (best == _queue.end())
+    {
+        return nullptr;
+    }
+
+    const auto client = *best;
+    _queue.erase(best);
+    client->_queued = false;
+    client->_painting = true;
+    return client;
 }
 
-// Stops the rendering thread, and waits for it to finish.
-void RenderThread::TriggerTeardown() noexcept
+void RenderScheduler::_spawnThreadLocked() noexcept
 {
-    const auto guard = _threadMutex.lock_exclusive();
-
-    if (_thread)
+    wil::unique_handle thread{ CreateThread(nullptr, 0, s_ThreadProc, this, 0, nullptr) };
+    if (!thread)
     {
-        // The render thread first waits for the event and then checks _keepRunning. By doing it
-        // in reverse order here, we ensure that it's impossible for the render thread to miss this.
-        _keepRunning.store(false, std::memory_order_relaxed);
-        _redraw.SetEvent();
-        _enable.SetEvent();
-
-        WaitForSingleObject(_thread.get(), INFINITE);
-        _thread.reset();
+        // The already existing threads will pick up the work eventually.
+        // If there are none, the next NotifyPaint() will try again.
+        LOG_LAST_ERROR();
+        return;
     }
 
-    DisablePainting();
+    _threadCount++;
+
+    // SetThreadDescription only works on 1607 and higher. If we cannot find it,
+    // then it's no big deal. Just skip setting the description.
+    const auto func = GetProcAddressByFunctionDeclaration(GetModuleHandleW(L"kernel32.dll"), SetThreadDescription);
+    if (func)
+    {
+        LOG_IF_FAILED(func(thread.get(), L"Rendering Output Thread"));
+    }
 }
@@ -7,6 +7,8 @@ Module Name:
 
 Abstract:
 - This is the definition of our rendering thread designed to throttle and compartmentalize drawing operations.
+- The frames of all renderers in the process are painted by a pool of worker threads,
+  owned by the RenderScheduler. RenderThread is the per-renderer handle into that pool.
 
 Author(s):
 - Michael Niksa (MiNiksa) Feb 2016
@@ -14,10 +16,24 @@ Author(s):
 
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
+
 namespace Microsoft::Console::Render
 {
     class Renderer;
 
+    struct RenderThreadStatistics
+    {
+        // The number of PaintFrame() calls.
+        uint64_t frames = 0;
+        // The number of NotifyPaint() calls that were folded into an already pending frame.
+        uint64_t coalescedNotifications = 0;
+        // The time between the first NotifyPaint() of a frame and the start of its PaintFrame().
+        std::chrono::microseconds totalLatency{};
+        std::chrono::microseconds maxLatency{};
+    };
+
     class RenderThread
     {
     public:
@@ -29,15 +45,80 @@ namespace Microsoft::Console::Render
         void DisablePainting() noexcept;
         void TriggerTeardown() noexcept;
 
+        void SetFocusHint(bool focused) noexcept;
+        void SetVisibilityHint(bool visible) noexcept;
+        RenderThreadStatistics GetStatistics() const noexcept;
+
+    private:
+        friend class RenderScheduler;
+        using clock = std::chrono::steady_clock;
+
+        Renderer* renderer;
+
+        // All of the following members are protected by the RenderScheduler's mutex.
+        clock::time_point _notifyTime{};
+        clock::time_point _paintTime{};
+        RenderThreadStatistics _statistics;
+        bool _enabled = false;
+        // A frame was requested via NotifyPaint() and hasn't been painted yet.
+        bool _pending = false;
+        // The renderer is in the RenderScheduler's queue.
+        bool _queued = false;
+        // A worker thread is currently inside WaitUntilCanRender() or PaintFrame().
+        bool _painting = false;
+        // Set via SetFocusHint() by whoever owns the keyboard focus (e.g. the window).
+        bool _focused = false;
+        bool _visible = true;
+    };
+
+    // Paints the frames of all renderers in the process on a shared pool of threads
+    // instead of giving each of them a thread of its own. With many panes open, most of
+    // them are idle and shouldn't need to keep a thread around for that.
+    //
+    // Painting a renderer blocks its thread in WaitUntilCanRender() (e.g. for vsync) and
+    // PaintFrame(). To prevent a slow renderer from holding up the others, a new thread is
+    // spawned whenever a renderer gets queued while no thread is idle. The pool thus never
+    // grows beyond the number of renderers with pending frames and shrinks again once idle.
+    //
+    // A renderer is never painted by two threads at once. The focused renderer is painted
+    // first and as often as its engines allow (see WaitUntilCanRender()), while unfocused ones
+    // are paced to BackgroundFrameInterval. Renderers that aren't visible aren't painted at all,
+    // but they retain their pending frame until they become visible again.
+    class RenderScheduler
+    {
+    public:
+        static RenderScheduler& Instance();
+
+        void Notify(RenderThread& client) noexcept;
+        void Enable(RenderThread& client) noexcept;
+        void Disable(RenderThread& client) noexcept;
+        void Teardown(RenderThread& client) noexcept;
+        void SetFocused(RenderThread& client, bool focused) noexcept;
+        void SetVisible(RenderThread& client, bool visible) noexcept;
+        RenderThreadStatistics GetStatistics(const RenderThread& client) noexcept;
+
     private:
+        using clock = RenderThread::clock;
+
+        static constexpr clock::duration BackgroundFrameInterval = std::chrono::milliseconds{ 16 };
+        static constexpr clock::duration IdleThreadTimeout = std::chrono::seconds{ 30 };
+
+        RenderScheduler() = default;
+
         static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
         DWORD WINAPI _ThreadProc();
 
-        Renderer* renderer;
-        wil::slim_event_manual_reset _enable;
-        wil::slim_event_auto_reset _redraw;
-        wil::srwlock _threadMutex;
-        wil::unique_handle _thread;
-        std::atomic<bool> _keepRunning{ false };
+        bool _scheduleLocked(RenderThread& client) noexcept;
+        void _wakeLocked() noexcept;
+        void _unscheduleLocked(RenderThread& client) noexcept;
+        RenderThread* _popLocked(clock::time_point now, clock::time_point& wakeup) noexcept;
+        void _spawnThreadLocked() noexcept;
+
+        std::mutex _mutex;
+        std::condition_variable _workAvailable;
+        std::condition_variable _paintFinished;
+        std::vector<RenderThread*> _queue;
+        size_t _threadCount = 0;
+        size_t _idleThreads = 0;
     };
 }
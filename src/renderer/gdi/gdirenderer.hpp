@@ -177,6 +177,7 @@ namespace Microsoft::Console::Render
         std::pmr::vector<std::pmr::wstring> _polyStrings;
         std::pmr::vector<std::pmr::vector<int>> _polyWidths;
 
+        std::vector<RGBQUAD> _imagePixels;
         std::vector<DWORD> _imageMask;
 
         [[nodiscard]] HRESULT _InvalidCombine(const til::rect* const prc) noexcept;
@@ -675,12 +675,16 @@ try
     LOG_IF_FAILED(_FlushBufferLines());
     LOG_IF_FAILED(ResetLineTransform());
 
-    const auto& imagePixels = imageSlice.Pixels();
-    if (_imageMask.size() < imagePixels.size())
+    const auto pixelCount = imageSlice.PixelCount();
+    if (_imagePixels.size() < pixelCount)
     {
-        _imageMask.resize(imagePixels.size());
+        _imagePixels.resize(pixelCount);
+        _imageMask.resize(pixelCount);
     }
 
+    const auto imagePixels = std::span{ _imagePixels }.first(pixelCount);
+    imageSlice.ExpandPixels(imagePixels);
+
     const auto srcCellSize = imageSlice.CellSize();
     const auto dstCellSize = _GetFontSize();
     const auto srcWidth = imageSlice.PixelWidth();
@@ -23,7 +23,8 @@ namespace Microsoft::Console::VirtualTerminal
 class Microsoft::Console::VirtualTerminal::ITermDispatch
 {
 public:
-    using StringHandler = std::function<bool(const wchar_t)>;
+    // Must match IStateMachineEngine::StringHandler.
+    using StringHandler = std::function<bool(const std::wstring_view)>;
 
     enum class OptionalFeature
     {
@@ -37,6 +38,7 @@ public:
 
     virtual void Print(const wchar_t wchPrintable) = 0;
     virtual void PrintString(const std::wstring_view string) = 0;
+    virtual void PrintLines(const std::wstring_view string) = 0; // Text separated by CR, LF or CRLF
 
     virtual void CursorUp(const VTInt distance) = 0; // CUU
     virtual void CursorDown(const VTInt distance) = 0; // CUD
@@ -17,6 +17,56 @@ using namespace Microsoft::Console::VirtualTerminal;
 using namespace std::chrono;
 using namespace std::chrono_literals;
 
+// Sets every pixel in dst to the given pixel, for which the corresponding sixel
+// value has the given bit set. This is one of the 6 rows ("bitplanes") that a
+// run of sixel values expands to. The values still include the '?' offset.
+static void writeBitplane(const wchar_t* values, const size_t count, const uint16_t bit, const ImageSlice::IndexedPixel pixel, ImageSlice::IndexedPixel* dst) noexcept
+{
+    size_t i = 0;
+
+#if defined(TIL_SSE_INTRINSICS)
+
+    // IndexedPixel is 2 bytes large, which allows us to blend 8 pixels at a time.
+    static_assert(sizeof(ImageSlice::IndexedPixel) == sizeof(uint16_t));
+    const auto offset = _mm_set1_epi16(L'?');
+    const auto mask = _mm_set1_epi16(static_cast<short>(bit));
+    const auto fill = _mm_set1_epi16(std::bit_cast<int16_t>(pixel));
+
+    for (const auto end = count & ~size_t{ 7 }; i < end; i += 8)
+    {
+        const auto v = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), offset);
+        const auto set = _mm_cmpeq_epi16(_mm_and_si128(v, mask), mask);
+        const auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_and_si128(set, fill), _mm_andnot_si128(set, d)));
+    }
+
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+
+    static_assert(sizeof(ImageSlice::IndexedPixel) == sizeof(uint16_t));
+    const auto offset = vdupq_n_u16(L'?');
+    const auto mask = vdupq_n_u16(bit);
+    const auto fill = vdupq_n_u16(std::bit_cast<uint16_t>(pixel));
+
+    for (const auto end = count & ~size_t{ 7 }; i < end; i += 8)
+    {
+        const auto v = vsubq_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(values + i)), offset);
+        const auto set = vtstq_u16(v, mask);
+        const auto d = vld1q_u16(reinterpret_cast<const uint16_t*>(dst + i));
+        vst1q_u16(reinterpret_cast<uint16_t*>(dst + i), vbslq_u16(set, fill, d));
+    }
+
+#endif
+
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    for (; i < count; i++)
+    {
+        if ((values[i] - L'?') & bit)
+        {
+            dst[i] = pixel;
+        }
+    }
+}
+
 til::size SixelParser::CellSizeForLevel(const VTInt conformanceLevel) noexcept
 {
     switch (conformanceLevel)
@@ -80,7 +130,7 @@ void SixelParser::SetDisplayMode(const bool enabled) noexcept
     }
 }
 
-std::function<bool(wchar_t)> SixelParser::DefineImage(const VTInt macroParameter, const DispatchTypes::SixelBackground backgroundSelect, const VTParameter backgroundColor)
+std::function<bool(std::wstring_view)> SixelParser::DefineImage(const VTInt macroParameter, const DispatchTypes::SixelBackground backgroundSelect, const VTParameter backgroundColor)
 {
     if (_initTextBufferBoundaries())
     {
@@ -89,8 +139,8 @@ std::function<bool(wchar_t)> SixelParser::DefineImage(const VTInt macroParameter
         _initImageBuffer();
         _state = States::Normal;
         _parameters.clear();
-        return [&](const auto ch) {
-            _parseCommandChar(ch);
+        return [&](const auto str) {
+            _parseString(str);
             return true;
         };
     }
@@ -100,12 +150,42 @@ std::function<bool(wchar_t)> SixelParser::DefineImage(const VTInt macroParameter
     }
 }
 
+constexpr bool SixelParser::_isSixelValue(const wchar_t ch) noexcept
+{
+    return ch >= '?' && ch <= '~';
+}
+
+void SixelParser::_parseString(const std::wstring_view str)
+{
+    const auto end = str.end();
+    auto it = str.begin();
+    while (it != end)
+    {
+        // Runs of sixel values make up the bulk of an image, so we decode them
+        // all at once. But if there's a pending command (e.g. a repeat), that
+        // needs to be applied to the first value via _parseCommandChar.
+        if (_state == States::Normal && _isSixelValue(*it)) [[likely]]
+        {
+            const auto runEnd = std::find_if_not(it, end, _isSixelValue);
+            _writeRunToImageBuffer({ it, runEnd });
+            it = runEnd;
+        }
+        else
+        {
+            const auto ch = *it++;
+            _remainingChars = gsl::narrow_cast<size_t>(end - it);
+            _parseCommandChar(ch);
+        }
+    }
+    _remainingChars = 0;
+}
+
 void SixelParser::_parseCommandChar(const wchar_t ch)
 {
     // Characters in the range `?` to `~` encode a sixel value, which is a group
     // of six vertical pixels. After subtracting `?` from the character, you've
     // got a six bit binary value which represents the six pixels.
-    if (ch >= '?' && ch <= '~') [[likely]]
+    if (_isSixelValue(ch)) [[likely]]
     {
         // When preceded by a repeat command, the repeat parameter value denotes
         // the number of times that the following sixel should be repeated.
@@ -223,6 +303,13 @@ int SixelParser::_applyPendingCommand()
     return 1;
 }
 
+bool SixelParser::_isProcessingLastCharacter() const noexcept
+{
+    // The state machine passes us runs of characters, so we're only processing
+    // the last character of its packet if it's also the last one of our run.
+    return _remainingChars == 0 && _stateMachine.IsProcessingLastCharacter();
+}
+
 void SixelParser::_executeCarriageReturn() noexcept
 {
     _imageWidth = std::max(_imageWidth, _imageCursor.x);
@@ -554,7 +641,7 @@ void SixelParser::_defineColor(const size_t colorNumber, const COLORREF color)
         // If some image content has already been defined at this point, and
         // we're processing the last character in the packet, this is likely an
         // attempt to animate the palette, so we should flush the image.
-        if (_imageWidth > 0 && _stateMachine.IsProcessingLastCharacter())
+        if (_imageWidth > 0 && _isProcessingLastCharacter())
         {
             _maybeFlushImageBuffer();
         }
@@ -762,6 +849,29 @@ void SixelParser::_writeToImageBuffer(int sixelValue, int repeatCount)
     _imageCursor.x += repeatCount;
 }
 
+void SixelParser::_writeRunToImageBuffer(const std::wstring_view sixelValues)
+{
+    _fillImageBackground();
+
+    // Instead of checking the bounds for every value, we clamp the run up front.
+    // Just like in _writeToImageBuffer, anything past the maximum width is dropped.
+    const auto count = std::min(sixelValues.size(), gsl::narrow_cast<size_t>(_imageMaxWidth - _imageCursor.x));
+    const auto targetOffset = _imageCursor.y * _imageMaxWidth + _imageCursor.x;
+    auto imageBufferPtr = std::next(_imageBuffer.data(), targetOffset);
+    // The image buffer is stored in rows, so rather than writing 6 vertical
+    // pixels per value, we write one row of pixels per bit of the values.
+    for (auto i = 0; i < 6; i++)
+    {
+        const auto bit = gsl::narrow_cast<uint16_t>(1 << i);
+        for (auto repeatAspectRatio = 0; repeatAspectRatio < _pixelAspectRatio; repeatAspectRatio++)
+        {
+            writeBitplane(sixelValues.data(), count, bit, _foregroundPixel, imageBufferPtr);
+            std::advance(imageBufferPtr, _imageMaxWidth);
+        }
+    }
+    _imageCursor.x += gsl::narrow_cast<til::CoordType>(count);
+}
+
 void SixelParser::_eraseImageBufferRows(const int rowCount, const til::CoordType rowOffset) noexcept
 {
     const auto pixelCount = rowCount * _cellSize.height;
@@ -815,7 +925,7 @@ void SixelParser::_maybeFlushImageBuffer(const bool endOfSequence)
     const auto currentTime = steady_clock::now();
     const auto timeSinceLastFlush = duration_cast<milliseconds>(currentTime - _lastFlushTime);
     const auto linesSinceLastFlush = _imageLineCount - _lastFlushLine;
-    if (endOfSequence || timeSinceLastFlush > 500ms || (linesSinceLastFlush <= 1 && _stateMachine.IsProcessingLastCharacter()))
+    if (endOfSequence || timeSinceLastFlush > 500ms || (linesSinceLastFlush <= 1 && _isProcessingLastCharacter()))
     {
         _lastFlushTime = currentTime;
         _lastFlushLine = _imageLineCount;
@@ -836,8 +946,20 @@ void SixelParser::_maybeFlushImageBuffer(const bool endOfSequence)
             const auto columnBegin = _imageOriginCell.x;
             const auto columnEnd = _imageOriginCell.x + (_imageWidth + _cellSize.width - 1) / _cellSize.width;
             auto rowOffset = _imageOriginCell.y;
-            auto srcIterator = _imageBuffer.begin();
-            while (srcIterator < _imageBuffer.end() && rowOffset < page.Bottom())
+
+            // The slices store palette indices of their own, so they need the
+            // actual colors to map our color registers into their palettes.
+            std::array<RGBQUAD, MAX_COLORS> colors;
+            for (size_t i = 0; i < colors.size(); i++)
+            {
+                til::at(colors, i) = _makeRGBQUAD(_colorFromIndex(gsl::narrow_cast<IndexType>(i)));
+            }
+
+            const auto srcStride = gsl::narrow_cast<size_t>(_imageMaxWidth);
+            const auto srcRowsPerCell = gsl::narrow_cast<size_t>(_cellSize.height);
+            const ImageSlice* previousSlice = nullptr;
+            auto srcOffset = size_t{ 0 };
+            while (srcOffset < _imageBuffer.size() && rowOffset < page.Bottom())
             {
                 if (rowOffset >= 0)
                 {
@@ -848,30 +970,18 @@ void SixelParser::_maybeFlushImageBuffer(const bool endOfSequence)
                         dstSlice = dstRow.SetImageSlice(std::make_unique<ImageSlice>(_cellSize));
                         __assume(dstSlice != nullptr);
                     }
-                    auto dstIterator = dstSlice->MutablePixels(columnBegin, columnEnd);
-                    for (auto pixelRow = 0; pixelRow < _cellSize.height; pixelRow++)
+                    const auto srcRows = std::min(srcRowsPerCell, (_imageBuffer.size() - srcOffset + srcStride - 1) / srcStride);
+                    const auto src = _imageBuffer.data() + srcOffset;
+                    dstSlice->WritePixels(columnBegin, columnEnd, src, srcStride, _imageWidth, gsl::narrow_cast<til::CoordType>(srcRows), colors);
+                    // Images with solid backgrounds or stripes frequently produce identical
+                    // rows, in which case the two slices can share their pixel storage.
+                    if (previousSlice)
                     {
-                        for (auto pixelColumn = 0; pixelColumn < _imageWidth; pixelColumn++)
-                        {
-                            const auto srcPixel = til::at(srcIterator, pixelColumn);
-                            if (!srcPixel.transparent)
-                            {
-                                const auto srcColor = _colorFromIndex(srcPixel.colorIndex);
-                                til::at(dstIterator, pixelColumn) = _makeRGBQUAD(srcColor);
-                            }
-                        }
-                        std::advance(srcIterator, _imageMaxWidth);
-                        if (srcIterator >= _imageBuffer.end())
-                        {
-                            break;
-                        }
-                        std::advance(dstIterator, dstSlice->PixelWidth());
+                        dstSlice->Deduplicate(*previousSlice);
                     }
+                    previousSlice = dstSlice;
                 }
-                else
-                {
-                    std::advance(srcIterator, _imageMaxWidth * _cellSize.height);
-                }
+                srcOffset += srcStride * srcRowsPerCell;
                 rowOffset++;
             }
 
@@ -13,6 +13,7 @@ Abstract:
 
 #include "til.h"
 #include "DispatchTypes.hpp"
+#include "../buffer/out/ImageSlice.hpp"
 
 class Cursor;
 class TextBuffer;
@@ -34,27 +35,26 @@ namespace Microsoft::Console::VirtualTerminal
         SixelParser(AdaptDispatch& dispatcher, const StateMachine& stateMachine, const VTInt conformanceLevel = DefaultConformance) noexcept;
         void SoftReset();
         void SetDisplayMode(const bool enabled) noexcept;
-        std::function<bool(wchar_t)> DefineImage(const VTInt macroParameter, const DispatchTypes::SixelBackground backgroundSelect, const VTParameter backgroundColor);
+        std::function<bool(std::wstring_view)> DefineImage(const VTInt macroParameter, const DispatchTypes::SixelBackground backgroundSelect, const VTParameter backgroundColor);
 
     private:
         // NB: If we want to support more than 256 colors, we'll also need to
-        // change the IndexType to uint16_t, and use a bit field in IndexedPixel
-        // to retain the 16-bit size.
+        // change the IndexType to uint16_t, and use a bit field in the
+        // ImageSlice::IndexedPixel to retain the 16-bit size.
         static constexpr size_t MAX_COLORS = 256;
         using IndexType = uint8_t;
-        struct IndexedPixel
-        {
-            uint8_t transparent = false;
-            IndexType colorIndex = 0;
-        };
+        using IndexedPixel = ImageSlice::IndexedPixel;
 
         AdaptDispatch& _dispatcher;
         const StateMachine& _stateMachine;
         const VTInt _conformanceLevel;
 
+        void _parseString(const std::wstring_view str);
         void _parseCommandChar(const wchar_t ch);
         void _parseParameterChar(const wchar_t ch);
         int _applyPendingCommand();
+        static constexpr bool _isSixelValue(const wchar_t ch) noexcept;
+        bool _isProcessingLastCharacter() const noexcept;
         void _executeCarriageReturn() noexcept;
         void _executeNextLine();
         void _executeMoveToHome();
@@ -68,6 +68,7 @@ namespace Microsoft::Console::VirtualTerminal
         };
         States _state = States::Normal;
         std::vector<VTParameter> _parameters;
+        size_t _remainingChars = 0;
 
         bool _initTextBufferBoundaries();
         void _initRasterAttributes(const VTInt macroParameter, const DispatchTypes::SixelBackground backgroundSelect) noexcept;
@@ -114,6 +115,7 @@ namespace Microsoft::Console::VirtualTerminal
         void _fillImageBackgroundWhenScrolled();
         void _decreaseFilledBackgroundHeight(const int decreasedHeight) noexcept;
         void _writeToImageBuffer(const int sixelValue, const int repeatCount);
+        void _writeRunToImageBuffer(const std::wstring_view sixelValues);
         void _eraseImageBufferRows(const int rowCount, const til::CoordType startRow = 0) noexcept;
         void _maybeFlushImageBuffer(const bool endOfSequence = false);
 
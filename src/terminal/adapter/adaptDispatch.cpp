@@ -18,6 +18,77 @@ using namespace Microsoft::Console::VirtualTerminal;
 
 static constexpr std::wstring_view whitespace{ L" " };
 
+// Most of our data string parsers process one character at a time, so this
+// adapts them to the StringHandler interface, which receives whole runs.
+template<typename T>
+static ITermDispatch::StringHandler characterHandler(T&& handler)
+{
+    return [handler = std::forward<T>(handler)](const std::wstring_view str) mutable {
+        for (const auto ch : str)
+        {
+            if (!handler(ch))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+}
+
+// Returns the sum of the given characters as used by the DECRQCRA checksum,
+// wrapping around at 16 bits. U+2426 is counted as if it was an ESC (0x1B).
+static uint16_t sumChecksumCharacters(const std::wstring_view text) noexcept
+{
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    auto it = text.data();
+    const auto end = it + text.size();
+    uint16_t sum = 0;
+
+#if defined(TIL_SSE_INTRINSICS)
+
+    const auto symbol = _mm_set1_epi16(0x2426);
+    const auto fixup = _mm_set1_epi16(0x2426 - 0x1B);
+    auto sums = _mm_setzero_si128();
+
+    for (const auto vecEnd = it + (text.size() & ~size_t{ 7 }); it < vecEnd; it += 8)
+    {
+        const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        const auto isSymbol = _mm_cmpeq_epi16(wch, symbol);
+        sums = _mm_add_epi16(sums, _mm_sub_epi16(wch, _mm_and_si128(isSymbol, fixup)));
+    }
+
+    sums = _mm_add_epi16(sums, _mm_srli_si128(sums, 8));
+    sums = _mm_add_epi16(sums, _mm_srli_si128(sums, 4));
+    sums = _mm_add_epi16(sums, _mm_srli_si128(sums, 2));
+    sum = static_cast<uint16_t>(_mm_cvtsi128_si32(sums));
+
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+
+    const auto symbol = vdupq_n_u16(0x2426);
+    const auto fixup = vdupq_n_u16(0x2426 - 0x1B);
+    auto sums = vdupq_n_u16(0);
+
+    for (const auto vecEnd = it + (text.size() & ~size_t{ 7 }); it < vecEnd; it += 8)
+    {
+        const auto wch = vld1q_u16(reinterpret_cast<const uint16_t*>(it));
+        const auto isSymbol = vceqq_u16(wch, symbol);
+        sums = vaddq_u16(sums, vsubq_u16(wch, vandq_u16(isSymbol, fixup)));
+    }
+
+    sum = vaddvq_u16(sums);
+
+#endif
+
+    for (; it < end; ++it)
+    {
+        sum += *it == L'\u2426' ? 0x1B : *it;
+    }
+
+    return sum;
+#pragma warning(pop)
+}
+
 struct XtermResourceColorTableEntry
 {
     int ColorTableIndex;
@@ -92,9 +163,164 @@ void AdaptDispatch::PrintString(const std::wstring_view string)
     }
 }
 
+// Routine Description
+// - Writes lines of text, each of which is followed by a CR, LF or CRLF. This is
+//   equivalent to calling PrintString(), CarriageReturn() and LineFeed() for each
+//   part of the string, but in the common case of a page without margins, we only
+//   need to look up the page and modes once for all of the lines.
+// Arguments:
+// - string - Lines of text, and the CR and LF characters that separate them
+// Return Value:
+// - <none>
+void AdaptDispatch::PrintLines(const std::wstring_view string)
+{
+    auto page = _pages.ActivePage();
+    auto& cursor = page.Cursor();
+
+    if (_termOutput.NeedToTranslate() || !_IsCursorInPageWithoutMargins(page))
+    {
+        for (size_t i = 0; i < string.size();)
+        {
+            const auto wch = til::at(string, i);
+            if (wch == AsciiChars::CR)
+            {
+                CarriageReturn();
+                i++;
+            }
+            else if (wch == AsciiChars::LF)
+            {
+                LineFeed(DispatchTypes::LineFeedType::DependsOnMode);
+                i++;
+            }
+            else
+            {
+                const auto end = std::min(string.find_first_of(L"\r\n", i), string.size());
+                PrintString(string.substr(i, end - i));
+                i = end;
+            }
+        }
+        return;
+    }
+
+    const auto lineFeedWithReturn = _api.GetSystemMode(ITerminalApi::Mode::LineFeed);
+
+    // Without margins, every line feed either moves the cursor down or recycles the topmost
+    // row. So, if a line is followed by at least BufferHeight() line feeds, the row it's
+    // written to is gone by the end of this output, and we can skip writing it entirely.
+    // Programs like `cat` on a large file produce a lot of such output.
+    const auto bufferHeight = gsl::narrow_cast<size_t>(page.BufferHeight());
+    size_t lineFeedsAhead = 0;
+    if (!_modes.test(Mode::InsertReplace))
+    {
+        lineFeedsAhead = gsl::narrow_cast<size_t>(std::count(string.begin(), string.end(), AsciiChars::LF));
+        lineFeedsAhead += _api.GetStateMachine().GetLineFeedsAhead();
+    }
+
+    // UIA appends a newline to each notification, so joining the lines with
+    // newlines is equivalent to sending them one by one like PrintString() does.
+    std::wstring newText;
+    newText.reserve(string.size());
+
+    for (size_t i = 0; i < string.size();)
+    {
+        const auto wch = til::at(string, i);
+        if (wch == AsciiChars::CR)
+        {
+            // Without margins and with the cursor inside the page,
+            // this is what _CursorMovePosition() boils down to.
+            cursor.SetPosition({ 0, cursor.GetPosition().y });
+            _ApplyCursorMovementFlags(cursor);
+            i++;
+        }
+        else if (wch == AsciiChars::LF)
+        {
+            if (_DoLineFeed(page, lineFeedWithReturn, false))
+            {
+                page.MoveViewportDown();
+            }
+            if (lineFeedsAhead)
+            {
+                lineFeedsAhead--;
+            }
+            i++;
+        }
+        else
+        {
+            const auto end = std::min(string.find_first_of(L"\r\n", i), string.size());
+            const auto text = string.substr(i, end - i);
+            const auto scrollsOutOfBuffer = lineFeedsAhead >= bufferHeight && _IsPrintableAscii(text);
+            _WriteToPage(page, text, scrollsOutOfBuffer);
+            if (!newText.empty())
+            {
+                newText.push_back(L'\n');
+            }
+            newText.append(text);
+            i = end;
+        }
+    }
+
+    page.Buffer().TriggerNewTextNotification(newText);
+}
+
+// Routine Description
+// - Checks whether the cursor is inside the page and no margins are set. In that case,
+//   line feeds can't move the cursor out of the page, and they're guaranteed to scroll
+//   the buffer whenever the cursor is on the bottom row.
+// Arguments:
+// - page - The page to check.
+// Return Value:
+// - True if the cursor is inside the page and no margins are set.
+bool AdaptDispatch::_IsCursorInPageWithoutMargins(const Page& page) noexcept
+{
+    const auto cursorPosition = page.Cursor().GetPosition();
+    if (cursorPosition.y < page.Top() || cursorPosition.y >= page.Bottom())
+    {
+        return false;
+    }
+
+    const auto [topMargin, bottomMargin] = _GetVerticalMargins(page, true);
+    const auto [leftMargin, rightMargin] = _GetHorizontalMargins(page.Width());
+    return topMargin == page.Top() && bottomMargin == page.Bottom() - 1 && leftMargin == 0 && rightMargin == page.Width() - 1;
+}
+
+// Routine Description
+// - Checks whether the text consists of nothing but printable ASCII characters.
+//   Text like that takes up exactly one column per character.
+// Arguments:
+// - string - The text to check.
+// Return Value:
+// - True if the text is printable ASCII.
+bool AdaptDispatch::_IsPrintableAscii(const std::wstring_view string) noexcept
+{
+    return std::all_of(string.begin(), string.end(), [](const auto wch) {
+        return wch >= L' ' && wch <= L'~';
+    });
+}
+
 void AdaptDispatch::_WriteToBuffer(const std::wstring_view string)
 {
     auto page = _pages.ActivePage();
+    _WriteToPage(page, string, false);
+
+    // Notify terminal and UIA of new text.
+    // It's important to do this here instead of in TextBuffer, because here you
+    // have access to the entire line of text, whereas TextBuffer writes it one
+    // character at a time via the OutputCellIterator.
+    page.Buffer().TriggerNewTextNotification(string);
+}
+
+// Routine Description
+// - Writes text at the cursor position of the given page, wrapping it across
+//   lines as necessary. If the viewport needs to move down, the page is updated.
+// Arguments:
+// - page - The page to write to.
+// - string - The text to write.
+// - scrollsOutOfBuffer - Set to true if the text is going to be scrolled out of the
+//   buffer before the end of the output. The text must be printable ASCII in that case.
+// Return Value:
+// - <none>
+void AdaptDispatch::_WriteToPage(Page& page, const std::wstring_view string, const bool scrollsOutOfBuffer)
+{
     auto& textBuffer = page.Buffer();
     auto& cursor = page.Cursor();
     auto cursorPosition = cursor.GetPosition();
@@ -150,7 +376,19 @@ void AdaptDispatch::_WriteToBuffer(const std::wstring_view string)
         state.columnBegin = cursorPosition.x;
 
         const auto textPositionBefore = state.text.data();
-        if (_modes.test(Mode::InsertReplace))
+        if (scrollsOutOfBuffer)
+        {
+            // The text is going to be scrolled out of the buffer before anyone can
+            // see it, so we only need to advance the cursor like ROW::ReplaceText()
+            // would, which is simple, because each character takes up one column.
+            const auto rowWidth = textBuffer.GetSize().Width();
+            const auto columnBegin = std::clamp(state.columnBegin, 0, rowWidth);
+            const auto columnLimit = std::clamp(state.columnLimit, 0, rowWidth);
+            const auto count = std::min<size_t>(state.text.size(), std::max(0, columnLimit - columnBegin));
+            state.text = state.text.substr(count);
+            state.columnEnd = columnBegin + gsl::narrow_cast<til::CoordType>(count);
+        }
+        else if (_modes.test(Mode::InsertReplace))
         {
             textBuffer.Insert(cursorPosition.y, attributes, state);
         }
@@ -193,12 +431,6 @@ void AdaptDispatch::_WriteToBuffer(const std::wstring_view string)
     }
 
     _ApplyCursorMovementFlags(cursor);
-
-    // Notify terminal and UIA of new text.
-    // It's important to do this here instead of in TextBuffer, because here you
-    // have access to the entire line of text, whereas TextBuffer writes it one
-    // character at a time via the OutputCellIterator.
-    textBuffer.TriggerNewTextNotification(string);
 }
 
 // Routine Description:
@@ -576,8 +808,9 @@ void AdaptDispatch::_ScrollRectVertically(const Page& page, const til::rect& scr
         if (width == page.Width())
         {
             // If the scrollRect is the full width of the buffer, we can scroll
-            // more efficiently by rotating the row storage.
-            textBuffer.ScrollRows(top, height, actualDelta);
+            // more efficiently by rotating the row storage. The rows it uncovers
+            // are erased below, so they don't need to retain their contents.
+            textBuffer.RotateRows(top, height, actualDelta);
             textBuffer.TriggerRedraw(Viewport::FromExclusive(scrollRect));
         }
         else
@@ -944,31 +1177,24 @@ void AdaptDispatch::_ChangeRectAttributes(const Page& page, const til::rect& cha
 {
     if (changeRect)
     {
-        for (auto row = changeRect.top; row < changeRect.bottom; row++)
-        {
-            auto& rowBuffer = page.Buffer().GetMutableRowByOffset(row);
-            for (auto col = changeRect.left; col < changeRect.right; col++)
+        page.Buffer().TransformAttributes(changeRect, [&](TextAttribute& attr) {
+            auto characterAttributes = attr.GetCharacterAttributes();
+            characterAttributes &= changeOps.andAttrMask;
+            characterAttributes ^= changeOps.xorAttrMask;
+            attr.SetCharacterAttributes(characterAttributes);
+            if (changeOps.foreground)
             {
-                auto attr = rowBuffer.GetAttrByColumn(col);
-                auto characterAttributes = attr.GetCharacterAttributes();
-                characterAttributes &= changeOps.andAttrMask;
-                characterAttributes ^= changeOps.xorAttrMask;
-                attr.SetCharacterAttributes(characterAttributes);
-                if (changeOps.foreground)
-                {
-                    attr.SetForeground(*changeOps.foreground);
-                }
-                if (changeOps.background)
-                {
-                    attr.SetBackground(*changeOps.background);
-                }
-                if (changeOps.underlineColor)
-                {
-                    attr.SetUnderlineColor(*changeOps.underlineColor);
-                }
-                rowBuffer.ReplaceAttributes(col, col + 1, attr);
+                attr.SetForeground(*changeOps.foreground);
             }
-        }
+            if (changeOps.background)
+            {
+                attr.SetBackground(*changeOps.background);
+            }
+            if (changeOps.underlineColor)
+            {
+                attr.SetUnderlineColor(*changeOps.underlineColor);
+            }
+        });
         page.Buffer().TriggerRedraw(Viewport::FromExclusive(changeRect));
     }
 }
@@ -1318,52 +1544,114 @@ void AdaptDispatch::RequestChecksumRectangularArea(const VTInt id, const VTInt p
 
                 const auto target = _pages.Get(page);
                 const auto eraseRect = _CalculateRectArea(target, top, left, bottom, right);
-                for (auto row = eraseRect.top; row < eraseRect.bottom; row++)
+                const auto& textBuffer = target.Buffer();
+
+                const auto defaultIndices = std::pair{ defaultFgIndex, defaultBgIndex };
+                if (_rowChecksumsDefaultIndices != defaultIndices)
+                {
+                    _rowChecksums.clear();
+                    _rowChecksumsDefaultIndices = defaultIndices;
+                }
+
+                // Only the checksums of rows that were part of this request are retained,
+                // which keeps the cache from growing with every row that ever scrolled by.
+                decltype(_rowChecksums) usedRowChecksums;
+
+                for (auto y = eraseRect.top; y < eraseRect.bottom; y++)
                 {
-                    for (auto col = eraseRect.left; col < eraseRect.right; col++)
+                    const auto& row = textBuffer.GetRowByOffset(y);
+                    const auto generation = row.GetGeneration();
+                    // A generation of 0 means the row was never modified, which
+                    // doesn't uniquely identify its contents, so it can't be cached.
+                    const auto cacheable = generation != 0 && eraseRect.left == 0 && eraseRect.right >= row.size();
+
+                    if (!cacheable)
                     {
-                        // The algorithm we're using here should match the DEC terminals
-                        // for the ASCII and Latin-1 range. Their other character sets
-                        // predate Unicode, though, so we'd need a custom mapping table
-                        // to lookup the correct checksums. Considering this is only for
-                        // testing at the moment, that doesn't seem worth the effort.
-                        const auto cell = target.Buffer().GetCellDataAt({ col, row });
-                        for (auto ch : cell->Chars())
-                        {
-                            // That said, I've made a special allowance for U+2426,
-                            // since that is widely used in a lot of character sets.
-                            checksum -= (ch == L'\u2426' ? 0x1B : ch);
-                        }
-
-                        // Since we're attempting to match the DEC checksum algorithm,
-                        // the only attributes affecting the checksum are the ones that
-                        // were supported by DEC terminals.
-                        const auto attr = cell->TextAttr();
-                        checksum -= attr.IsProtected() ? 0x04 : 0;
-                        checksum -= attr.IsInvisible() ? 0x08 : 0;
-                        checksum -= attr.IsUnderlined() ? 0x10 : 0;
-                        checksum -= attr.IsReverseVideo() ? 0x20 : 0;
-                        checksum -= attr.IsBlinking() ? 0x40 : 0;
-                        checksum -= attr.IsIntense() ? 0x80 : 0;
-
-                        // For the same reason, we only care about the eight basic ANSI
-                        // colors, although technically we also report the 8-16 index
-                        // range. Everything else gets mapped to the default colors.
-                        const auto colorIndex = [](const auto color, const auto defaultIndex) {
-                            return color.IsLegacy() ? color.GetIndex() : defaultIndex;
-                        };
-                        const auto fgIndex = colorIndex(attr.GetForeground(), defaultFgIndex);
-                        const auto bgIndex = colorIndex(attr.GetBackground(), defaultBgIndex);
-                        checksum -= gsl::narrow_cast<uint16_t>(fgIndex << 4);
-                        checksum -= gsl::narrow_cast<uint16_t>(bgIndex);
+                        checksum += _CalculateRowChecksum(row, eraseRect.left, eraseRect.right, defaultFgIndex, defaultBgIndex);
+                        continue;
                     }
+
+                    const auto it = _rowChecksums.find(generation);
+                    const auto rowChecksum = it != _rowChecksums.end() ? it->second : _CalculateRowChecksum(row, 0, row.size(), defaultFgIndex, defaultBgIndex);
+                    usedRowChecksums.emplace(generation, rowChecksum);
+                    checksum += rowChecksum;
                 }
+
+                _rowChecksums = std::move(usedRowChecksums);
             }
         }
     }
     _ReturnDcsResponse(wil::str_printf<std::wstring>(L"%d!~%04X", id, checksum));
 }
 
+// Routine Description:
+// - Calculates the DECRQCRA checksum of the cells in the given column range of a row.
+// Arguments:
+// - row - The row to calculate the checksum for.
+// - left - The first column of the range.
+// - right - The column past the end of the range.
+// - defaultFgIndex - The color index reported for the default foreground.
+// - defaultBgIndex - The color index reported for the default background.
+// Return Value:
+// - The checksum, which is to be added to the checksums of other rows.
+uint16_t AdaptDispatch::_CalculateRowChecksum(const ROW& row, const til::CoordType left, const til::CoordType right, const size_t defaultFgIndex, const size_t defaultBgIndex)
+{
+    uint16_t checksum = 0;
+
+    // The algorithm we're using here should match the DEC terminals for
+    // the ASCII and Latin-1 range. Their other character sets predate
+    // Unicode, though, so we'd need a custom mapping table to lookup the
+    // correct checksums. Considering this is only for testing at the moment,
+    // that doesn't seem worth the effort. That said, I've made a special
+    // allowance for U+2426, since that is widely used in a lot of character sets.
+    if (right <= row.GetReadableColumnCount() && row.HasOneCharPerColumn(left, right))
+    {
+        // This is the common case: Every column holds exactly one character,
+        // so we can sum them all up in one go.
+        checksum -= sumChecksumCharacters(row.GetText(left, right));
+    }
+    else
+    {
+        // Otherwise we have to go column by column, because a wide glyph
+        // is included in the checksum once for each column it covers.
+        for (auto col = left; col < right; col++)
+        {
+            checksum -= sumChecksumCharacters(row.GlyphAt(col));
+        }
+    }
+
+    // Since we're attempting to match the DEC checksum algorithm, the only
+    // attributes affecting the checksum are the ones that were supported by
+    // DEC terminals. Their contribution is the same for every cell in a run.
+    const auto attributes = row.Attributes().slice(gsl::narrow_cast<uint16_t>(left), gsl::narrow_cast<uint16_t>(right));
+    for (const auto& run : attributes.runs())
+    {
+        const auto& attr = run.value;
+        uint16_t cellChecksum = 0;
+        cellChecksum += attr.IsProtected() ? 0x04 : 0;
+        cellChecksum += attr.IsInvisible() ? 0x08 : 0;
+        cellChecksum += attr.IsUnderlined() ? 0x10 : 0;
+        cellChecksum += attr.IsReverseVideo() ? 0x20 : 0;
+        cellChecksum += attr.IsBlinking() ? 0x40 : 0;
+        cellChecksum += attr.IsIntense() ? 0x80 : 0;
+
+        // For the same reason, we only care about the eight basic ANSI
+        // colors, although technically we also report the 8-16 index
+        // range. Everything else gets mapped to the default colors.
+        const auto colorIndex = [](const auto color, const auto defaultIndex) {
+            return color.IsLegacy() ? color.GetIndex() : defaultIndex;
+        };
+        const auto fgIndex = colorIndex(attr.GetForeground(), defaultFgIndex);
+        const auto bgIndex = colorIndex(attr.GetBackground(), defaultBgIndex);
+        cellChecksum += gsl::narrow_cast<uint16_t>(fgIndex << 4);
+        cellChecksum += gsl::narrow_cast<uint16_t>(bgIndex);
+
+        checksum -= gsl::narrow_cast<uint16_t>(cellChecksum * run.length);
+    }
+
+    return checksum;
+}
+
 // Routine Description:
 // - DECSWL/DECDWL/DECDHL - Sets the line rendition attribute for the current line.
 // Arguments:
@@ -3868,7 +4156,7 @@ ITermDispatch::StringHandler AdaptDispatch::DownloadDRCS(const VTInt fontNumber,
         return nullptr;
     }
 
-    return [=](const auto ch) {
+    return characterHandler([=](const auto ch) {
         // We pass the data string straight through to the font buffer class
         // until we receive an ESC, indicating the end of the string. At that
         // point we can finalize the buffer, and if valid, update the renderer
@@ -3899,7 +4187,7 @@ ITermDispatch::StringHandler AdaptDispatch::DownloadDRCS(const VTInt fontNumber,
             }
         }
         return true;
-    };
+    });
 }
 
 // Method Description:
@@ -3921,7 +4209,7 @@ void AdaptDispatch::RequestUserPreferenceCharset()
 // - a function to parse the character set ID
 ITermDispatch::StringHandler AdaptDispatch::AssignUserPreferenceCharset(const DispatchTypes::CharsetSize charsetSize)
 {
-    return [this, charsetSize, idBuilder = VTIDBuilder{}](const auto ch) mutable {
+    return characterHandler([this, charsetSize, idBuilder = VTIDBuilder{}](const auto ch) mutable {
         if (ch >= L'\x20' && ch <= L'\x2f')
         {
             idBuilder.AddIntermediate(ch);
@@ -3941,7 +4229,7 @@ ITermDispatch::StringHandler AdaptDispatch::AssignUserPreferenceCharset(const Di
             return false;
         }
         return true;
-    };
+    });
 }
 
 // Method Description:
@@ -3964,9 +4252,9 @@ ITermDispatch::StringHandler AdaptDispatch::DefineMacro(const VTInt macroId,
 
     if (_macroBuffer->InitParser(macroId, deleteControl, encoding))
     {
-        return [&](const auto ch) {
+        return characterHandler([&](const auto ch) {
             return _macroBuffer->ParseDefinition(ch);
-        };
+        });
     }
 
     return nullptr;
@@ -4085,7 +4373,7 @@ void AdaptDispatch::_ReportColorTable(const DispatchTypes::ColorModel colorModel
 // - a function to parse the report data.
 ITermDispatch::StringHandler AdaptDispatch::_RestoreColorTable()
 {
-    return [this, parameter = VTInt{}, parameters = std::vector<VTParameter>{}](const auto ch) mutable {
+    return characterHandler([this, parameter = VTInt{}, parameters = std::vector<VTParameter>{}](const auto ch) mutable {
         if (ch >= L'0' && ch <= L'9')
         {
             parameter *= 10;
@@ -4124,7 +4412,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreColorTable()
             parameter = 0;
         }
         return (ch != AsciiChars::ESC);
-    };
+    });
 }
 
 // Method Description:
@@ -4143,7 +4431,7 @@ ITermDispatch::StringHandler AdaptDispatch::RequestSetting()
     // this is the opposite of what is documented in most DEC manuals, which
     // say that 0 is for a valid response, and 1 is for an error. The correct
     // interpretation is documented in the DEC STD 070 reference.
-    return [this, parameter = VTInt{}, idBuilder = VTIDBuilder{}](const auto ch) mutable {
+    return characterHandler([this, parameter = VTInt{}, idBuilder = VTIDBuilder{}](const auto ch) mutable {
         const auto isFinal = ch >= L'\x40' && ch <= L'\x7e';
         if (isFinal)
         {
@@ -4198,7 +4486,7 @@ ITermDispatch::StringHandler AdaptDispatch::RequestSetting()
             }
             return true;
         }
-    };
+    });
 }
 
 // Method Description:
@@ -4545,7 +4833,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreCursorInformation()
         VTParameter row{};
         VTParameter column{};
     };
-    return [&, state = State{}](const auto ch) mutable {
+    return characterHandler([&, state = State{}](const auto ch) mutable {
         if (numeric.test(state.field))
         {
             if (ch >= '0' && ch <= '9')
@@ -4665,7 +4953,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreCursorInformation()
             }
         }
         return (ch != AsciiChars::ESC);
-    };
+    });
 }
 
 // Method Description:
@@ -4717,7 +5005,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreTabStops()
     _ClearAllTabStops();
     _InitTabStopsForWidth(width);
 
-    return [this, width, column = size_t{}](const auto ch) mutable {
+    return characterHandler([this, width, column = size_t{}](const auto ch) mutable {
         if (ch >= L'0' && ch <= L'9')
         {
             column *= 10;
@@ -4741,7 +5029,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreTabStops()
             return false;
         }
         return (ch != AsciiChars::ESC);
-    };
+    });
 }
 
 void AdaptDispatch::_ReturnCsiResponse(const std::wstring_view response) const
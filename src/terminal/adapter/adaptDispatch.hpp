@@ -40,6 +40,7 @@ namespace Microsoft::Console::VirtualTerminal
 
         void Print(const wchar_t wchPrintable) override;
         void PrintString(const std::wstring_view string) override;
+        void PrintLines(const std::wstring_view string) override;
 
         void CursorUp(const VTInt distance) override; // CUU
         void CursorDown(const VTInt distance) override; // CUD
@@ -237,7 +238,10 @@ namespace Microsoft::Console::VirtualTerminal
             std::optional<TextColor> underlineColor;
         };
 
+        bool _IsCursorInPageWithoutMargins(const Page& page) noexcept;
+        static bool _IsPrintableAscii(const std::wstring_view string) noexcept;
         void _WriteToBuffer(const std::wstring_view string);
+        void _WriteToPage(Page& page, const std::wstring_view string, const bool scrollsOutOfBuffer);
         std::pair<int, int> _GetVerticalMargins(const Page& page, const bool absolute) noexcept;
         std::pair<int, int> _GetHorizontalMargins(const til::CoordType bufferWidth) noexcept;
         void _CursorMovePosition(const Offset rowOffset, const Offset colOffset, const bool clampInMargins);
@@ -247,6 +251,7 @@ namespace Microsoft::Console::VirtualTerminal
         void _ChangeRectAttributes(const Page& page, const til::rect& changeRect, const ChangeOps& changeOps);
         void _ChangeRectOrStreamAttributes(const til::rect& changeArea, const ChangeOps& changeOps);
         til::rect _CalculateRectArea(const Page& page, const VTInt top, const VTInt left, const VTInt bottom, const VTInt right);
+        static uint16_t _CalculateRowChecksum(const ROW& row, const til::CoordType left, const til::CoordType right, const size_t defaultFgIndex, const size_t defaultBgIndex);
         void _EraseScrollback();
         void _EraseAll();
         TextAttribute _GetEraseAttributes(const Page& page) const noexcept;
@@ -329,6 +334,12 @@ namespace Microsoft::Console::VirtualTerminal
 
         SgrStack _sgrStack;
 
+        // DECRQCRA checksums of entire rows, keyed by ROW::GetGeneration(). Test suites
+        // tend to request the checksum of the whole page after every small change, so
+        // most of the rows can be answered without looking at their contents again.
+        std::unordered_map<uint64_t, uint16_t> _rowChecksums;
+        std::pair<size_t, size_t> _rowChecksumsDefaultIndices;
+
         void _SetUnderlineStyleHelper(const VTParameter option, TextAttribute& attr) noexcept;
         size_t _SetRgbColorsHelper(const VTParameters options,
                                    TextAttribute& attr,
@@ -24,6 +24,28 @@ class Microsoft::Console::VirtualTerminal::TermDispatch : public Microsoft::Cons
 public:
     void Print(const wchar_t wchPrintable) override = 0;
     void PrintString(const std::wstring_view string) override = 0;
+    void PrintLines(const std::wstring_view string) override
+    {
+        for (size_t i = 0; i < string.size();)
+        {
+            if (til::at(string, i) == L'\r')
+            {
+                CarriageReturn();
+                i++;
+            }
+            else if (til::at(string, i) == L'\n')
+            {
+                LineFeed(DispatchTypes::LineFeedType::DependsOnMode);
+                i++;
+            }
+            else
+            {
+                const auto end = std::min(string.find_first_of(L"\r\n", i), string.size());
+                PrintString(string.substr(i, end - i));
+                i = end;
+            }
+        }
+    }
 
     void CursorUp(const VTInt /*distance*/) override {} // CUU
     void CursorDown(const VTInt /*distance*/) override {} // CUD
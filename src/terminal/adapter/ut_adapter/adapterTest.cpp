@@ -1849,9 +1849,9 @@ public:
             const auto stringHandler = _pDispatch->RequestSetting();
             for (auto ch : settingId)
             {
-                stringHandler(ch);
+                stringHandler({ &ch, 1 });
             }
-            stringHandler(L'\033'); // String terminator
+            stringHandler(L"\033"); // String terminator
         };
 
         Log::Comment(L"Requesting DECSTBM margins (5 to 10).");
@@ -2264,6 +2264,36 @@ public:
             attr.SetIndexedBackground(TextColor::DARK_BLUE);
         });
         verifyChecksumReport(L"FF8B");
+
+        Log::Comment(L"Test 6: Entire rows");
+        const auto rowChecksum = [&](const VTInt left, const VTInt right) {
+            _testGetSet->_response.clear();
+            _pDispatch->RequestChecksumRectangularArea(99, 1, 1, left, 1, right);
+            // The response has the form "\x1bP99!~XXXX\x1b\\".
+            return std::wcstoul(_testGetSet->_response.substr(6, 4).c_str(), nullptr, 16);
+        };
+        const auto sumOfColumns = [&](const VTInt left, const VTInt right) {
+            unsigned long sum = 0;
+            for (auto col = left; col <= right; col++)
+            {
+                sum += rowChecksum(col, col);
+            }
+            return sum & 0xFFFF;
+        };
+
+        _testGetSet->PrepData();
+        _pDispatch->PrintString(L"ABC\u2426DEFGHIJ\u3042KLMNOPQRSTUVWXYZ"sv);
+        VERIFY_ARE_EQUAL(sumOfColumns(1, 10), rowChecksum(1, 10));
+        const auto expected = sumOfColumns(1, 100);
+        VERIFY_ARE_EQUAL(expected, rowChecksum(1, 100));
+        Log::Comment(L"The cached checksum of the row should be reported again");
+        VERIFY_ARE_EQUAL(expected, rowChecksum(1, 100));
+        Log::Comment(L"Modifying the row should invalidate the cached checksum");
+        _testGetSet->_textBuffer->SetCurrentAttributes(TextAttribute{ FOREGROUND_RED });
+        _pDispatch->PrintString(L"\u2426"sv);
+        const auto actual = rowChecksum(1, 100);
+        VERIFY_ARE_NOT_EQUAL(expected, actual);
+        VERIFY_ARE_EQUAL(sumOfColumns(1, 100), actual);
     }
 
     TEST_METHOD(ColorTableReportTests)
@@ -3564,9 +3594,9 @@ public:
             const auto stringHandler = _pDispatch->AssignUserPreferenceCharset(charsetSize);
             for (auto ch : charsetId)
             {
-                stringHandler(ch);
+                stringHandler({ &ch, 1 });
             }
-            stringHandler(L'\033'); // String terminator
+            stringHandler(L"\033"); // String terminator
         };
         auto& termOutput = _pDispatch->_termOutput;
         termOutput.SoftReset();
@@ -20,7 +20,9 @@ namespace Microsoft::Console::VirtualTerminal
     class IStateMachineEngine
     {
     public:
-        using StringHandler = std::function<bool(const wchar_t)>;
+        // Data strings are passed to the handler in runs of one or more characters.
+        // The terminating ESC is always passed on its own.
+        using StringHandler = std::function<bool(const std::wstring_view)>;
 
         virtual ~IStateMachineEngine() = 0;
         IStateMachineEngine(const IStateMachineEngine&) = default;
@@ -34,6 +36,10 @@ namespace Microsoft::Console::VirtualTerminal
         virtual bool ActionExecuteFromEscape(const wchar_t wch) = 0;
         virtual bool ActionPrint(const wchar_t wch) = 0;
         virtual bool ActionPrintString(const std::wstring_view string) = 0;
+        // Runs of printable characters, each followed by a CR, LF or CRLF. This must be
+        // equivalent to calling ActionPrintString() and ActionExecute() for each part.
+        // The state machine only batches lines of output, so input engines needn't override this.
+        virtual bool ActionPrintLines(const std::wstring_view /*string*/) { return false; }
 
         virtual bool ActionPassThroughString(const std::wstring_view string) = 0;
 
@@ -163,6 +163,24 @@ bool OutputStateMachineEngine::ActionPrintString(const std::wstring_view string)
     return true;
 }
 
+// Routine Description:
+// - Triggers the PrintLines action to indicate that the listener should render
+//      the lines of text given, and execute the CR and LF characters between them.
+// Arguments:
+// - string - string to dispatch.
+// Return Value:
+// - true iff we successfully dispatched the sequence.
+bool OutputStateMachineEngine::ActionPrintLines(const std::wstring_view string)
+{
+    _dispatch->PrintLines(string);
+
+    // The string always ends with a CR or LF, and just like
+    // ActionExecute(), that resets the last printed character.
+    _ClearLastChar();
+
+    return true;
+}
+
 // Routine Description:
 // This is called when we have determined that we don't understand a particular
 //      sequence, or the adapter has determined that the string is intended for
@@ -33,6 +33,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool ActionPrintString(const std::wstring_view string) override;
 
+        bool ActionPrintLines(const std::wstring_view string) override;
+
         bool ActionPassThroughString(const std::wstring_view string) noexcept override;
 
         bool ActionEscDispatch(const VTID id) override;
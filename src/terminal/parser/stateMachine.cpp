@@ -432,6 +432,21 @@ void StateMachine::_ActionPrintString(const std::wstring_view string)
     _trace.DispatchPrintRunTrace(string);
 }
 
+// Routine Description:
+// - Triggers the PrintLines action to indicate that the listener should render the lines
+//   of text given, and execute the CR and LF characters that separate them.
+// Arguments:
+// - string - Characters to dispatch.
+// Return Value:
+// - <none>
+void StateMachine::_ActionPrintLines(const std::wstring_view string)
+{
+    _SafeExecute([=]() {
+        return _engine->ActionPrintLines(string);
+    });
+    _trace.DispatchPrintRunTrace(string);
+}
+
 // Routine Description:
 // - Triggers the EscDispatch action to indicate that the listener should handle a simple escape sequence.
 //   These sequences traditionally start with ESC and a simple letter. No complicated parameters.
@@ -655,7 +670,8 @@ void StateMachine::_ActionInterrupt()
     if (_state == VTStates::DcsPassThrough)
     {
         // The ESC signals the end of the data string.
-        _dcsStringHandler(AsciiChars::ESC);
+        static constexpr wchar_t terminator = AsciiChars::ESC;
+        _dcsStringHandler({ &terminator, 1 });
         _dcsStringHandler = nullptr;
     }
 }
@@ -1804,7 +1820,7 @@ void StateMachine::_EventDcsPassThrough(const wchar_t wch)
     _trace.TraceOnEvent(L"DcsPassThrough");
     if (_isC0Code(wch) || _isDcsPassThroughValid(wch))
     {
-        if (!_dcsStringHandler(wch))
+        if (!_dcsStringHandler({ &wch, 1 }))
         {
             _EnterDcsIgnore();
         }
@@ -1815,6 +1831,36 @@ void StateMachine::_EventDcsPassThrough(const wchar_t wch)
     }
 }
 
+// Routine Description:
+// - Passes the longest prefix of the given string that consists of valid data
+//   string characters through to the DCS handler in a single call. This is
+//   equivalent to calling _EventDcsPassThrough for each of those characters,
+//   but allows handlers like the sixel parser to decode their data in bulk.
+// Arguments:
+// - string - The remainder of the string passed to ProcessString
+// Return Value:
+// - The number of characters that were passed through. This is 0 if the first
+//   character needs to be processed by the state machine (e.g. an ESC).
+size_t StateMachine::_EventDcsPassThroughString(const std::wstring_view string)
+{
+    const auto end = std::find_if_not(string.begin(), string.end(), [](const auto wch) {
+        return _isC0Code(wch) || _isDcsPassThroughValid(wch);
+    });
+    const auto run = std::wstring_view{ string.begin(), end };
+    if (!run.empty())
+    {
+        // As far as the handler is concerned, it's processing the last character
+        // if the run extends to the end of the string.
+        _processingLastCharacter = end == string.end();
+        _trace.TraceOnEvent(L"DcsPassThrough");
+        if (!_dcsStringHandler(run))
+        {
+            _EnterDcsIgnore();
+        }
+    }
+    return run.size();
+}
+
 // Routine Description:
 // - Handle SOS/PM/APC string.
 //   In this state the entire string is ignored.
@@ -1964,6 +2010,30 @@ bool StateMachine::FlushToTerminal()
     return success;
 }
 
+// Routine Description:
+// - Returns the end of the lines that start with the line break at the given position.
+//   Each line consists of a CR, LF or CRLF, and the printable text that follows it.
+//   Only text that is followed by another line break is included, so the result
+//   either points past the last line break, or equals `it` if there's none.
+// Arguments:
+// - it - The first actionable control character after a run of printable text.
+// - end - The end of the string.
+// Return Value:
+// - The end of the lines.
+static const wchar_t* _findEndOfLines(const wchar_t* it, const wchar_t* const end) noexcept
+{
+    auto linesEnd = it;
+    while (it != end && (*it == AsciiChars::CR || *it == AsciiChars::LF))
+    {
+        // Pointer arithmetic is perfectly fine for our hot path.
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).)
+        ++it;
+        linesEnd = it;
+        it = Microsoft::Console::Utils::FindActionableControlCharacter(it, end - it);
+    }
+    return linesEnd;
+}
+
 // Routine Description:
 // - Helper for entry to the state machine. Will take an array of characters
 //     and print as many as it can without encountering a character indicating
@@ -1980,6 +2050,7 @@ void StateMachine::ProcessString(const std::wstring_view string)
     _runOffset = 0;
     _runSize = 0;
     _injections.clear();
+    _lineFeedLookahead = {};
 
     if (_state != VTStates::Ground)
     {
@@ -1996,13 +2067,29 @@ void StateMachine::ProcessString(const std::wstring_view string)
             const auto beg = string.data() + i;
             const auto len = string.size() - i;
             const auto it = Microsoft::Console::Utils::FindActionableControlCharacter(beg, len);
+            // Output like logs mostly consists of short lines separated by CR/LF. Instead of
+            // processing each line break individually, we hand the engine all the lines
+            // up to the next escape sequence or other control character at once.
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).)
+            const auto linesEnd = _isEngineForInput ? it : _findEndOfLines(it, beg + len);
 
             _runOffset = i;
-            _runSize = it - beg;
+            _runSize = linesEnd - beg;
 
             if (_runSize)
             {
-                _ActionPrintString(_CurrentRun());
+                _printingRun = true;
+                const auto resetPrintingRun = wil::scope_exit([&]() noexcept {
+                    _printingRun = false;
+                });
+                if (linesEnd != it)
+                {
+                    _ActionPrintLines(_CurrentRun());
+                }
+                else
+                {
+                    _ActionPrintString(_CurrentRun());
+                }
 
                 i += _runSize;
                 _runOffset = i;
@@ -2018,6 +2105,19 @@ void StateMachine::ProcessString(const std::wstring_view string)
 
         do
         {
+            // Data strings (e.g. sixel images) can be very long and consist of nothing but
+            // pass-through characters, so we hand them to the DCS handler in bulk.
+            if (_state == VTStates::DcsPassThrough)
+            {
+                const auto count = _EventDcsPassThroughString(string.substr(i));
+                _runSize += count;
+                i += count;
+                if (i >= string.size())
+                {
+                    break;
+                }
+            }
+
             _runSize++;
             _processingLastCharacter = i + 1 >= string.size();
             // If we're processing characters individually, send it to the state machine.
@@ -2108,6 +2208,142 @@ bool StateMachine::IsProcessingLastCharacter() const noexcept
     return _processingLastCharacter;
 }
 
+// Routine Description:
+// - Returns the end of the SGR or window title OSC sequence starting at the given
+//   offset. Neither of them affect the buffer contents or the cursor position.
+// Arguments:
+// - string - The string to scan.
+// - offset - The offset of the ESC character that introduces the sequence.
+// Return Value:
+// - The offset past the end of the sequence, or the given offset if it's
+//   any other sequence, or if it's incomplete.
+static size_t _skipInertSequence(const std::wstring_view string, const size_t offset) noexcept
+{
+    const auto size = string.size();
+    auto i = offset + 1;
+    if (i >= size)
+    {
+        return offset;
+    }
+
+    const auto introducer = til::at(string, i++);
+    if (introducer == L'[')
+    {
+        while (i < size && (_isNumericParamValue(til::at(string, i)) || _isParameterDelimiter(til::at(string, i)) || _isSubParameterDelimiter(til::at(string, i))))
+        {
+            i++;
+        }
+        return i < size && til::at(string, i) == L'm' ? i + 1 : offset;
+    }
+
+    if (introducer == L']')
+    {
+        if (i + 1 >= size || til::at(string, i) < L'0' || til::at(string, i) > L'2' || til::at(string, i + 1) != L';')
+        {
+            return offset;
+        }
+        for (i += 2; i < size; i++)
+        {
+            const auto wch = til::at(string, i);
+            if (wch == AsciiChars::BEL)
+            {
+                return i + 1;
+            }
+            if (wch == AsciiChars::ESC)
+            {
+                return i + 1 < size && _isStringTerminatorIndicator(til::at(string, i + 1)) ? i + 2 : offset;
+            }
+            if (wch < AsciiChars::SPC || _isDelete(wch) || _isC1ControlCharacter(wch))
+            {
+                return offset;
+            }
+        }
+    }
+
+    return offset;
+}
+
+// Routine Description:
+// - Counts the line feeds that follow the run of text that's currently being printed,
+//   up to the first character or sequence that could move the cursor back up, or
+//   that could affect the buffer in any other way than a plain line feed does.
+//   The dispatch can use this to skip writing text that would be scrolled out
+//   of the buffer again before the end of this ProcessString() call anyway.
+// - To keep this simple, it only returns a non-zero count while the engine is handling
+//   ActionPrintLines(), and the only escape sequences it looks past are SGR and window
+//   title OSCs. Everything else ends the count. Line feeds within the lines that are
+//   currently being printed aren't included.
+// Arguments:
+// - <none>
+// Return Value:
+// - The number of LF, VT and FF characters that are certain to follow the current run.
+size_t StateMachine::GetLineFeedsAhead() noexcept
+{
+    if (!_printingRun || !_parserMode.test(Mode::Ansi))
+    {
+        return 0;
+    }
+
+    const auto string = _currentString;
+    const auto runEnd = _runOffset + _runSize;
+    if (!_runSize || (til::at(string, runEnd - 1) != AsciiChars::CR && til::at(string, runEnd - 1) != AsciiChars::LF))
+    {
+        return 0;
+    }
+
+    static constexpr auto isLineFeed = [](const wchar_t wch) noexcept {
+        return wch == AsciiChars::LF || wch == AsciiChars::VT || wch == AsciiChars::FF;
+    };
+
+    // Most of the time we get called for each line of the same string. Instead of scanning
+    // the remainder of the string each time, we only discount the line feeds that we have
+    // passed since the last call, and continue scanning where we left off.
+    auto& lookahead = _lineFeedLookahead;
+    if (runEnd > lookahead.end || runEnd < lookahead.begin)
+    {
+        lookahead = { runEnd, runEnd, 0, false };
+    }
+    else
+    {
+        for (auto i = lookahead.begin; i < runEnd; i++)
+        {
+            if (isLineFeed(til::at(string, i)))
+            {
+                lookahead.lineFeeds--;
+            }
+        }
+        lookahead.begin = runEnd;
+    }
+
+    while (!lookahead.blocked && lookahead.end < string.size())
+    {
+        const auto wch = til::at(string, lookahead.end);
+        if (isLineFeed(wch))
+        {
+            lookahead.lineFeeds++;
+            lookahead.end++;
+        }
+        else if (wch == AsciiChars::ESC)
+        {
+            const auto end = _skipInertSequence(string, lookahead.end);
+            lookahead.blocked = end == lookahead.end;
+            lookahead.end = end;
+        }
+        else if (wch == AsciiChars::BS || _isC1ControlCharacter(wch))
+        {
+            // A backspace can reverse wrap into the preceding line, and
+            // C1 controls are just as arbitrary as escape sequences.
+            lookahead.blocked = true;
+        }
+        else
+        {
+            lookahead.end++;
+        }
+    }
+
+    return lookahead.lineFeeds;
+}
+
 void StateMachine::InjectSequence(const InjectionType type)
 {
     _injections.emplace_back(type, _runOffset + _runSize);
@@ -2202,5 +2438,7 @@ void StateMachine::_ExecuteCsiCompleteCallback()
         _currentString = savedCurrentString;
         _runOffset = savedRunOffset;
         _runSize = savedRunSize;
+        // The callback may have changed the lookahead state for a different string.
+        _lineFeedLookahead = {};
     }
 }
@@ -82,6 +82,7 @@ namespace Microsoft::Console::VirtualTerminal
         void ProcessCharacter(const wchar_t wch);
         void ProcessString(const std::wstring_view string);
         bool IsProcessingLastCharacter() const noexcept;
+        size_t GetLineFeedsAhead() noexcept;
 
         void InjectSequence(InjectionType type);
         const til::small_vector<Injection, 8>& GetInjections() const noexcept;
@@ -98,6 +99,7 @@ namespace Microsoft::Console::VirtualTerminal
         void _ActionExecuteFromEscape(const wchar_t wch);
         void _ActionPrint(const wchar_t wch);
         void _ActionPrintString(const std::wstring_view string);
+        void _ActionPrintLines(const std::wstring_view string);
         void _ActionEscDispatch(const wchar_t wch);
         void _ActionVt52EscDispatch(const wchar_t wch);
         void _ActionCollect(const wchar_t wch) noexcept;
@@ -154,6 +156,7 @@ namespace Microsoft::Console::VirtualTerminal
         void _EventDcsIntermediate(const wchar_t wch);
         void _EventDcsParam(const wchar_t wch);
         void _EventDcsPassThrough(const wchar_t wch);
+        size_t _EventDcsPassThroughString(const std::wstring_view string);
         void _EventSosPmApcString(const wchar_t wch) noexcept;
 
         void _AccumulateTo(const wchar_t wch, VTInt& value) noexcept;
@@ -229,6 +232,19 @@ namespace Microsoft::Console::VirtualTerminal
         //   can start and finish a sequence.
         bool _processingLastCharacter;
 
+        // State for GetLineFeedsAhead(). It caches how many line feeds were found in the
+        // range [begin, end) of _currentString, so that calling it for each line of the
+        // same string doesn't turn into a quadratic amount of work.
+        struct LineFeedLookahead
+        {
+            size_t begin = 0;
+            size_t end = 0;
+            size_t lineFeeds = 0;
+            bool blocked = false;
+        };
+        LineFeedLookahead _lineFeedLookahead;
+        bool _printingRun = false;
+
         std::function<void()> _onCsiCompleteCallback;
     };
 }
@@ -33,11 +33,13 @@ public:
         printed.clear();
         passedThrough.clear();
         executed.clear();
+        printedLines.clear();
         csiId = 0;
         csiParams.clear();
         dcsId = 0;
         dcsParams.clear();
         dcsDataString.clear();
+        dcsDataRuns.clear();
     }
 
     bool EncounteredWin32InputModeSequence() const noexcept override
@@ -59,6 +61,23 @@ public:
         return true;
     };
 
+    bool ActionPrintLines(const std::wstring_view string) override
+    {
+        printedLines.emplace_back(string);
+        for (const auto wch : string)
+        {
+            if (wch == L'\r' || wch == L'\n')
+            {
+                executed += wch;
+            }
+            else
+            {
+                printed += wch;
+            }
+        }
+        return true;
+    };
+
     bool ActionPassThroughString(const std::wstring_view string) override
     {
         passedThrough += string;
@@ -109,7 +128,12 @@ public:
             dcsParams.push_back(parameters.at(i).value_or(0));
         }
         dcsDataString.clear();
-        return [=](const auto ch) { dcsDataString += ch; return true; };
+        dcsDataRuns.clear();
+        return [=](const auto str) {
+            dcsDataString += str;
+            dcsDataRuns.emplace_back(str);
+            return true;
+        };
     }
 
     // These will only be populated if ActionCsiDispatch is called.
@@ -128,10 +152,14 @@ public:
     // Executed string.
     std::wstring executed;
 
+    // Batches of lines passed to ActionPrintLines.
+    std::vector<std::wstring> printedLines;
+
     // These will only be populated if ActionDcsDispatch is called.
     uint64_t dcsId = 0;
     std::vector<size_t> dcsParams;
     std::wstring dcsDataString;
+    std::vector<std::wstring> dcsDataRuns;
 };
 
 class Microsoft::Console::VirtualTerminal::StateMachineTest
@@ -153,9 +181,11 @@ class Microsoft::Console::VirtualTerminal::StateMachineTest
     TEST_METHOD(PassThroughUnhandled);
     TEST_METHOD(RunStorageBeforeEscape);
     TEST_METHOD(BulkTextPrint);
+    TEST_METHOD(BulkLinePrint);
     TEST_METHOD(PassThroughUnhandledSplitAcrossWrites);
 
     TEST_METHOD(DcsDataStringsReceivedByHandler);
+    TEST_METHOD(DcsDataStringsReceivedInBulk);
 
     TEST_METHOD(VtParameterSubspanTest);
 };
@@ -230,6 +260,24 @@ void StateMachineTest::BulkTextPrint()
     VERIFY_ARE_EQUAL(String(L"12345 Hello World"), String(engine.printed.c_str()));
 }
 
+void StateMachineTest::BulkLinePrint()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // Lines of text separated by CR, LF and CRLF should be passed on as a whole, up to the
+    // last line break before the escape sequence. The text before it is printed by itself.
+    machine.ProcessString(L"one\r\ntwo\nthree\rfour\x1b[mfive\r\nsix");
+
+    VERIFY_ARE_EQUAL(2u, engine.printedLines.size());
+    VERIFY_ARE_EQUAL(String(L"one\r\ntwo\nthree\r"), String(engine.printedLines.at(0).c_str()));
+    VERIFY_ARE_EQUAL(String(L"five\r\n"), String(engine.printedLines.at(1).c_str()));
+    VERIFY_ARE_EQUAL(String(L"onetwothreefourfivesix"), String(engine.printed.c_str()));
+    VERIFY_ARE_EQUAL(String(L"\r\n\n\r\r\n"), String(engine.executed.c_str()));
+}
+
 void StateMachineTest::PassThroughUnhandledSplitAcrossWrites()
 {
     auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
@@ -339,6 +387,26 @@ void StateMachineTest::DcsDataStringsReceivedByHandler()
     VERIFY_ARE_EQUAL(expectedExecuted, engine.executed);
 }
 
+void StateMachineTest::DcsDataStringsReceivedInBulk()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // The DEL is ignored, which splits the first write into two runs.
+    // C0 controls other than ESC, CAN, and SUB are part of the data string.
+    machine.ProcessString(L"\033P1;2;3|data\rstring\x7fmore");
+    machine.ProcessString(L"text\033\\");
+
+    VERIFY_ARE_EQUAL(L"data\rstringmoretext\033", engine.dcsDataString);
+    VERIFY_ARE_EQUAL(static_cast<size_t>(4), engine.dcsDataRuns.size());
+    VERIFY_ARE_EQUAL(L"data\rstring", engine.dcsDataRuns.at(0));
+    VERIFY_ARE_EQUAL(L"more", engine.dcsDataRuns.at(1));
+    VERIFY_ARE_EQUAL(L"text", engine.dcsDataRuns.at(2));
+    VERIFY_ARE_EQUAL(L"\033", engine.dcsDataRuns.at(3));
+}
+
 void StateMachineTest::VtParameterSubspanTest()
 {
     const auto parameterList = std::vector<VTParameter>{ 12, 34, 56, 78 };
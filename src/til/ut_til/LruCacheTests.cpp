@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include <til/lru_cache.h>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class LruCacheTests
+{
+    TEST_CLASS(LruCacheTests);
+
+    TEST_METHOD(Basic)
+    {
+        til::lru_cache<std::wstring, int> cache{ 2 };
+        VERIFY_ARE_EQUAL(2u, cache.capacity());
+
+        VERIFY_IS_NULL(cache.find(L"a"));
+        cache.insert_or_assign(L"a", 1);
+        cache.insert_or_assign(L"b", 2);
+        VERIFY_ARE_EQUAL(2u, cache.size());
+
+        const auto a = cache.find(L"a");
+        VERIFY_IS_NOT_NULL(a);
+        VERIFY_ARE_EQUAL(1, *a);
+
+        // Assigning to an existing key must not grow the cache.
+        cache.insert_or_assign(L"a", 3);
+        VERIFY_ARE_EQUAL(2u, cache.size());
+        VERIFY_ARE_EQUAL(3, *cache.find(L"a"));
+
+        VERIFY_ARE_EQUAL(2u, cache.hits());
+        VERIFY_ARE_EQUAL(1u, cache.misses());
+
+        cache.clear();
+        VERIFY_ARE_EQUAL(0u, cache.size());
+        VERIFY_IS_NULL(cache.find(L"a"));
+    }
+
+    TEST_METHOD(EvictsLeastRecentlyUsed)
+    {
+        til::lru_cache<int, int> cache{ 3 };
+        cache.insert_or_assign(1, 1);
+        cache.insert_or_assign(2, 2);
+        cache.insert_or_assign(3, 3);
+
+        // Using 1 makes 2 the least recently used entry...
+        VERIFY_IS_NOT_NULL(cache.find(1));
+        cache.insert_or_assign(4, 4);
+        VERIFY_IS_NULL(cache.find(2));
+
+        // ...and assigning to 3 makes 1 the least recently used one.
+        cache.insert_or_assign(3, 5);
+        cache.insert_or_assign(6, 6);
+        VERIFY_IS_NULL(cache.find(1));
+
+        VERIFY_ARE_EQUAL(3u, cache.size());
+        VERIFY_ARE_EQUAL(5, *cache.find(3));
+        VERIFY_ARE_EQUAL(4, *cache.find(4));
+        VERIFY_ARE_EQUAL(6, *cache.find(6));
+    }
+};
@@ -0,0 +1,75 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include <til/parallel.h>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class ParallelTests
+{
+    TEST_CLASS(ParallelTests);
+
+    TEST_METHOD(ChunkCount)
+    {
+        const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+
+        VERIFY_ARE_EQUAL(1u, til::parallel_chunk_count(0, 1024));
+        VERIFY_ARE_EQUAL(1u, til::parallel_chunk_count(2047, 1024));
+        VERIFY_ARE_EQUAL(std::min<size_t>(2, cores), til::parallel_chunk_count(2048, 1024));
+        VERIFY_ARE_EQUAL(cores, til::parallel_chunk_count(SIZE_MAX, 1));
+        VERIFY_ARE_EQUAL(1u, til::parallel_chunk_count(1, 0));
+    }
+
+    TEST_METHOD(CallsEachIndexOnce)
+    {
+        static constexpr size_t count = 8;
+        const auto caller = std::this_thread::get_id();
+        std::array<std::atomic<int>, count> calls{};
+        std::array<std::thread::id, count> threads{};
+
+        til::parallel_for(count, [&](const size_t i) {
+            calls[i].fetch_add(1, std::memory_order_relaxed);
+            threads[i] = std::this_thread::get_id();
+        });
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            VERIFY_ARE_EQUAL(1, calls[i].load());
+        }
+        VERIFY_IS_TRUE(threads[0] == caller);
+
+        // Nothing to do must not call func at all.
+        til::parallel_for(0, [&](size_t) {
+            VERIFY_FAIL(L"func called for an empty range");
+        });
+    }
+
+    TEST_METHOD(RethrowsLowestIndexAfterJoining)
+    {
+        static constexpr size_t count = 4;
+        std::atomic<size_t> finished{ 0 };
+
+        try
+        {
+            til::parallel_for(count, [&](const size_t i) {
+                finished.fetch_add(1, std::memory_order_relaxed);
+                if (i >= 1)
+                {
+                    throw std::runtime_error{ std::to_string(i) };
+                }
+            });
+            VERIFY_FAIL(L"parallel_for didn't throw");
+        }
+        catch (const std::runtime_error& e)
+        {
+            VERIFY_ARE_EQUAL(std::string_view{ "1" }, std::string_view{ e.what() });
+        }
+
+        // All calls must have returned before the exception is rethrown.
+        VERIFY_ARE_EQUAL(count, finished.load());
+    }
+};
@@ -429,6 +429,205 @@ class RunLengthEncodingTests
         }
     }
 
+    TEST_METHOD(ReplaceRanges)
+    {
+        using edit_type = rle_vector::edit_type;
+
+        struct TestCase
+        {
+            std::string_view source;
+            std::vector<edit_type> edits;
+            std::string_view expected;
+        };
+
+        const std::array<TestCase, 7> test_cases{
+            {
+                // no edits
+                { "1|3 3|2|1 1 1|5 5", {}, "1|3 3|2|1 1 1|5 5" },
+                // separate edits
+                { "1|3 3|2|1 1 1|5 5", { { 0, 1, 2 }, { 3, 4, 2 } }, "2|3 3|2|1 1 1|5 5" },
+                // join with predecessor/successor runs
+                { "1|3 3|2|1 1 1|5 5", { { 1, 3, 1 }, { 4, 7, 2 } }, "1 1 1|2 2 2 2|5 5" },
+                // adjacent edits
+                { "1|3 3|2|1 1 1|5 5", { { 2, 4, 6 }, { 4, 6, 6 } }, "1|3|6 6 6 6|1|5 5" },
+                // end_index past the end
+                { "1|3 3|2|1 1 1|5 5", { { 7, 20, 1 } }, "1|3 3|2|1 1 1 1 1" },
+                // all
+                { "1|3 3|2|1 1 1|5 5", { { 0, 9, 4 } }, "4 4 4 4 4 4 4 4 4" },
+                // empty edits
+                { "1|3 3|2|1 1 1|5 5", { { 0, 0, 4 }, { 5, 5, 4 } }, "1|3 3|2|1 1 1|5 5" },
+            }
+        };
+
+        auto idx = 0;
+
+        for (const auto& test_case : test_cases)
+        {
+            rle_vector rle{ rle_encode(test_case.source) };
+            rle.replace_ranges(test_case.edits);
+
+            VERIFY_ARE_EQUAL(
+                test_case.expected,
+                rle,
+                NoThrowString().Format(
+                    L"test case: %d\nsource:    %hs\nexpected:  %hs\nactual:    %s",
+                    idx,
+                    test_case.source.data(),
+                    test_case.expected.data(),
+                    rle.to_string().c_str()));
+            ++idx;
+        }
+
+        // Overlapping edits are rejected and leave the vector unchanged.
+        {
+            rle_vector rle{ rle_encode("1|3 3|2|1 1 1|5 5") };
+            const std::array<edit_type, 2> edits{ { { 2, 5, 2 }, { 4, 6, 3 } } };
+            VERIFY_THROWS(rle.replace_ranges(edits), std::out_of_range);
+            VERIFY_ARE_EQUAL("1|3 3|2|1 1 1|5 5"sv, rle);
+        }
+    }
+
+    TEST_METHOD(Transform)
+    {
+        struct TestCase
+        {
+            std::string_view source;
+
+            size_type start_index;
+            size_type end_index;
+            // Maps each digit to its new value.
+            std::string_view mapping;
+
+            std::string_view expected;
+            size_t expected_calls;
+        };
+
+        std::array<TestCase, 5> test_cases{
+            {
+                // all
+                { "1|3 3|2|1 1 1|5 5", 0, 9, "0323456789", "3 3 3|2|3 3 3|5 5", 5 },
+                // within runs
+                { "1|3 3|2|1 1 1|5 5", 2, 5, "2222222222", "1|3|2 2 2|1 1|5 5", 3 },
+                // join with predecessor/successor runs
+                { "1|3 3|2|1 1 1|5 5", 1, 3, "1111111111", "1 1 1|2|1 1 1|5 5", 1 },
+                // end_index past the end
+                { "1|3 3|2|1 1 1|5 5", 5, 20, "5555555555", "1|3 3|2|1|5 5 5 5", 2 },
+                // empty range
+                { "1|3 3|2|1 1 1|5 5", 4, 4, "5555555555", "1|3 3|2|1 1 1|5 5", 0 },
+            }
+        };
+
+        auto idx = 0;
+
+        for (const auto& test_case : test_cases)
+        {
+            rle_vector rle{ rle_encode(test_case.source) };
+            size_t calls = 0;
+
+            rle.transform(test_case.start_index, test_case.end_index, [&](const value_type value) {
+                ++calls;
+                return static_cast<value_type>(test_case.mapping.at(value) - '0');
+            });
+
+            VERIFY_ARE_EQUAL(
+                test_case.expected,
+                rle,
+                NoThrowString().Format(
+                    L"test case:   %d\nsource:      %hs\nstart_index: %u\nend_index:   %u\nexpected:    %hs\nactual:      %s",
+                    idx,
+                    test_case.source.data(),
+                    test_case.start_index,
+                    test_case.end_index,
+                    test_case.expected.data(),
+                    rle.to_string().c_str()));
+            VERIFY_ARE_EQUAL(test_case.expected_calls, calls);
+            ++idx;
+        }
+    }
+
+    // Compares DECCARA-style per-cell attribute changes with transform().
+    TEST_METHOD(TransformBenchmark)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"Ignore", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        static constexpr size_type width = 200;
+        static constexpr size_t height = 10000;
+
+        std::vector<rle_vector> perCell(height, rle_vector(width, 0));
+        for (auto& rle : perCell)
+        {
+            for (size_type x = 0; x < width; x += 7)
+            {
+                rle.replace(x, x + 3, static_cast<value_type>(x % 5 + 1));
+            }
+        }
+        auto perRow = perCell;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        for (auto& rle : perCell)
+        {
+            for (size_type x = 0; x < width; ++x)
+            {
+                rle.replace(x, x + 1, static_cast<value_type>(rle.at(x) ^ 8));
+            }
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        for (auto& rle : perRow)
+        {
+            rle.transform(0, width, [](const value_type value) { return static_cast<value_type>(value ^ 8); });
+        }
+        const auto t2 = std::chrono::steady_clock::now();
+
+        VERIFY_IS_TRUE(perCell == perRow);
+        Log::Comment(NoThrowString().Format(
+            L"per cell: %lldus, transform: %lldus",
+            std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count(),
+            std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()));
+    }
+
+    // Compares applying many small edits per row (like syntax-highlighted output) with replace_ranges().
+    TEST_METHOD(ReplaceRangesBenchmark)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"Ignore", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        static constexpr size_type width = 200;
+        static constexpr size_t height = 10000;
+
+        std::vector<rle_vector::edit_type> edits;
+        for (size_type x = 0; x < width; x += 3)
+        {
+            edits.push_back({ x, static_cast<size_type>(x + 2), static_cast<value_type>(x % 11 + 1) });
+        }
+
+        std::vector<rle_vector> sequential(height, rle_vector(width, 0));
+        auto batched = sequential;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        for (auto& rle : sequential)
+        {
+            for (const auto& edit : edits)
+            {
+                rle.replace(edit.start_index, edit.end_index, edit.value);
+            }
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+        for (auto& rle : batched)
+        {
+            rle.replace_ranges(edits);
+        }
+        const auto t2 = std::chrono::steady_clock::now();
+
+        VERIFY_IS_TRUE(sequential == batched);
+        Log::Comment(NoThrowString().Format(
+            L"replace: %lldus, replace_ranges: %lldus",
+            std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count(),
+            std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()));
+    }
+
     TEST_METHOD(ResizeTrailingExtent)
     {
         constexpr std::string_view data{ "133211155" };
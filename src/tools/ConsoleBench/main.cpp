@@ -33,6 +33,9 @@ struct BenchmarkContext
     std::string_view utf8_128Ki;
     std::wstring_view utf16_4Ki;
     std::wstring_view utf16_128Ki;
+    std::wstring_view utf16_cjk_128Ki;
+    std::wstring_view sixel_800x600;
+    std::wstring_view log_lines_1Ki;
     std::span<WORD> attr_4Ki;
     std::span<CHAR_INFO> char_4Ki;
     std::span<INPUT_RECORD> input_4Ki;
@@ -48,6 +51,8 @@ struct Benchmark
 {
     const char* title;
     void (*exec)(BenchmarkContext& ctx);
+    // How many items (frames, lines, ...) each measurement covers. Used to print the items per second.
+    size_t items_per_measurement = 1;
 };
 
 struct AccumulatedResults
@@ -111,6 +116,43 @@ static constexpr Benchmark s_benchmarks[] = {
             }
         },
     },
+    Benchmark{
+        .title = "WriteConsoleW CJK 128Ki",
+        .exec = [](BenchmarkContext& ctx) {
+            while (ctx.wants_more())
+            {
+                ctx.mark_beg();
+                const auto res = WriteConsoleW(ctx.output, ctx.utf16_cjk_128Ki.data(), static_cast<DWORD>(ctx.utf16_cjk_128Ki.size()), nullptr, nullptr);
+                ctx.mark_end();
+                debugAssert(res == TRUE);
+            }
+        },
+    },
+    Benchmark{
+        .title = "WriteConsoleW Sixel 800x600",
+        .exec = [](BenchmarkContext& ctx) {
+            while (ctx.wants_more())
+            {
+                ctx.mark_beg();
+                const auto res = WriteConsoleW(ctx.output, ctx.sixel_800x600.data(), static_cast<DWORD>(ctx.sixel_800x600.size()), nullptr, nullptr);
+                ctx.mark_end();
+                debugAssert(res == TRUE);
+            }
+        },
+    },
+    Benchmark{
+        .title = "WriteConsoleW Log 1Ki lines",
+        .exec = [](BenchmarkContext& ctx) {
+            while (ctx.wants_more())
+            {
+                ctx.mark_beg();
+                const auto res = WriteConsoleW(ctx.output, ctx.log_lines_1Ki.data(), static_cast<DWORD>(ctx.log_lines_1Ki.size()), nullptr, nullptr);
+                ctx.mark_end();
+                debugAssert(res == TRUE);
+            }
+        },
+        .items_per_measurement = 1024,
+    },
     Benchmark{
         .title = "WriteConsoleOutputAttribute 4Ki",
         .exec = [](BenchmarkContext& ctx) {
@@ -404,6 +446,75 @@ static constexpr Benchmark s_benchmarks[] = {
             }
         },
     },
+    Benchmark{
+        .title = "ReadConsoleW type into 100Ki line",
+        .exec = [](BenchmarkContext& ctx) {
+            static constexpr DWORD line_length = 100 * 1024;
+            static constexpr DWORD cap = 2 * line_length;
+
+            struct ReaderState
+            {
+                HANDLE input;
+                wchar_t* buf;
+                DWORD read;
+            };
+
+            const auto scratch = mem::get_scratch_arena(ctx.arena);
+            const auto line = scratch.arena.push_uninitialized<INPUT_RECORD>(line_length);
+            auto key = ctx.input_4Ki[0];
+            key.Event.KeyEvent.uChar.UnicodeChar = L'x';
+            std::fill_n(line, line_length, key);
+
+            ReaderState state{
+                .input = ctx.input,
+                .buf = scratch.arena.push_uninitialized<wchar_t>(cap),
+            };
+            DWORD written, mode;
+
+            FlushConsoleInputBuffer(ctx.input);
+            GetConsoleMode(ctx.input, &mode);
+            SetConsoleMode(ctx.input, mode | ENABLE_LINE_INPUT);
+
+            // The cooked read happens on a background thread, while we measure how long it takes
+            // for each keystroke we write to get processed and echoed into the edit line.
+            // Pre-fill the line with text before the read starts, so that it gets consumed in one go.
+            WriteConsoleInputW(ctx.input, line, line_length, &written);
+            const auto reader = CreateThread(
+                nullptr,
+                0,
+                [](void* param) -> DWORD {
+                    const auto state = static_cast<ReaderState*>(param);
+                    ReadConsoleW(state->input, state->buf, cap, &state->read, nullptr);
+                    return 0;
+                },
+                &state,
+                0,
+                nullptr);
+
+            for (DWORD pending = 1; pending != 0;)
+            {
+                Sleep(1);
+                GetNumberOfConsoleInputEvents(ctx.input, &pending);
+            }
+
+            while (ctx.wants_more())
+            {
+                ctx.mark_beg();
+                WriteConsoleInputW(ctx.input, &key, 1, &written);
+                ctx.mark_end();
+                debugAssert(written == 1);
+            }
+
+            auto enter = ctx.input_4Ki[0];
+            enter.Event.KeyEvent.wVirtualKeyCode = VK_RETURN;
+            enter.Event.KeyEvent.uChar.UnicodeChar = L'\r';
+            WriteConsoleInputW(ctx.input, &enter, 1, &written);
+
+            WaitForSingleObject(reader, INFINITE);
+            CloseHandle(reader);
+            SetConsoleMode(ctx.input, mode);
+        },
+    },
 #endif
 #if ENABLE_TEST_CLIPBOARD
     Benchmark{
@@ -448,6 +559,8 @@ static constexpr size_t s_samples_max = 1000;
 static constexpr std::string_view s_payload_utf8{ "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna alΑΒΓΔΕ" };
 // 128 characters and 128 columns.
 static constexpr std::wstring_view s_payload_utf16{ L"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.ΑΒΓΔΕ" };
+// 72 characters and 144 columns.
+static constexpr std::wstring_view s_payload_utf16_cjk{ L"中华人民共和国国务院总理在北京人民大会堂会见了来访的外国代表团成员，双方就进一步加强两国在经济贸易科技文化教育等领域的交流与合作深入交换了意见。" };
 
 static constexpr WORD s_payload_attr = FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED;
 static constexpr CHAR_INFO s_payload_char{
@@ -656,6 +769,90 @@ static void prepare_conhost(BenchmarkContext& ctx, HWND parent_hwnd)
     WriteFile(ctx.output, buf, s_buffer_size.Y, nullptr, nullptr);
 }
 
+// Generates a single 800x600 frame with 16 colors, modelled after the output of dithering
+// encoders like libsixel (as used by mpv --vo=sixel): Each color covers a part of every
+// band, mostly with plain sixel values, but also with the occasional repeat introducer.
+static std::wstring_view generate_sixel_frame(mem::Arena& arena)
+{
+    static constexpr int bands = 600 / 6;
+    static constexpr int colors = 16;
+    static constexpr int span = 192;
+    static constexpr int spacing = (800 - span) / (colors - 1);
+
+    const auto scratch = mem::get_scratch_arena(arena);
+    const auto buf = arena.push_uninitialized<wchar_t>(512 * 1024);
+    size_t len = 0;
+    const auto append = [&](std::wstring_view str) {
+        mem::copy(buf + len, str.data(), str.size());
+        len += str.size();
+    };
+
+    // Move the cursor home first, so that every frame is drawn at the same position.
+    append(L"\x1b[H\x1bP0;1q\"1;1;800;600");
+    for (int c = 0; c < colors; ++c)
+    {
+        append(mem::format(scratch.arena, L"#%d;2;%d;%d;%d", c, c * 37 % 101, c * 59 % 101, c * 83 % 101));
+    }
+
+    for (int band = 0; band < bands; ++band)
+    {
+        for (int c = 0; c < colors; ++c)
+        {
+            append(mem::format(scratch.arena, L"#%d", c));
+            if (const auto skip = c * spacing)
+            {
+                append(mem::format(scratch.arena, L"!%d?", skip));
+            }
+
+            for (int x = 0; x < span;)
+            {
+                const auto value = static_cast<wchar_t>(L'?' + ((x * 7 + band * 3 + c * 11) ^ (x >> 2)) % 64);
+                // Every other block of 16 pixels is solid, like the flat areas of an image.
+                if ((x / 16 + band + c) % 2 == 0)
+                {
+                    append(mem::format(scratch.arena, L"!16%c", value));
+                    x += 16;
+                }
+                else
+                {
+                    buf[len++] = value;
+                    x += 1;
+                }
+            }
+
+            append(L"$");
+        }
+        if (band + 1 < bands)
+        {
+            append(L"-");
+        }
+    }
+
+    append(L"\x1b\\");
+    return { buf, len };
+}
+
+// Generates 1024 short CRLF-terminated lines without any escape sequences, like the output of a build or
+// a server log. Unlike the other payloads, most of the time is spent on line breaks and not on the text.
+static std::wstring_view generate_log_lines(mem::Arena& arena)
+{
+    static constexpr int lines = 1024;
+    static constexpr std::wstring_view levels[]{ L"INFO", L"DEBUG", L"WARN", L"INFO" };
+
+    const auto scratch = mem::get_scratch_arena(arena);
+    const auto buf = arena.push_uninitialized<wchar_t>(lines * 96);
+    size_t len = 0;
+
+    for (int i = 0; i < lines; ++i)
+    {
+        const auto line = mem::format(scratch.arena, L"12:%02d:%02d.%03d %ls [worker-%d] request %d completed in %dms\r\n", i / 60 % 60, i % 60, i * 37 % 1000, levels[i % 4].data(), i % 8, 10000 + i, i * 13 % 250);
+        mem::copy(buf + len, line.data(), line.size());
+        len += line.size();
+    }
+
+    return { buf, len };
+}
+
 static std::span<Measurements> run_benchmarks_for_path(mem::Arena& arena, const wchar_t* path)
 {
     const auto scratch = mem::get_scratch_arena(arena);
@@ -682,6 +879,9 @@ static std::span<Measurements> run_benchmarks_for_path(mem::Arena& arena, const
         .utf8_128Ki = mem::repeat(scratch.arena, s_payload_utf8, 128 * 1024 / s_payload_utf8.size()),
         .utf16_4Ki = mem::repeat(scratch.arena, s_payload_utf16, 4 * 1024 / s_payload_utf16.size()),
         .utf16_128Ki = mem::repeat(scratch.arena, s_payload_utf16, 128 * 1024 / s_payload_utf16.size()),
+        .utf16_cjk_128Ki = mem::repeat(scratch.arena, s_payload_utf16_cjk, 128 * 1024 / s_payload_utf16_cjk.size()),
+        .sixel_800x600 = generate_sixel_frame(scratch.arena),
+        .log_lines_1Ki = generate_log_lines(scratch.arena),
         .attr_4Ki = mem::repeat(scratch.arena, s_payload_attr, 4 * 1024),
         .char_4Ki = mem::repeat(scratch.arena, s_payload_char, 4 * 1024),
         .input_4Ki = mem::repeat(scratch.arena, s_payload_record, 4 * 1024),
@@ -727,7 +927,14 @@ static std::span<Measurements> run_benchmarks_for_path(mem::Arena& arena, const
         }
         results[bench_idx] = measurements;
 
-        print_with_parent_connection(", done\r\n");
+        // For benchmarks like the sixel one, this is the number of frames per second. For the log one, it's lines.
+        int64_t total_ticks = 0;
+        for (size_t i = 0; i < ctx.m_measurements_off; ++i)
+        {
+            total_ticks += ctx.m_measurements[i];
+        }
+        const auto per_second = static_cast<double>(ctx.m_measurements_off * bench.items_per_measurement) * freq / std::max<int64_t>(total_ticks, 1);
+        print_with_parent_connection(", done (%.1f/s)\r\n", per_second);
     }
 
     set_active_connection(parent_connection);
@@ -767,6 +767,76 @@ constexpr const wchar_t* resetIfOutOfRange(const wchar_t* beg, const wchar_t* en
     return ret;
 }
 
+// Complex grapheme clusters (emoji ZWJ sequences, flags, Indic conjuncts, etc.) consist of multiple codepoints and
+// are comparatively expensive to segment. Since the same ones tend to get written over and over again, the Graphemes
+// mode memoizes them in a small set-associative cache, indexed by their first 2 codepoints. Entries are matched as a
+// prefix of the input and store the parser state after their last codepoint, so that a longer cluster
+// (e.g. a family emoji with an additional member) can resume parsing from there.
+//
+// The results of the Graphemes mode don't depend on the mutable state of a CodepointWidthDetector, which allows us to use
+// a thread_local cache. This makes it thread-safe without any locking, which would cost more than it saves.
+struct ClusterCacheEntry
+{
+    wchar_t chars[14];
+    // 0 marks an empty entry.
+    uint8_t len;
+    // Clamped to <= 2, which is fine because widths only ever grow as a cluster gets longer.
+    uint8_t width;
+    uint8_t state;
+    uint8_t lead;
+};
+struct ClusterCacheSet
+{
+    ClusterCacheEntry ways[4];
+    uint8_t next;
+};
+static constexpr size_t s_clusterCacheSets = 64;
+static thread_local ClusterCacheSet s_clusterCache[s_clusterCacheSets];
+
+static ClusterCacheSet& clusterCacheSet(const char32_t cp0, const char32_t cp1) noexcept
+{
+    // The upper bits of a multiplicative hash are the best mixed ones.
+    const uint32_t h = (cp0 * 0x9E3779B1u) ^ (cp1 * 0x85EBCA77u);
+    return s_clusterCache[((h * 0x9E3779B1u) >> 16) & (s_clusterCacheSets - 1)];
+}
+
+// Finds the longest cached cluster that the string [it, end) starts with.
+static bool clusterCacheLookup(const wchar_t* it, const wchar_t* end, const char32_t cp0, const char32_t cp1, ClusterCacheEntry& out) noexcept
+{
+    const auto& set = clusterCacheSet(cp0, cp1);
+    const auto available = static_cast<size_t>(end - it);
+    size_t bestLen = 0;
+
+    for (const auto& entry : set.ways)
+    {
+        if (entry.len > bestLen && entry.len <= available && memcmp(&entry.chars[0], it, entry.len * sizeof(wchar_t)) == 0)
+        {
+            out = entry;
+            bestLen = entry.len;
+        }
+    }
+
+    return bestLen != 0;
+}
+
+static void clusterCacheInsert(const wchar_t* beg, const wchar_t* end, const char32_t cp0, const char32_t cp1, const int width, const int state, const int lead) noexcept
+{
+    const auto len = static_cast<size_t>(end - beg);
+    if (len > std::size(ClusterCacheEntry{}.chars))
+    {
+        return;
+    }
+
+    // The ways of a set are replaced round-robin, which is close enough to LRU for our purposes.
+    auto& set = clusterCacheSet(cp0, cp1);
+    auto& entry = set.ways[set.next++ % std::size(set.ways)];
+    memcpy(&entry.chars[0], beg, len * sizeof(wchar_t));
+    entry.len = static_cast<uint8_t>(len);
+    entry.width = static_cast<uint8_t>(width > 2 ? 2 : width);
+    entry.state = static_cast<uint8_t>(state);
+    entry.lead = static_cast<uint8_t>(lead);
+}
+
 static CodepointWidthDetector s_codepointWidthDetector;
 
 CodepointWidthDetector& CodepointWidthDetector::Singleton() noexcept
@@ -800,6 +870,147 @@ bool CodepointWidthDetector::GraphemePrev(GraphemeState& s, const std::wstring_v
     return _graphemePrevConsole(s, str);
 }
 
+size_t CodepointWidthDetector::GraphemeSegment(const std::wstring_view& str, const std::span<size_t> ends, const std::span<uint8_t> widths) noexcept
+{
+    const auto capacity = ends.size() < widths.size() ? ends.size() : widths.size();
+    const auto beg = str.data();
+    const auto end = beg + str.size();
+    auto it = beg;
+    size_t count = 0;
+
+    if (_mode != TextMeasurementMode::Graphemes)
+    {
+        // The other modes are rarely used and not worth optimizing.
+        GraphemeState s{ .beg = beg };
+        while (it < end && count < capacity)
+        {
+            GraphemeNext(s, str);
+            it = s.beg + s.len;
+            ends[count] = static_cast<size_t>(it - beg);
+            widths[count] = static_cast<uint8_t>(s.width);
+            ++count;
+        }
+        return count;
+    }
+
+    while (it < end && count < capacity)
+    {
+        // CJK text mostly consists of ideographs from the U+4E00-U+9FFF block. All of them are wide, they're all
+        // assigned, and they're all of grapheme break property "Other". Since two "Other" characters never join,
+        // we can skip the trie lookups for the 7 leading characters of any vector that consists only of them.
+        // The 8th character needs to be checked against its successor (e.g. a combining mark) the regular way.
+#if defined(TIL_SSE_INTRINSICS)
+        while (end - it >= 8 && capacity - count >= 7)
+        {
+            const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            // Same as "(wch - 0x4E00) <= 0x51FF" for unsigned numbers. SSE2 lacks unsigned comparisons,
+            // but "max(0, a - b) == 0" is equivalent to "a <= b" and "max(0, a - b)" is what "SubS" is.
+            const auto off = _mm_sub_epi16(wch, _mm_set1_epi16(0x4E00));
+            const auto gt = _mm_subs_epu16(off, _mm_set1_epi16(0x9FFF - 0x4E00));
+            const auto ok = _mm_cmpeq_epi16(gt, _mm_setzero_si128());
+            if (_mm_movemask_epi8(ok) != 0xffff)
+            {
+                break;
+            }
+
+            for (int i = 0; i < 7; ++i)
+            {
+                ++it;
+                ends[count] = static_cast<size_t>(it - beg);
+                widths[count] = 2;
+                ++count;
+            }
+        }
+
+        if (it >= end || count >= capacity)
+        {
+            break;
+        }
+#endif
+
+        int width;
+        it = _graphemeSegmentOne(it, end, width);
+        ends[count] = static_cast<size_t>(it - beg);
+        widths[count] = static_cast<uint8_t>(width);
+        ++count;
+    }
+
+    return count;
+}
+
+// A stateless variant of _graphemeNext() used by GraphemeSegment(). Parses the grapheme cluster
+// starting at `it` and returns its end. Assumes `it < end`. Updates `width` with the cluster width.
+const wchar_t* CodepointWidthDetector::_graphemeSegmentOne(const wchar_t* it, const wchar_t* end, int& width) const noexcept
+{
+    const auto codepointWidth = [this](const int val, const char32_t cp) noexcept {
+        auto w = ucdToCharacterWidth(val);
+        if (w == 3)
+        {
+            w = _ambiguousWidth;
+        }
+        // See _graphemeNext() for why U+FE0F is wide.
+        if (cp == 0xFE0F)
+        {
+            w = 2;
+        }
+        return w;
+    };
+
+    const auto clusterBeg = it;
+    char32_t cp0;
+    char32_t cp1 = 0;
+    it = utf16NextOrFFFD(it, end, cp0);
+    auto lead = ucdLookup(cp0);
+    auto state = 0;
+    auto total = codepointWidth(lead, cp0);
+    auto consulted = false;
+    const wchar_t* cachedEnd = nullptr;
+
+    while (it < end)
+    {
+        char32_t cp;
+        const auto next = utf16NextOrFFFD(it, end, cp);
+        const auto trail = ucdLookup(cp);
+
+        const auto joined = ucdGraphemeJoins(state, lead, trail);
+        if (ucdGraphemeDone(joined))
+        {
+            break;
+        }
+
+        // This is the first time we know that the cluster consists of more than 1 codepoint.
+        if (!consulted)
+        {
+            consulted = true;
+            cp1 = cp;
+
+            ClusterCacheEntry entry;
+            if (clusterCacheLookup(clusterBeg, end, cp0, cp1, entry))
+            {
+                it = clusterBeg + entry.len;
+                cachedEnd = it;
+                total = entry.width;
+                state = entry.state;
+                lead = entry.lead;
+                continue;
+            }
+        }
+
+        state = joined;
+        it = next;
+        lead = trail;
+        total += codepointWidth(lead, cp);
+    }
+
+    if (consulted && it != cachedEnd)
+    {
+        clusterCacheInsert(clusterBeg, it, cp0, cp1, total, state, lead);
+    }
+
+    width = total > 2 ? 2 : total;
+    return it;
+}
+
 // Parses the next grapheme cluster from the given string. The algorithm largely follows "UAX #29: Unicode Text Segmentation",
 // but takes some mild liberties. Returns false if the end of the string was reached. Updates `s` with the cluster.
 bool CodepointWidthDetector::_graphemeNext(GraphemeState& s, const std::wstring_view& str) const noexcept
@@ -827,6 +1038,12 @@ bool CodepointWidthDetector::_graphemeNext(GraphemeState& s, const std::wstring_
         // Thus, we're storing `s._state` bit-flipped so that we can differentiate between it being unset (0) and
         // storing a previous state of 0 (0xffff...).
         const auto gotState = state != 0;
+        // The cluster cache is only consulted at the start of a cluster, once we know it has at least 2 codepoints.
+        auto consulted = gotState;
+        const wchar_t* cachedEnd = nullptr;
+        char32_t cp0 = 0;
+        char32_t cp1 = 0;
+
         state = ~state;
         if (gotState)
         {
@@ -834,6 +1051,7 @@ bool CodepointWidthDetector::_graphemeNext(GraphemeState& s, const std::wstring_
         }
 
         clusterEnd = utf16NextOrFFFD(clusterEnd, end, cp);
+        cp0 = cp;
         lead = ucdLookup(cp);
         width = 0;
         state = 0;
@@ -870,15 +1088,43 @@ bool CodepointWidthDetector::_graphemeNext(GraphemeState& s, const std::wstring_
             const auto clusterEndNext = utf16NextOrFFFD(clusterEnd, end, cp);
             const auto trail = ucdLookup(cp);
 
-            state = ucdGraphemeJoins(state, lead, trail);
-            if (ucdGraphemeDone(state))
+            const auto joined = ucdGraphemeJoins(state, lead, trail);
+            if (ucdGraphemeDone(joined))
             {
+                if (consulted && clusterEnd != cachedEnd)
+                {
+                    clusterCacheInsert(clusterBeg, clusterEnd, cp0, cp1, width, state, lead);
+                }
+
                 // We'll later do `state = ~state` which will result in `state == 0`.
                 state = ~0;
                 lead = 0;
                 break;
             }
 
+            if (!consulted)
+            {
+                consulted = true;
+                cp1 = cp;
+
+                ClusterCacheEntry entry;
+                if (clusterCacheLookup(clusterBeg, end, cp0, cp1, entry))
+                {
+                    clusterEnd = clusterBeg + entry.len;
+                    cachedEnd = clusterEnd;
+                    width = entry.width;
+                    state = entry.state;
+                    lead = entry.lead;
+
+                    if (clusterEnd >= end)
+                    {
+                        break;
+                    }
+                    goto fetchNext;
+                }
+            }
+
+            state = joined;
             clusterEnd = clusterEndNext;
             lead = trail;
         }
@@ -1224,9 +1470,12 @@ try
         return 1;
     }
 
-    if (const auto it = _fallbackCache.find(codepoint); it != _fallbackCache.end())
     {
-        return it->second;
+        std::shared_lock lock{ _fallbackLock };
+        if (const auto it = _fallbackCache.find(codepoint); it != _fallbackCache.end())
+        {
+            return it->second;
+        }
     }
 
     wchar_t buf[2];
@@ -1243,7 +1492,11 @@ try
         len = 2;
     }
 
+    // _pfnFallbackMethod calls into the renderer, which is why we don't hold the lock during the call.
+    // Two threads may race to resolve the same codepoint, but they'll arrive at the same result.
     const int width = _pfnFallbackMethod({ &buf[0], len }) ? 2 : 1;
+
+    std::unique_lock lock{ _fallbackLock };
     _fallbackCache.insert_or_assign(codepoint, width);
     return width;
 }
@@ -1276,5 +1529,8 @@ void CodepointWidthDetector::SetFallbackMethod(std::function<bool(const std::wst
 void CodepointWidthDetector::Reset(const TextMeasurementMode mode) noexcept
 {
     _mode = mode;
+
+#pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function 'lock()' which may throw exceptions (f.6).
+    std::unique_lock lock{ _fallbackLock };
     _fallbackCache.clear();
 }
@@ -55,6 +55,14 @@ struct CodepointWidthDetector
     bool GraphemeNext(GraphemeState& s, const std::wstring_view& str) noexcept;
     bool GraphemePrev(GraphemeState& s, const std::wstring_view& str) noexcept;
 
+    // Segments the entire string into grapheme clusters in a single pass, which is a lot faster than calling
+    // GraphemeNext() in a loop. For each cluster, it stores the offset past its end (relative to str.data())
+    // in `ends` and its width (0-2) in `widths`. Stops once the end of the string has been reached or
+    // the smaller of the two arrays is full, and returns the number of clusters it stored.
+    // Clusters are never split, so you can continue segmenting at str.substr(ends[count - 1]).
+    // Unlike GraphemeNext() it doesn't join clusters across separate strings.
+    size_t GraphemeSegment(const std::wstring_view& str, std::span<size_t> ends, std::span<uint8_t> widths) noexcept;
+
     TextMeasurementMode GetMode() const noexcept;
     void SetFallbackMethod(std::function<bool(const std::wstring_view&)> pfnFallback) noexcept;
     void Reset(TextMeasurementMode mode) noexcept;
@@ -66,8 +74,12 @@ private:
     bool _graphemePrevWcswidth(GraphemeState& s, const std::wstring_view& str) const noexcept;
     bool _graphemeNextConsole(GraphemeState& s, const std::wstring_view& str) noexcept;
     bool _graphemePrevConsole(GraphemeState& s, const std::wstring_view& str) noexcept;
+    const wchar_t* _graphemeSegmentOne(const wchar_t* it, const wchar_t* end, int& width) const noexcept;
     __declspec(noinline) int _checkFallbackViaCache(char32_t codepoint) noexcept;
 
+    // The singleton is shared between all terminals in a process (= between multiple output threads).
+    // The lock is never held while calling _pfnFallbackMethod, since that calls into the renderer.
+    std::shared_mutex _fallbackLock;
     std::unordered_map<char32_t, int> _fallbackCache;
     std::function<bool(const std::wstring_view&)> _pfnFallbackMethod;
     TextMeasurementMode _mode = TextMeasurementMode::Graphemes;
@@ -1197,6 +1197,20 @@ class CodepointWidthDetectorTests
                 }
                 std::reverse(actual.begin(), actual.end());
                 VERIFY_ARE_EQUAL(expected, actual, test.comment);
+
+                actual.clear();
+                {
+                    std::array<size_t, 4> ends;
+                    std::array<uint8_t, 4> widths;
+                    const auto count = cwd.GraphemeSegment(text, ends, widths);
+                    size_t beg = 0;
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        actual.emplace_back(text.data() + beg, ends[i] - beg);
+                        beg = ends[i];
+                    }
+                }
+                VERIFY_ARE_EQUAL(expected, actual, test.comment);
             }
         }
     }
@@ -1247,6 +1261,115 @@ class CodepointWidthDetectorTests
         VERIFY_ARE_EQUAL(expectedWidths, actualWidths);
     }
 
+    TEST_METHOD(SegmentCJK)
+    {
+        // 9 ideographs (enough to hit the vectorized path), followed by a combining mark which must join with the last one,
+        // followed by a few characters that aren't ideographs, followed by 8 ideographs which need to be split across batches.
+        static constexpr std::wstring_view text{ L"\u4E00\u4E8C\u4E09\u56DB\u4E94\u516D\u4E03\u516B\u4E5D\u0301a\u4DC0\U0001F308\u9F8D\u9F8D\u9F8D\u9F8D\u9F8D\u9F8D\u9F8D\u9FFF" };
+
+        CodepointWidthDetector cwd;
+        std::vector<size_t> expectedAdvances;
+        std::vector<int> expectedWidths;
+        std::vector<size_t> actualAdvances;
+        std::vector<int> actualWidths;
+
+        for (const auto mode : { TextMeasurementMode::Graphemes, TextMeasurementMode::Wcswidth, TextMeasurementMode::Console })
+        {
+            cwd.Reset(mode);
+
+            expectedAdvances.clear();
+            expectedWidths.clear();
+            for (GraphemeState state;;)
+            {
+                const auto ok = cwd.GraphemeNext(state, text);
+                expectedAdvances.emplace_back(state.len);
+                expectedWidths.emplace_back(state.width);
+                if (!ok)
+                {
+                    break;
+                }
+            }
+
+            // A capacity of 11 forces the text to be split into 2 batches, the second of which starts with the surrogate pair.
+            std::array<size_t, 11> ends;
+            std::array<uint8_t, 11> widths;
+            actualAdvances.clear();
+            actualWidths.clear();
+            for (size_t beg = 0; beg < text.size();)
+            {
+                const auto count = cwd.GraphemeSegment(text.substr(beg), ends, widths);
+                size_t prev = 0;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    actualAdvances.emplace_back(ends[i] - prev);
+                    actualWidths.emplace_back(widths[i]);
+                    prev = ends[i];
+                }
+                beg += prev;
+            }
+
+            VERIFY_ARE_EQUAL(expectedAdvances, actualAdvances);
+            VERIFY_ARE_EQUAL(expectedWidths, actualWidths);
+        }
+
+        cwd.Reset(TextMeasurementMode::Graphemes);
+        std::array<size_t, 64> ends;
+        std::array<uint8_t, 64> widths;
+        VERIFY_ARE_EQUAL(static_cast<size_t>(0), cwd.GraphemeSegment({}, ends, widths));
+        VERIFY_ARE_EQUAL(static_cast<size_t>(1), cwd.GraphemeSegment(text, std::span{ ends }.first(1), widths));
+        VERIFY_ARE_EQUAL(static_cast<size_t>(1), ends[0]);
+        VERIFY_ARE_EQUAL(2, static_cast<int>(widths[0]));
+    }
+
+    TEST_METHOD(ClusterCache)
+    {
+        // The second family emoji extends the first one by another member. Once the first one is cached, it's a prefix of
+        // the second one, which must not prevent us from finding the full cluster. The third one must not match the second one.
+        static constexpr std::wstring_view text{ L"\U0001F468\u200D\U0001F469\u200D\U0001F467\U0001F468\u200D\U0001F469\u200D\U0001F467\u200D\U0001F466\U0001F468\u200D\U0001F469\u200D\U0001F467\U0001F1FA\U0001F1F8\U0001F1FA\U0001F1F8\u0915\u094D\u0937a" };
+
+        const std::vector<size_t> expectedAdvances{ 8, 11, 8, 4, 4, 3, 1 };
+        const std::vector<int> expectedWidths{ 2, 2, 2, 2, 2, 2, 1 };
+        std::vector<size_t> actualAdvances;
+        std::vector<int> actualWidths;
+
+        CodepointWidthDetector cwd;
+
+        // The second iteration will be served from the cache.
+        for (int i = 0; i < 2; ++i)
+        {
+            actualAdvances.clear();
+            actualWidths.clear();
+            for (GraphemeState state;;)
+            {
+                const auto ok = cwd.GraphemeNext(state, text);
+                actualAdvances.emplace_back(state.len);
+                actualWidths.emplace_back(state.width);
+                if (!ok)
+                {
+                    break;
+                }
+            }
+
+            VERIFY_ARE_EQUAL(expectedAdvances, actualAdvances);
+            VERIFY_ARE_EQUAL(expectedWidths, actualWidths);
+
+            std::array<size_t, 16> ends;
+            std::array<uint8_t, 16> widths;
+            const auto count = cwd.GraphemeSegment(text, ends, widths);
+            actualAdvances.clear();
+            actualWidths.clear();
+            for (size_t j = 0, prev = 0; j < count; ++j)
+            {
+                actualAdvances.emplace_back(ends[j] - prev);
+                actualWidths.emplace_back(widths[j]);
+                prev = ends[j];
+            }
+
+            VERIFY_ARE_EQUAL(expectedAdvances, actualAdvances);
+            VERIFY_ARE_EQUAL(expectedWidths, actualWidths);
+        }
+    }
+
     TEST_METHOD(ChunkedText)
     {
         struct Test